@@ -4,6 +4,11 @@
  */
 
 
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
 #include "parserlib.hpp"
 #include "ebnf.hpp"
 
@@ -90,13 +95,417 @@ namespace parserlib::ebnf {
     static const auto concatenation = (factor >> *(',' >> WS >> factor)) >= EBNF::CONCATENATION;
 
 
-    static const Rule<EBNFParseContext> alternation = (concatenation >> *('|' >> WS >> concatenation)) >= EBNF::ALTERNATION;
+    const Rule<EBNFParseContext> alternation = (concatenation >> *('|' >> WS >> concatenation)) >= EBNF::ALTERNATION;
 
 
     static const auto rule = (WS >> identifier >> WS >> '=' >> WS >> alternation >> terminator) >= EBNF::RULE;
 
 
-    static const auto ebnf = *rule;
+    static const auto ebnf = *rule >> WS;
+
+
+    bool parse(const std::string& source, std::vector<Match>& matches) {
+        EBNFParseContext pc(source);
+        const bool ok = ebnf(pc) && pc.sourceEnded();
+        matches = pc.matches();
+        return ok;
+    }
+
+
+    /**
+     * Compiles the match tree of an EBNF grammar into a bytecode program.
+     *
+     * The rules are analyzed before they are compiled, in order to reject left-recursive rules,
+     * since the machine calls the rules of the program directly.
+     */
+    class GrammarCompiler {
+    public:
+        /**
+         * Compiles an EBNF grammar.
+         * @param source source of the grammar.
+         * @param rootRule name of the root rule; if empty, then the first rule of the grammar is the root rule.
+         * @return the compiled grammar.
+         */
+        static Grammar compile(const std::string& source, const std::string& rootRule) {
+            EBNFParseContext pc(source);
+            if (!ebnf(pc) || !pc.sourceEnded()) {
+                throw compileError("syntax error", !pc.errors().empty() ? pc.errors().back().position() : pc.sourcePosition());
+            }
+            GrammarCompiler compiler;
+            compiler.compileGrammar(pc.matches(), rootRule);
+            return std::move(compiler.m_grammar);
+        }
+
+    private:
+        using PositionType = LineCountingSourcePosition<std::string>;
+        using ProgramType = Grammar::ProgramType;
+
+        static constexpr std::uint32_t NoOperand = BytecodeInstruction::NoOperand;
+
+        //result of analyzing a term: if it may succeed without consuming input,
+        //and the rules it may invoke at the position it starts from
+        struct Analysis {
+            bool nullable;
+            std::vector<size_t> leftRules;
+        };
+
+        //compilation data of a rule
+        struct RuleEntry {
+            std::string name;
+            const Match* expression;
+            PositionType position;
+            bool nullable{ false };
+            std::vector<size_t> leftRules;
+            std::uint32_t address{ NoOperand };
+        };
+
+        std::vector<RuleEntry> m_rules;
+        std::map<std::string, size_t> m_ruleIndexes;
+        std::vector<std::pair<std::uint32_t, size_t>> m_calls;
+        Grammar m_grammar;
+
+        //the default constructor; compilers are created only by the compile function
+        GrammarCompiler() {
+        }
+
+        //creates an exception for an error at the given position
+        static std::runtime_error compileError(const std::string& text, const PositionType& position) {
+            return std::runtime_error("ebnf: " + text + " at line " + std::to_string(position.line()) + ", column " + std::to_string(position.column()));
+        }
+
+        //returns the string of a terminal, without the quotes
+        static std::string terminalString(const Match& terminal) {
+            const std::string content = terminal.content();
+            return content.substr(1, content.size() - 2);
+        }
+
+        //finds the rules, analyzes them, then emits a call to the root rule, and the rules
+        void compileGrammar(const std::vector<Match>& matches, const std::string& rootRule) {
+            for (const Match& match : matches) {
+                const Match& identifier = match.children()[0];
+                const std::string name = identifier.content();
+                if (!m_ruleIndexes.emplace(name, m_rules.size()).second) {
+                    throw compileError("rule '" + name + "' is defined twice", identifier.begin());
+                }
+                m_rules.push_back(RuleEntry{ name, &match.children()[1], identifier.begin() });
+                m_grammar.m_ruleNames.push_back(name);
+            }
+            if (m_rules.empty()) {
+                throw std::runtime_error("ebnf: the grammar has no rules");
+            }
+            const std::string rootName = rootRule.empty() ? m_rules[0].name : rootRule;
+            const auto root = m_ruleIndexes.find(rootName);
+            if (root == m_ruleIndexes.end()) {
+                throw std::runtime_error("ebnf: the root rule '" + rootName + "' is not defined");
+            }
+            m_grammar.m_rootRule = rootName;
+
+            analyzeGrammar();
+
+            ProgramType& program = m_grammar.m_program;
+            m_calls.push_back(std::make_pair(program.addInstruction(BytecodeOpcode::Call), root->second));
+            program.addInstruction(BytecodeOpcode::Halt);
+            for (RuleEntry& rule : m_rules) {
+                rule.address = program.nextAddress();
+                program.addInstruction(BytecodeOpcode::OpenTreeMatch);
+                emit(*rule.expression);
+                program.addInstruction(BytecodeOpcode::CloseTreeMatch, program.addMatchId(rule.name));
+                program.addInstruction(BytecodeOpcode::Return);
+            }
+            for (const auto& [address, ruleIndex] : m_calls) {
+                program.setOperand(address, m_rules[ruleIndex].address);
+            }
+        }
+
+        //finds which rules are nullable, then rejects left-recursive rules
+        void analyzeGrammar() {
+            //repeat until nothing changes, since rules may be recursive
+            for (bool changed = true; changed;) {
+                changed = false;
+                for (RuleEntry& rule : m_rules) {
+                    Analysis analysis = analyze(*rule.expression);
+                    changed = changed || analysis.nullable != rule.nullable;
+                    rule.nullable = analysis.nullable;
+                    rule.leftRules = std::move(analysis.leftRules);
+                }
+            }
+
+            //a rule is left-recursive if it can invoke itself without consuming input
+            for (size_t ruleIndex = 0; ruleIndex < m_rules.size(); ++ruleIndex) {
+                std::vector<bool> visited(m_rules.size(), false);
+                std::vector<size_t> pending = m_rules[ruleIndex].leftRules;
+                while (!pending.empty()) {
+                    const size_t index = pending.back();
+                    pending.pop_back();
+                    if (index == ruleIndex) {
+                        throw compileError("rule '" + m_rules[ruleIndex].name + "' is left-recursive", m_rules[ruleIndex].position);
+                    }
+                    if (!visited[index]) {
+                        visited[index] = true;
+                        pending.insert(pending.end(), m_rules[index].leftRules.begin(), m_rules[index].leftRules.end());
+                    }
+                }
+            }
+        }
+
+        //analyze a sequence of analyses
+        static void analyzeSequence(Analysis& result, Analysis&& analysis) {
+            if (result.nullable) {
+                result.leftRules.insert(result.leftRules.end(), analysis.leftRules.begin(), analysis.leftRules.end());
+                result.nullable = analysis.nullable;
+            }
+        }
+
+        //analyze a term
+        Analysis analyze(const Match& match) {
+            switch (match.id()) {
+                case EBNF::ALTERNATION: {
+                    Analysis result{ false, {} };
+                    for (const Match& child : match.children()) {
+                        Analysis analysis = analyze(child);
+                        result.nullable = result.nullable || analysis.nullable;
+                        result.leftRules.insert(result.leftRules.end(), analysis.leftRules.begin(), analysis.leftRules.end());
+                    }
+                    return result;
+                }
+
+                case EBNF::CONCATENATION: {
+                    Analysis result{ true, {} };
+                    for (const Match& child : match.children()) {
+                        analyzeSequence(result, analyze(child));
+                    }
+                    return result;
+                }
+
+                case EBNF::TERM_GROUPED:
+                case EBNF::TERM_REPEATED_1_OR_MORE_POSTFIX:
+                    return analyze(match.children()[0]);
+
+                case EBNF::TERM_OPTIONAL:
+                case EBNF::TERM_REPEATED:
+                case EBNF::TERM_OPTIONAL_POSTFIX:
+                case EBNF::TERM_REPEATED_0_OR_MORE_POSTFIX:
+                    return { true, analyze(match.children()[0]).leftRules };
+
+                //the exception is tested before the term
+                case EBNF::EXCEPTION: {
+                    Analysis result{ true, analyze(match.children()[1]).leftRules };
+                    analyzeSequence(result, analyze(match.children()[0]));
+                    return result;
+                }
+
+                case EBNF::TERMINAL:
+                    return { terminalString(match).empty(), {} };
+
+                case EBNF::IDENTIFIER: {
+                    const size_t index = ruleIndex(match);
+                    return { m_rules[index].nullable, { index } };
+                }
+
+                default:
+                    throw compileError("unexpected term", match.begin());
+            }
+        }
+
+        //returns the index of the rule the given identifier refers to
+        size_t ruleIndex(const Match& identifier) const {
+            const std::string name = identifier.content();
+            const auto it = m_ruleIndexes.find(name);
+            if (it == m_ruleIndexes.end()) {
+                throw compileError("rule '" + name + "' is not defined", identifier.begin());
+            }
+            return it->second;
+        }
+
+        //adds the values of a term to the given vector, if the term is a single-character terminal or an alternation of them
+        static bool addCharacterSet(const Match& match, std::vector<char>& values) {
+            switch (match.id()) {
+                case EBNF::ALTERNATION:
+                    for (const Match& child : match.children()) {
+                        if (!addCharacterSet(child, values)) {
+                            return false;
+                        }
+                    }
+                    return true;
+
+                case EBNF::CONCATENATION:
+                    return match.children().size() == 1 && addCharacterSet(match.children()[0], values);
+
+                case EBNF::TERM_GROUPED:
+                    return addCharacterSet(match.children()[0], values);
+
+                case EBNF::TERMINAL: {
+                    const std::string str = terminalString(match);
+                    if (str.size() != 1) {
+                        return false;
+                    }
+                    values.push_back(str[0]);
+                    return true;
+                }
+
+                default:
+                    return false;
+            }
+        }
+
+        //invokes a parser natively
+        template <class ParserType> static bool invokeNative(const void* parser, GrammarParseContext& pc) {
+            return (*static_cast<const ParserType*>(parser))(pc);
+        }
+
+        //adds a character set to the program, along with the parser that records its errors
+        std::uint32_t addCharacterSet(const std::vector<char>& values, std::uint32_t& errorOperand) {
+            ProgramType& program = m_grammar.m_program;
+            m_grammar.m_setParsers.push_back(std::make_unique<TerminalSetParser<char>>(values));
+            errorOperand = program.addNativeParser(m_grammar.m_setParsers.back().get(), &invokeNative<TerminalSetParser<char>>);
+            return program.addCharacterSet(CharacterSet(values));
+        }
+
+        //emit a loop over the given term, as an optional that is resumed after each iteration
+        void emitLoop(const Match& match) {
+            ProgramType& program = m_grammar.m_program;
+            const std::uint32_t optional = program.addInstruction(BytecodeOpcode::Optional);
+            const std::uint32_t body = program.nextAddress();
+            emit(match);
+            program.addInstruction(BytecodeOpcode::LoopNext, body);
+            program.setOperand(optional, program.nextAddress());
+        }
+
+        //emit a term
+        void emit(const Match& match) {
+            ProgramType& program = m_grammar.m_program;
+
+            std::vector<char> values;
+            if (addCharacterSet(match, values)) {
+                std::uint32_t errorOperand;
+                const std::uint32_t set = addCharacterSet(values, errorOperand);
+                program.addInstruction(BytecodeOpcode::Set, set, errorOperand);
+                return;
+            }
+
+            switch (match.id()) {
+                //one choice frame is used for all the alternatives
+                case EBNF::ALTERNATION: {
+                    if (match.children().size() == 1) {
+                        emit(match.children()[0]);
+                        break;
+                    }
+                    std::vector<std::uint32_t> commits;
+                    std::uint32_t alternative = program.addInstruction(BytecodeOpcode::Choice);
+                    for (size_t index = 0; index < match.children().size(); ++index) {
+                        if (index > 0) {
+                            program.setOperand(alternative, program.nextAddress());
+                            alternative = program.addInstruction(BytecodeOpcode::NextChoice);
+                        }
+                        emit(match.children()[index]);
+                        commits.push_back(program.addInstruction(BytecodeOpcode::Commit));
+                    }
+                    for (const std::uint32_t commit : commits) {
+                        program.setOperand(commit, program.nextAddress());
+                    }
+                    break;
+                }
+
+                case EBNF::CONCATENATION:
+                    for (const Match& child : match.children()) {
+                        emit(child);
+                    }
+                    break;
+
+                case EBNF::TERM_GROUPED:
+                    emit(match.children()[0]);
+                    break;
+
+                case EBNF::TERM_OPTIONAL:
+                case EBNF::TERM_OPTIONAL_POSTFIX: {
+                    const std::uint32_t optional = program.addInstruction(BytecodeOpcode::Optional);
+                    emit(match.children()[0]);
+                    const std::uint32_t commit = program.addInstruction(BytecodeOpcode::Commit);
+                    program.setOperand(optional, program.nextAddress());
+                    program.setOperand(commit, program.nextAddress());
+                    break;
+                }
+
+                //repetitions of character sets are spans
+                case EBNF::TERM_REPEATED:
+                case EBNF::TERM_REPEATED_0_OR_MORE_POSTFIX:
+                    if (addCharacterSet(match.children()[0], values)) {
+                        program.addInstruction(BytecodeOpcode::Span, program.addCharacterSet(CharacterSet(values)));
+                    }
+                    else {
+                        emitLoop(match.children()[0]);
+                    }
+                    break;
+
+                //the first iteration must consume input
+                case EBNF::TERM_REPEATED_1_OR_MORE_POSTFIX:
+                    if (addCharacterSet(match.children()[0], values)) {
+                        std::uint32_t errorOperand;
+                        const std::uint32_t set = addCharacterSet(values, errorOperand);
+                        program.addInstruction(BytecodeOpcode::Set, set, errorOperand);
+                        program.addInstruction(BytecodeOpcode::Span, set);
+                    }
+                    else {
+                        program.addInstruction(BytecodeOpcode::PushPosition);
+                        emit(match.children()[0]);
+                        program.addInstruction(BytecodeOpcode::CheckAdvance);
+                        emitLoop(match.children()[0]);
+                    }
+                    break;
+
+                //the term is parsed if the exception does not parse
+                case EBNF::EXCEPTION: {
+                    const std::uint32_t predicate = program.addInstruction(BytecodeOpcode::Predicate);
+                    emit(match.children()[1]);
+                    program.addInstruction(BytecodeOpcode::PredicateFail);
+                    program.setOperand(predicate, program.nextAddress());
+                    emit(match.children()[0]);
+                    break;
+                }
+
+                case EBNF::TERMINAL: {
+                    const std::string str = terminalString(match);
+                    m_grammar.m_stringParsers.push_back(std::make_unique<TerminalStringParser<char>>(str.c_str()));
+                    const TerminalStringParser<char>& parser = *m_grammar.m_stringParsers.back();
+                    const std::uint32_t errorOperand = program.addNativeParser(std::addressof(parser), &invokeNative<TerminalStringParser<char>>);
+                    program.addInstruction(BytecodeOpcode::String, program.addString(parser.string(), parser.foldedString()), errorOperand);
+                    break;
+                }
+
+                case EBNF::IDENTIFIER:
+                    m_calls.push_back(std::make_pair(program.addInstruction(BytecodeOpcode::Call), ruleIndex(match)));
+                    break;
+
+                default:
+                    throw compileError("unexpected term", match.begin());
+            }
+        }
+    };
+
+
+    Grammar compile(const std::string& source, const std::string& rootRule) {
+        return GrammarCompiler::compile(source, rootRule);
+    }
+
+
+    std::shared_ptr<const Grammar> load(const std::string& filename, const std::string& rootRule) {
+        static std::mutex mutex;
+        static std::map<std::pair<std::string, std::string>, std::shared_ptr<const Grammar>> cache;
+
+        //grammars are compiled while the cache is locked, so as that each grammar is compiled once
+        const std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<const Grammar>& grammar = cache[std::make_pair(filename, rootRule)];
+        if (!grammar) {
+            std::ifstream file(filename, std::ios::binary);
+            if (!file) {
+                throw std::runtime_error("ebnf: cannot open file: " + filename);
+            }
+            std::stringstream stream;
+            stream << file.rdbuf();
+            grammar = std::make_shared<const Grammar>(compile(stream.str(), rootRule));
+        }
+        return grammar;
+    }
 
 
 } //namespace parserlib::ebnf
@@ -2,8 +2,17 @@
 #define PARSERLIB_EBNF_HPP
 
 
+#include <string>
+#include <vector>
+#include <memory>
 #include "parserlib/Match.hpp"
 #include "parserlib/LineCountingSourcePosition.hpp"
+#include "parserlib/ParseContext.hpp"
+#include "parserlib/Rule.hpp"
+#include "parserlib/BytecodeProgram.hpp"
+#include "parserlib/BytecodeMachine.hpp"
+#include "parserlib/TerminalStringParser.hpp"
+#include "parserlib/TerminalSetParser.hpp"
 
 
 namespace parserlib::ebnf {
@@ -81,6 +90,107 @@ namespace parserlib::ebnf {
     using Match = parserlib::Match<std::string, EBNF, LineCountingSourcePosition<std::string>>;
 
 
+    /**
+     * Parses an EBNF grammar.
+     * @param source source to parse.
+     * @param matches the matches of the parsed grammar rules.
+     * @return true if the whole source was parsed successfully, false otherwise.
+     */
+    bool parse(const std::string& source, std::vector<Match>& matches);
+
+
+    /**
+     * Parse context type for grammars compiled from EBNF; match ids are rule names.
+     */
+    using GrammarParseContext = ParseContext<std::string, std::string>;
+
+
+    /**
+     * A grammar compiled from EBNF at runtime.
+     *
+     * The grammar is a bytecode program, which is run by the bytecode machine; each rule is called by the machine,
+     * and it adds a tree match with the name of the rule as the match id.
+     * Alternations of single-character terminals are compiled to character sets, and repetitions of them to spans.
+     *
+     * Grammars are immutable, and therefore they can be shared by multiple threads.
+     */
+    class Grammar {
+    public:
+        /**
+         * Program type.
+         */
+        using ProgramType = BytecodeProgram<GrammarParseContext>;
+
+        /**
+         * Returns the bytecode program of the grammar.
+         * @return the bytecode program of the grammar.
+         */
+        const ProgramType& program() const {
+            return m_program;
+        }
+
+        /**
+         * Returns the name of the root rule of the grammar.
+         * @return the name of the root rule.
+         */
+        const std::string& rootRule() const {
+            return m_rootRule;
+        }
+
+        /**
+         * Returns the names of the rules of the grammar, in the order they are defined.
+         * @return the names of the rules.
+         */
+        const std::vector<std::string>& ruleNames() const {
+            return m_ruleNames;
+        }
+
+        /**
+         * Parses the source of the given parse context with the root rule.
+         * @param pc parse context.
+         * @return true if parsing succeeds, false otherwise.
+         */
+        bool operator ()(GrammarParseContext& pc) const {
+            return m_program(pc);
+        }
+
+    private:
+        ProgramType m_program;
+        std::string m_rootRule;
+        std::vector<std::string> m_ruleNames;
+
+        //the parsers that record the errors of the terminals; the program refers to them
+        std::vector<std::unique_ptr<TerminalStringParser<char>>> m_stringParsers;
+        std::vector<std::unique_ptr<TerminalSetParser<char>>> m_setParsers;
+
+        friend class GrammarCompiler;
+    };
+
+
+    /**
+     * Compiles an EBNF grammar.
+     * @param source source of the grammar.
+     * @param rootRule name of the root rule; if empty, then the first rule of the grammar is the root rule.
+     * @return the compiled grammar.
+     * @exception std::runtime_error thrown if the source cannot be parsed, if a rule is defined twice,
+     *  if a rule refers to an undefined rule, if a rule is left-recursive, or if the root rule is not defined;
+     *  the message contains the line and column of the error.
+     */
+    Grammar compile(const std::string& source, const std::string& rootRule = std::string());
+
+
+    /**
+     * Loads and compiles an EBNF grammar file, once per process.
+     * Compiled grammars are cached by file name and root rule; subsequent calls return the cached grammar,
+     * even if the file has changed since. The function is thread-safe.
+     * @param filename name of the grammar file.
+     * @param rootRule name of the root rule; if empty, then the first rule of the grammar is the root rule.
+     * @return the compiled grammar.
+     * @exception std::runtime_error thrown if the file cannot be read, or if the grammar cannot be compiled.
+     */
+    std::shared_ptr<const Grammar> load(const std::string& filename, const std::string& rootRule = std::string());
+
+
 } //namespace parserlib::ebnf
 
 
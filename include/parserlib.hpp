@@ -6,9 +6,12 @@
 #include "parserlib/TerminalStringParser.hpp"
 #include "parserlib/TerminalRangeParser.hpp"
 #include "parserlib/TerminalSetParser.hpp"
+#include "parserlib/KeywordsParser.hpp"
 #include "parserlib/EOFParser.hpp"
 #include "parserlib/EmptyParser.hpp"
+#include "parserlib/CutParser.hpp"
 #include "parserlib/Rule.hpp"
+#include "parserlib/PushSource.hpp"
 #include "parserlib/util.hpp"
 
 
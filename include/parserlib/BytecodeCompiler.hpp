@@ -0,0 +1,493 @@
+#ifndef PARSERLIB_BYTECODECOMPILER_HPP
+#define PARSERLIB_BYTECODECOMPILER_HPP
+
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include <utility>
+#include "BytecodeProgram.hpp"
+#include "BytecodeMachine.hpp"
+#include "ParserVisitor.hpp"
+#include "Rule.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * Lowers a grammar, i.e. a tree of parser nodes and the rules it refers to, into a bytecode program.
+     *
+     * Character predicates (terminals, sets, ranges, and choices of them) become single set tests,
+     * and loops over them become spans; sequences, choices, loops, optionals, predicates, matches, cuts and rules
+     * become instructions of the machine, so as that parsing them does not use the native stack.
+     *
+     * The following parsers are invoked natively, i.e. directly by the machine, along with the parsers they contain:
+     *  - rules that are left-recursive, which are found by analyzing the grammar before compiling it;
+     *  - error recovery parsers, loops with a fixed count, and parser node types unknown to the compiler.
+     *
+     * The compiled program refers to the parsers it is compiled from, and therefore the grammar must outlive the program.
+     *
+     * The grammar is inspected through a `ParserVisitor`; therefore the compiler is instantiated only by the code that compiles bytecode,
+     * not by every rule.
+     *
+     * @param ParseContextType type of parse context to use for parsing.
+     */
+    template <class ParseContextType> class BytecodeCompiler : private ParserVisitor<ParseContextType> {
+    public:
+        /**
+         * Program type.
+         */
+        using ProgramType = BytecodeProgram<ParseContextType>;
+
+        /**
+         * Rule type.
+         */
+        using RuleType = Rule<ParseContextType>;
+
+        /**
+         * Compiles a grammar.
+         * @param parser the root of the grammar; it must outlive the program.
+         * @return the program.
+         */
+        template <class ParserNodeType> static ProgramType compile(const ParserNode<ParserNodeType>& parser) {
+            BytecodeCompiler compiler;
+            compiler.compileGrammar(VisitorType::node(static_cast<const ParserNodeType&>(parser)));
+            return std::move(compiler.m_program);
+        }
+
+        /**
+         * Compiles a grammar.
+         * @param rule the root rule of the grammar; it must outlive the program.
+         * @return the program.
+         */
+        static ProgramType compile(const RuleType& rule) {
+            BytecodeCompiler compiler;
+            const RuleReference<ParseContextType> root(rule);
+            compiler.compileGrammar(VisitorType::node(root));
+            return std::move(compiler.m_program);
+        }
+
+    private:
+        using VisitorType = ParserVisitor<ParseContextType>;
+        using Node = typename VisitorType::Node;
+        using ElementType = typename VisitorType::ElementType;
+        using MatchIdType = typename VisitorType::MatchIdType;
+
+        static constexpr std::uint32_t NoOperand = BytecodeInstruction::NoOperand;
+
+        //result of analyzing a parser: if it may succeed without consuming input,
+        //and the rules it may invoke at the position it starts from
+        struct Analysis {
+            bool nullable;
+            std::vector<size_t> leftRules;
+        };
+
+        //compilation data of a rule
+        struct RuleEntry {
+            const RuleType* rule;
+            bool nullable{ false };
+            std::vector<size_t> leftRules;
+            bool leftRecursive{ false };
+            std::uint32_t address{ NoOperand };
+            bool scheduled{ false };
+        };
+
+        ProgramType m_program;
+        std::vector<RuleEntry> m_rules;
+        std::map<const RuleType*, size_t> m_ruleIndexes;
+        std::vector<std::pair<std::uint32_t, size_t>> m_calls;
+        std::vector<size_t> m_scheduledRules;
+        bool m_analyzing{ false };
+        Analysis m_analysis;
+
+        //if the failure of the parser being emitted leaves the state for the enclosing frame, i.e. if it is not within a sequence
+        bool m_keepsFailureState{ true };
+
+        //the default constructor; compilers are created only by the compile functions
+        BytecodeCompiler() {
+        }
+
+        //analyzes the grammar, then emits the root, then the rules that are invoked by the machine
+        void compileGrammar(const Node& root) {
+            analyzeGrammar(root);
+
+            emit(root);
+            addInstruction(BytecodeOpcode::Halt);
+
+            while (!m_scheduledRules.empty()) {
+                const size_t ruleIndex = m_scheduledRules.back();
+                m_scheduledRules.pop_back();
+                m_rules[ruleIndex].address = m_program.nextAddress();
+                m_rules[ruleIndex].rule->accept(*this);
+                addInstruction(BytecodeOpcode::Return);
+            }
+
+            for (const auto& [address, ruleIndex] : m_calls) {
+                m_program.setOperand(address, m_rules[ruleIndex].address);
+            }
+        }
+
+        //finds the rules of the grammar, and which ones are left-recursive
+        void analyzeGrammar(const Node& root) {
+            m_analyzing = true;
+            analyze(root);
+
+            //find which rules are nullable; repeat until nothing changes, since rules may be recursive
+            for (bool changed = true; changed;) {
+                changed = false;
+                for (size_t ruleIndex = 0; ruleIndex < m_rules.size(); ++ruleIndex) {
+                    m_rules[ruleIndex].rule->accept(*this);
+                    changed = changed || m_analysis.nullable != m_rules[ruleIndex].nullable;
+                    m_rules[ruleIndex].nullable = m_analysis.nullable;
+                    m_rules[ruleIndex].leftRules = std::move(m_analysis.leftRules);
+                }
+            }
+
+            //a rule is left-recursive if it can invoke itself without consuming input
+            for (size_t ruleIndex = 0; ruleIndex < m_rules.size(); ++ruleIndex) {
+                std::vector<bool> visited(m_rules.size(), false);
+                std::vector<size_t> pending = m_rules[ruleIndex].leftRules;
+                while (!pending.empty() && !m_rules[ruleIndex].leftRecursive) {
+                    const size_t index = pending.back();
+                    pending.pop_back();
+                    if (index == ruleIndex) {
+                        m_rules[ruleIndex].leftRecursive = true;
+                    }
+                    else if (!visited[index]) {
+                        visited[index] = true;
+                        pending.insert(pending.end(), m_rules[index].leftRules.begin(), m_rules[index].leftRules.end());
+                    }
+                }
+            }
+
+            m_analyzing = false;
+        }
+
+        //returns the index of the given rule, adding it if needed
+        size_t ruleIndex(const RuleType& rule) {
+            const auto [it, inserted] = m_ruleIndexes.insert(std::make_pair(std::addressof(rule), m_rules.size()));
+            if (inserted) {
+                m_rules.push_back(RuleEntry{ std::addressof(rule) });
+            }
+            return it->second;
+        }
+
+        //invokes a left-recursive rule natively
+        static bool invokeRule(const void* rule, ParseContextType& pc) {
+            return (*static_cast<const RuleType*>(rule))(pc);
+        }
+
+        //adds a native parser to the program
+        std::uint32_t addNativeParser(const Node& node) {
+            return m_program.addNativeParser(node.parser, node.parse);
+        }
+
+        //adds a native parser to the program for recording the errors of the given parser, if errors are tracked
+        std::uint32_t addErrorParser(const Node& node) {
+            if constexpr (ParseContextType::ErrorTrackingPolicy::enabled) {
+                return addNativeParser(node);
+            }
+            else {
+                return NoOperand;
+            }
+        }
+
+        //analyze a sequence of analyses
+        static void analyzeSequence(Analysis& result, Analysis&& analysis) {
+            if (result.nullable) {
+                result.leftRules.insert(result.leftRules.end(), analysis.leftRules.begin(), analysis.leftRules.end());
+                result.nullable = analysis.nullable;
+            }
+        }
+
+        //analyze parser; the visit functions store the analysis of the parser they visit
+        Analysis analyze(const Node& node) {
+            node(*this);
+            return std::move(m_analysis);
+        }
+
+        //emit parser; the visit functions emit the instructions of the parser they visit
+        void emit(const Node& node) {
+            node(*this);
+        }
+
+        //emit parser, with the given failure mode for its instructions
+        void emit(const Node& node, bool keepsFailureState) {
+            const bool previousKeepsFailureState = m_keepsFailureState;
+            m_keepsFailureState = keepsFailureState;
+            node(*this);
+            m_keepsFailureState = previousKeepsFailureState;
+        }
+
+        //adds an instruction with the failure mode of the parser being emitted
+        std::uint32_t addInstruction(BytecodeOpcode opcode, std::uint32_t operand = NoOperand, std::uint32_t errorOperand = NoOperand) {
+            return m_program.addInstruction(opcode, operand, errorOperand, m_keepsFailureState);
+        }
+
+        //emit loop over the given child; the loop is an optional that is resumed after each iteration
+        void emitLoop(const Node& child) {
+            const std::uint32_t optional = addInstruction(BytecodeOpcode::Optional);
+            const std::uint32_t body = m_program.nextAddress();
+            emit(child, true);
+            addInstruction(BytecodeOpcode::LoopNext, body);
+            m_program.setOperand(optional, m_program.nextAddress());
+        }
+
+        //character predicates become set tests
+        void visitCharacterSet(const Node& node, const CharacterSet& set) override {
+            if (m_analyzing) {
+                m_analysis = { false, {} };
+                return;
+            }
+            addInstruction(BytecodeOpcode::Set, m_program.addCharacterSet(set), addErrorParser(node));
+        }
+
+        //terminal strings become string tests
+        void visitString(const Node& node, const ElementType* string, const ElementType* foldedString) override {
+            if (m_analyzing) {
+                m_analysis = { string[0] == ElementType(), {} };
+                return;
+            }
+            addInstruction(BytecodeOpcode::String, m_program.addString(string, foldedString), addErrorParser(node));
+        }
+
+        //sequence
+        void visitSequence(const Node* children, size_t count) override {
+            if (m_analyzing) {
+                Analysis result{ true, {} };
+                for (size_t index = 0; index < count; ++index) {
+                    analyzeSequence(result, analyze(children[index]));
+                }
+                m_analysis = std::move(result);
+                return;
+            }
+            //a sequence restores its state when it fails
+            for (size_t index = 0; index < count; ++index) {
+                emit(children[index], m_keepsFailureState && count == 1);
+            }
+        }
+
+        //choice; one choice frame is used for all the alternatives
+        void visitChoice(const Node* children, size_t count) override {
+            if (m_analyzing) {
+                Analysis result{ false, {} };
+                for (size_t index = 0; index < count; ++index) {
+                    Analysis analysis = analyze(children[index]);
+                    result.nullable = result.nullable || analysis.nullable;
+                    result.leftRules.insert(result.leftRules.end(), analysis.leftRules.begin(), analysis.leftRules.end());
+                }
+                m_analysis = std::move(result);
+                return;
+            }
+            std::vector<std::uint32_t> commits;
+            std::uint32_t alternative = addInstruction(BytecodeOpcode::Choice);
+            for (size_t index = 0; index < count; ++index) {
+                if (index > 0) {
+                    m_program.setOperand(alternative, m_program.nextAddress());
+                    alternative = addInstruction(BytecodeOpcode::NextChoice);
+                }
+                emit(children[index], true);
+                commits.push_back(addInstruction(BytecodeOpcode::Commit));
+            }
+            for (const std::uint32_t commit : commits) {
+                m_program.setOperand(commit, m_program.nextAddress());
+            }
+        }
+
+        //loop 0; loops over character predicates become spans
+        void visitLoop0(const Node& child, const CharacterSet* set) override {
+            if (m_analyzing) {
+                m_analysis = { true, analyze(child).leftRules };
+                return;
+            }
+            if (set) {
+                addInstruction(BytecodeOpcode::Span, m_program.addCharacterSet(*set));
+            }
+            else {
+                emitLoop(child);
+            }
+        }
+
+        //loop 1; the first iteration must consume input
+        void visitLoop1(const Node& child, const CharacterSet* set) override {
+            if (m_analyzing) {
+                m_analysis = analyze(child);
+                return;
+            }
+            if (set) {
+                const std::uint32_t setIndex = m_program.addCharacterSet(*set);
+                addInstruction(BytecodeOpcode::Set, setIndex, addErrorParser(child));
+                addInstruction(BytecodeOpcode::Span, setIndex);
+            }
+            else {
+                addInstruction(BytecodeOpcode::PushPosition);
+                emit(child);
+                addInstruction(BytecodeOpcode::CheckAdvance);
+                emitLoop(child);
+            }
+        }
+
+        //loop n; it is invoked natively
+        void visitLoopN(const Node& node, const Node& child, size_t loopCount) override {
+            if (m_analyzing) {
+                m_analysis = analyze(child);
+                m_analysis.nullable = m_analysis.nullable || loopCount == 0;
+                return;
+            }
+            addInstruction(BytecodeOpcode::Native, addNativeParser(node));
+        }
+
+        //optional
+        void visitOptional(const Node& child) override {
+            if (m_analyzing) {
+                m_analysis = { true, analyze(child).leftRules };
+                return;
+            }
+            const std::uint32_t optional = addInstruction(BytecodeOpcode::Optional);
+            emit(child, true);
+            const std::uint32_t commit = addInstruction(BytecodeOpcode::Commit);
+            m_program.setOperand(optional, m_program.nextAddress());
+            m_program.setOperand(commit, m_program.nextAddress());
+        }
+
+        //and
+        void visitAnd(const Node& child) override {
+            if (m_analyzing) {
+                m_analysis = { true, analyze(child).leftRules };
+                return;
+            }
+            addInstruction(BytecodeOpcode::Predicate);
+            emit(child);
+            addInstruction(BytecodeOpcode::PredicateSucceed);
+        }
+
+        //not
+        void visitNot(const Node& child) override {
+            if (m_analyzing) {
+                m_analysis = { true, analyze(child).leftRules };
+                return;
+            }
+            const std::uint32_t predicate = addInstruction(BytecodeOpcode::Predicate);
+            emit(child);
+            addInstruction(BytecodeOpcode::PredicateFail);
+            m_program.setOperand(predicate, m_program.nextAddress());
+        }
+
+        //match
+        void visitMatch(const Node& child, const MatchIdType& matchId) override {
+            if (m_analyzing) {
+                m_analysis = analyze(child);
+                return;
+            }
+            addInstruction(BytecodeOpcode::OpenMatch);
+            emit(child);
+            addInstruction(BytecodeOpcode::CloseMatch, m_program.addMatchId(matchId));
+        }
+
+        //tree match
+        void visitTreeMatch(const Node& child, const MatchIdType& matchId) override {
+            if (m_analyzing) {
+                m_analysis = analyze(child);
+                return;
+            }
+            addInstruction(BytecodeOpcode::OpenTreeMatch);
+            emit(child);
+            addInstruction(BytecodeOpcode::CloseTreeMatch, m_program.addMatchId(matchId));
+        }
+
+        //error parser; it is invoked natively, and the recovery parser may be invoked at the start position,
+        //if the left-hand-side parser fails
+        void visitErrorParser(const Node& node, const Node& lhs, const Node& rhs) override {
+            if (m_analyzing) {
+                Analysis result = analyze(lhs);
+                Analysis recovery = analyze(rhs);
+                result.nullable = true;
+                result.leftRules.insert(result.leftRules.end(), recovery.leftRules.begin(), recovery.leftRules.end());
+                m_analysis = std::move(result);
+                return;
+            }
+            addInstruction(BytecodeOpcode::Native, addNativeParser(node));
+        }
+
+        //empty
+        void visitEmpty() override {
+            if (m_analyzing) {
+                m_analysis = { true, {} };
+            }
+        }
+
+        //eof
+        void visitEndOfSource() override {
+            if (m_analyzing) {
+                m_analysis = { true, {} };
+                return;
+            }
+            addInstruction(BytecodeOpcode::EndOfSource);
+        }
+
+        //cut
+        void visitCut() override {
+            if (m_analyzing) {
+                m_analysis = { true, {} };
+                return;
+            }
+            addInstruction(BytecodeOpcode::Cut);
+        }
+
+        //rule reference; left-recursive rules are invoked natively, other rules are called
+        void visitRule(const RuleType& rule) override {
+            const size_t index = ruleIndex(rule);
+            if (m_analyzing) {
+                m_analysis = { m_rules[index].nullable, { index } };
+                return;
+            }
+            if (m_rules[index].leftRecursive) {
+                addInstruction(BytecodeOpcode::Native, m_program.addNativeParser(std::addressof(rule), &invokeRule));
+                return;
+            }
+            m_calls.push_back(std::make_pair(addInstruction(BytecodeOpcode::Call), index));
+            if (!m_rules[index].scheduled) {
+                m_rules[index].scheduled = true;
+                m_scheduledRules.push_back(index);
+            }
+        }
+
+        //a parser that is opaque to the compiler; it is invoked natively
+        void visitParser(const Node& node, bool nullable) override {
+            if (m_analyzing) {
+                m_analysis = { nullable, {} };
+                return;
+            }
+            addInstruction(BytecodeOpcode::Native, addNativeParser(node));
+        }
+    };
+
+
+    /**
+     * Compiles a grammar into a bytecode program.
+     * @param parser the root of the grammar; it must outlive the program.
+     * @return the program.
+     */
+    template <class ParseContextType, class ParserNodeType>
+    BytecodeProgram<ParseContextType> compileBytecode(const ParserNode<ParserNodeType>& parser) {
+        return BytecodeCompiler<ParseContextType>::compile(parser);
+    }
+
+
+    /**
+     * Compiles a grammar into a bytecode program.
+     * @param rule the root rule of the grammar; it must outlive the program.
+     * @return the program.
+     */
+    template <class ParseContextType>
+    BytecodeProgram<ParseContextType> compileBytecode(const Rule<ParseContextType>& rule) {
+        return BytecodeCompiler<ParseContextType>::compile(rule);
+    }
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_BYTECODECOMPILER_HPP
@@ -0,0 +1,603 @@
+#ifndef PARSERLIB_BYTECODEMACHINE_HPP
+#define PARSERLIB_BYTECODEMACHINE_HPP
+
+
+#include <cstdint>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include "BytecodeProgram.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * The result of resumable parsing.
+     */
+    enum class ParseStatus {
+        /**
+         * The program succeeded.
+         */
+        Success,
+
+        /**
+         * The program failed; the state of the parse context is restored to the state before parsing.
+         */
+        Failure,
+
+        /**
+         * The program needs elements that are not available yet; parsing shall be resumed when more elements are appended to the source.
+         */
+        NeedMoreInput
+    };
+
+
+    /**
+     * An interpreter for bytecode programs.
+     *
+     * The machine keeps the states to backtrack to, the return addresses and the beginnings of matches
+     * in an explicit stack on the heap, instead of the native stack;
+     * therefore, the depth of the input that can be parsed is limited only by the available memory.
+     *
+     * The semantics of the instructions are the same as the ones of the parser nodes they are compiled from:
+     * backtracking, error states, cuts, and the delivery of matches to the match handler of the parse context behave in the same way.
+     * In particular, the failure of a natively invoked parser that leaves the state changed, such as an error recovery parser,
+     * is seen by the enclosing choices, loops and optionals with that state, unless the failure is within a sequence, which restores its state.
+     *
+     * Parsing can also be suspended when the available input runs out, and resumed when more input arrives;
+     * see `start` and `resume`.
+     *
+     * A machine is not thread-safe; each thread shall use its own machine. Programs can be shared.
+     *
+     * @param ParseContextType type of parse context to use for parsing.
+     */
+    template <class ParseContextType> class BytecodeMachine {
+    public:
+        /**
+         * Program type.
+         */
+        using ProgramType = BytecodeProgram<ParseContextType>;
+
+        /**
+         * Constructor.
+         * @param program the program to run; it must outlive the machine.
+         */
+        BytecodeMachine(const ProgramType& program) : m_program(program) {
+        }
+
+        /**
+         * Runs the program from its beginning.
+         * On failure, the state of the parse context is restored to the state before parsing,
+         * unless the failure is of a native parser that leaves the state elsewhere, such as an error recovery parser that skipped input,
+         * and it is not within a sequence; then the state is left as the grammar would leave it.
+         * @param pc parse context.
+         * @return true if parsing succeeds, false otherwise.
+         * @exception whatever the native parsers or the parse context throw.
+         */
+        bool operator ()(ParseContextType& pc) {
+            m_stack.clear();
+            m_initialState.reset();
+            try {
+                return run<false>(pc, pc.state(), 0, true) == ParseStatus::Success;
+            }
+            catch (...) {
+                unwind(pc);
+                throw;
+            }
+        }
+
+        /**
+         * Starts parsing a source that may not be complete yet, e.g. a `PushSource` that receives its elements from the network.
+         *
+         * While the input is not complete, an instruction that needs elements after the end of the source does not fail;
+         * instead, parsing is suspended at that instruction and `ParseStatus::NeedMoreInput` is returned.
+         * Native parsers are run with the examined source tracked; if they examine the source past its end,
+         * the state of the parse context is restored to the state before them and parsing is suspended before them,
+         * so as that they are run again when more input is available; therefore they must not have side effects outside of the parse context.
+         *
+         * Matches become final, and are delivered to the match handler of the parse context, while the input is received.
+         * Memoization shall be disabled, because results memoized before the end of the source would not see the elements appended later.
+         *
+         * Requires a random access source, and a parse context with the TrackExaminedSource policy, which is the default for a PushSource.
+         *
+         * @param pc parse context.
+         * @param endOfInput true if the source is complete, false if more elements may be appended to it.
+         * @return the status of parsing.
+         * @exception whatever the native parsers or the parse context throw.
+         */
+        ParseStatus start(ParseContextType& pc, bool endOfInput = false) {
+            m_stack.clear();
+            m_initialState.emplace(pc.state());
+            m_address = 0;
+            return resume(pc, endOfInput);
+        }
+
+        /**
+         * Resumes parsing that was suspended because it needed more input,
+         * after more elements have been appended to the source, or after the source is complete.
+         * @param pc the parse context parsing was started with.
+         * @param endOfInput true if the source is complete, false if more elements may be appended to it.
+         * @return the status of parsing.
+         * @exception std::logic_error thrown if parsing is not suspended.
+         * @exception whatever the native parsers or the parse context throw.
+         */
+        ParseStatus resume(ParseContextType& pc, bool endOfInput = false) {
+            static_assert(IsRandomAccessSource, "resumable parsing requires a random access source");
+            static_assert(ParseContextType::ExaminedSourcePolicy::enabled, "resumable parsing requires the TrackExaminedSource policy, which is the default for a PushSource");
+            if (!m_initialState) {
+                throw std::logic_error("BytecodeMachine: there is no suspended parsing to resume.");
+            }
+            const bool examinedSourceTracking = pc.examinedSourceTracking();
+            try {
+                const ParseStatus status = run<true>(pc, *m_initialState, m_address, endOfInput);
+                if (status != ParseStatus::NeedMoreInput) {
+                    m_initialState.reset();
+                }
+                return status;
+            }
+            catch (...) {
+                pc.setExaminedSourceTracking(examinedSourceTracking);
+                m_initialState.reset();
+                unwind(pc);
+                throw;
+            }
+        }
+
+        /**
+         * Checks if parsing is suspended, waiting for more input.
+         * @return true if parsing is suspended, false otherwise.
+         */
+        bool suspended() const {
+            return m_initialState.has_value();
+        }
+
+        /**
+         * Returns the max number of frames that were on the stack of the machine at the same time.
+         * @return the max number of frames that were on the stack of the machine at the same time.
+         */
+        size_t maxStackSize() const {
+            return m_maxStackSize;
+        }
+
+    private:
+        using State = typename ParseContextType::State;
+        using ErrorState = typename ParseContextType::ErrorState;
+        static constexpr std::uint32_t NoOperand = BytecodeInstruction::NoOperand;
+
+        //frame types
+        enum class FrameType : std::uint8_t {
+            Choice,
+            Optional,
+            Predicate,
+            Position,
+            Match,
+            TreeMatch,
+            Call
+        };
+
+        //stack frame
+        struct Frame {
+            FrameType type;
+
+            //if the failure of the frame leaves the state as it is; see BytecodeInstruction::keepsFailureState
+            bool keepsFailureState;
+
+            //address to resume from, or to return to
+            std::uint32_t address;
+
+            //the cut count for backtracking frames, or the match count for tree match frames
+            size_t count;
+
+            //state to restore on backtracking; its position is the beginning of a match
+            State state;
+
+            //error state to restore when a choice, optional or predicate ends
+            ErrorState errorState;
+        };
+
+        static constexpr bool IsRandomAccessSource = std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<typename ParseContextType::SourceType::const_iterator>::iterator_category>;
+
+        const ProgramType& m_program;
+        std::vector<Frame> m_stack;
+        size_t m_maxStackSize{ 0 };
+
+        //state of suspended parsing: the state before parsing, and the address of the instruction to resume from
+        std::optional<State> m_initialState;
+        std::uint32_t m_address{ 0 };
+
+        //pushes a frame
+        void push(ParseContextType& pc, FrameType type, const BytecodeInstruction& instruction, std::uint32_t address, size_t count) {
+            m_stack.push_back(Frame{ type, instruction.keepsFailureState, address, count, pc.state(), pc.errorState() });
+            if (m_stack.size() > m_maxStackSize) {
+                m_maxStackSize = m_stack.size();
+            }
+        }
+
+        //records the error of a failed instruction, by invoking the parser the instruction was compiled from
+        void addError(ParseContextType& pc, std::uint32_t errorOperand) const {
+            if constexpr (ParseContextType::ErrorTrackingPolicy::enabled) {
+                if (errorOperand != NoOperand && !pc.sourceEnded()) {
+                    const auto& native = m_program.nativeParsers()[errorOperand];
+                    native.parse(native.parser, pc);
+                }
+            }
+        }
+
+        //pops frames until a frame that resumes parsing is found; returns false if there is none;
+        //while the failure keeps its state, the frames continue from the state the failure left, as native parsers do;
+        //otherwise, they restore their state
+        bool backtrack(ParseContextType& pc, std::uint32_t& address, bool& keepState) {
+            while (!m_stack.empty()) {
+                Frame& frame = m_stack.back();
+                switch (frame.type) {
+                    case FrameType::Choice:
+                        //try the next alternative, unless there is none, or the failed alternative was cut
+                        if (frame.address != NoOperand && frame.count == pc.cutCount()) {
+                            if (keepState) {
+                                frame.state = pc.state();
+                            }
+                            else {
+                                pc.setState(frame.state);
+                            }
+                            address = frame.address;
+                            return true;
+                        }
+                        //the failed branch is discarded before its matches can be delivered
+                        if (!keepState) {
+                            pc.setState(frame.state);
+                        }
+                        keepState = frame.keepsFailureState;
+                        m_stack.pop_back();
+                        pc.decrementBacktrackDepth();
+                        break;
+
+                    case FrameType::Optional:
+                        //stop, unless the failed branch was cut
+                        if (frame.count == pc.cutCount()) {
+                            const ErrorState errorState = frame.errorState;
+                            address = frame.address;
+                            if (!keepState) {
+                                pc.setState(frame.state);
+                            }
+                            m_stack.pop_back();
+                            pc.decrementBacktrackDepth();
+                            pc.setErrorState(errorState);
+                            return true;
+                        }
+                        if (!keepState) {
+                            pc.setState(frame.state);
+                        }
+                        keepState = frame.keepsFailureState;
+                        m_stack.pop_back();
+                        pc.decrementBacktrackDepth();
+                        break;
+
+                    case FrameType::Predicate: {
+                        const ErrorState errorState = frame.errorState;
+                        const std::uint32_t resumeAddress = frame.address;
+                        pc.setState(frame.state);
+                        keepState = frame.keepsFailureState;
+                        m_stack.pop_back();
+                        pc.decrementBacktrackDepth();
+                        pc.setErrorState(errorState);
+                        if (resumeAddress != NoOperand) {
+                            address = resumeAddress;
+                            return true;
+                        }
+                        break;
+                    }
+
+                    default:
+                        //the state of a failure within the frame is the state the frame started with,
+                        //which is needed only if the failure of the frame keeps its state
+                        if (!keepState && frame.keepsFailureState) {
+                            pc.setState(frame.state);
+                        }
+                        keepState = frame.keepsFailureState;
+                        if (frame.type == FrameType::TreeMatch) {
+                            pc.decrementTreeMatchDepth();
+                        }
+                        m_stack.pop_back();
+                        break;
+                }
+            }
+            return false;
+        }
+
+        //pops all frames, after an exception
+        void unwind(ParseContextType& pc) {
+            for (; !m_stack.empty(); m_stack.pop_back()) {
+                if (m_stack.back().type == FrameType::TreeMatch) {
+                    pc.decrementTreeMatchDepth();
+                }
+            }
+        }
+
+        //runs a native parser with the examined source tracked;
+        //returns its result, or nothing if it examined the source past its end, in which case the parse context is restored;
+        //matches are not delivered while the native parser runs, not even by its cuts, since they are discarded if it is run again on more input
+        template <class NativeParserType>
+        static std::optional<bool> runNativeOnPartialInput(ParseContextType& pc, const NativeParserType& native) {
+            const State state = pc.state();
+            const ErrorState errorState = pc.errorState();
+            const bool examinedSourceTracking = pc.examinedSourceTracking();
+            const size_t examinedOffset = pc.examinedOffset();
+            pc.setExaminedSourceTracking(true);
+            pc.setExaminedOffset(0);
+            pc.incrementBacktrackDepth();
+            pc.incrementTreeMatchDepth();
+            const bool result = native.parse(native.parser, pc);
+            pc.decrementTreeMatchDepth();
+            const bool needMoreInput = pc.examinedPastSourceEnd();
+            pc.setExaminedOffset(std::max(examinedOffset, pc.examinedOffset()));
+            pc.setExaminedSourceTracking(examinedSourceTracking);
+            if (needMoreInput) {
+                pc.setState(state);
+                pc.setErrorState(errorState);
+                pc.decrementBacktrackDepth();
+                return std::nullopt;
+            }
+            pc.decrementBacktrackDepth();
+            return result;
+        }
+
+        //pops a choice, optional or predicate frame, restoring the error state
+        void commit(ParseContextType& pc) {
+            const ErrorState errorState = m_stack.back().errorState;
+            m_stack.pop_back();
+            pc.decrementBacktrackDepth();
+            pc.setErrorState(errorState);
+        }
+
+        //returns the number of elements from the current position to the end of the source
+        static size_t remainingSize(const ParseContextType& pc) {
+            return static_cast<size_t>(pc.sourceEnd() - pc.sourcePosition().iterator());
+        }
+
+        //the interpreter loop; successful instructions continue the loop, failed instructions break out of the switch;
+        //if resumable and the input is not complete, instructions that need more input suspend parsing at their address
+        template <bool Resumable>
+        ParseStatus run(ParseContextType& pc, const State& initialState, std::uint32_t address, bool endOfInput) {
+            const BytecodeInstruction* const instructions = m_program.instructions().data();
+            const bool partialInput = Resumable && !endOfInput;
+
+            while (true) {
+                const BytecodeInstruction& instruction = instructions[address];
+
+                switch (instruction.opcode) {
+                    case BytecodeOpcode::Halt:
+                        return ParseStatus::Success;
+
+                    case BytecodeOpcode::Fail:
+                        break;
+
+                    case BytecodeOpcode::Jump:
+                        address = instruction.operand;
+                        continue;
+
+                    case BytecodeOpcode::Set:
+                        if constexpr (Resumable) {
+                            if (partialInput && pc.sourceEnded()) {
+                                m_address = address;
+                                return ParseStatus::NeedMoreInput;
+                            }
+                        }
+                        if (!pc.sourceEnded() && pc.sourcePositionContains(m_program.characterSets()[instruction.operand])) {
+                            pc.incrementSourcePosition();
+                            ++address;
+                            continue;
+                        }
+                        addError(pc, instruction.errorOperand);
+                        break;
+
+                    case BytecodeOpcode::Span: {
+                        const size_t count = pc.sourcePositionSpan(m_program.characterSets()[instruction.operand]);
+                        if (count > 0) {
+                            pc.increaseSourcePosition(count);
+                        }
+                        //the span may continue in the input not received yet; it resumes from where it stopped
+                        if constexpr (Resumable) {
+                            if (partialInput && pc.sourceEnded()) {
+                                m_address = address;
+                                return ParseStatus::NeedMoreInput;
+                            }
+                        }
+                        ++address;
+                        continue;
+                    }
+
+                    case BytecodeOpcode::String: {
+                        const auto& str = m_program.strings()[instruction.operand];
+                        //suspend only if the available elements are a prefix of the string
+                        if constexpr (Resumable) {
+                            if (partialInput) {
+                                const size_t remaining = remainingSize(pc);
+                                if (remaining < str.size() && pc.sourcePositionContains(str.c_str(), m_program.foldedStrings()[instruction.operand].c_str(), remaining)) {
+                                    m_address = address;
+                                    return ParseStatus::NeedMoreInput;
+                                }
+                            }
+                        }
+                        if (!pc.sourceEnded() && pc.sourcePositionContains(str.c_str(), m_program.foldedStrings()[instruction.operand].c_str(), str.size())) {
+                            pc.increaseSourcePosition(str.size());
+                            ++address;
+                            continue;
+                        }
+                        addError(pc, instruction.errorOperand);
+                        break;
+                    }
+
+                    case BytecodeOpcode::EndOfSource:
+                        if (pc.sourceEnded()) {
+                            if constexpr (Resumable) {
+                                if (partialInput) {
+                                    m_address = address;
+                                    return ParseStatus::NeedMoreInput;
+                                }
+                            }
+                            ++address;
+                            continue;
+                        }
+                        break;
+
+                    case BytecodeOpcode::Native: {
+                        const auto& native = m_program.nativeParsers()[instruction.operand];
+                        if constexpr (Resumable) {
+                            if (partialInput) {
+                                if (const auto result = runNativeOnPartialInput(pc, native)) {
+                                    if (*result) {
+                                        ++address;
+                                        continue;
+                                    }
+                                    break;
+                                }
+                                m_address = address;
+                                return ParseStatus::NeedMoreInput;
+                            }
+                        }
+                        if (native.parse(native.parser, pc)) {
+                            ++address;
+                            continue;
+                        }
+                        break;
+                    }
+
+                    case BytecodeOpcode::Choice:
+                        push(pc, FrameType::Choice, instruction, instruction.operand, pc.cutCount());
+                        pc.incrementBacktrackDepth();
+                        ++address;
+                        continue;
+
+                    case BytecodeOpcode::NextChoice:
+                        m_stack.back().address = instruction.operand;
+                        ++address;
+                        continue;
+
+                    case BytecodeOpcode::Commit:
+                        commit(pc);
+                        address = instruction.operand;
+                        continue;
+
+                    case BytecodeOpcode::Optional:
+                        push(pc, FrameType::Optional, instruction, instruction.operand, pc.cutCount());
+                        pc.incrementBacktrackDepth();
+                        ++address;
+                        continue;
+
+                    case BytecodeOpcode::LoopNext: {
+                        Frame& frame = m_stack.back();
+
+                        //if no advance was made, stop in order to avoid an infinite loop
+                        if (pc.sourcePosition() == frame.state.sourcePosition()) {
+                            commit(pc);
+                            ++address;
+                            continue;
+                        }
+
+                        //the iteration is complete; matches may be final
+                        pc.decrementBacktrackDepth();
+                        pc.incrementBacktrackDepth();
+                        frame.state = pc.state();
+                        frame.count = pc.cutCount();
+                        address = instruction.operand;
+                        continue;
+                    }
+
+                    case BytecodeOpcode::Predicate:
+                        push(pc, FrameType::Predicate, instruction, instruction.operand, pc.cutCount());
+                        pc.incrementBacktrackDepth();
+                        ++address;
+                        continue;
+
+                    case BytecodeOpcode::PredicateSucceed:
+                        pc.setState(m_stack.back().state);
+                        commit(pc);
+                        ++address;
+                        continue;
+
+                    case BytecodeOpcode::PredicateFail:
+                        pc.setState(m_stack.back().state);
+                        commit(pc);
+                        break;
+
+                    case BytecodeOpcode::PushPosition:
+                        push(pc, FrameType::Position, instruction, NoOperand, 0);
+                        ++address;
+                        continue;
+
+                    case BytecodeOpcode::CheckAdvance: {
+                        const bool advanced = !(pc.sourcePosition() == m_stack.back().state.sourcePosition());
+                        m_stack.pop_back();
+                        if (advanced) {
+                            ++address;
+                            continue;
+                        }
+                        break;
+                    }
+
+                    case BytecodeOpcode::OpenMatch:
+                        push(pc, FrameType::Match, instruction, NoOperand, 0);
+                        ++address;
+                        continue;
+
+                    case BytecodeOpcode::CloseMatch: {
+                        const auto begin = m_stack.back().state.sourcePosition();
+                        m_stack.pop_back();
+                        pc.addMatch(m_program.matchIds()[instruction.operand], begin, pc.sourcePosition());
+                        ++address;
+                        continue;
+                    }
+
+                    case BytecodeOpcode::OpenTreeMatch:
+                        push(pc, FrameType::TreeMatch, instruction, NoOperand, pc.matches().size());
+                        pc.incrementTreeMatchDepth();
+                        ++address;
+                        continue;
+
+                    case BytecodeOpcode::CloseTreeMatch: {
+                        const auto begin = m_stack.back().state.sourcePosition();
+                        const size_t beginMatchCount = m_stack.back().count;
+                        m_stack.pop_back();
+                        pc.decrementTreeMatchDepth();
+                        pc.addMatch(m_program.matchIds()[instruction.operand], begin, pc.sourcePosition(), pc.matches().size() - beginMatchCount);
+                        ++address;
+                        continue;
+                    }
+
+                    case BytecodeOpcode::Call:
+                        push(pc, FrameType::Call, instruction, address + 1, 0);
+                        address = instruction.operand;
+                        continue;
+
+                    case BytecodeOpcode::Return:
+                        address = m_stack.back().address;
+                        m_stack.pop_back();
+                        continue;
+
+                    case BytecodeOpcode::Cut:
+                        pc.cut();
+                        ++address;
+                        continue;
+                }
+
+                //the instruction failed
+                bool keepState = instruction.keepsFailureState;
+                if (!backtrack(pc, address, keepState)) {
+                    if (!keepState) {
+                        pc.setState(initialState);
+                    }
+                    return ParseStatus::Failure;
+                }
+            }
+        }
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_BYTECODEMACHINE_HPP
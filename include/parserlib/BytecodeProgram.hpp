@@ -0,0 +1,420 @@
+#ifndef PARSERLIB_BYTECODEPROGRAM_HPP
+#define PARSERLIB_BYTECODEPROGRAM_HPP
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CharacterSet.hpp"
+
+
+namespace parserlib {
+
+
+    template <class ParseContextType> class BytecodeMachine;
+
+
+    /**
+     * Bytecode operation codes.
+     *
+     * Frames are pushed on the stack of the machine by the instructions that may backtrack, call or capture;
+     * when an instruction fails, frames are popped until a frame that can resume parsing is found.
+     */
+    enum class BytecodeOpcode : std::uint8_t {
+        /**
+         * Parsing succeeded; stops the machine.
+         */
+        Halt,
+
+        /**
+         * Fails.
+         */
+        Fail,
+
+        /**
+         * Jumps to the address in the operand.
+         */
+        Jump,
+
+        /**
+         * Consumes one element that belongs to the character set in the operand, or fails;
+         * on failure, the native parser in the error operand, if there is one, is invoked in order to record the error.
+         */
+        Set,
+
+        /**
+         * Consumes all the consecutive elements that belong to the character set in the operand; it never fails.
+         */
+        Span,
+
+        /**
+         * Consumes the string in the operand, or fails; errors are recorded as for `Set`.
+         */
+        String,
+
+        /**
+         * Succeeds at the end of the source, otherwise fails.
+         */
+        EndOfSource,
+
+        /**
+         * Invokes the native parser in the operand; fails if the native parser fails.
+         */
+        Native,
+
+        /**
+         * Pushes a choice frame; on failure, the state is restored and parsing resumes from the address in the operand,
+         * unless the address is `NoOperand`, or the failed branch contains a cut.
+         */
+        Choice,
+
+        /**
+         * Sets the address of the next alternative of the choice frame on the top of the stack to the operand.
+         */
+        NextChoice,
+
+        /**
+         * Pops the choice or optional frame on the top of the stack, restores the error state, and jumps to the address in the operand.
+         */
+        Commit,
+
+        /**
+         * Pushes an optional frame; on failure, the state and the error state are restored
+         * and parsing resumes from the address in the operand, unless the failed branch contains a cut.
+         */
+        Optional,
+
+        /**
+         * Ends an iteration of a loop started with `Optional`; if the iteration consumed input,
+         * the optional frame is updated and parsing continues from the address in the operand;
+         * otherwise, the loop ends as if it was committed.
+         */
+        LoopNext,
+
+        /**
+         * Pushes a predicate frame; on failure, the state and the error state are restored,
+         * and parsing resumes from the address in the operand, or fails again if the address is `NoOperand`.
+         */
+        Predicate,
+
+        /**
+         * Pops the predicate frame on the top of the stack, restores the state and the error state, and continues.
+         */
+        PredicateSucceed,
+
+        /**
+         * Pops the predicate frame on the top of the stack, restores the state and the error state, and fails.
+         */
+        PredicateFail,
+
+        /**
+         * Pushes a frame with the current position.
+         */
+        PushPosition,
+
+        /**
+         * Pops the frame pushed by `PushPosition`; fails if the current position is the same as the one of the frame.
+         */
+        CheckAdvance,
+
+        /**
+         * Pushes a match frame with the current position.
+         */
+        OpenMatch,
+
+        /**
+         * Pops the match frame on the top of the stack and adds a match with the match id in the operand.
+         */
+        CloseMatch,
+
+        /**
+         * Pushes a tree match frame with the current position and match count.
+         */
+        OpenTreeMatch,
+
+        /**
+         * Pops the tree match frame on the top of the stack and adds a tree match with the match id in the operand.
+         */
+        CloseTreeMatch,
+
+        /**
+         * Pushes a call frame and jumps to the address in the operand.
+         */
+        Call,
+
+        /**
+         * Pops the call frame on the top of the stack and returns to the address after the call.
+         */
+        Return,
+
+        /**
+         * Commits the parse up to the current position.
+         */
+        Cut
+    };
+
+
+    /**
+     * Returns the name of a bytecode operation.
+     * @param opcode operation code.
+     * @return the name of the operation.
+     */
+    inline const char* bytecodeOpcodeName(BytecodeOpcode opcode) {
+        static const char* const names[] = {
+            "halt", "fail", "jump", "set", "span", "string", "end", "native",
+            "choice", "next_choice", "commit", "optional", "loop_next", "predicate", "predicate_succeed", "predicate_fail",
+            "push_position", "check_advance", "open_match", "close_match", "open_tree_match", "close_tree_match",
+            "call", "return", "cut"
+        };
+        return names[static_cast<size_t>(opcode)];
+    }
+
+
+    /**
+     * A bytecode instruction.
+     */
+    struct BytecodeInstruction {
+        /**
+         * Value of operands that are not used.
+         */
+        static constexpr std::uint32_t NoOperand = UINT32_MAX;
+
+        /**
+         * Operation code.
+         */
+        BytecodeOpcode opcode;
+
+        /**
+         * If true, a failure of the instruction, or of the frame it pushes, leaves the state as it is, for the enclosing frame to continue from,
+         * as native parsers do when a child that is not within a sequence fails;
+         * e.g. an error recovery parser that fails after skipping input leaves the position where recovery stopped.
+         * If false, the failure restores the state of the enclosing frame, as a native sequence restores its state when it fails.
+         */
+        bool keepsFailureState{ false };
+
+        /**
+         * Operand; an address, or an index into one of the tables of the program.
+         */
+        std::uint32_t operand{ NoOperand };
+
+        /**
+         * Index of the native parser that records the error of a failed `Set` or `String` instruction.
+         */
+        std::uint32_t errorOperand{ NoOperand };
+    };
+
+
+    /**
+     * A program for the bytecode machine.
+     *
+     * A program is a flat array of instructions, along with the tables its instructions refer to:
+     * character sets, strings, match ids, and native parsers, i.e. parsers that are invoked directly.
+     * Execution starts at address 0.
+     *
+     * Programs are usually created by BytecodeCompiler, but they can also be built directly.
+     * Programs are immutable while parsing, and therefore they can be shared by multiple threads.
+     *
+     * @param ParseContextType type of parse context to use for parsing.
+     */
+    template <class ParseContextType> class BytecodeProgram {
+    public:
+        /**
+         * Element type of the source.
+         */
+        using ElementType = typename ParseContextType::SourceType::value_type;
+
+        /**
+         * String type.
+         */
+        using StringType = std::basic_string<ElementType>;
+
+        /**
+         * Match id type.
+         */
+        using MatchIdType = typename ParseContextType::MatchIdType;
+
+        /**
+         * A parser invoked directly by the machine.
+         */
+        struct NativeParser {
+            /**
+             * The parser object.
+             */
+            const void* parser;
+
+            /**
+             * The function that invokes the parser object.
+             */
+            bool (*parse)(const void* parser, ParseContextType& pc);
+        };
+
+        /**
+         * Value of operands that are not used.
+         */
+        static constexpr std::uint32_t NoOperand = BytecodeInstruction::NoOperand;
+
+        /**
+         * Returns the instructions.
+         * @return the instructions.
+         */
+        const std::vector<BytecodeInstruction>& instructions() const {
+            return m_instructions;
+        }
+
+        /**
+         * Returns the character sets.
+         * @return the character sets.
+         */
+        const std::vector<CharacterSet>& characterSets() const {
+            return m_characterSets;
+        }
+
+        /**
+         * Returns the strings.
+         * @return the strings.
+         */
+        const std::vector<StringType>& strings() const {
+            return m_strings;
+        }
+
+        /**
+         * Returns the strings folded to lowercase; they have the indexes of the strings.
+         * @return the strings folded to lowercase.
+         */
+        const std::vector<StringType>& foldedStrings() const {
+            return m_foldedStrings;
+        }
+
+        /**
+         * Returns the match ids.
+         * @return the match ids.
+         */
+        const std::vector<MatchIdType>& matchIds() const {
+            return m_matchIds;
+        }
+
+        /**
+         * Returns the native parsers.
+         * @return the native parsers.
+         */
+        const std::vector<NativeParser>& nativeParsers() const {
+            return m_nativeParsers;
+        }
+
+        /**
+         * Returns the address of the next instruction to be added.
+         * @return the address of the next instruction to be added.
+         */
+        std::uint32_t nextAddress() const {
+            return static_cast<std::uint32_t>(m_instructions.size());
+        }
+
+        /**
+         * Adds an instruction.
+         * @param opcode operation code.
+         * @param operand operand.
+         * @param errorOperand error operand.
+         * @param keepsFailureState if a failure of the instruction leaves the state as it is; see `BytecodeInstruction::keepsFailureState`.
+         * @return the address of the instruction.
+         */
+        std::uint32_t addInstruction(BytecodeOpcode opcode, std::uint32_t operand = NoOperand, std::uint32_t errorOperand = NoOperand, bool keepsFailureState = false) {
+            m_instructions.push_back(BytecodeInstruction{ opcode, keepsFailureState, operand, errorOperand });
+            return static_cast<std::uint32_t>(m_instructions.size() - 1);
+        }
+
+        /**
+         * Sets the operand of an instruction; used for resolving forward jumps.
+         * @param address address of the instruction.
+         * @param operand the new operand.
+         */
+        void setOperand(std::uint32_t address, std::uint32_t operand) {
+            m_instructions[address].operand = operand;
+        }
+
+        /**
+         * Adds a character set.
+         * @param set the character set.
+         * @return the index of the character set.
+         */
+        std::uint32_t addCharacterSet(const CharacterSet& set) {
+            m_characterSets.push_back(set);
+            return static_cast<std::uint32_t>(m_characterSets.size() - 1);
+        }
+
+        /**
+         * Adds a string.
+         * @param str the string.
+         * @param foldedStr the string folded to lowercase.
+         * @return the index of the string.
+         */
+        std::uint32_t addString(const StringType& str, const StringType& foldedStr) {
+            m_strings.push_back(str);
+            m_foldedStrings.push_back(foldedStr);
+            return static_cast<std::uint32_t>(m_strings.size() - 1);
+        }
+
+        /**
+         * Adds a match id.
+         * @param id the match id.
+         * @return the index of the match id.
+         */
+        std::uint32_t addMatchId(const MatchIdType& id) {
+            m_matchIds.push_back(id);
+            return static_cast<std::uint32_t>(m_matchIds.size() - 1);
+        }
+
+        /**
+         * Adds a native parser.
+         * @param parser the parser object; it must outlive the program.
+         * @param parse the function that invokes the parser object.
+         * @return the index of the native parser.
+         */
+        std::uint32_t addNativeParser(const void* parser, bool (*parse)(const void*, ParseContextType&)) {
+            m_nativeParsers.push_back(NativeParser{ parser, parse });
+            return static_cast<std::uint32_t>(m_nativeParsers.size() - 1);
+        }
+
+        /**
+         * Parses the source of the given parse context with a new machine.
+         * @param pc parse context.
+         * @return true if parsing succeeds, false otherwise.
+         */
+        bool operator ()(ParseContextType& pc) const {
+            BytecodeMachine<ParseContextType> machine(*this);
+            return machine(pc);
+        }
+
+        /**
+         * Returns a listing of the instructions, one per line.
+         * @return a listing of the instructions.
+         */
+        std::string disassemble() const {
+            std::string result;
+            for (size_t address = 0; address < m_instructions.size(); ++address) {
+                const BytecodeInstruction& instruction = m_instructions[address];
+                result += std::to_string(address);
+                result += ": ";
+                result += bytecodeOpcodeName(instruction.opcode);
+                if (instruction.operand != NoOperand) {
+                    result += ' ';
+                    result += std::to_string(instruction.operand);
+                }
+                result += '\n';
+            }
+            return result;
+        }
+
+    private:
+        std::vector<BytecodeInstruction> m_instructions;
+        std::vector<CharacterSet> m_characterSets;
+        std::vector<StringType> m_strings;
+        std::vector<StringType> m_foldedStrings;
+        std::vector<MatchIdType> m_matchIds;
+        std::vector<NativeParser> m_nativeParsers;
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_BYTECODEPROGRAM_HPP
@@ -0,0 +1,167 @@
+#ifndef PARSERLIB_CHARACTERPREDICATE_HPP
+#define PARSERLIB_CHARACTERPREDICATE_HPP
+
+
+#include <tuple>
+#include <type_traits>
+#include "CharacterSet.hpp"
+#include "TerminalParser.hpp"
+#include "TerminalSetParser.hpp"
+#include "TerminalRangeParser.hpp"
+#include "ChoiceParser.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * Trait that tells if a parser node is a pure single-character predicate,
+     * i.e. a parser that either consumes one byte-sized element that belongs to a set, or fails.
+     * Such parsers can be converted to a character set.
+     * @param ParserNodeType type of parser node.
+     */
+    template <class ParserNodeType> struct CharacterPredicate {
+        /**
+         * False for parser nodes that are not character predicates.
+         */
+        static constexpr bool value = false;
+    };
+
+
+    /**
+     * Character predicate trait for terminals.
+     * @param TerminalValueType value type of the terminal.
+     */
+    template <class TerminalValueType> struct CharacterPredicate<TerminalParser<TerminalValueType>> {
+        /**
+         * True for byte-sized terminal values.
+         */
+        static constexpr bool value = sizeof(TerminalValueType) == 1;
+
+        /**
+         * Adds the terminal value to the given character set.
+         * @param node parser node.
+         * @param set character set.
+         */
+        static void addTo(const TerminalParser<TerminalValueType>& node, CharacterSet& set) {
+            set.add(node.terminalValue());
+        }
+    };
+
+
+    /**
+     * Character predicate trait for terminal sets.
+     * @param TerminalValueType value type of the terminal.
+     */
+    template <class TerminalValueType> struct CharacterPredicate<TerminalSetParser<TerminalValueType>> {
+        /**
+         * True for byte-sized terminal values.
+         */
+        static constexpr bool value = sizeof(TerminalValueType) == 1;
+
+        /**
+         * Adds the terminal values to the given character set.
+         * @param node parser node.
+         * @param set character set.
+         */
+        static void addTo(const TerminalSetParser<TerminalValueType>& node, CharacterSet& set) {
+            for (const TerminalValueType& value : node.terminalValues()) {
+                set.add(value);
+            }
+        }
+    };
+
+
+    /**
+     * Character predicate trait for terminal ranges.
+     * @param TerminalValueType value type of the terminal.
+     */
+    template <class TerminalValueType> struct CharacterPredicate<TerminalRangeParser<TerminalValueType>> {
+        /**
+         * True for byte-sized terminal values.
+         */
+        static constexpr bool value = sizeof(TerminalValueType) == 1;
+
+        /**
+         * Adds the terminal range to the given character set.
+         * @param node parser node.
+         * @param set character set.
+         */
+        static void addTo(const TerminalRangeParser<TerminalValueType>& node, CharacterSet& set) {
+            set.addRange(node.minTerminalValue(), node.maxTerminalValue());
+        }
+    };
+
+
+    /**
+     * Character predicate trait for choices; a choice is a character predicate if all its children are.
+     * @param Children children parser nodes.
+     */
+    template <class ...Children> struct CharacterPredicate<ChoiceParser<Children...>> {
+        /**
+         * True if all children are character predicates.
+         */
+        static constexpr bool value = (CharacterPredicate<Children>::value && ...);
+
+        /**
+         * Adds the sets of all children to the given character set.
+         * @param node parser node.
+         * @param set character set.
+         */
+        static void addTo(const ChoiceParser<Children...>& node, CharacterSet& set) {
+            std::apply([&](const auto&... children) {
+                (CharacterPredicate<std::decay_t<decltype(children)>>::addTo(children, set), ...);
+                }, node.children());
+        }
+    };
+
+
+    /**
+     * Empty type used in place of a character set for parser nodes that are not character predicates.
+     */
+    struct NoCharacterSet {
+    };
+
+
+    /**
+     * Creates the character set of a parser node.
+     * @param node parser node.
+     * @return a character set, if the parser node is a character predicate, otherwise an empty object.
+     */
+    template <class ParserNodeType> auto makeCharacterSet(const ParserNodeType& node) {
+        if constexpr (CharacterPredicate<ParserNodeType>::value) {
+            CharacterSet set;
+            CharacterPredicate<ParserNodeType>::addTo(node, set);
+            return set;
+        }
+        else {
+            return NoCharacterSet();
+        }
+    }
+
+
+    /**
+     * Advances the source position over the consecutive elements that belong to the given character set.
+     * Nothing is done if there is no character set or if the source elements are not byte-sized.
+     * @param pc parse context.
+     * @param set character set.
+     * @return the number of elements skipped.
+     */
+    template <class ParseContextType, class CharacterSetType> size_t skipCharacters(ParseContextType& pc, const CharacterSetType& set) {
+        if constexpr (std::is_same_v<CharacterSetType, CharacterSet> && sizeof(typename ParseContextType::SourceType::value_type) == 1) {
+            const size_t count = pc.sourcePositionSpan(set);
+            if (count > 0) {
+                pc.increaseSourcePosition(count);
+            }
+            return count;
+        }
+        else {
+            return 0;
+        }
+    }
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_CHARACTERPREDICATE_HPP
@@ -0,0 +1,260 @@
+#ifndef PARSERLIB_CHARACTERSCAN_HPP
+#define PARSERLIB_CHARACTERSCAN_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+//select the simd instruction set; define PARSERLIB_NO_SIMD in order to use only scalar code
+#ifndef PARSERLIB_NO_SIMD
+#if defined(__AVX2__)
+#define PARSERLIB_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PARSERLIB_SSE2
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+#define PARSERLIB_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+
+#if defined(_MSC_VER) && (defined(PARSERLIB_AVX2) || defined(PARSERLIB_SSE2))
+#include <intrin.h>
+#endif
+
+
+namespace parserlib {
+
+
+    /**
+     * A range of byte values, used by the simd scanning kernels.
+     */
+    struct CharacterRange {
+        /**
+         * The lowest value of the range.
+         */
+        unsigned char min;
+
+        /**
+         * The difference between the highest and the lowest value of the range.
+         */
+        unsigned char span;
+    };
+
+
+    //returns the index of the lowest set bit of a non-zero value
+    inline unsigned lowestBitIndex(std::uint32_t value) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, value);
+        return static_cast<unsigned>(index);
+#else
+        return static_cast<unsigned>(__builtin_ctz(value));
+#endif
+    }
+
+
+    /**
+     * Returns the number of consecutive bytes, from the beginning of the given span,
+     * that belong to a set of byte values.
+     * Blocks of bytes are classified with simd range comparisons, if available and if ranges are given;
+     * the remaining bytes are classified with the 256-bit table of the set.
+     * @param begin the beginning of the span.
+     * @param end the end of the span.
+     * @param bits the 256-bit table of the set.
+     * @param ranges the set as a list of ranges.
+     * @param rangeCount number of ranges; if 0, only the table is used.
+     * @return the number of consecutive bytes that belong to the set.
+     */
+    inline size_t spanCharacters(const unsigned char* begin, const unsigned char* end, const std::uint64_t* bits, const CharacterRange* ranges, size_t rangeCount) {
+        const unsigned char* it = begin;
+
+        if (rangeCount > 0) {
+#if defined(PARSERLIB_AVX2)
+            while (end - it >= 32) {
+                const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+                __m256i result = _mm256_setzero_si256();
+                for (size_t index = 0; index < rangeCount; ++index) {
+                    //value in range if (value - min) <= span, unsigned
+                    const __m256i offset = _mm256_sub_epi8(values, _mm256_set1_epi8(static_cast<char>(ranges[index].min)));
+                    const __m256i span = _mm256_set1_epi8(static_cast<char>(ranges[index].span));
+                    result = _mm256_or_si256(result, _mm256_cmpeq_epi8(_mm256_max_epu8(offset, span), span));
+                }
+                const std::uint32_t mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(result));
+                if (mask != 0xFFFFFFFFu) {
+                    return static_cast<size_t>(it - begin) + lowestBitIndex(~mask);
+                }
+                it += 32;
+            }
+#elif defined(PARSERLIB_SSE2)
+            while (end - it >= 16) {
+                const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+                __m128i result = _mm_setzero_si128();
+                for (size_t index = 0; index < rangeCount; ++index) {
+                    //value in range if (value - min) <= span, unsigned
+                    const __m128i offset = _mm_sub_epi8(values, _mm_set1_epi8(static_cast<char>(ranges[index].min)));
+                    const __m128i span = _mm_set1_epi8(static_cast<char>(ranges[index].span));
+                    result = _mm_or_si128(result, _mm_cmpeq_epi8(_mm_max_epu8(offset, span), span));
+                }
+                const std::uint32_t mask = static_cast<std::uint32_t>(_mm_movemask_epi8(result));
+                if (mask != 0xFFFFu) {
+                    return static_cast<size_t>(it - begin) + lowestBitIndex(~mask);
+                }
+                it += 16;
+            }
+#elif defined(PARSERLIB_NEON)
+            while (end - it >= 16) {
+                const uint8x16_t values = vld1q_u8(it);
+                uint8x16_t result = vdupq_n_u8(0);
+                for (size_t index = 0; index < rangeCount; ++index) {
+                    const uint8x16_t offset = vsubq_u8(values, vdupq_n_u8(ranges[index].min));
+                    result = vorrq_u8(result, vcleq_u8(offset, vdupq_n_u8(ranges[index].span)));
+                }
+                //if not all bytes belong to the set, the scalar loop finds the first one that does not
+                if (vminvq_u8(result) != 0xFF) {
+                    break;
+                }
+                it += 16;
+            }
+#endif
+        }
+
+        for (; it != end && ((bits[*it >> 6] >> (*it & 63)) & 1); ++it) {
+        }
+
+        return static_cast<size_t>(it - begin);
+    }
+
+
+    /**
+     * Appends the offsets of all the bytes of the given span that are equal to the given value to a vector.
+     * Blocks of bytes are compared with simd instructions, if available; the remaining bytes are compared one by one.
+     * @param begin the beginning of the span.
+     * @param end the end of the span.
+     * @param value the value to find.
+     * @param offsets the vector to append the offsets, from the beginning of the span, to.
+     */
+    template <class Vector> void findCharacters(const unsigned char* begin, const unsigned char* end, unsigned char value, Vector& offsets) {
+        const unsigned char* it = begin;
+
+#if defined(PARSERLIB_AVX2)
+        const __m256i values = _mm256_set1_epi8(static_cast<char>(value));
+        for (; end - it >= 32; it += 32) {
+            std::uint32_t mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(it)), values)));
+            for (; mask != 0; mask &= mask - 1) {
+                offsets.push_back(static_cast<size_t>(it - begin) + lowestBitIndex(mask));
+            }
+        }
+#elif defined(PARSERLIB_SSE2)
+        const __m128i values = _mm_set1_epi8(static_cast<char>(value));
+        for (; end - it >= 16; it += 16) {
+            std::uint32_t mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it)), values)));
+            for (; mask != 0; mask &= mask - 1) {
+                offsets.push_back(static_cast<size_t>(it - begin) + lowestBitIndex(mask));
+            }
+        }
+#elif defined(PARSERLIB_NEON)
+        const uint8x16_t values = vdupq_n_u8(value);
+        for (; end - it >= 16; it += 16) {
+            //blocks without the value are skipped; the others are searched one byte at a time
+            if (vmaxvq_u8(vceqq_u8(vld1q_u8(it), values)) != 0) {
+                for (size_t index = 0; index < 16; ++index) {
+                    if (it[index] == value) {
+                        offsets.push_back(static_cast<size_t>(it - begin) + index);
+                    }
+                }
+            }
+        }
+#endif
+
+        for (; it != end; ++it) {
+            if (*it == value) {
+                offsets.push_back(static_cast<size_t>(it - begin));
+            }
+        }
+    }
+
+
+
+    /**
+     * Folds a value to lowercase; only the ASCII letters are folded.
+     * @param value value to fold.
+     * @return the lowercase value.
+     */
+    template <class T> T foldCharacter(const T& value) {
+        return value >= 'A' && value <= 'Z' ? static_cast<T>(value + ('a' - 'A')) : value;
+    }
+
+
+    /**
+     * Checks if the bytes of the given span, folded to lowercase, are equal to the given lowercase string.
+     * Only the ASCII letters are folded, as with the function `foldCharacter`.
+     * Blocks of bytes are folded and compared with simd instructions, if available; the remaining bytes are compared one by one.
+     * @param begin the beginning of the span.
+     * @param foldedString the lowercase string to compare the span to.
+     * @param length the length of both the span and the string.
+     * @return true if the folded span is equal to the string, false otherwise.
+     */
+    inline bool equalCharactersCaseInsensitive(const unsigned char* begin, const unsigned char* foldedString, size_t length) {
+        size_t index = 0;
+
+#if defined(PARSERLIB_AVX2)
+        const __m256i upperMin = _mm256_set1_epi8('A');
+        const __m256i upperSpan = _mm256_set1_epi8('Z' - 'A');
+        const __m256i caseBit = _mm256_set1_epi8('a' - 'A');
+        for (; length - index >= 32; index += 32) {
+            //uppercase if (value - 'A') <= ('Z' - 'A'), unsigned
+            const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin + index));
+            const __m256i offset = _mm256_sub_epi8(values, upperMin);
+            const __m256i upper = _mm256_cmpeq_epi8(_mm256_max_epu8(offset, upperSpan), upperSpan);
+            const __m256i folded = _mm256_or_si256(values, _mm256_and_si256(upper, caseBit));
+            const __m256i expected = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(foldedString + index));
+            if (static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(folded, expected))) != 0xFFFFFFFFu) {
+                return false;
+            }
+        }
+#elif defined(PARSERLIB_SSE2)
+        const __m128i upperMin = _mm_set1_epi8('A');
+        const __m128i upperSpan = _mm_set1_epi8('Z' - 'A');
+        const __m128i caseBit = _mm_set1_epi8('a' - 'A');
+        for (; length - index >= 16; index += 16) {
+            //uppercase if (value - 'A') <= ('Z' - 'A'), unsigned
+            const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin + index));
+            const __m128i offset = _mm_sub_epi8(values, upperMin);
+            const __m128i upper = _mm_cmpeq_epi8(_mm_max_epu8(offset, upperSpan), upperSpan);
+            const __m128i folded = _mm_or_si128(values, _mm_and_si128(upper, caseBit));
+            const __m128i expected = _mm_loadu_si128(reinterpret_cast<const __m128i*>(foldedString + index));
+            if (static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(folded, expected))) != 0xFFFFu) {
+                return false;
+            }
+        }
+#elif defined(PARSERLIB_NEON)
+        const uint8x16_t upperMin = vdupq_n_u8('A');
+        const uint8x16_t upperSpan = vdupq_n_u8('Z' - 'A');
+        const uint8x16_t caseBit = vdupq_n_u8('a' - 'A');
+        for (; length - index >= 16; index += 16) {
+            const uint8x16_t values = vld1q_u8(begin + index);
+            const uint8x16_t upper = vcleq_u8(vsubq_u8(values, upperMin), upperSpan);
+            const uint8x16_t folded = vorrq_u8(values, vandq_u8(upper, caseBit));
+            if (vminvq_u8(vceqq_u8(folded, vld1q_u8(foldedString + index))) != 0xFF) {
+                return false;
+            }
+        }
+#endif
+
+        for (; index < length; ++index) {
+            if (foldCharacter(begin[index]) != foldedString[index]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_CHARACTERSCAN_HPP
@@ -0,0 +1,169 @@
+#ifndef PARSERLIB_CHARACTERSET_HPP
+#define PARSERLIB_CHARACTERSET_HPP
+
+
+#include <cctype>
+#include <cstdint>
+#include <vector>
+#include "CharacterScan.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * A set of byte-sized values, stored as a 256-bit table.
+     * Membership is tested with a single load and bit test.
+     * The table of the case insensitive set is precomputed from the values,
+     * so as that case folding is not performed while parsing.
+     * The set is also kept as a short list of ranges, if possible, for simd scanning.
+     */
+    class CharacterSet {
+    public:
+        /**
+         * Max number of ranges used for simd scanning;
+         * if a set requires more ranges, scanning uses only the table.
+         */
+        static constexpr size_t MaxRangeCount = 8;
+
+        /**
+         * Constructor; creates an empty set.
+         */
+        CharacterSet() {
+        }
+
+        /**
+         * Constructor.
+         * @param values values of the set; they shall be byte-sized.
+         */
+        template <class T, class Alloc>
+        CharacterSet(const std::vector<T, Alloc>& values) {
+            for (const T& value : values) {
+                add(value);
+            }
+        }
+
+        /**
+         * Adds a value.
+         * A value is contained in the case insensitive set if its lowercase equals the lowercase of the added value.
+         * @param value value to add.
+         */
+        template <class T>
+        void add(const T& value) {
+            addRange(value, value);
+        }
+
+        /**
+         * Adds a range of values.
+         * A value is contained in the case insensitive set if its lowercase is within the lowercase values of the range.
+         * @param minValue lowest value of the range.
+         * @param maxValue highest value of the range.
+         */
+        template <class T>
+        void addRange(const T& minValue, const T& maxValue) {
+            const T lowerMinValue = toLower(minValue);
+            const T lowerMaxValue = toLower(maxValue);
+            for (int index = 0; index < 256; ++index) {
+                const T value = static_cast<T>(static_cast<unsigned char>(index));
+                if (value >= minValue && value <= maxValue) {
+                    set(m_bits, static_cast<unsigned char>(index));
+                }
+                const T lowerValue = toLower(value);
+                if (lowerValue >= lowerMinValue && lowerValue <= lowerMaxValue) {
+                    set(m_caseInsensitiveBits, static_cast<unsigned char>(index));
+                }
+            }
+            m_rangeCount = computeRanges(m_bits, m_ranges);
+            m_caseInsensitiveRangeCount = computeRanges(m_caseInsensitiveBits, m_caseInsensitiveRanges);
+        }
+
+        /**
+         * Checks if the given value belongs to the set.
+         * @param value value to check.
+         * @return true if the value belongs to the set, false otherwise.
+         */
+        template <class T>
+        bool contains(const T& value) const {
+            return test(m_bits, static_cast<unsigned char>(value));
+        }
+
+        /**
+         * Checks if the given value belongs to the set, ignoring case.
+         * @param value value to check.
+         * @return true if the value belongs to the set, false otherwise.
+         */
+        template <class T>
+        bool containsCaseInsensitive(const T& value) const {
+            return test(m_caseInsensitiveBits, static_cast<unsigned char>(value));
+        }
+
+        /**
+         * Returns the number of consecutive values, from the beginning of the given span, that belong to the set.
+         * @param begin the beginning of the span.
+         * @param end the end of the span.
+         * @return the number of consecutive values that belong to the set.
+         */
+        size_t span(const unsigned char* begin, const unsigned char* end) const {
+            return spanCharacters(begin, end, m_bits, m_ranges, m_rangeCount);
+        }
+
+        /**
+         * Returns the number of consecutive values, from the beginning of the given span, that belong to the set, ignoring case.
+         * @param begin the beginning of the span.
+         * @param end the end of the span.
+         * @return the number of consecutive values that belong to the set.
+         */
+        size_t spanCaseInsensitive(const unsigned char* begin, const unsigned char* end) const {
+            return spanCharacters(begin, end, m_caseInsensitiveBits, m_caseInsensitiveRanges, m_caseInsensitiveRangeCount);
+        }
+
+    private:
+        std::uint64_t m_bits[4]{};
+        std::uint64_t m_caseInsensitiveBits[4]{};
+        CharacterRange m_ranges[MaxRangeCount]{};
+        CharacterRange m_caseInsensitiveRanges[MaxRangeCount]{};
+        size_t m_rangeCount{ 0 };
+        size_t m_caseInsensitiveRangeCount{ 0 };
+
+        //set bit
+        static void set(std::uint64_t* bits, unsigned char value) {
+            bits[value >> 6] |= std::uint64_t(1) << (value & 63);
+        }
+
+        //test bit
+        static bool test(const std::uint64_t* bits, unsigned char value) {
+            return (bits[value >> 6] >> (value & 63)) & 1;
+        }
+
+        //lowercase of value
+        template <class T> static T toLower(const T& value) {
+            return static_cast<T>(std::tolower(static_cast<unsigned char>(value)));
+        }
+
+        //computes the ranges of the given table; returns 0 if more than the max number of ranges are required
+        static size_t computeRanges(const std::uint64_t* bits, CharacterRange* ranges) {
+            size_t count = 0;
+            for (int index = 0; index < 256;) {
+                if (!test(bits, static_cast<unsigned char>(index))) {
+                    ++index;
+                    continue;
+                }
+                const int min = index;
+                for (; index < 256 && test(bits, static_cast<unsigned char>(index)); ++index) {
+                }
+                if (count == MaxRangeCount) {
+                    return 0;
+                }
+                ranges[count].min = static_cast<unsigned char>(min);
+                ranges[count].span = static_cast<unsigned char>(index - 1 - min);
+                ++count;
+            }
+            return count;
+        }
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_CHARACTERSET_HPP
@@ -2,8 +2,11 @@
 #define PARSERLIB_CHOICEPARSER_HPP
 
 
+#include <array>
 #include <type_traits>
+#include <utility>
 #include "ParserNode.hpp"
+#include "FirstSet.hpp"
 #include "TerminalParser.hpp"
 #include "TerminalStringParser.hpp"
 
@@ -14,6 +17,13 @@ namespace parserlib {
     /**
      * Choice of parsers.
      * At least one parser must parse successfully in order to parse the choice successfully.
+     *
+     * The FIRST sets of the children are computed on construction; when the source elements are byte-sized,
+     * children whose FIRST set is known and that are not nullable are skipped if the current element
+     * is not in their FIRST set, since they would fail anyway; when errors are tracked, such a child is still tried
+     * if the error it would record is needed.
+     * Children with unknown FIRST sets, e.g. rules, are always tried, in order.
+     *
      * @param Children children parser nodes.
      */
     template <class ...Children> class ChoiceParser : public ParserNode<ChoiceParser<Children...>> {
@@ -24,6 +34,7 @@ namespace parserlib {
          */
         ChoiceParser(const std::tuple<Children...>& children) 
             : m_children(children) {
+            initFirstSets(std::index_sequence_for<Children...>());
         }
 
         /**
@@ -40,8 +51,14 @@ namespace parserlib {
          * @return true if parsing succeeds, false otherwise.
          */
         template <class ParseContextType> bool operator ()(ParseContextType& pc) const {
+            if constexpr (ParseContextType::InstrumentationPolicy::enabled) {
+                pc.profile().addChoiceInvocation(this, sizeof...(Children));
+            }
             const auto errorState = pc.errorState();
-            if (parse<0>(pc, [&](const auto& child) { return child(pc); })) {
+            pc.incrementBacktrackDepth();
+            const bool result = parseChildren(pc);
+            pc.decrementBacktrackDepth();
+            if (result) {
                 pc.setErrorState(errorState);
                 return true;
             }
@@ -58,7 +75,10 @@ namespace parserlib {
          */
         template <class ParseContextType> bool parseLeftRecursionContinuation(ParseContextType& pc, LeftRecursionContext<ParseContextType>& lrc) const {
             const auto errorState = pc.errorState();
-            if (parseLRC<0>(pc, lrc)) {
+            pc.incrementBacktrackDepth();
+            const bool result = parseLRC<0>(pc, lrc);
+            pc.decrementBacktrackDepth();
+            if (result) {
                 pc.setErrorState(errorState);
                 return true;
             }
@@ -67,12 +87,65 @@ namespace parserlib {
 
     private:
         std::tuple<Children...> m_children;
+        std::array<CharacterSet, sizeof...(Children)> m_firstSets;
+        std::array<bool, sizeof...(Children)> m_dispatch{};
+        bool m_hasDispatch{ false };
+
+        //computes the FIRST sets of the children; terminals are not dispatched, since they test the current element directly
+        template <size_t ...Indexes> void initFirstSets(std::index_sequence<Indexes...>) {
+            ([&](const auto& child, CharacterSet& set, bool& dispatch) {
+                if constexpr (!IsTerminalParser<std::decay_t<decltype(child)>>::value) {
+                    bool nullable = false;
+                    dispatch = addFirstSet(child, set, nullable) && !nullable;
+                    m_hasDispatch = m_hasDispatch || dispatch;
+                }
+            }(std::get<Indexes>(m_children), m_firstSets[Indexes], m_dispatch[Indexes]), ...);
+        }
+
+        //parses the children, skipping the ones that cannot parse the current element
+        template <class ParseContextType> bool parseChildren(ParseContextType& pc) const {
+            if constexpr (sizeof(typename ParseContextType::SourceType::value_type) == 1) {
+                if (m_hasDispatch) {
+                    return parseDispatch<0>(pc);
+                }
+            }
+            return parse<0>(pc, [&](const auto& child) { return child(pc); });
+        }
+
+        //a child that cannot parse the current element can only fail at the current position;
+        //it is skipped, unless it would record the error of the choice, in which case it is tried, in order,
+        //so as that the errors are the same as the ones of trying all the children in order
+        template <size_t Index, class ParseContextType> bool parseDispatch(ParseContextType& pc) const {
+            if constexpr (Index < sizeof...(Children)) {
+                if (m_dispatch[Index] && (pc.sourceEnded() || !pc.sourcePositionContains(m_firstSets[Index])) && !pc.canAddError(pc.sourcePosition())) {
+                    return parseDispatch<Index + 1>(pc);
+                }
+                const size_t cutCount = pc.cutCount();
+                if (std::get<Index>(m_children)(pc)) {
+                    addHit<Index>(pc);
+                    return true;
+                }
+                if (pc.cutCount() != cutCount) {
+                    return false;
+                }
+                return parseDispatch<Index + 1>(pc);
+            }
+            else {
+                return false;
+            }
+        }
 
         template <size_t Index, class ParseContextType, class PF> bool parse(ParseContextType& pc, const PF& pf) const {
             if constexpr (Index < sizeof...(Children)) {
+                const size_t cutCount = pc.cutCount();
                 if (pf(std::get<Index>(m_children))) {
+                    addHit<Index>(pc);
                     return true;
                 }
+                //do not try other branches if the failed branch was cut
+                if (pc.cutCount() != cutCount) {
+                    return false;
+                }
                 return parse<Index + 1>(pc, pf);
             }
             else {
@@ -80,12 +153,23 @@ namespace parserlib {
             }
         }
 
+        //records the alternative that parsed successfully, if the parse context is instrumented
+        template <size_t Index, class ParseContextType> void addHit(ParseContextType& pc) const {
+            if constexpr (ParseContextType::InstrumentationPolicy::enabled) {
+                pc.profile().addChoiceHit(this, Index);
+            }
+        }
+
         template <size_t Index, class ParseContextType> bool parseLRC(ParseContextType& pc, LeftRecursionContext<ParseContextType>& lrc) const {
             if constexpr (Index < sizeof...(Children)) {
                 lrc.setContinuationResolved(false);
+                const size_t cutCount = pc.cutCount();
                 if (std::get<Index>(m_children).parseLeftRecursionContinuation(pc, lrc)) {
                     return true;
                 }
+                if (pc.cutCount() != cutCount) {
+                    return false;
+                }
                 return parseLRC<Index + 1>(pc, lrc);
             }
             else {
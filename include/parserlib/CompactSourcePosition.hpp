@@ -0,0 +1,246 @@
+#ifndef PARSERLIB_COMPACTSOURCEPOSITION_HPP
+#define PARSERLIB_COMPACTSOURCEPOSITION_HPP
+
+
+#include "SourcePosition.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * A source position that holds only an iterator; the end of the source is held once by the parse context.
+     *
+     * It is half the size of a SourcePosition, and so are the states, rule states, errors and matches that contain it;
+     * backtracking snapshots and match trees use less memory, and deep parses are more cache friendly.
+     *
+     * Since a position does not know the end of the source, it does not provide views of the source;
+     * the error messages of terminal strings do not contain the found source,
+     * and parsing a part of a source (i.e. creating a parse context from a position) is not available.
+     *
+     * @param SourceType source type.
+     * @param CaseSensitive if true, comparison is case sensitive, otherwise case insensitive.
+     */
+    template <class SourceType_ = std::string, bool CaseSensitive = true> class CompactSourcePosition {
+    public:
+        /**
+         * Source type.
+         */
+        using SourceType = SourceType_;
+
+        /**
+         * True if comparison is case sensitive, false otherwise.
+         */
+        static constexpr bool CaseSensitiveComparison = CaseSensitive;
+
+        /**
+         * The default constructor.
+         */
+        CompactSourcePosition() {
+        }
+
+        /**
+         * Constructor.
+         * @param begin iterator to the first element of the source.
+         * @param end iterator to the end of the source; not stored.
+         */
+        CompactSourcePosition(const typename SourceType::const_iterator& begin, const typename SourceType::const_iterator& end)
+            : m_iterator(begin)
+        {
+        }
+
+        /**
+         * Returns the iterator.
+         * @return the iterator.
+         */
+        const typename SourceType::const_iterator& iterator() const {
+            return m_iterator;
+        }
+
+        /**
+         * Compares the current value with the given one.
+         * If CaseSensitive is false, then both values are set to lowercase before compared.
+         * @param value value to compare with the value at the current position.
+         * @return true if equal, false otherwise.
+         */
+        template <class T>
+        bool contains(const T& value) const {
+            return SourcePositionType::contains(m_iterator, value);
+        }
+
+        /**
+         * Compares the current value with the given range of values.
+         * If CaseSensitive is false, then values are set to lowercase before compared.
+         * @param minValue lowest value to compare with the value at the current position.
+         * @param maxValue max value to compare with the value at the current position.
+         * @return true if within range, false otherwise.
+         */
+        template <class T>
+        bool contains(const T& minValue, const T& maxValue) const {
+            return SourcePositionType::contains(m_iterator, minValue, maxValue);
+        }
+
+        /**
+         * Compares the current value with the given array of values.
+         * If CaseSensitive is false, then values are set to lowercase before compared.
+         * @param values.
+         * @return true if within range, false otherwise.
+         */
+        template <class T, class Alloc>
+        bool contains(const std::vector<T, Alloc>& values) const {
+            return SourcePositionType::contains(m_iterator, values);
+        }
+
+        /**
+         * Checks if the current value belongs to the given character set.
+         * @param set character set.
+         * @return true if within the set, false otherwise.
+         */
+        bool contains(const CharacterSet& set) const {
+            return SourcePositionType::contains(m_iterator, set);
+        }
+
+        /**
+         * Compares the source from the current position with the given null-terminated string.
+         * If CaseSensitive is false, then values are set to lowercase before compared.
+         * @param end the end of the source.
+         * @param str null-terminated string.
+         * @return true if string is present at the current position, false otherwise.
+         */
+        template <class T>
+        bool contains(const typename SourceType::const_iterator& end, const T* str) const {
+            return SourcePositionType::contains(m_iterator, end, str);
+        }
+
+        /**
+         * Compares the source from the current position with the given string of known length.
+         * @param end the end of the source.
+         * @param str string.
+         * @param foldedStr the string folded to lowercase with the function `foldCharacter`; used if CaseSensitive is false.
+         * @param length length of the string.
+         * @return true if string is present at the current position, false otherwise.
+         */
+        template <class T>
+        bool contains(const typename SourceType::const_iterator& end, const T* str, const T* foldedStr, size_t length) const {
+            return SourcePositionType::contains(m_iterator, end, str, foldedStr, length);
+        }
+
+        /**
+         * Returns the number of consecutive elements, from the current position, that belong to the given character set.
+         * @param end the end of the source.
+         * @param set character set.
+         * @return number of consecutive elements that belong to the set.
+         */
+        size_t span(const typename SourceType::const_iterator& end, const CharacterSet& set) const {
+            return SourcePositionType::span(m_iterator, end, set);
+        }
+
+        /**
+         * Increments the position by one place.
+         */
+        void increment() {
+            ++m_iterator;
+        }
+
+        /**
+         * Increases the position by multiple places.
+         * @param count number of places to increase the position by.
+         */
+        void increase(size_t count) {
+            m_iterator += count;
+        }
+
+        /**
+         * Moves the position from one source to another, keeping its place relative to an anchor position:
+         * the position, which is at or after the old anchor, is placed after the new anchor at the same distance.
+         * Available only for random access sources.
+         * @param oldAnchor position in the source of this position.
+         * @param newAnchor the corresponding position in the other source.
+         */
+        void rebase(const CompactSourcePosition& oldAnchor, const CompactSourcePosition& newAnchor) {
+            m_iterator = newAnchor.m_iterator + (m_iterator - oldAnchor.m_iterator);
+        }
+
+        /**
+         * Checks if the two positions are equal.
+         * @param other the other position to compare this to.
+         * @return true if they are equal, false otherwise.
+         */
+        bool operator == (const CompactSourcePosition& other) const {
+            return m_iterator == other.m_iterator;
+        }
+
+        /**
+         * Checks if this position is equal to the given iterator.
+         * @param it iterator to compare to this.
+         * @return true if they are equal, false otherwise.
+         */
+        bool operator == (const typename SourceType::const_iterator& it) const {
+            return m_iterator == it;
+        }
+
+        /**
+         * Checks if the two positions are different.
+         * @param other the other position to compare this to.
+         * @return true if they are different, false otherwise.
+         */
+        bool operator != (const CompactSourcePosition& other) const {
+            return m_iterator != other.m_iterator;
+        }
+
+        /**
+         * Checks if this position is different to the given iterator.
+         * @param it iterator to compare to this.
+         * @return true if they are different, false otherwise.
+         */
+        bool operator != (const typename SourceType::const_iterator& it) const {
+            return m_iterator != it;
+        }
+
+        /**
+         * Checks if the this position comes before the other position.
+         * @param other the other position to compare this to.
+         * @return true if the comparison is true, false otherwise.
+         */
+        bool operator < (const CompactSourcePosition& other) const {
+            return m_iterator < other.m_iterator;
+        }
+
+        /**
+         * Checks if the this position comes after the other position.
+         * @param other the other position to compare this to.
+         * @return true if the comparison is true, false otherwise.
+         */
+        bool operator > (const CompactSourcePosition& other) const {
+            return m_iterator > other.m_iterator;
+        }
+
+        /**
+         * Checks if the this position comes before or is equal to the other position.
+         * @param other the other position to compare this to.
+         * @return true if the comparison is true, false otherwise.
+         */
+        bool operator <= (const CompactSourcePosition& other) const {
+            return m_iterator <= other.m_iterator;
+        }
+
+        /**
+         * Checks if the this position comes after or is equal to the other position.
+         * @param other the other position to compare this to.
+         * @return true if the comparison is true, false otherwise.
+         */
+        bool operator >= (const CompactSourcePosition& other) const {
+            return m_iterator >= other.m_iterator;
+        }
+
+    private:
+        using SourcePositionType = SourcePosition<SourceType, CaseSensitive>;
+
+        typename SourceType::const_iterator m_iterator;
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_COMPACTSOURCEPOSITION_HPP
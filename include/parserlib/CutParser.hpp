@@ -0,0 +1,58 @@
+#ifndef PARSERLIB_CUTPARSER_HPP
+#define PARSERLIB_CUTPARSER_HPP
+
+
+#include "ParserNode.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * A parser that commits the parse up to the current position; it does not parse anything and always returns true.
+     *
+     * After a cut, the enclosing choices, loops and optionals do not backtrack past the cut position:
+     * if their current branch fails after the cut, they fail, instead of trying another branch.
+     * The parse context then discards the memoized results before the cut position,
+     * and the matches found so far become final, unless the cut is within a tree match.
+     *
+     * A cut shall not be used within a left-recursive rule.
+     */
+    class CutParser : public ParserNode<CutParser> {
+    public:
+        /**
+         * Commits the parse up to the current position.
+         * @param pc parse context.
+         * @return always true.
+         */
+        template <class ParseContextType> bool operator ()(ParseContextType& pc) const {
+            pc.cut();
+            return true;
+        }
+
+        /**
+         * Commits the parse up to the current position.
+         * @param pc parse context.
+         * @param lrc left recursion context.
+         * @return always true.
+         */
+        template <class ParseContextType> bool parseLeftRecursionContinuation(ParseContextType& pc, LeftRecursionContext<ParseContextType>& lrc) const {
+            pc.cut();
+            return true;
+        }
+    };
+
+
+    /**
+     * Creates a cut parser.
+     * @return a cut parser.
+     */
+    inline CutParser cut() {
+        return CutParser();
+    }
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_CUTPARSER_HPP
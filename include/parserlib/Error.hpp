@@ -2,8 +2,16 @@
 #define PARSERLIB_ERROR_HPP
 
 
+#include <cstdint>
 #include <string>
 #include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_set>
+#include <sstream>
+#include <iterator>
 
 
 namespace parserlib {
@@ -25,12 +33,70 @@ namespace parserlib {
     };
 
 
+    /**
+     * The description of what a parser node expects, which begins the messages of the node's errors.
+     * It is created on the first error of the node, and shared by the copies of the node.
+     * Descriptions are interned in a table of the process, which keeps them for the duration of the process;
+     * therefore the errors do not refer to the node, and their messages can be created after the node is destroyed.
+     */
+    class ErrorDescription {
+    public:
+        /**
+         * The default constructor.
+         */
+        ErrorDescription() : m_text(std::make_shared<std::atomic<const std::string*>>(nullptr)) {
+        }
+
+        /**
+         * Returns the description, creating it if it does not exist yet; thread-safe.
+         * @param create function that creates the description.
+         * @return the description; it is valid for the duration of the process.
+         */
+        template <class CreateFunction> const std::string* get(const CreateFunction& create) const {
+            const std::string* text = m_text->load(std::memory_order_acquire);
+            if (!text) {
+                text = intern(create());
+                m_text->store(text, std::memory_order_release);
+            }
+            return text;
+        }
+
+    private:
+        std::shared_ptr<std::atomic<const std::string*>> m_text;
+
+        //returns the interned copy of the given text; nodes that expect the same share it;
+        //the table is never destroyed, so as that messages can be created during the destruction of static objects
+        static const std::string* intern(std::string&& text) {
+            static std::mutex mutex;
+            static std::unordered_set<std::string>* const table = new std::unordered_set<std::string>();
+            std::lock_guard lock(mutex);
+            return &*table->insert(std::move(text)).first;
+        }
+    };
+
+
     /**
      * Definition of error.
+     *
+     * An error is a compact record of the error type, the error position,
+     * and optionally the description of what the failed parser node expected along with a copy of the elements found instead;
+     * in that case, the message is created when it is requested, out of these values only.
+     * Therefore messages can be requested after the grammar and the source are destroyed, and from multiple threads.
+     *
      * @param SourcePositionType type of source position.
      */
     template <class SourcePositionType> class Error {
     public:
+        /**
+         * Type of source elements.
+         */
+        using ElementType = typename std::iterator_traits<typename SourcePositionType::SourceType::const_iterator>::value_type;
+
+        /**
+         * Max number of found elements an error keeps for its message.
+         */
+        static constexpr size_t MaxFoundLength = 16;
+
         /**
          * The default constructor.
          */
@@ -48,6 +114,23 @@ namespace parserlib {
         {
         }
 
+        /**
+         * Constructor from parameters, with deferred message creation.
+         * @param type error type; stored as 'int' internally.
+         * @param pos source position type.
+         * @param description description of what was expected, as returned by an ErrorDescription; the message begins with it.
+         * @param foundEnd end of the source; the found elements are copied from the error position up to it.
+         * @param foundLength number of found elements to copy; at most MaxFoundLength elements are copied. If 0, the message does not include the found elements.
+         * @param quoteFound if true, the found elements are quoted in the message.
+         */
+        template <class ErrorType, class Iterator> Error(ErrorType type, const SourcePositionType& pos, const std::string* description, const Iterator& foundEnd, size_t foundLength, bool quoteFound)
+            : m_type(static_cast<int>(type)), m_position(pos), m_description(description), m_quoteFound(quoteFound)
+        {
+            for (auto it = pos.iterator(); m_foundLength < foundLength && m_foundLength < MaxFoundLength && it != foundEnd; ++it) {
+                m_found[m_foundLength++] = *it;
+            }
+        }
+
         /**
          * Returns the error type.
          * @return the error type.
@@ -64,18 +147,50 @@ namespace parserlib {
             return m_position;
         }
 
+        /**
+         * Returns a view of the source at the error position, without copying it.
+         * Available only for contiguous sources; the source must be alive.
+         * @param length max number of elements of the view.
+         * @return a view of the source at the error position.
+         */
+        auto sourceView(size_t length) const {
+            return m_position.view(length);
+        }
+
         /**
          * Returns the error message.
+         * If the error was created with a description, the message is created out of the description and the found elements.
          * @return the error message.
          */
-        const std::string& message() const {
-            return m_message;
+        std::string message() const {
+            if (!m_description) {
+                return m_message;
+            }
+            if (m_foundLength == 0) {
+                return *m_description;
+            }
+            std::stringstream stream;
+            stream << *m_description << ", found: ";
+            if (m_quoteFound) {
+                stream << '"';
+            }
+            for (size_t index = 0; index < m_foundLength; ++index) {
+                stream << m_found[index];
+            }
+            if (m_quoteFound) {
+                stream << '"';
+            }
+            return stream.str();
         }
 
     private:
-        int m_type;
+        int m_type{ 0 };
         SourcePositionType m_position;
         std::string m_message;
+        const std::string* m_description{ nullptr };
+        std::array<ElementType, MaxFoundLength> m_found{};
+        std::uint8_t m_foundLength{ 0 };
+        bool m_quoteFound{ false };
     };
 
 
@@ -98,6 +213,32 @@ namespace parserlib {
     }
 
 
+    /**
+     * Helper function for creating an error instance with deferred message creation.
+     * @param type error type; stored as 'int' internally.
+     * @param pos source position type.
+     * @param description description of what was expected, as returned by an ErrorDescription; the message begins with it.
+     * @param foundEnd end of the source; the found elements are copied from the error position up to it.
+     * @param foundLength number of found elements to copy.
+     * @param quoteFound if true, the found elements are quoted in the message.
+     * @return an error instance.
+     */
+    template <class ErrorType, class SourcePositionType, class Iterator>
+    Error<SourcePositionType> makeError(ErrorType type, const SourcePositionType& pos, const std::string* description, const Iterator& foundEnd, size_t foundLength, bool quoteFound = false) {
+        return { type, pos, description, foundEnd, foundLength, quoteFound };
+    }
+
+
+    /**
+     * Returns the message of an error.
+     * @param error the error.
+     * @return the message of the error.
+     */
+    template <class SourcePositionType> std::string formatError(const Error<SourcePositionType>& error) {
+        return error.message();
+    }
+
+
 } //namespace parserlib
 
 
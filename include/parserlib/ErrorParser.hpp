@@ -2,7 +2,11 @@
 #define PARSERLIB_ERRORPARSER_HPP
 
 
+#include <cstdint>
+#include <stdexcept>
 #include "SequenceParser.hpp"
+#include "CharacterSet.hpp"
+#include "FirstSet.hpp"
 
 
 namespace parserlib {
@@ -10,17 +14,44 @@ namespace parserlib {
 
     /**
      * Special structure that wraps a parser in order to indicate an error recovery point.
+     *
+     * A recovery point may have a sync set, i.e. the set of elements the recovery parser may start with;
+     * error recovery then skips the elements that are not in the sync set in bulk, instead of invoking the recovery parser at each position.
+     * A recovery point may also have a max distance, i.e. the max number of elements error recovery may skip.
+     *
      * @param ParserType type of parser to use for error recovery.
      */
     template <class ParserType> class ErrorRecoveryPoint {
     public:
         /**
          * The constructor.
+         * The recovery point has no sync set and no max distance.
          * @param parser parser to use for error recovery.
          */
         ErrorRecoveryPoint(const ParserType& parser) : m_parser(parser) {
         }
 
+        /**
+         * Constructor with a sync set and a max distance.
+         * @param parser parser to use for error recovery.
+         * @param syncSet set of elements at which the parser is invoked; other elements are skipped.
+         * @param maxDistance max number of elements skipped.
+         */
+        ErrorRecoveryPoint(const ParserType& parser, const CharacterSet& syncSet, size_t maxDistance)
+            : m_parser(parser), m_syncSet(syncSet), m_hasSyncSet(true), m_maxDistance(maxDistance)
+        {
+        }
+
+        /**
+         * Constructor with a max distance.
+         * @param parser parser to use for error recovery.
+         * @param maxDistance max number of elements skipped.
+         */
+        ErrorRecoveryPoint(const ParserType& parser, size_t maxDistance)
+            : m_parser(parser), m_maxDistance(maxDistance)
+        {
+        }
+
         /**
          * Returns the parser to be used for error recovery.
          * @return the parser to be used for error recovery.
@@ -29,8 +60,35 @@ namespace parserlib {
             return m_parser;
         }
 
+        /**
+         * Returns the sync set.
+         * @return the sync set; it is empty if the recovery point has no sync set.
+         */
+        const CharacterSet& syncSet() const {
+            return m_syncSet;
+        }
+
+        /**
+         * Checks if the recovery point has a sync set.
+         * @return true if the recovery point has a sync set, false otherwise.
+         */
+        bool hasSyncSet() const {
+            return m_hasSyncSet;
+        }
+
+        /**
+         * Returns the max number of elements error recovery may skip.
+         * @return the max distance; SIZE_MAX if there is no limit.
+         */
+        size_t maxDistance() const {
+            return m_maxDistance;
+        }
+
     private:
         ParserType m_parser;
+        CharacterSet m_syncSet;
+        bool m_hasSyncSet{ false };
+        size_t m_maxDistance{ SIZE_MAX };
     };
 
 
@@ -43,6 +101,12 @@ namespace parserlib {
      * 
      *    LHS >> ~RHS
      * 
+     * When the source elements are byte-sized, positions at which the right-hand-side parser cannot start are skipped in bulk;
+     * these positions are given by the sync set of the recovery point, or, if there is none,
+     * by the FIRST set of the right-hand-side parser, if it is known and the parser is not nullable.
+     * Error recovery gives up after skipping the max distance of the recovery point,
+     * and it is not attempted if the parse context has reached its max recovery count.
+     * 
      * @param LHS left-hand-side parser; type of parser that is on the left side of `operator >>()`.
      * @param RHS right-hand-side parser; type of parser that is on the right side of `operator >>()`; used for error recovery.
      */
@@ -53,7 +117,47 @@ namespace parserlib {
          * @param lhs left-hand-side parser.
          * @param rhs right-hand-side parser.
          */
-        ErrorParser(const LHS& lhs, const RHS& rhs) : m_lhs(lhs), m_rhs(rhs) {
+        ErrorParser(const LHS& lhs, const RHS& rhs) : ErrorParser(lhs, ErrorRecoveryPoint<RHS>(rhs)) {
+        }
+
+        /**
+         * Constructor from a recovery point.
+         * @param lhs left-hand-side parser.
+         * @param recoveryPoint recovery point; it contains the right-hand-side parser.
+         */
+        ErrorParser(const LHS& lhs, const ErrorRecoveryPoint<RHS>& recoveryPoint)
+            : m_lhs(lhs)
+            , m_rhs(recoveryPoint.parser())
+            , m_maxDistance(recoveryPoint.maxDistance())
+        {
+            CharacterSet syncSet;
+            bool nullable;
+            if (recoveryPoint.hasSyncSet()) {
+                syncSet = recoveryPoint.syncSet();
+                m_hasSkipSet = true;
+            }
+            else {
+                m_hasSkipSet = addFirstSet(m_rhs, syncSet, nullable) && !nullable;
+            }
+            if (m_hasSkipSet) {
+                m_skipSet = makeSkipSet(syncSet);
+            }
+        }
+
+        /**
+         * Returns the left-hand-side parser.
+         * @return the left-hand-side parser.
+         */
+        const LHS& lhs() const {
+            return m_lhs;
+        }
+
+        /**
+         * Returns the right-hand-side parser, used for error recovery.
+         * @return the right-hand-side parser.
+         */
+        const RHS& rhs() const {
+            return m_rhs;
         }
 
         /**
@@ -72,17 +176,10 @@ namespace parserlib {
          * @return true if parsing succeeds, false otherwise.
          */
         template <class ParseContextType> bool operator ()(ParseContextType& pc) const {
-            if (m_lhs(pc)) {
-                if (m_rhs(pc)) {
-                    return true;
-                }
-            }
-
-            if (recover(pc)) {
-                return true;
-            }
-
-            return false;
+            pc.incrementBacktrackDepth();
+            const bool result = (m_lhs(pc) && m_rhs(pc)) || recover(pc);
+            pc.decrementBacktrackDepth();
+            return result;
         }
 
         /**
@@ -92,6 +189,37 @@ namespace parserlib {
          * @return true if parsing succeeds, false otherwise.
          */
         template <class ParseContextType> bool parseLeftRecursionContinuation(ParseContextType& pc, LeftRecursionContext<ParseContextType>& lrc) const {
+            pc.incrementBacktrackDepth();
+            const bool result = parseLRC(pc, lrc);
+            pc.decrementBacktrackDepth();
+            return result;
+        }
+
+    private:
+        LHS m_lhs;
+        RHS m_rhs;
+        CharacterSet m_skipSet;
+        bool m_hasSkipSet{ false };
+        size_t m_maxDistance;
+
+        //the complement of the sync set; values that are in the sync set in either case are not skipped, so as that the set applies to case insensitive parsing
+        static CharacterSet makeSkipSet(const CharacterSet& syncSet) {
+            CharacterSet result;
+            for (int index = 0; index < 256; ) {
+                if (syncSet.containsCaseInsensitive(static_cast<unsigned char>(index))) {
+                    ++index;
+                    continue;
+                }
+                const int first = index;
+                for (; index < 256 && !syncSet.containsCaseInsensitive(static_cast<unsigned char>(index)); ++index) {
+                }
+                result.addRange(static_cast<unsigned char>(first), static_cast<unsigned char>(index - 1));
+            }
+            return result;
+        }
+
+        //parse within a left recursion context
+        template <class ParseContextType> bool parseLRC(ParseContextType& pc, LeftRecursionContext<ParseContextType>& lrc) const {
             if (m_lhs.parseLeftRecursionContinuation(pc, lrc)) {
                 if (lrc.continuationResolved()) {
                     if (m_rhs(pc)) {
@@ -112,20 +240,38 @@ namespace parserlib {
             return false;
         }
 
-    private:
-        LHS m_lhs;
-        RHS m_rhs;
-
         //recover from error
         template <class ParseContextType> bool recover(ParseContextType& pc) const {
             //commit the current errors
             pc.commitErrors();
 
+            //the parse context may limit the number of recoveries; there is nothing to recover at the end of the source
+            if (pc.sourceEnded() || !pc.incrementRecoveryCount()) {
+                return false;
+            }
+
             //rewind the error state on end; don't record errors while testing for recovery
             const auto errorState = pc.errorState();
 
-            //until the source is exhausted
-            while (!pc.sourceEnded()) {
+            //until the source is exhausted or the max distance is skipped
+            for (size_t distance = 0; !pc.sourceEnded(); ) {
+
+                //skip the elements the right-hand-side parser cannot start with
+                if constexpr (sizeof(typename ParseContextType::SourceType::value_type) == 1) {
+                    if (m_hasSkipSet) {
+                        const size_t count = pc.sourcePositionSpan(m_skipSet);
+                        if (count > m_maxDistance - distance) {
+                            break;
+                        }
+                        if (count > 0) {
+                            pc.increaseSourcePosition(count);
+                            distance += count;
+                            if (pc.sourceEnded()) {
+                                break;
+                            }
+                        }
+                    }
+                }
 
                 //if the right-hand-side parser suceeds, then remove the temporary errors
                 //and report success
@@ -135,7 +281,11 @@ namespace parserlib {
                 }
 
                 //next position since current position failed to parse
+                if (distance == m_maxDistance) {
+                    break;
+                }
                 pc.incrementSourcePosition();
+                ++distance;
             }
 
             //error; no recovery possible
@@ -145,6 +295,22 @@ namespace parserlib {
     };
 
 
+    /**
+     * Creates the sync set of an error recovery point out of the FIRST set of a parser node.
+     * @param sync parser node.
+     * @return the FIRST set of the parser node.
+     * @exception std::invalid_argument thrown if the FIRST set of the parser node is unknown, or if the parser node is nullable.
+     */
+    template <class SyncParserNodeType> CharacterSet makeSyncSet(const SyncParserNodeType& sync) {
+        CharacterSet result;
+        bool nullable;
+        if (!addFirstSet(sync, result, nullable) || nullable) {
+            throw std::invalid_argument("The sync parser of an error recovery point shall have a known FIRST set and shall not be nullable.");
+        }
+        return result;
+    }
+
+
     /**
      * Operator that creates an error recovery point from a parser node.
      * @param node parser node to create an error recovery point from.
@@ -164,7 +330,33 @@ namespace parserlib {
      */
     template <class LHS, class RHS> 
     ErrorParser<LHS, RHS> operator >> (const ParserNode<LHS>& lhs, const ErrorRecoveryPoint<RHS>& rhs) {
-        return { static_cast<const LHS&>(lhs), rhs.parser() };
+        return { static_cast<const LHS&>(lhs), rhs };
+    }
+
+
+    /**
+     * Creates an error recovery point with a sync set and a max distance.
+     * @param node parser node to use for error recovery.
+     * @param sync parser node whose FIRST set is the sync set; error recovery invokes the recovery parser only at the elements of the set.
+     * @param maxDistance max number of elements error recovery may skip.
+     * @return an error recovery point.
+     * @exception std::invalid_argument thrown if the FIRST set of the sync parser node is unknown, or if the sync parser node is nullable.
+     */
+    template <class ParserNodeType, class SyncParserNodeType>
+    ErrorRecoveryPoint<ParserNodeType> recoveryPoint(const ParserNode<ParserNodeType>& node, const ParserNode<SyncParserNodeType>& sync, size_t maxDistance = SIZE_MAX) {
+        return { static_cast<const ParserNodeType&>(node), makeSyncSet(static_cast<const SyncParserNodeType&>(sync)), maxDistance };
+    }
+
+
+    /**
+     * Creates an error recovery point with a max distance.
+     * @param node parser node to use for error recovery.
+     * @param maxDistance max number of elements error recovery may skip.
+     * @return an error recovery point.
+     */
+    template <class ParserNodeType>
+    ErrorRecoveryPoint<ParserNodeType> recoveryPoint(const ParserNode<ParserNodeType>& node, size_t maxDistance) {
+        return { static_cast<const ParserNodeType&>(node), maxDistance };
     }
 
 
@@ -0,0 +1,35 @@
+#ifndef PARSERLIB_ERRORTRACKINGPOLICY_HPP
+#define PARSERLIB_ERRORTRACKINGPOLICY_HPP
+
+
+namespace parserlib {
+
+
+    /**
+     * Error tracking policy that records errors; the default.
+     */
+    struct TrackErrors {
+        /**
+         * Errors are tracked.
+         */
+        static constexpr bool enabled = true;
+    };
+
+
+    /**
+     * Error tracking policy that does not record errors.
+     * It is useful for input that is known to be valid, where only the result of parsing and the matches are required;
+     * all error-related operations of the parse context compile to nothing.
+     */
+    struct NoErrors {
+        /**
+         * Errors are not tracked.
+         */
+        static constexpr bool enabled = false;
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_ERRORTRACKINGPOLICY_HPP
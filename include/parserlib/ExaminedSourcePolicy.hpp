@@ -0,0 +1,50 @@
+#ifndef PARSERLIB_EXAMINEDSOURCEPOLICY_HPP
+#define PARSERLIB_EXAMINEDSOURCEPOLICY_HPP
+
+
+namespace parserlib {
+
+
+    /**
+     * Examined source policy that does not track how far into the source parsers look.
+     * All examined source bookkeeping compiles to nothing; incremental and resumable parsing are not available.
+     */
+    struct IgnoreExaminedSource {
+        /**
+         * The examined source is not tracked.
+         */
+        static constexpr bool enabled = false;
+    };
+
+
+    /**
+     * Examined source policy that tracks how far into the source parsers look, including lookahead,
+     * while memoization or examined source tracking is enabled.
+     * It is required for incremental parsing, which reuses memoized results the edits do not affect,
+     * and for resumable parsing, which suspends parsers that need more input than is available.
+     */
+    struct TrackExaminedSource {
+        /**
+         * The examined source is tracked.
+         */
+        static constexpr bool enabled = true;
+    };
+
+
+    /**
+     * Trait that selects the default examined source policy of parse contexts over the given type of source.
+     * The source is not tracked by default.
+     * @param SourceType type of source.
+     */
+    template <class SourceType> struct DefaultExaminedSourcePolicy {
+        /**
+         * The default policy.
+         */
+        using type = IgnoreExaminedSource;
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_EXAMINEDSOURCEPOLICY_HPP
@@ -0,0 +1,471 @@
+#ifndef PARSERLIB_FIRSTSET_HPP
+#define PARSERLIB_FIRSTSET_HPP
+
+
+#include <tuple>
+#include <type_traits>
+#include "CharacterSet.hpp"
+
+
+namespace parserlib {
+
+
+    template <class TerminalValueType> class TerminalParser;
+    template <class TerminalValueType> class TerminalStringParser;
+    template <class TerminalValueType> class TerminalSetParser;
+    template <class TerminalValueType> class TerminalRangeParser;
+    template <class TerminalValueType, class MatchIdType> class KeywordsParser;
+    template <class ...Children> class SequenceParser;
+    template <class ...Children> class ChoiceParser;
+    template <class ParserNodeType> class Loop0Parser;
+    template <class ParserNodeType> class Loop1Parser;
+    template <class ParserNodeType> class LoopNParser;
+    template <class ParserNodeType> class OptionalParser;
+    template <class ParserNodeType> class AndParser;
+    template <class ParserNodeType> class NotParser;
+    template <class ParserNodeType, class MatchIdType> class MatchParser;
+    template <class ParserNodeType, class MatchIdType> class TreeMatchParser;
+    class EmptyParser;
+    class EOFParser;
+    class CutParser;
+
+
+    /**
+     * Trait that computes the FIRST set of a parser node, i.e. the set of byte-sized elements
+     * that the parser node may consume first when it parses successfully.
+     *
+     * The FIRST set of a parser node is known if it is computed from terminals only;
+     * if it is known, then the parser node either succeeds without consuming input, if it is nullable,
+     * or it fails when the current element does not belong to its FIRST set.
+     *
+     * The FIRST set of parser nodes without a specialization, e.g. rules, is unknown.
+     *
+     * @param ParserNodeType type of parser node.
+     */
+    template <class ParserNodeType> struct FirstSet {
+        /**
+         * The FIRST set of unknown parser nodes is unknown.
+         * @param node parser node.
+         * @param set character set to add the FIRST set to.
+         * @param nullable set to true if the parser node may succeed without consuming input.
+         * @return false.
+         */
+        static bool addTo(const ParserNodeType& node, CharacterSet& set, bool& nullable) {
+            return false;
+        }
+    };
+
+
+    /**
+     * Trait that tells if a parser node is a terminal.
+     * Terminals test the current element directly, and therefore testing their FIRST set before invoking them is not faster.
+     * @param ParserNodeType type of parser node.
+     */
+    template <class ParserNodeType> struct IsTerminalParser : std::false_type {
+    };
+
+
+    /**
+     * Terminals are terminal parsers.
+     * @param TerminalValueType value type of the terminal.
+     */
+    template <class TerminalValueType> struct IsTerminalParser<TerminalParser<TerminalValueType>> : std::true_type {
+    };
+
+
+    /**
+     * Terminal strings are terminal parsers.
+     * @param TerminalValueType value type of the terminal.
+     */
+    template <class TerminalValueType> struct IsTerminalParser<TerminalStringParser<TerminalValueType>> : std::true_type {
+    };
+
+
+    /**
+     * Terminal sets are terminal parsers.
+     * @param TerminalValueType value type of the terminal.
+     */
+    template <class TerminalValueType> struct IsTerminalParser<TerminalSetParser<TerminalValueType>> : std::true_type {
+    };
+
+
+    /**
+     * Terminal ranges are terminal parsers.
+     * @param TerminalValueType value type of the terminal.
+     */
+    template <class TerminalValueType> struct IsTerminalParser<TerminalRangeParser<TerminalValueType>> : std::true_type {
+    };
+
+
+    /**
+     * Keywords are terminal parsers.
+     * @param TerminalValueType value type of the keywords.
+     * @param MatchIdType type of match id.
+     */
+    template <class TerminalValueType, class MatchIdType> struct IsTerminalParser<KeywordsParser<TerminalValueType, MatchIdType>> : std::true_type {
+    };
+
+
+    /**
+     * Adds the FIRST set of the given parser node to the given character set.
+     * @param node parser node.
+     * @param set character set to add the FIRST set to.
+     * @param nullable set to true if the parser node may succeed without consuming input, false otherwise.
+     * @return true if the FIRST set is known, false otherwise.
+     */
+    template <class ParserNodeType> bool addFirstSet(const ParserNodeType& node, CharacterSet& set, bool& nullable) {
+        nullable = false;
+        return FirstSet<ParserNodeType>::addTo(node, set, nullable);
+    }
+
+
+    /**
+     * FIRST set trait for terminals.
+     * @param TerminalValueType value type of the terminal.
+     */
+    template <class TerminalValueType> struct FirstSet<TerminalParser<TerminalValueType>> {
+        /**
+         * Adds the terminal value to the set.
+         * @param node parser node.
+         * @param set character set to add the FIRST set to.
+         * @param nullable not modified.
+         * @return true for byte-sized terminal values.
+         */
+        static bool addTo(const TerminalParser<TerminalValueType>& node, CharacterSet& set, bool& nullable) {
+            if constexpr (sizeof(TerminalValueType) == 1) {
+                set.add(node.terminalValue());
+                return true;
+            }
+            else {
+                return false;
+            }
+        }
+    };
+
+
+    /**
+     * FIRST set trait for terminal strings.
+     * @param TerminalValueType value type of the terminal.
+     */
+    template <class TerminalValueType> struct FirstSet<TerminalStringParser<TerminalValueType>> {
+        /**
+         * Adds the first element of the string to the set; an empty string is nullable.
+         * @param node parser node.
+         * @param set character set to add the FIRST set to.
+         * @param nullable set to true if the string is empty.
+         * @return true for byte-sized terminal values.
+         */
+        static bool addTo(const TerminalStringParser<TerminalValueType>& node, CharacterSet& set, bool& nullable) {
+            if constexpr (sizeof(TerminalValueType) == 1) {
+                if (node.string()[0]) {
+                    set.add(node.string()[0]);
+                }
+                else {
+                    nullable = true;
+                }
+                return true;
+            }
+            else {
+                return false;
+            }
+        }
+    };
+
+
+    /**
+     * FIRST set trait for terminal sets.
+     * @param TerminalValueType value type of the terminal.
+     */
+    template <class TerminalValueType> struct FirstSet<TerminalSetParser<TerminalValueType>> {
+        /**
+         * Adds the terminal values to the set.
+         * @param node parser node.
+         * @param set character set to add the FIRST set to.
+         * @param nullable not modified.
+         * @return true for byte-sized terminal values.
+         */
+        static bool addTo(const TerminalSetParser<TerminalValueType>& node, CharacterSet& set, bool& nullable) {
+            if constexpr (sizeof(TerminalValueType) == 1) {
+                for (const TerminalValueType& value : node.terminalValues()) {
+                    set.add(value);
+                }
+                return true;
+            }
+            else {
+                return false;
+            }
+        }
+    };
+
+
+    /**
+     * FIRST set trait for keywords.
+     * @param TerminalValueType value type of the keywords.
+     * @param MatchIdType type of match id.
+     */
+    template <class TerminalValueType, class MatchIdType> struct FirstSet<KeywordsParser<TerminalValueType, MatchIdType>> {
+        /**
+         * Adds the first element of each keyword to the set; an empty keyword is nullable.
+         * @param node parser node.
+         * @param set character set to add the FIRST set to.
+         * @param nullable set to true if there is an empty keyword.
+         * @return true for byte-sized terminal values.
+         */
+        static bool addTo(const KeywordsParser<TerminalValueType, MatchIdType>& node, CharacterSet& set, bool& nullable) {
+            if constexpr (sizeof(TerminalValueType) == 1) {
+                for (const auto& keyword : node.keywords()) {
+                    if (!keyword.empty()) {
+                        set.add(keyword[0]);
+                    }
+                    else {
+                        nullable = true;
+                    }
+                }
+                return true;
+            }
+            else {
+                return false;
+            }
+        }
+    };
+
+
+    /**
+     * FIRST set trait for terminal ranges.
+     * @param TerminalValueType value type of the terminal.
+     */
+    template <class TerminalValueType> struct FirstSet<TerminalRangeParser<TerminalValueType>> {
+        /**
+         * Adds the terminal range to the set.
+         * @param node parser node.
+         * @param set character set to add the FIRST set to.
+         * @param nullable not modified.
+         * @return true for byte-sized terminal values.
+         */
+        static bool addTo(const TerminalRangeParser<TerminalValueType>& node, CharacterSet& set, bool& nullable) {
+            if constexpr (sizeof(TerminalValueType) == 1) {
+                set.addRange(node.minTerminalValue(), node.maxTerminalValue());
+                return true;
+            }
+            else {
+                return false;
+            }
+        }
+    };
+
+
+    /**
+     * FIRST set trait for sequences; the FIRST sets of the children are added up to the first child that is not nullable.
+     * @param Children children parser nodes.
+     */
+    template <class ...Children> struct FirstSet<SequenceParser<Children...>> {
+        /**
+         * Adds the FIRST sets of the children to the set.
+         * @param node parser node.
+         * @param set character set to add the FIRST set to.
+         * @param nullable set to true if all children are nullable.
+         * @return true if the FIRST sets of the children up to the first non-nullable child are known.
+         */
+        static bool addTo(const SequenceParser<Children...>& node, CharacterSet& set, bool& nullable) {
+            bool known = true;
+            bool childNullable = true;
+            std::apply([&](const auto&... children) {
+                ((known && childNullable ? (void)(known = addFirstSet(children, set, childNullable)) : (void)0), ...);
+                }, node.children());
+            nullable = childNullable;
+            return known;
+        }
+    };
+
+
+    /**
+     * FIRST set trait for choices; the FIRST set is the union of the FIRST sets of the children.
+     * @param Children children parser nodes.
+     */
+    template <class ...Children> struct FirstSet<ChoiceParser<Children...>> {
+        /**
+         * Adds the FIRST sets of the children to the set.
+         * @param node parser node.
+         * @param set character set to add the FIRST set to.
+         * @param nullable set to true if any child is nullable.
+         * @return true if the FIRST sets of all children are known.
+         */
+        static bool addTo(const ChoiceParser<Children...>& node, CharacterSet& set, bool& nullable) {
+            bool known = true;
+            std::apply([&](const auto&... children) {
+                ([&](const auto& child) {
+                    bool childNullable = false;
+                    known = known && addFirstSet(child, set, childNullable);
+                    nullable = nullable || childNullable;
+                }(children), ...);
+                }, node.children());
+            return known;
+        }
+    };
+
+
+    /**
+     * FIRST set trait for parser nodes that are nullable and whose FIRST set is the FIRST set of their child:
+     * loops of 0 or more times and optionals.
+     * @param ParserNodeType type of parser node.
+     */
+    template <class ParserNodeType> struct NullableChildFirstSet {
+        /**
+         * Adds the FIRST set of the child to the set.
+         * @param node parser node.
+         * @param set character set to add the FIRST set to.
+         * @param nullable set to true.
+         * @return true if the FIRST set of the child is known.
+         */
+        static bool addTo(const ParserNodeType& node, CharacterSet& set, bool& nullable) {
+            bool childNullable = false;
+            nullable = true;
+            return addFirstSet(node.child(), set, childNullable);
+        }
+    };
+
+
+    /**
+     * FIRST set trait for parser nodes whose FIRST set is the FIRST set of their child:
+     * loops of 1 or more times and matches.
+     * @param ParserNodeType type of parser node.
+     */
+    template <class ParserNodeType> struct ChildFirstSet {
+        /**
+         * Adds the FIRST set of the child to the set.
+         * @param node parser node.
+         * @param set character set to add the FIRST set to.
+         * @param nullable set to true if the child is nullable.
+         * @return true if the FIRST set of the child is known.
+         */
+        static bool addTo(const ParserNodeType& node, CharacterSet& set, bool& nullable) {
+            return addFirstSet(node.child(), set, nullable);
+        }
+    };
+
+
+    /**
+     * FIRST set trait for parser nodes that do not consume input: predicates, empty, end of source and cuts.
+     * Their FIRST set is empty, and they are nullable.
+     * @param ParserNodeType type of parser node.
+     */
+    template <class ParserNodeType> struct EmptyFirstSet {
+        /**
+         * Adds nothing to the set.
+         * @param node parser node.
+         * @param set character set to add the FIRST set to.
+         * @param nullable set to true.
+         * @return true.
+         */
+        static bool addTo(const ParserNodeType& node, CharacterSet& set, bool& nullable) {
+            nullable = true;
+            return true;
+        }
+    };
+
+
+    /**
+     * FIRST set trait for loops of 0 or more times.
+     * @param ParserNodeType type of the child parser node.
+     */
+    template <class ParserNodeType> struct FirstSet<Loop0Parser<ParserNodeType>> : NullableChildFirstSet<Loop0Parser<ParserNodeType>> {
+    };
+
+
+    /**
+     * FIRST set trait for optionals.
+     * @param ParserNodeType type of the child parser node.
+     */
+    template <class ParserNodeType> struct FirstSet<OptionalParser<ParserNodeType>> : NullableChildFirstSet<OptionalParser<ParserNodeType>> {
+    };
+
+
+    /**
+     * FIRST set trait for loops of 1 or more times.
+     * @param ParserNodeType type of the child parser node.
+     */
+    template <class ParserNodeType> struct FirstSet<Loop1Parser<ParserNodeType>> : ChildFirstSet<Loop1Parser<ParserNodeType>> {
+    };
+
+
+    /**
+     * FIRST set trait for loops of N times; a loop of 0 times is nullable.
+     * @param ParserNodeType type of the child parser node.
+     */
+    template <class ParserNodeType> struct FirstSet<LoopNParser<ParserNodeType>> {
+        /**
+         * Adds the FIRST set of the child to the set.
+         * @param node parser node.
+         * @param set character set to add the FIRST set to.
+         * @param nullable set to true if the child is nullable or the loop count is 0.
+         * @return true if the FIRST set of the child is known.
+         */
+        static bool addTo(const LoopNParser<ParserNodeType>& node, CharacterSet& set, bool& nullable) {
+            const bool known = addFirstSet(node.child(), set, nullable);
+            nullable = nullable || node.loopCount() == 0;
+            return known;
+        }
+    };
+
+
+    /**
+     * FIRST set trait for matches.
+     * @param ParserNodeType type of the child parser node.
+     * @param MatchIdType type of the match id.
+     */
+    template <class ParserNodeType, class MatchIdType> struct FirstSet<MatchParser<ParserNodeType, MatchIdType>>
+        : ChildFirstSet<MatchParser<ParserNodeType, MatchIdType>> {
+    };
+
+
+    /**
+     * FIRST set trait for tree matches.
+     * @param ParserNodeType type of the child parser node.
+     * @param MatchIdType type of the match id.
+     */
+    template <class ParserNodeType, class MatchIdType> struct FirstSet<TreeMatchParser<ParserNodeType, MatchIdType>>
+        : ChildFirstSet<TreeMatchParser<ParserNodeType, MatchIdType>> {
+    };
+
+
+    /**
+     * FIRST set trait for logical and.
+     * @param ParserNodeType type of the child parser node.
+     */
+    template <class ParserNodeType> struct FirstSet<AndParser<ParserNodeType>> : EmptyFirstSet<AndParser<ParserNodeType>> {
+    };
+
+
+    /**
+     * FIRST set trait for logical not.
+     * @param ParserNodeType type of the child parser node.
+     */
+    template <class ParserNodeType> struct FirstSet<NotParser<ParserNodeType>> : EmptyFirstSet<NotParser<ParserNodeType>> {
+    };
+
+
+    /**
+     * FIRST set trait for the empty parser.
+     */
+    template <> struct FirstSet<EmptyParser> : EmptyFirstSet<EmptyParser> {
+    };
+
+
+    /**
+     * FIRST set trait for the end of source parser.
+     */
+    template <> struct FirstSet<EOFParser> : EmptyFirstSet<EOFParser> {
+    };
+
+
+    /**
+     * FIRST set trait for cuts.
+     */
+    template <> struct FirstSet<CutParser> : EmptyFirstSet<CutParser> {
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_FIRSTSET_HPP
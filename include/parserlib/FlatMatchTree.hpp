@@ -0,0 +1,528 @@
+#ifndef PARSERLIB_FLATMATCHTREE_HPP
+#define PARSERLIB_FLATMATCHTREE_HPP
+
+
+#include <vector>
+#include <iterator>
+#include "SourceView.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * A match container that stores the whole match tree in one contiguous array of nodes.
+     *
+     * Nodes are stored in post-order: the nodes of a subtree are contiguous and the root of the subtree is the last one.
+     * Each node keeps links to its parent, first child and next sibling, therefore creating a tree match
+     * does not copy or allocate its children; it only links the existing nodes to the new node.
+     *
+     * Links are stored as offsets relative to the node, so as that a range of complete subtrees
+     * can be copied and appended elsewhere in the array (for example by memoization).
+     *
+     * It can be used as a parse context's match container type, in place of the default vector of matches;
+     * in that case, match counts used by the parse context are node counts.
+     *
+     * @param SourceType container with source data.
+     * @param MatchIdType id to apply to a match.
+     * @param PositionType type of source position.
+     */
+    template <class SourceType, class MatchIdType, class PositionType> class FlatMatchTree {
+    public:
+        /**
+         * A node of the tree.
+         */
+        class Node {
+        public:
+            /**
+             * Constructor.
+             * @param id id of match.
+             * @param begin begin position of match.
+             * @param end end position of match.
+             */
+            Node(const MatchIdType& id, const PositionType& begin, const PositionType& end)
+                : m_id(id), m_begin(begin), m_end(end)
+            {
+            }
+
+            /**
+             * Returns the id of the match.
+             * @return the id of the match.
+             */
+            const MatchIdType& id() const {
+                return m_id;
+            }
+
+            /**
+             * Returns the position the match begins.
+             * @return the position the match begins.
+             */
+            const PositionType& begin() const {
+                return m_begin;
+            }
+
+            /**
+             * Returns the position the match ends.
+             * @return the position the match ends.
+             */
+            const PositionType& end() const {
+                return m_end;
+            }
+
+            /**
+             * Returns the number of nodes of the subtree that has this node as root, including this node.
+             * @return the number of nodes of the subtree.
+             */
+            size_t subtreeSize() const {
+                return m_subtreeSize;
+            }
+
+            /**
+             * Replaces the positions of the node with the positions returned by the given function;
+             * it allows rebasing nodes into another source.
+             * @param func function that receives a position and returns the position to replace it with.
+             */
+            template <class F> void mapPositions(const F& func) {
+                m_begin = func(m_begin);
+                m_end = func(m_end);
+            }
+
+        private:
+            MatchIdType m_id;
+            PositionType m_begin;
+            PositionType m_end;
+            size_t m_parentOffset{ 0 };
+            size_t m_firstChildOffset{ 0 };
+            size_t m_nextSiblingOffset{ 0 };
+            size_t m_subtreeSize{ 1 };
+
+            friend class FlatMatchTree;
+        };
+
+        /**
+         * Value type; same as node, in order to allow the container to be used like a vector of nodes.
+         */
+        using value_type = Node;
+
+        /**
+         * Node iterator type.
+         */
+        using const_iterator = typename std::vector<Node>::const_iterator;
+
+        /**
+         * A reference to a match stored in a tree.
+         */
+        class Match {
+        public:
+            /**
+             * Constructor.
+             * @param tree the tree.
+             * @param index index of the node into the tree.
+             */
+            Match(const FlatMatchTree& tree, size_t index) : m_tree(&tree), m_index(index) {
+            }
+
+            /**
+             * Returns the index of the node of this match.
+             * @return the index of the node of this match.
+             */
+            size_t index() const {
+                return m_index;
+            }
+
+            /**
+             * Returns the id of the match.
+             * @return the id of the match.
+             */
+            const MatchIdType& id() const {
+                return node().id();
+            }
+
+            /**
+             * Returns the position the match begins.
+             * @return the position the match begins.
+             */
+            const PositionType& begin() const {
+                return node().begin();
+            }
+
+            /**
+             * Returns the position the match ends.
+             * @return the position the match ends.
+             */
+            const PositionType& end() const {
+                return node().end();
+            }
+
+            /**
+             * Returns the parsed content.
+             * @return the parsed content.
+             */
+            SourceType content() const {
+                return SourceType(begin().iterator(), end().iterator());
+            }
+
+            /**
+             * Returns a view of the parsed content, without copying it.
+             * Available only for contiguous sources; the view is a string view for character sources, a span otherwise.
+             * The view is valid as long as the source is.
+             * @return a view of the parsed content.
+             */
+            SourceViewType<SourceType> contentView() const {
+                return makeSourceView<SourceType>(begin().iterator(), end().iterator());
+            }
+
+            /**
+             * Checks if the match has a parent.
+             * @return true if the match is a child of another match, false if it is a root match.
+             */
+            bool hasParent() const {
+                return node().m_parentOffset != 0;
+            }
+
+            /**
+             * Returns the parent match.
+             * @return the parent match; valid only if hasParent() returns true.
+             */
+            Match parent() const {
+                return { *m_tree, m_index + node().m_parentOffset };
+            }
+
+            /**
+             * Returns the children matches.
+             * @return a range over the children matches.
+             */
+            auto children() const {
+                const size_t first = node().m_firstChildOffset ? m_index - node().m_firstChildOffset : npos;
+                return Range(*m_tree, first);
+            }
+
+            /**
+             * Checks if two matches refer to the same node of the same tree.
+             * @param other the other match.
+             * @return true if the matches are the same, false otherwise.
+             */
+            bool operator == (const Match& other) const {
+                return m_tree == other.m_tree && m_index == other.m_index;
+            }
+
+            /**
+             * Checks if two matches refer to different nodes.
+             * @param other the other match.
+             * @return true if the matches are different, false otherwise.
+             */
+            bool operator != (const Match& other) const {
+                return !operator == (other);
+            }
+
+        private:
+            const FlatMatchTree* m_tree;
+            size_t m_index;
+
+            const Node& node() const {
+                return m_tree->m_nodes[m_index];
+            }
+        };
+
+        /**
+         * Iterator over sibling matches.
+         */
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Match;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Match*;
+            using reference = Match;
+
+            /**
+             * Constructor.
+             * @param tree the tree.
+             * @param index index of the current node; npos for the end iterator.
+             */
+            Iterator(const FlatMatchTree& tree, size_t index) : m_tree(&tree), m_index(index) {
+            }
+
+            /**
+             * Returns the current match.
+             * @return the current match.
+             */
+            Match operator *() const {
+                return { *m_tree, m_index };
+            }
+
+            /**
+             * Moves to the next sibling.
+             * @return reference to this.
+             */
+            Iterator& operator ++() {
+                const size_t offset = m_tree->m_nodes[m_index].m_nextSiblingOffset;
+                m_index = offset ? m_index + offset : npos;
+                return *this;
+            }
+
+            /**
+             * Moves to the next sibling.
+             * @return the previous iterator.
+             */
+            Iterator operator ++(int) {
+                Iterator result = *this;
+                operator ++();
+                return result;
+            }
+
+            /**
+             * Checks if two iterators are equal.
+             * @param other the other iterator.
+             * @return true if equal, false otherwise.
+             */
+            bool operator == (const Iterator& other) const {
+                return m_index == other.m_index;
+            }
+
+            /**
+             * Checks if two iterators are different.
+             * @param other the other iterator.
+             * @return true if different, false otherwise.
+             */
+            bool operator != (const Iterator& other) const {
+                return m_index != other.m_index;
+            }
+
+        private:
+            const FlatMatchTree* m_tree;
+            size_t m_index;
+        };
+
+        /**
+         * A range of sibling matches.
+         */
+        class Range {
+        public:
+            /**
+             * Constructor.
+             * @param tree the tree.
+             * @param first index of the first node; npos for an empty range.
+             */
+            Range(const FlatMatchTree& tree, size_t first) : m_tree(&tree), m_first(first) {
+            }
+
+            /**
+             * Returns the iterator to the first match.
+             * @return the iterator to the first match.
+             */
+            Iterator begin() const {
+                return { *m_tree, m_first };
+            }
+
+            /**
+             * Returns the end iterator.
+             * @return the end iterator.
+             */
+            Iterator end() const {
+                return { *m_tree, npos };
+            }
+
+            /**
+             * Checks if the range is empty.
+             * @return true if empty, false otherwise.
+             */
+            bool empty() const {
+                return m_first == npos;
+            }
+
+            /**
+             * Returns the number of matches in the range; it is linear to the number of matches.
+             * @return the number of matches in the range.
+             */
+            size_t size() const {
+                return static_cast<size_t>(std::distance(begin(), end()));
+            }
+
+        private:
+            const FlatMatchTree* m_tree;
+            size_t m_first;
+        };
+
+        /**
+         * Value that represents an invalid index.
+         */
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        /**
+         * Returns the number of nodes.
+         * @return the number of nodes.
+         */
+        size_t size() const {
+            return m_nodes.size();
+        }
+
+        /**
+         * Returns the number of nodes the tree can hold without reallocating its memory.
+         * @return the capacity of the tree.
+         */
+        size_t capacity() const {
+            return m_nodes.capacity();
+        }
+
+        /**
+         * Reserves memory for the given number of nodes.
+         * @param count number of nodes.
+         */
+        void reserve(size_t count) {
+            m_nodes.reserve(count);
+        }
+
+        /**
+         * Checks if the tree is empty.
+         * @return true if empty, false otherwise.
+         */
+        bool empty() const {
+            return m_nodes.empty();
+        }
+
+        /**
+         * Returns the node at the given index.
+         * @param index index of node.
+         * @return the node at the given index.
+         */
+        const Node& operator [](size_t index) const {
+            return m_nodes[index];
+        }
+
+        /**
+         * Returns an iterator to the first node.
+         * @return an iterator to the first node.
+         */
+        const_iterator begin() const {
+            return m_nodes.begin();
+        }
+
+        /**
+         * Returns an iterator to the end of nodes.
+         * @return an iterator to the end of nodes.
+         */
+        const_iterator end() const {
+            return m_nodes.end();
+        }
+
+        /**
+         * Returns the match for the node at the given index.
+         * @param index index of node.
+         * @return the match for the node.
+         */
+        Match match(size_t index) const {
+            return { *this, index };
+        }
+
+        /**
+         * Returns the root matches, i.e. the matches without a parent.
+         * Finding the first root is linear to the number of roots.
+         * @return a range over the root matches.
+         */
+        Range roots() const {
+            size_t first = npos;
+            for (size_t index = m_nodes.size(); index > 0; index -= m_nodes[index - 1].m_subtreeSize) {
+                first = index - 1;
+            }
+            return { *this, first };
+        }
+
+        /**
+         * Adds a childless node.
+         * @param id match id.
+         * @param begin begin position into the source.
+         * @param end end position into the source.
+         */
+        void addMatch(const MatchIdType& id, const PositionType& begin, const PositionType& end) {
+            push_back(Node(id, begin, end));
+        }
+
+        /**
+         * Adds a node that becomes the parent of the last nodes of the array.
+         * The given node count must cover complete subtrees.
+         * @param id match id.
+         * @param begin begin position into the source.
+         * @param end end position into the source.
+         * @param nodeCount number of last nodes that form the subtrees of the children.
+         */
+        void addMatch(const MatchIdType& id, const PositionType& begin, const PositionType& end, size_t nodeCount) {
+            Node node(id, begin, end);
+            node.m_subtreeSize = nodeCount + 1;
+            m_nodes.push_back(std::move(node));
+            const size_t parent = m_nodes.size() - 1;
+
+            //link the children roots, from last to first
+            size_t nextChild = npos;
+            for (size_t child = parent; child > parent - nodeCount; child -= m_nodes[child - 1].m_subtreeSize) {
+                Node& childNode = m_nodes[child - 1];
+                childNode.m_parentOffset = parent - (child - 1);
+                childNode.m_nextSiblingOffset = nextChild != npos ? nextChild - (child - 1) : 0;
+                nextChild = child - 1;
+            }
+            if (nextChild != npos) {
+                m_nodes[parent].m_firstChildOffset = parent - nextChild;
+            }
+
+            linkRoot(parent);
+        }
+
+        /**
+         * Appends a node.
+         * The node shall either be a root node, or belong to a range of complete subtrees
+         * that is appended as a whole.
+         * @param node node to append.
+         */
+        void push_back(const Node& node) {
+            m_nodes.push_back(node);
+            if (!node.m_parentOffset) {
+                linkRoot(m_nodes.size() - 1);
+            }
+        }
+
+        /**
+         * Removes the nodes after the given count;
+         * the children of removed nodes that remain in the tree become root nodes.
+         * @param count number of nodes to keep; it cannot be greater than the current node count.
+         */
+        void resize(size_t count) {
+            m_nodes.erase(m_nodes.begin() + count, m_nodes.end());
+
+            //the roots chain might end in removed nodes; unlink the removed nodes
+            size_t next = npos;
+            for (size_t index = count; index > 0; index -= m_nodes[index - 1].m_subtreeSize) {
+                Node& node = m_nodes[index - 1];
+                const bool orphan = node.m_parentOffset != 0;
+                node.m_parentOffset = 0;
+                node.m_nextSiblingOffset = next != npos ? next - (index - 1) : 0;
+                next = index - 1;
+                if (!orphan) {
+                    break;
+                }
+            }
+        }
+
+        /**
+         * Removes all nodes.
+         */
+        void clear() {
+            m_nodes.clear();
+        }
+
+    private:
+        std::vector<Node> m_nodes;
+
+        //links the given root node to the previous root node
+        void linkRoot(size_t index) {
+            const size_t first = index + 1 - m_nodes[index].m_subtreeSize;
+            if (first > 0) {
+                m_nodes[first - 1].m_nextSiblingOffset = index - (first - 1);
+            }
+        }
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_FLATMATCHTREE_HPP
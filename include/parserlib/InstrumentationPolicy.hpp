@@ -0,0 +1,36 @@
+#ifndef PARSERLIB_INSTRUMENTATIONPOLICY_HPP
+#define PARSERLIB_INSTRUMENTATIONPOLICY_HPP
+
+
+namespace parserlib {
+
+
+    /**
+     * Instrumentation policy that does not instrument parsing; the default.
+     * All instrumentation hooks compile to nothing.
+     */
+    struct NoInstrumentation {
+        /**
+         * Parsing is not instrumented.
+         */
+        static constexpr bool enabled = false;
+    };
+
+
+    /**
+     * Instrumentation policy that profiles parsing.
+     * The parse context keeps a ParseProfile, with statistics per rule and per choice,
+     * and the call tree of rules, for flame graphs.
+     */
+    struct ProfileParsing {
+        /**
+         * Parsing is instrumented.
+         */
+        static constexpr bool enabled = true;
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_INSTRUMENTATIONPOLICY_HPP
@@ -0,0 +1,203 @@
+#ifndef PARSERLIB_KEYWORDTRIE_HPP
+#define PARSERLIB_KEYWORDTRIE_HPP
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include "CharacterScan.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * Selects the keyword recognized when several keywords are prefixes of the source.
+     */
+    enum class KeywordMatch {
+        /**
+         * The longest keyword is recognized.
+         */
+        Longest,
+
+        /**
+         * The keyword that comes first in the list is recognized, as with a choice of terminal strings.
+         */
+        First
+    };
+
+
+    /**
+     * A trie of keywords, which recognizes a keyword in one pass over the source.
+     * The nodes are stored in a vector; the edges of each node are stored contiguously, sorted by value,
+     * and they are searched linearly if they are few, otherwise with a binary search.
+     * A second trie, over the keywords folded to lowercase with the function `foldCharacter`, is used for case insensitive parsing.
+     * @param TerminalValueType value type of the keywords.
+     */
+    template <class TerminalValueType> class KeywordTrie {
+    public:
+        /**
+         * Keyword index that signifies that no keyword was recognized.
+         */
+        static constexpr size_t NoKeyword = SIZE_MAX;
+
+        /**
+         * Result of searching for a keyword.
+         */
+        struct Result {
+            /**
+             * Index of the recognized keyword, or NoKeyword.
+             */
+            size_t keyword;
+
+            /**
+             * Length of the recognized keyword.
+             */
+            size_t length;
+
+            /**
+             * Number of elements examined, from the beginning of the search;
+             * it includes the element, or the end of the source, that stopped the search.
+             */
+            size_t examinedCount;
+        };
+
+        /**
+         * Constructor.
+         * If some keywords are equal, then the first one of them is recognized.
+         * @param keywords keywords.
+         * @param mode selects the keyword recognized when several keywords are prefixes of the source.
+         */
+        KeywordTrie(const std::vector<std::basic_string<TerminalValueType>>& keywords, KeywordMatch mode)
+            : m_mode(mode)
+        {
+            std::vector<std::basic_string<TerminalValueType>> foldedKeywords(keywords);
+            for (auto& keyword : foldedKeywords) {
+                for (TerminalValueType& value : keyword) {
+                    value = foldCharacter(value);
+                }
+            }
+            m_tree = buildTree(keywords);
+            m_foldedTree = buildTree(foldedKeywords);
+        }
+
+        /**
+         * Searches for a keyword at the beginning of the given source.
+         * @param begin the beginning of the source.
+         * @param end the end of the source.
+         * @param caseInsensitive if true, then the source is folded to lowercase and searched in the trie of folded keywords.
+         * @return the result of the search.
+         */
+        template <class Iterator> Result find(const Iterator& begin, const Iterator& end, bool caseInsensitive) const {
+            return caseInsensitive ? find<true>(m_foldedTree, begin, end) : find<false>(m_tree, begin, end);
+        }
+
+    private:
+        struct Node {
+            std::uint32_t edgeBegin;
+            std::uint32_t edgeCount;
+            size_t keyword;
+        };
+
+        struct Tree {
+            std::vector<Node> nodes;
+            std::vector<TerminalValueType> edgeValues;
+            std::vector<std::uint32_t> edgeTargets;
+        };
+
+        //max number of edges searched linearly
+        static constexpr std::uint32_t LinearEdgeCount = 8;
+
+        KeywordMatch m_mode;
+        Tree m_tree;
+        Tree m_foldedTree;
+
+        //builds a tree out of the given keywords
+        static Tree buildTree(const std::vector<std::basic_string<TerminalValueType>>& keywords) {
+            std::vector<std::map<TerminalValueType, std::uint32_t>> children(1);
+            std::vector<size_t> nodeKeywords(1, NoKeyword);
+            for (size_t index = 0; index < keywords.size(); ++index) {
+                std::uint32_t node = 0;
+                for (const TerminalValueType& value : keywords[index]) {
+                    const auto it = children[node].find(value);
+                    if (it != children[node].end()) {
+                        node = it->second;
+                    }
+                    else {
+                        const std::uint32_t child = static_cast<std::uint32_t>(children.size());
+                        children[node].emplace(value, child);
+                        children.emplace_back();
+                        nodeKeywords.push_back(NoKeyword);
+                        node = child;
+                    }
+                }
+                if (nodeKeywords[node] == NoKeyword) {
+                    nodeKeywords[node] = index;
+                }
+            }
+
+            Tree tree;
+            tree.nodes.reserve(children.size());
+            for (size_t node = 0; node < children.size(); ++node) {
+                tree.nodes.push_back(Node{ static_cast<std::uint32_t>(tree.edgeValues.size()), static_cast<std::uint32_t>(children[node].size()), nodeKeywords[node] });
+                for (const auto& [value, child] : children[node]) {
+                    tree.edgeValues.push_back(value);
+                    tree.edgeTargets.push_back(child);
+                }
+            }
+            return tree;
+        }
+
+        //returns the child of the given node for the given value, or 0 if there is none
+        template <class T> static std::uint32_t child(const Tree& tree, const Node& node, const T& value) {
+            const TerminalValueType* begin = tree.edgeValues.data() + node.edgeBegin;
+            const TerminalValueType* end = begin + node.edgeCount;
+            if (node.edgeCount <= LinearEdgeCount) {
+                for (const TerminalValueType* it = begin; it != end; ++it) {
+                    if (*it == value) {
+                        return tree.edgeTargets[it - tree.edgeValues.data()];
+                    }
+                }
+                return 0;
+            }
+            const TerminalValueType* it = std::lower_bound(begin, end, value, [](const TerminalValueType& a, const T& b) { return a < b; });
+            return it != end && *it == value ? tree.edgeTargets[it - tree.edgeValues.data()] : 0;
+        }
+
+        //walks the tree, recording the keywords found on the way
+        template <bool Fold, class Iterator> Result find(const Tree& tree, const Iterator& begin, const Iterator& end) const {
+            Result result{ NoKeyword, 0, 0 };
+            const Node* node = &tree.nodes[0];
+            size_t depth = 0;
+            for (auto it = begin;; ++it) {
+                if (node->keyword != NoKeyword && (m_mode == KeywordMatch::Longest || node->keyword < result.keyword)) {
+                    result.keyword = node->keyword;
+                    result.length = depth;
+                }
+                if (node->edgeCount == 0) {
+                    result.examinedCount = depth;
+                    break;
+                }
+                if (it == end) {
+                    result.examinedCount = depth + 1;
+                    break;
+                }
+                const std::uint32_t next = Fold ? child(tree, *node, foldCharacter(*it)) : child(tree, *node, *it);
+                if (!next) {
+                    result.examinedCount = depth + 1;
+                    break;
+                }
+                node = &tree.nodes[next];
+                ++depth;
+            }
+            return result;
+        }
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_KEYWORDTRIE_HPP
@@ -0,0 +1,159 @@
+#ifndef PARSERLIB_KEYWORDSPARSER_HPP
+#define PARSERLIB_KEYWORDSPARSER_HPP
+
+
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <initializer_list>
+#include <type_traits>
+#include "ParserNode.hpp"
+#include "KeywordTrie.hpp"
+#include "util.hpp"
+#include "Error.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * A parser that parses one keyword out of a list of keywords.
+     * The keywords are stored in a trie, and therefore the keyword is recognized in one pass over the source,
+     * instead of trying each keyword in turn, as a choice of terminal strings would do.
+     * If match ids are given, then the recognized keyword is added to the parse context as a match with the id of the keyword.
+     * @param TerminalValueType value type of the keywords.
+     * @param MatchIdType type of match id; if void, then no matches are added.
+     */
+    template <class TerminalValueType, class MatchIdType = void> class KeywordsParser
+        : public ParserNode<KeywordsParser<TerminalValueType, MatchIdType>> {
+    public:
+        /**
+         * Constructor.
+         * @param keywords keywords.
+         * @param mode selects the keyword recognized when several keywords are prefixes of the source.
+         */
+        KeywordsParser(const std::vector<std::basic_string<TerminalValueType>>& keywords, KeywordMatch mode = KeywordMatch::Longest)
+            : m_keywords(keywords)
+            , m_trie(keywords, mode)
+        {
+        }
+
+        /**
+         * Constructor.
+         * @param keywords keywords.
+         * @param matchIds match ids; one for each keyword.
+         * @param mode selects the keyword recognized when several keywords are prefixes of the source.
+         * @exception std::invalid_argument thrown if the number of match ids is not the number of keywords.
+         */
+        template <class T = MatchIdType, class = std::enable_if_t<!std::is_void_v<T>>>
+        KeywordsParser(const std::vector<std::basic_string<TerminalValueType>>& keywords, const std::vector<T>& matchIds, KeywordMatch mode = KeywordMatch::Longest)
+            : m_keywords(keywords)
+            , m_trie(keywords, mode)
+            , m_matchIds(matchIds)
+        {
+            if (matchIds.size() != keywords.size()) {
+                throw std::invalid_argument("There shall be one match id for each keyword.");
+            }
+        }
+
+        /**
+         * Returns the keywords.
+         * @return the keywords.
+         */
+        const std::vector<std::basic_string<TerminalValueType>>& keywords() const {
+            return m_keywords;
+        }
+
+        /**
+         * Parses a keyword.
+         * @param pc parse context.
+         * @return true if parsing succeeds, false otherwise.
+         */
+        template <class ParseContextType> bool operator ()(ParseContextType& pc) const {
+            const auto result = pc.sourcePositionKeyword(m_trie);
+            if (result.keyword != KeywordTrie<TerminalValueType>::NoKeyword) {
+                if constexpr (std::is_void_v<MatchIdType>) {
+                    pc.increaseSourcePosition(result.length);
+                }
+                else {
+                    const auto begin = pc.sourcePosition();
+                    pc.increaseSourcePosition(result.length);
+                    pc.addMatch(m_matchIds[result.keyword], begin, pc.sourcePosition());
+                }
+                return true;
+            }
+            if (!pc.sourceEnded()) {
+                pc.addError(pc.sourcePosition(), [&]() {
+                    return makeError(ErrorType::SyntaxError, pc.sourcePosition(), m_errorDescription.get([&]() { return toString("Syntax error: expected one of: ", m_keywords); }), pc.sourceEnd(), 1);
+                    });
+            }
+            return false;
+        }
+
+        /**
+         * Does nothing; a terminal should not parse when a rule is expected to parse,
+         * in order to continue after the non-left recursive part is parsed.
+         * @param pc parse context.
+         * @param lrc left recursion context.
+         * @return always false.
+         */
+        template <class ParseContextType> bool parseLeftRecursionContinuation(ParseContextType& pc, LeftRecursionContext<ParseContextType>& lrc) const {
+            return false;
+        }
+
+    private:
+        //empty type used in place of the match ids if there are no match ids
+        struct NoMatchIds {
+        };
+
+        std::vector<std::basic_string<TerminalValueType>> m_keywords;
+        KeywordTrie<TerminalValueType> m_trie;
+        std::conditional_t<std::is_void_v<MatchIdType>, NoMatchIds, std::vector<std::conditional_t<std::is_void_v<MatchIdType>, int, MatchIdType>>> m_matchIds;
+        ErrorDescription m_errorDescription;
+    };
+
+
+    /**
+     * Creates a keywords parser.
+     * @param keywords null-terminated keywords.
+     * @param mode selects the keyword recognized when several keywords are prefixes of the source.
+     * @return a keywords parser.
+     */
+    template <class TerminalValueType>
+    KeywordsParser<TerminalValueType> keywords(std::initializer_list<const TerminalValueType*> keywords, KeywordMatch mode = KeywordMatch::Longest) {
+        return { std::vector<std::basic_string<TerminalValueType>>(keywords.begin(), keywords.end()), mode };
+    }
+
+
+    /**
+     * Creates a keywords parser that adds the recognized keyword as a match.
+     * @param keywords null-terminated keywords.
+     * @param matchIds match ids; one for each keyword.
+     * @param mode selects the keyword recognized when several keywords are prefixes of the source.
+     * @return a keywords parser.
+     * @exception std::invalid_argument thrown if the number of match ids is not the number of keywords.
+     */
+    template <class TerminalValueType, class MatchIdType>
+    KeywordsParser<TerminalValueType, MatchIdType> keywords(std::initializer_list<const TerminalValueType*> keywords, std::initializer_list<MatchIdType> matchIds, KeywordMatch mode = KeywordMatch::Longest) {
+        return { std::vector<std::basic_string<TerminalValueType>>(keywords.begin(), keywords.end()), std::vector<MatchIdType>(matchIds), mode };
+    }
+
+
+    /**
+     * Creates a keywords parser that adds the recognized keyword as a match with a character string match id.
+     * @param keywords null-terminated keywords.
+     * @param matchIds match ids; one for each keyword.
+     * @param mode selects the keyword recognized when several keywords are prefixes of the source.
+     * @return a keywords parser.
+     * @exception std::invalid_argument thrown if the number of match ids is not the number of keywords.
+     */
+    template <class TerminalValueType, class CharType>
+    KeywordsParser<TerminalValueType, std::basic_string<CharType>> keywords(std::initializer_list<const TerminalValueType*> keywords, std::initializer_list<const CharType*> matchIds, KeywordMatch mode = KeywordMatch::Longest) {
+        return { std::vector<std::basic_string<TerminalValueType>>(keywords.begin(), keywords.end()), std::vector<std::basic_string<CharType>>(matchIds.begin(), matchIds.end()), mode };
+    }
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_KEYWORDSPARSER_HPP
@@ -2,6 +2,9 @@
 #define PARSERLIB_LEFTRECURSIONCONTEXT_HPP
 
 
+#include <cstddef>
+
+
 namespace parserlib {
 
 
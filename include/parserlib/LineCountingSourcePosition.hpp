@@ -2,6 +2,9 @@
 #define PARSERLIB_LINECOUNTINGSOURCEPOSITION_HPP
 
 
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
 #include "SourcePosition.hpp"
 
 
@@ -60,6 +63,20 @@ namespace parserlib {
         {
         }
 
+        /**
+         * Constructor from position and end.
+         * The new position has the state of the given position, including line and column, but a different end;
+         * it allows parsing a part of a source.
+         * @param pos position to copy the state of.
+         * @param end iterator to the end of the part of the source.
+         */
+        LineCountingSourcePosition(const LineCountingSourcePosition& pos, const typename SourceType::const_iterator& end)
+            : SourcePosition<SourceType, CaseSensitive>(pos, end)
+            , m_line(pos.m_line)
+            , m_column(pos.m_column)
+        {
+        }
+
         /**
          * Increments the position by one place.
          * It also increments column/line, depending on if current sequence represents a newline.
@@ -77,12 +94,48 @@ namespace parserlib {
 
         /**
          * Increases the position by multiple places.
-         * It also increases the column value by the given amount.
+         * It also increases column/line, depending on the newlines found within the given places.
          * @param count number of places to increase the position by.
          */
         void increase(size_t count) {
-            m_column += count;
-            SourcePosition<SourceType, CaseSensitive>::increase(count);
+            if constexpr (std::is_same_v<NewlineTraits, DefaultNewlineTraits> && std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<typename SourceType::const_iterator>::iterator_category>) {
+                auto it = SourcePosition<SourceType, CaseSensitive>::iterator();
+                const auto last = it + count;
+                for (;;) {
+                    const auto newline = std::find(it, last, '\n');
+                    if (newline == last) {
+                        break;
+                    }
+                    ++m_line;
+                    m_column = 1;
+                    it = newline + 1;
+                }
+                m_column += static_cast<size_t>(last - it);
+                SourcePosition<SourceType, CaseSensitive>::increase(count);
+            }
+            else {
+                for (; count > 0; --count) {
+                    increment();
+                }
+            }
+        }
+
+        /**
+         * Moves the position from one source to another, keeping its place relative to an anchor position:
+         * the position, which is at or after the old anchor, is placed after the new anchor at the same distance.
+         * The elements between the old anchor and the position shall be the same in both sources;
+         * therefore, the line and column are shifted by the difference of the anchors,
+         * the column only if the position is on the line of the anchor.
+         * Available only for random access sources.
+         * @param oldAnchor position in the source of this position.
+         * @param newAnchor the corresponding position in the other source.
+         */
+        void rebase(const LineCountingSourcePosition& oldAnchor, const LineCountingSourcePosition& newAnchor) {
+            SourcePosition<SourceType, CaseSensitive>::rebase(oldAnchor, newAnchor);
+            if (m_line == oldAnchor.m_line) {
+                m_column = newAnchor.m_column + (m_column - oldAnchor.m_column);
+            }
+            m_line = newAnchor.m_line + (m_line - oldAnchor.m_line);
         }
 
         /**
@@ -0,0 +1,155 @@
+#ifndef PARSERLIB_LINEINDEX_HPP
+#define PARSERLIB_LINEINDEX_HPP
+
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <iterator>
+#include <algorithm>
+#include "SourceView.hpp"
+#include "CharacterScan.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * An index of the lines of a source, which computes the line and column of source positions on demand.
+     *
+     * It allows parsing with a plain SourcePosition, which does not count lines while parsing,
+     * and computing lines and columns only for the positions that are reported, such as the positions of errors and matches.
+     * Lines and columns are the ones of a LineCountingSourcePosition with the default newline traits:
+     * lines are separated by '\n', and both lines and columns start from 1.
+     *
+     * The index, i.e. the offsets of the newlines of the source, is built on the first query;
+     * it is built with simd instructions if the source is contiguous and its elements are byte-sized.
+     * Queries then take logarithmic time, with a binary search of the index.
+     * Queries are thread-safe.
+     *
+     * @param SourceType source type.
+     */
+    template <class SourceType = std::string> class LineIndex {
+    public:
+        /**
+         * Iterator type.
+         */
+        using IteratorType = typename SourceType::const_iterator;
+
+        /**
+         * Line and column of a position.
+         */
+        struct Location {
+            /**
+             * The line, starting from 1.
+             */
+            size_t line;
+
+            /**
+             * The column, starting from 1.
+             */
+            size_t column;
+        };
+
+        /**
+         * Constructor.
+         * @param source the source; it must outlive the index.
+         */
+        LineIndex(const SourceType& source)
+            : m_begin(source.begin()), m_end(source.end())
+        {
+        }
+
+        /**
+         * Constructor from iterators.
+         * @param begin the beginning of the source.
+         * @param end the end of the source.
+         */
+        LineIndex(const IteratorType& begin, const IteratorType& end)
+            : m_begin(begin), m_end(end)
+        {
+        }
+
+        /**
+         * Returns the number of lines; a source without newlines has one line.
+         * @return the number of lines.
+         */
+        size_t lineCount() const {
+            return newlineOffsets().size() + 1;
+        }
+
+        /**
+         * Returns the line and column of the given position.
+         * @param it iterator to the source.
+         * @return the line and column of the given position.
+         */
+        Location location(const IteratorType& it) const {
+            const std::vector<size_t>& offsets = newlineOffsets();
+            const size_t offset = static_cast<size_t>(std::distance(m_begin, it));
+
+            //the newlines before the position
+            const size_t newlineCount = static_cast<size_t>(std::lower_bound(offsets.begin(), offsets.end(), offset) - offsets.begin());
+            const size_t lineBegin = newlineCount > 0 ? offsets[newlineCount - 1] + 1 : 0;
+            return { newlineCount + 1, offset - lineBegin + 1 };
+        }
+
+        /**
+         * Returns the line and column of the given source position.
+         * @param position source position.
+         * @return the line and column of the given source position.
+         */
+        template <class PositionType> auto location(const PositionType& position) const -> decltype(position.iterator(), Location()) {
+            return location(position.iterator());
+        }
+
+        /**
+         * Returns the line of the given position.
+         * @param position iterator or source position.
+         * @return the line of the given position.
+         */
+        template <class T> size_t line(const T& position) const {
+            return location(position).line;
+        }
+
+        /**
+         * Returns the column of the given position.
+         * @param position iterator or source position.
+         * @return the column of the given position.
+         */
+        template <class T> size_t column(const T& position) const {
+            return location(position).column;
+        }
+
+    private:
+        IteratorType m_begin;
+        IteratorType m_end;
+        mutable std::once_flag m_built;
+        mutable std::vector<size_t> m_newlineOffsets;
+
+        //returns the offsets of the newlines, building them on the first call
+        const std::vector<size_t>& newlineOffsets() const {
+            std::call_once(m_built, [&]() {
+                if constexpr (IsContiguousSource<SourceType>::value && sizeof(typename SourceType::value_type) == 1) {
+                    if (m_begin != m_end) {
+                        const unsigned char* begin = reinterpret_cast<const unsigned char*>(&*m_begin);
+                        findCharacters(begin, begin + (m_end - m_begin), static_cast<unsigned char>('\n'), m_newlineOffsets);
+                    }
+                }
+                else {
+                    size_t offset = 0;
+                    for (auto it = m_begin; it != m_end; ++it, ++offset) {
+                        if (*it == '\n') {
+                            m_newlineOffsets.push_back(offset);
+                        }
+                    }
+                }
+            });
+            return m_newlineOffsets;
+        }
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_LINEINDEX_HPP
@@ -2,7 +2,9 @@
 #define PARSERLIB_LOOP0PARSER_HPP
 
 
+#include <utility>
 #include "ParserNode.hpp"
+#include "CharacterPredicate.hpp"
 
 
 namespace parserlib {
@@ -10,6 +12,7 @@ namespace parserlib {
 
     /**
      * A parser that invokes another parser in a loop.
+     * If the child parser is a character predicate, then the loop scans the source in bulk.
      * @param ParserNodeType the parser to invoke in a loop.
      */
     template <class ParserNodeType> class Loop0Parser : public ParserNode<Loop0Parser<ParserNodeType>> {
@@ -18,7 +21,7 @@ namespace parserlib {
          * The default constructor.
          * @param child child parser to invoke in a loop.
          */
-        Loop0Parser(const ParserNodeType& child) : m_child(child) {
+        Loop0Parser(const ParserNodeType& child) : m_child(child), m_characterSet(makeCharacterSet(child)) {
         }
 
         /**
@@ -35,6 +38,8 @@ namespace parserlib {
          * @return always true.
          */
         template <class ParseContextType> bool operator ()(ParseContextType& pc) const {
+            //skip the elements the child would parse; then the child is invoked at the stop position as usual
+            skipCharacters(pc, m_characterSet);
             return parse(pc, [&]() { return m_child(pc); });
         }
 
@@ -52,6 +57,7 @@ namespace parserlib {
 
     private:
         const ParserNodeType m_child;
+        const decltype(makeCharacterSet(std::declval<const ParserNodeType&>())) m_characterSet;
 
         template <class ParseContextType, class PF> bool parse(ParseContextType& pc, const PF& pf) const {
             const auto errorState = pc.errorState();
@@ -59,9 +65,16 @@ namespace parserlib {
             //parse once with the given function
             {
                 const auto startPosition = pc.sourcePosition();
-
-                //if no more parsing possible, stop
-                if (!pf()) {
+                const size_t cutCount = pc.cutCount();
+                pc.incrementBacktrackDepth();
+                const bool result = pf();
+                pc.decrementBacktrackDepth();
+
+                //if no more parsing possible, stop; but fail if the failed iteration was cut
+                if (!result) {
+                    if (pc.cutCount() != cutCount) {
+                        return false;
+                    }
                     pc.setErrorState(errorState);
                     return true;
                 }
@@ -76,9 +89,16 @@ namespace parserlib {
             //since parsing suceeded, parse with normal function from now on
             while (true) {
                 const auto startPosition = pc.sourcePosition();
-
-                //if no more parsing possible, stop
-                if (!m_child(pc)) {
+                const size_t cutCount = pc.cutCount();
+                pc.incrementBacktrackDepth();
+                const bool result = m_child(pc);
+                pc.decrementBacktrackDepth();
+
+                //if no more parsing possible, stop; but fail if the failed iteration was cut
+                if (!result) {
+                    if (pc.cutCount() != cutCount) {
+                        return false;
+                    }
                     break;
                 }
 
@@ -2,7 +2,9 @@
 #define PARSERLIB_LOOP1PARSER_HPP
 
 
+#include <utility>
 #include "ParserNode.hpp"
+#include "CharacterPredicate.hpp"
 
 
 namespace parserlib {
@@ -10,6 +12,7 @@ namespace parserlib {
 
     /**
      * A parser that invokes another parser in a loop; the loop must suceed at least once.
+     * If the child parser is a character predicate, then the loop scans the source in bulk.
      * @param ParserNodeType the parser to invoke in a loop.
      */
     template <class ParserNodeType> class Loop1Parser : public ParserNode<Loop1Parser<ParserNodeType>> {
@@ -18,7 +21,7 @@ namespace parserlib {
          * The default constructor.
          * @param child child parser to invoke in a loop.
          */
-        Loop1Parser(const ParserNodeType& child) : m_child(child) {
+        Loop1Parser(const ParserNodeType& child) : m_child(child), m_characterSet(makeCharacterSet(child)) {
         }
 
         /**
@@ -36,6 +39,10 @@ namespace parserlib {
          * @return true if the 1st parsing succeeded, false otherwise.
          */
         template <class ParseContextType> bool operator ()(ParseContextType& pc) const {
+            //skip the elements the child would parse; then the child is invoked at the stop position as usual
+            if (skipCharacters(pc, m_characterSet) > 0) {
+                return parseLoop(pc);
+            }
             return parse(pc, [&]() { return m_child(pc); });
         }
 
@@ -54,6 +61,7 @@ namespace parserlib {
 
     private:
         ParserNodeType m_child;
+        decltype(makeCharacterSet(std::declval<const ParserNodeType&>())) m_characterSet;
 
         template <class ParseContextType, class PF> bool parse(ParseContextType& pc, const PF& pf) const {
             //parse the child once to define the result
@@ -70,14 +78,25 @@ namespace parserlib {
                 }
             }
 
+            return parseLoop(pc);
+        }
+
+        template <class ParseContextType> bool parseLoop(ParseContextType& pc) const {
             const auto errorState = pc.errorState();
 
             //parse loop; normal function, since advance was made
             while (true) {
                 const auto startPosition = pc.sourcePosition();
-
-                //if no more parsing possible, stop
-                if (!m_child(pc)) {                    
+                const size_t cutCount = pc.cutCount();
+                pc.incrementBacktrackDepth();
+                const bool result = m_child(pc);
+                pc.decrementBacktrackDepth();
+
+                //if no more parsing possible, stop; but fail if the failed iteration was cut
+                if (!result) {
+                    if (pc.cutCount() != cutCount) {
+                        return false;
+                    }
                     break;
                 }
 
@@ -0,0 +1,258 @@
+#ifndef PARSERLIB_MAPPEDFILESOURCE_HPP
+#define PARSERLIB_MAPPEDFILESOURCE_HPP
+
+
+#include <cstddef>
+#include <string>
+#include <stdexcept>
+#include <utility>
+
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+namespace parserlib {
+
+
+    /**
+     * A read-only source that maps a file into memory.
+     *
+     * The file is not copied; its pages are loaded on demand by the operating system,
+     * and shared with other processes that map the same file.
+     * The source is contiguous, so as that matches over it can provide views via `contentView()`,
+     * and bulk character scanning is used.
+     *
+     * The source must outlive the parse context and any views created from it.
+     */
+    class MappedFileSource {
+    public:
+        /**
+         * Element type.
+         */
+        using value_type = char;
+
+        /**
+         * Iterator type.
+         */
+        using iterator = const char*;
+
+        /**
+         * Const iterator type.
+         */
+        using const_iterator = const char*;
+
+        /**
+         * The default constructor; creates an empty source.
+         */
+        MappedFileSource() {
+        }
+
+        /**
+         * Constructor; maps the given file.
+         * @param filename name of the file.
+         * @exception std::runtime_error thrown if the file cannot be opened or mapped.
+         */
+        MappedFileSource(const char* filename) {
+            open(filename);
+        }
+
+        /**
+         * The move constructor.
+         * @param src source to move; it becomes empty.
+         */
+        MappedFileSource(MappedFileSource&& src) noexcept {
+            swap(src);
+        }
+
+        /**
+         * Sources cannot be copied.
+         */
+        MappedFileSource(const MappedFileSource&) = delete;
+
+        /**
+         * The destructor; unmaps the file.
+         */
+        ~MappedFileSource() {
+            close();
+        }
+
+        /**
+         * The move assignment operator.
+         * @param src source to move; it becomes empty.
+         * @return reference to this.
+         */
+        MappedFileSource& operator = (MappedFileSource&& src) noexcept {
+            MappedFileSource temp(std::move(src));
+            swap(temp);
+            return *this;
+        }
+
+        /**
+         * Sources cannot be copied.
+         */
+        MappedFileSource& operator = (const MappedFileSource&) = delete;
+
+        /**
+         * Returns the pointer to the first character.
+         * @return the pointer to the first character.
+         */
+        const char* data() const {
+            return m_data;
+        }
+
+        /**
+         * Returns the number of characters.
+         * @return the number of characters.
+         */
+        size_t size() const {
+            return m_size;
+        }
+
+        /**
+         * Checks if the source is empty.
+         * @return true if the source is empty, false otherwise.
+         */
+        bool empty() const {
+            return m_size == 0;
+        }
+
+        /**
+         * Returns the beginning of the source.
+         * @return the beginning of the source.
+         */
+        const_iterator begin() const {
+            return m_data;
+        }
+
+        /**
+         * Returns the end of the source.
+         * @return the end of the source.
+         */
+        const_iterator end() const {
+            return m_data + m_size;
+        }
+
+        /**
+         * Returns a character.
+         * @param index index of character.
+         * @return the character at the given index.
+         */
+        const char& operator [](size_t index) const {
+            return m_data[index];
+        }
+
+        /**
+         * Swaps this source with the given one.
+         * @param src source to swap with this.
+         */
+        void swap(MappedFileSource& src) noexcept {
+            std::swap(m_data, src.m_data);
+            std::swap(m_size, src.m_size);
+#ifdef _WIN32
+            std::swap(m_file, src.m_file);
+            std::swap(m_mapping, src.m_mapping);
+#endif
+        }
+
+    private:
+        const char* m_data{ nullptr };
+        size_t m_size{ 0 };
+#ifdef _WIN32
+        HANDLE m_file{ INVALID_HANDLE_VALUE };
+        HANDLE m_mapping{ nullptr };
+#endif
+
+        //maps the file; empty files are not mapped
+        void open(const char* filename) {
+#ifdef _WIN32
+            m_file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (m_file == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error(std::string("MappedFileSource: cannot open file: ") + filename);
+            }
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(m_file, &size)) {
+                close();
+                throw std::runtime_error(std::string("MappedFileSource: cannot get the size of file: ") + filename);
+            }
+            if (size.QuadPart == 0) {
+                return;
+            }
+            m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!m_mapping) {
+                close();
+                throw std::runtime_error(std::string("MappedFileSource: cannot map file: ") + filename);
+            }
+            m_data = static_cast<const char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+            if (!m_data) {
+                close();
+                throw std::runtime_error(std::string("MappedFileSource: cannot map file: ") + filename);
+            }
+            m_size = static_cast<size_t>(size.QuadPart);
+#else
+            const int fd = ::open(filename, O_RDONLY);
+            if (fd == -1) {
+                throw std::runtime_error(std::string("MappedFileSource: cannot open file: ") + filename);
+            }
+            struct stat status;
+            if (::fstat(fd, &status) == -1) {
+                ::close(fd);
+                throw std::runtime_error(std::string("MappedFileSource: cannot get the size of file: ") + filename);
+            }
+            if (status.st_size == 0) {
+                ::close(fd);
+                return;
+            }
+            void* data = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            //the mapping remains valid after the file is closed
+            ::close(fd);
+            if (data == MAP_FAILED) {
+                throw std::runtime_error(std::string("MappedFileSource: cannot map file: ") + filename);
+            }
+            ::madvise(data, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+            m_data = static_cast<const char*>(data);
+            m_size = static_cast<size_t>(status.st_size);
+#endif
+        }
+
+        //unmaps the file
+        void close() noexcept {
+#ifdef _WIN32
+            if (m_data) {
+                UnmapViewOfFile(m_data);
+            }
+            if (m_mapping) {
+                CloseHandle(m_mapping);
+            }
+            if (m_file != INVALID_HANDLE_VALUE) {
+                CloseHandle(m_file);
+            }
+            m_mapping = nullptr;
+            m_file = INVALID_HANDLE_VALUE;
+#else
+            if (m_data) {
+                ::munmap(const_cast<char*>(m_data), m_size);
+            }
+#endif
+            m_data = nullptr;
+            m_size = 0;
+        }
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_MAPPEDFILESOURCE_HPP
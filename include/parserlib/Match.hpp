@@ -2,17 +2,30 @@
 #define PARSERLIB_MATCH_HPP
 
 
+#include <vector>
+#include <memory>
+#include "SourceView.hpp"
+
+
 namespace parserlib {
 
 
     /**
      * Result of a successful parsing attempt.
+     * Matches are movable, so as that children can be transferred to a parent match without copying their subtrees.
+     * A match destroys its subtree recursively; deeply nested match trees shall be stored in a `FlatMatchTree` instead.
      * @param SourceType container with source data.
      * @param MatchIdType id to apply to a match.
      * @param PositionType type of source position.
+     * @param Allocator allocator of the children matches, rebound to the match type.
      */
-    template <class SourceType, class MatchIdType, class PositionType> class Match {
+    template <class SourceType, class MatchIdType, class PositionType, class Allocator = std::allocator<char>> class Match {
     public:
+        /**
+         * Container type of the children matches.
+         */
+        using ChildContainerType = std::vector<Match, typename std::allocator_traits<Allocator>::template rebind_alloc<Match>>;
+
         /**
          * The default constructor.
          * No member is initialized.
@@ -30,7 +43,7 @@ namespace parserlib {
         Match(const MatchIdType& id,
             const PositionType& begin,
             const PositionType& end,
-            std::vector<Match>&& children = std::vector<Match>())
+            ChildContainerType&& children = ChildContainerType())
             : m_id(id), m_begin(begin), m_end(end), m_children(std::move(children))
         {
         }
@@ -67,19 +80,48 @@ namespace parserlib {
             return SourceType(m_begin.iterator(), m_end.iterator());
         }
 
+        /**
+         * Returns a view of the parsed content, without copying it.
+         * Available only for contiguous sources; the view is a string view for character sources, a span otherwise.
+         * The view is valid as long as the source is.
+         * @return a view of the parsed content.
+         */
+        SourceViewType<SourceType> contentView() const {
+            return makeSourceView<SourceType>(m_begin.iterator(), m_end.iterator());
+        }
+
         /**
          * Returns the children matches.
          * @return the children matches.
          */
-        const std::vector<Match>& children() const {
+        const ChildContainerType& children() const {
             return m_children;
         }
 
+        /**
+         * Replaces the positions of the match and of its children with the positions returned by the given function;
+         * it allows rebasing matches into another source.
+         * @param func function that receives a position and returns the position to replace it with.
+         */
+        template <class F> void mapPositions(const F& func) {
+            //explicit stack, so that the depth of the tree is not limited by the native stack
+            std::vector<Match*> stack{ this };
+            while (!stack.empty()) {
+                Match* const match = stack.back();
+                stack.pop_back();
+                match->m_begin = func(match->m_begin);
+                match->m_end = func(match->m_end);
+                for (Match& child : match->m_children) {
+                    stack.push_back(&child);
+                }
+            }
+        }
+
     private:
-        const MatchIdType m_id{};
-        const PositionType m_begin;
-        const PositionType m_end;
-        const std::vector<Match> m_children;
+        MatchIdType m_id{};
+        PositionType m_begin;
+        PositionType m_end;
+        ChildContainerType m_children;
     };
 
 
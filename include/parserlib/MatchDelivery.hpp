@@ -0,0 +1,58 @@
+#ifndef PARSERLIB_MATCHDELIVERY_HPP
+#define PARSERLIB_MATCHDELIVERY_HPP
+
+
+#include <vector>
+#include "FlatMatchTree.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * What a parse context does with the matches it delivers to its match handler.
+     */
+    enum class MatchDelivery {
+        /**
+         * Delivered matches are removed from the parse context; memory is bounded by the matches that are not final yet.
+         */
+        DropMatches,
+
+        /**
+         * Delivered matches are kept in the parse context, as if there was no match handler.
+         */
+        KeepMatches
+    };
+
+
+    /**
+     * Trait that defines the type of match delivered to a match handler, for a match container.
+     * For vectors of matches, it is the match type.
+     * @param MatchContainerType match container type.
+     */
+    template <class MatchContainerType> struct DeliveredMatch {
+        /**
+         * The type of delivered match.
+         */
+        using Type = typename MatchContainerType::value_type;
+    };
+
+
+    /**
+     * Delivered match trait for flat match trees; root matches are delivered as match views.
+     * @param SourceType source type.
+     * @param MatchIdType match id type.
+     * @param PositionType position type.
+     */
+    template <class SourceType, class MatchIdType, class PositionType> struct DeliveredMatch<FlatMatchTree<SourceType, MatchIdType, PositionType>> {
+        /**
+         * The type of delivered match.
+         */
+        using Type = typename FlatMatchTree<SourceType, MatchIdType, PositionType>::Match;
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_MATCHDELIVERY_HPP
@@ -0,0 +1,303 @@
+#ifndef PARSERLIB_MATCHID_HPP
+#define PARSERLIB_MATCHID_HPP
+
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <ostream>
+#include <functional>
+
+
+namespace parserlib {
+
+
+    /**
+     * Table of interned match id names.
+     * Names are interned once, usually when the grammar is built, and never removed; each name gets a dense index, starting from 0 for the empty name.
+     * Interning is thread-safe; the names of interned ids can be read without locking.
+     * @param CharType character type of names.
+     */
+    template <class CharType> class BasicMatchIdTable {
+    public:
+        /**
+         * String type of names.
+         */
+        using StringType = std::basic_string<CharType>;
+
+        /**
+         * String view type of names.
+         */
+        using StringViewType = std::basic_string_view<CharType>;
+
+        /**
+         * An interned name.
+         */
+        struct Symbol {
+            /**
+             * Index of the name into the table.
+             */
+            std::uint32_t index;
+
+            /**
+             * The name.
+             */
+            StringType name;
+        };
+
+        /**
+         * Returns the table of the process.
+         * @return the table of the process.
+         */
+        static BasicMatchIdTable& instance() {
+            static BasicMatchIdTable table;
+            return table;
+        }
+
+        /**
+         * Interns a name.
+         * @param name name to intern.
+         * @return the symbol of the name; it remains valid for the duration of the process.
+         */
+        const Symbol* intern(const StringViewType& name) {
+            std::lock_guard lock(m_mutex);
+            return internUnlocked(name);
+        }
+
+        /**
+         * Returns the symbol at the given index.
+         * @param index index of symbol; it must be lower than the size of the table.
+         * @return the symbol at the given index.
+         */
+        const Symbol* symbol(std::uint32_t index) const {
+            std::lock_guard lock(m_mutex);
+            return &m_symbols[index];
+        }
+
+        /**
+         * Returns the symbol of the empty name, without locking.
+         * @return the symbol of the empty name.
+         */
+        const Symbol* emptySymbol() const {
+            return m_emptySymbol;
+        }
+
+        /**
+         * Returns the number of interned names.
+         * @return the number of interned names.
+         */
+        size_t size() const {
+            std::lock_guard lock(m_mutex);
+            return m_symbols.size();
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        std::deque<Symbol> m_symbols;
+        std::unordered_map<StringViewType, const Symbol*> m_index;
+        const Symbol* m_emptySymbol;
+
+        //the empty name is interned first, so as that default ids have index 0
+        BasicMatchIdTable() {
+            m_emptySymbol = internUnlocked(StringViewType());
+        }
+
+        //symbols are not moved when the deque grows, so their names can be keys of the index
+        const Symbol* internUnlocked(const StringViewType& name) {
+            const auto it = m_index.find(name);
+            if (it != m_index.end()) {
+                return it->second;
+            }
+            m_symbols.push_back(Symbol{ static_cast<std::uint32_t>(m_symbols.size()), StringType(name) });
+            const Symbol& symbol = m_symbols.back();
+            m_index.emplace(StringViewType(symbol.name), &symbol);
+            return &symbol;
+        }
+    };
+
+
+    /**
+     * An interned match id.
+     * Copying and comparing interned ids does not copy or compare their names; the name is stored once, in the match id table.
+     * String literal ids in grammars are interned when the grammar is built, so a parse context with interned ids
+     * does not copy a string per match; the ids convert to strings, so the same grammars work with parse contexts of string ids.
+     * @param CharType character type of names.
+     */
+    template <class CharType> class BasicMatchId {
+    public:
+        /**
+         * Table type.
+         */
+        using TableType = BasicMatchIdTable<CharType>;
+
+        /**
+         * String type of names.
+         */
+        using StringType = typename TableType::StringType;
+
+        /**
+         * String view type of names.
+         */
+        using StringViewType = typename TableType::StringViewType;
+
+        /**
+         * The default constructor.
+         * The id has the empty name and index 0.
+         */
+        BasicMatchId() : m_symbol(TableType::instance().emptySymbol()) {
+        }
+
+        /**
+         * Constructor from name; the name is interned.
+         * @param name name.
+         */
+        BasicMatchId(const CharType* name) : m_symbol(TableType::instance().intern(name)) {
+        }
+
+        /**
+         * Constructor from name; the name is interned.
+         * @param name name.
+         */
+        BasicMatchId(const StringType& name) : m_symbol(TableType::instance().intern(name)) {
+        }
+
+        /**
+         * Constructor from name; the name is interned.
+         * @param name name.
+         */
+        explicit BasicMatchId(const StringViewType& name) : m_symbol(TableType::instance().intern(name)) {
+        }
+
+        /**
+         * Returns the index of the id into the match id table.
+         * @return the index of the id.
+         */
+        std::uint32_t index() const {
+            return m_symbol->index;
+        }
+
+        /**
+         * Returns the name of the id.
+         * @return the name of the id.
+         */
+        const StringType& name() const {
+            return m_symbol->name;
+        }
+
+        /**
+         * Converts the id to its name, so as that grammars with interned ids can be used with parse contexts of string ids.
+         * @return the name of the id.
+         */
+        operator const StringType& () const {
+            return m_symbol->name;
+        }
+
+        /**
+         * Checks if two ids are equal.
+         * @param other the other id.
+         * @return true if equal, false otherwise.
+         */
+        bool operator == (const BasicMatchId& other) const {
+            return m_symbol == other.m_symbol;
+        }
+
+        /**
+         * Checks if two ids are different.
+         * @param other the other id.
+         * @return true if different, false otherwise.
+         */
+        bool operator != (const BasicMatchId& other) const {
+            return m_symbol != other.m_symbol;
+        }
+
+        /**
+         * Compares the indexes of two ids.
+         * @param other the other id.
+         * @return true if this index is less than the other index, false otherwise.
+         */
+        bool operator < (const BasicMatchId& other) const {
+            return m_symbol->index < other.m_symbol->index;
+        }
+
+        /**
+         * Checks if the id has the given name.
+         * @param name name.
+         * @return true if the id has the given name, false otherwise.
+         */
+        bool operator == (const CharType* name) const {
+            return m_symbol->name == name;
+        }
+
+        /**
+         * Checks if the id does not have the given name.
+         * @param name name.
+         * @return true if the id does not have the given name, false otherwise.
+         */
+        bool operator != (const CharType* name) const {
+            return m_symbol->name != name;
+        }
+
+        /**
+         * Checks if the id has the given name.
+         * @param name name.
+         * @return true if the id has the given name, false otherwise.
+         */
+        bool operator == (const StringType& name) const {
+            return m_symbol->name == name;
+        }
+
+        /**
+         * Checks if the id does not have the given name.
+         * @param name name.
+         * @return true if the id does not have the given name, false otherwise.
+         */
+        bool operator != (const StringType& name) const {
+            return m_symbol->name != name;
+        }
+
+    private:
+        const typename TableType::Symbol* m_symbol;
+    };
+
+
+    /**
+     * Table of interned match id names of char.
+     */
+    using MatchIdTable = BasicMatchIdTable<char>;
+
+
+    /**
+     * Interned match id of char names.
+     */
+    using MatchId = BasicMatchId<char>;
+
+
+    /**
+     * Writes the name of an id to a stream.
+     * @param stream the stream.
+     * @param id the id.
+     * @return the stream.
+     */
+    template <class CharType, class Traits> std::basic_ostream<CharType, Traits>& operator << (std::basic_ostream<CharType, Traits>& stream, const BasicMatchId<CharType>& id) {
+        return stream << id.name();
+    }
+
+
+} //namespace parserlib
+
+
+/**
+ * Hashes interned match ids by index.
+ * @param CharType character type of names.
+ */
+template <class CharType> struct std::hash<parserlib::BasicMatchId<CharType>> {
+    size_t operator ()(const parserlib::BasicMatchId<CharType>& id) const {
+        return std::hash<std::uint32_t>()(id.index());
+    }
+};
+
+
+#endif //PARSERLIB_MATCHID_HPP
@@ -4,6 +4,7 @@
 
 #include <string>
 #include "ParserNode.hpp"
+#include "MatchId.hpp"
 
 
 namespace parserlib {
@@ -99,9 +100,9 @@ namespace parserlib {
      * @return a match parser.
      */
     template <class ParserNodeType, class CharType>
-    MatchParser<ParserNodeType, std::basic_string<CharType>>
+    MatchParser<ParserNodeType, BasicMatchId<CharType>>
         operator == (const ParserNode<ParserNodeType>& node, const CharType* matchId) {
-        return MatchParser<ParserNodeType, std::basic_string<CharType>>(static_cast<const ParserNodeType&>(node), matchId);
+        return MatchParser<ParserNodeType, BasicMatchId<CharType>>(static_cast<const ParserNodeType&>(node), matchId);
     }
 
 
@@ -0,0 +1,98 @@
+#ifndef PARSERLIB_MEMOENTRY_HPP
+#define PARSERLIB_MEMOENTRY_HPP
+
+
+#include <vector>
+
+
+namespace parserlib {
+
+
+    /**
+     * The memoized result of a rule invocation at a specific source position.
+     * @param ParseContextType type of parse context.
+     */
+    template <class ParseContextType> class MemoEntry {
+    public:
+        /**
+         * Position type.
+         */
+        using PositionType = typename ParseContextType::PositionType;
+
+        /**
+         * Match type.
+         */
+        using MatchType = typename ParseContextType::MatchType;
+
+        /**
+         * Constructor.
+         * @param success result of the rule invocation.
+         * @param endPosition the source position after the rule invocation.
+         * @param matches the matches produced by the rule invocation.
+         * @param examinedOffset offset, from the beginning of parsing, of the end of the source examined by the rule invocation.
+         */
+        MemoEntry(bool success, const PositionType& endPosition, std::vector<MatchType>&& matches, size_t examinedOffset = 0)
+            : m_success(success), m_endPosition(endPosition), m_matches(std::move(matches)), m_examinedOffset(examinedOffset)
+        {
+        }
+
+        /**
+         * Returns the result of the rule invocation.
+         * @return true if the rule parsed successfully, false otherwise.
+         */
+        bool success() const {
+            return m_success;
+        }
+
+        /**
+         * Returns the source position after the rule invocation.
+         * @return the source position after the rule invocation.
+         */
+        const PositionType& endPosition() const {
+            return m_endPosition;
+        }
+
+        /**
+         * Returns the matches produced by the rule invocation.
+         * @return the matches produced by the rule invocation.
+         */
+        const std::vector<MatchType>& matches() const {
+            return m_matches;
+        }
+
+        /**
+         * Returns the offset, from the beginning of parsing, of the end of the source examined by the rule invocation;
+         * the result of the rule invocation depends only on the source before this offset.
+         * It is recorded only for random access sources.
+         * @return the offset of the end of the examined source.
+         */
+        size_t examinedOffset() const {
+            return m_examinedOffset;
+        }
+
+        /**
+         * Replaces the end position and the positions of the matches with the positions returned by the given function,
+         * and the examined offset with the given one; it allows rebasing a memoized result into an edited source.
+         * @param func function that receives a position and returns the position to replace it with.
+         * @param examinedOffset the new examined offset.
+         */
+        template <class F> void mapPositions(const F& func, size_t examinedOffset) {
+            m_endPosition = func(m_endPosition);
+            for (MatchType& match : m_matches) {
+                match.mapPositions(func);
+            }
+            m_examinedOffset = examinedOffset;
+        }
+
+    private:
+        bool m_success;
+        PositionType m_endPosition;
+        std::vector<MatchType> m_matches;
+        size_t m_examinedOffset;
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_MEMOENTRY_HPP
@@ -36,7 +36,14 @@ namespace parserlib {
          */
         template <class ParseContextType> bool operator ()(ParseContextType& pc) const {
             const auto errorState = pc.errorState();
-            m_child(pc);
+            const size_t cutCount = pc.cutCount();
+            pc.incrementBacktrackDepth();
+            const bool result = m_child(pc);
+            pc.decrementBacktrackDepth();
+            //fail if the child failed after a cut
+            if (!result && pc.cutCount() != cutCount) {
+                return false;
+            }
             pc.setErrorState(errorState);
             return true;
         }
@@ -51,7 +58,14 @@ namespace parserlib {
          */
         template <class ParseContextType> bool parseLeftRecursionContinuation(ParseContextType& pc, LeftRecursionContext<ParseContextType>& lrc) const {
             const auto errorState = pc.errorState();
-            m_child.parseLeftRecursionContinuation(pc, lrc);
+            const size_t cutCount = pc.cutCount();
+            pc.incrementBacktrackDepth();
+            const bool result = m_child.parseLeftRecursionContinuation(pc, lrc);
+            pc.decrementBacktrackDepth();
+            //fail if the child failed after a cut
+            if (!result && pc.cutCount() != cutCount) {
+                return false;
+            }
             pc.setErrorState(errorState);
             return true;
         }
@@ -0,0 +1,378 @@
+#ifndef PARSERLIB_PARALLELCHOICEPARSER_HPP
+#define PARSERLIB_PARALLELCHOICEPARSER_HPP
+
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "ChoiceParser.hpp"
+#include "ParseCancelledException.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * A pool of threads that run the alternatives of parallel choices.
+     *
+     * Tasks are queued in one queue; a thread that waits for its tasks to complete runs queued tasks meanwhile,
+     * including the tasks of other parallel choices, and therefore nested parallel choices do not block the pool.
+     */
+    class ParallelChoicePool {
+    public:
+        /**
+         * Constructor.
+         * @param threadCount number of threads; if 0, one less than the number of hardware threads,
+         *  since the thread that invokes a parallel choice parses the first alternative.
+         */
+        ParallelChoicePool(size_t threadCount = 0) {
+            if (threadCount == 0) {
+                const size_t hardwareThreadCount = std::thread::hardware_concurrency();
+                threadCount = hardwareThreadCount > 1 ? hardwareThreadCount - 1 : 0;
+            }
+            for (size_t index = 0; index < threadCount; ++index) {
+                m_threads.emplace_back([this]() { run(); });
+            }
+        }
+
+        /**
+         * The destructor.
+         * Waits for the queued tasks to complete, then stops the threads.
+         */
+        ~ParallelChoicePool() {
+            {
+                std::lock_guard lock(m_mutex);
+                m_stopped = true;
+            }
+            m_condition.notify_all();
+            for (std::thread& thread : m_threads) {
+                thread.join();
+            }
+        }
+
+        ParallelChoicePool(const ParallelChoicePool&) = delete;
+        ParallelChoicePool& operator = (const ParallelChoicePool&) = delete;
+
+        /**
+         * Returns the pool used by parallel choices by default; its threads are created on first use.
+         * @return the default pool.
+         */
+        static ParallelChoicePool& instance() {
+            static ParallelChoicePool pool;
+            return pool;
+        }
+
+        /**
+         * Returns the number of threads of the pool.
+         * @return the number of threads.
+         */
+        size_t threadCount() const {
+            return m_threads.size();
+        }
+
+        /**
+         * Queues a task.
+         * @param task the task; it shall not throw.
+         */
+        void submit(std::function<void()>&& task) {
+            {
+                std::lock_guard lock(m_mutex);
+                m_tasks.push_back(std::move(task));
+            }
+            m_condition.notify_one();
+        }
+
+        /**
+         * Runs a queued task on the calling thread, if there is one.
+         * @return true if a task was run, false if the queue was empty.
+         */
+        bool runQueuedTask() {
+            std::function<void()> task;
+            {
+                std::lock_guard lock(m_mutex);
+                if (m_tasks.empty()) {
+                    return false;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+            return true;
+        }
+
+    private:
+        std::vector<std::thread> m_threads;
+        std::deque<std::function<void()>> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_stopped{ false };
+
+        //runs tasks until the pool is stopped and the queue is empty
+        void run() {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock lock(m_mutex);
+                    m_condition.wait(lock, [&]() { return m_stopped || !m_tasks.empty(); });
+                    if (m_tasks.empty()) {
+                        return;
+                    }
+                    task = std::move(m_tasks.front());
+                    m_tasks.pop_front();
+                }
+                task();
+            }
+        }
+    };
+
+
+    /**
+     * A choice that parses its alternatives concurrently.
+     *
+     * Each alternative parses with its own fork of the parse context; the first alternative parses on the calling thread,
+     * the others on the threads of a pool. The result is the result of the ordered choice of the same alternatives:
+     * the first alternative, in order, that succeeds is joined to the parse context, along with the errors of the alternatives before it;
+     * an alternative that fails after a cut ends the choice, as in a sequential choice.
+     * When the result is decided, the alternatives after the deciding one are cancelled: the ones not started yet are not started,
+     * and the running ones stop at the next rule they invoke.
+     *
+     * Forking the parse context and waiting for the pool costs much more than trying a cheap alternative;
+     * parallel choices are for alternatives that are large grammars, which parse far before they fail.
+     * The alternatives shall not depend on matches before the choice, and the allocator of the parse context shall be thread-safe.
+     * The memoized results of the alternatives are discarded, and the profile of the alternatives is not recorded.
+     *
+     * Within the continuation of a left recursion, and if the pool has no threads, the alternatives are parsed in order, on the calling thread.
+     *
+     * @param Children children parser nodes.
+     */
+    template <class ...Children> class ParallelChoiceParser : public ParserNode<ParallelChoiceParser<Children...>> {
+    public:
+        /**
+         * Constructor.
+         * @param children children nodes.
+         * @param pool the pool of threads to parse the alternatives with; it must outlive the parser.
+         */
+        ParallelChoiceParser(const std::tuple<Children...>& children, ParallelChoicePool& pool = ParallelChoicePool::instance())
+            : m_choice(children), m_pool(&pool)
+        {
+        }
+
+        /**
+         * Returns the children nodes.
+         * @return the children nodes.
+         */
+        const std::tuple<Children...>& children() const {
+            return m_choice.children();
+        }
+
+        /**
+         * Returns the sequential choice of the same children.
+         * @return the sequential choice.
+         */
+        const ChoiceParser<Children...>& choice() const {
+            return m_choice;
+        }
+
+        /**
+         * Parses the alternatives concurrently, and joins the result of the first one, in order, that succeeds.
+         * @param pc parse context.
+         * @return true if parsing succeeds, false otherwise.
+         * @exception whatever the alternatives before the deciding one throw, in order; exceptions of cancelled alternatives are discarded.
+         */
+        template <class ParseContextType> bool operator ()(ParseContextType& pc) const {
+            if (m_pool->threadCount() == 0) {
+                return m_choice(pc);
+            }
+            if constexpr (ParseContextType::InstrumentationPolicy::enabled) {
+                pc.profile().addChoiceInvocation(this, sizeof...(Children));
+            }
+
+            const auto errorState = pc.errorState();
+            pc.incrementBacktrackDepth();
+
+            Invocation<ParseContextType> invocation(pc);
+            start(invocation, std::index_sequence_for<Children...>());
+            wait(invocation, pc);
+
+            //join the alternatives in order, up to the one that decides the result
+            const size_t cutCount = pc.cutCount();
+            for (size_t index = 0; index < sizeof...(Children); ++index) {
+                Branch<ParseContextType>& branch = invocation.branches[index];
+                if (branch.exception) {
+                    pc.decrementBacktrackDepth();
+                    std::rethrow_exception(branch.exception);
+                }
+                pc.join(*branch.pc, branch.success);
+                if (branch.success) {
+                    pc.decrementBacktrackDepth();
+                    pc.setErrorState(errorState);
+                    if constexpr (ParseContextType::InstrumentationPolicy::enabled) {
+                        pc.profile().addChoiceHit(this, index);
+                    }
+                    return true;
+                }
+                if (pc.cutCount() != cutCount) {
+                    break;
+                }
+            }
+            pc.decrementBacktrackDepth();
+            return false;
+        }
+
+        /**
+         * Parses the alternatives in order, within a left recursion parsing context.
+         * @param pc parse context.
+         * @param lrc left recursion context.
+         * @return true if parsing succeeds, false otherwise.
+         */
+        template <class ParseContextType> bool parseLeftRecursionContinuation(ParseContextType& pc, LeftRecursionContext<ParseContextType>& lrc) const {
+            return m_choice.parseLeftRecursionContinuation(pc, lrc);
+        }
+
+    private:
+        //the result of an alternative
+        template <class ParseContextType> struct Branch {
+            std::optional<ParseContextType> pc;
+            std::atomic<bool> cancelled{ false };
+            bool success{ false };
+            std::exception_ptr exception;
+        };
+
+        //the state of an invocation, shared by the threads that parse its alternatives
+        template <class ParseContextType> struct Invocation {
+            std::array<Branch<ParseContextType>, sizeof...(Children)> branches;
+            std::atomic<size_t> decidingIndex{ sizeof...(Children) };
+            size_t pendingCount{ sizeof...(Children) };
+            std::mutex mutex;
+            std::condition_variable condition;
+
+            //the forks are created on the calling thread
+            Invocation(const ParseContextType& pc) {
+                for (Branch<ParseContextType>& branch : branches) {
+                    branch.pc.emplace(pc.fork());
+                    branch.pc->setCancellationFlag(&branch.cancelled);
+                }
+            }
+        };
+
+        ChoiceParser<Children...> m_choice;
+        ParallelChoicePool* m_pool;
+
+        //queues the alternatives after the first, then parses the first on the calling thread
+        template <class ParseContextType, size_t First, size_t ...Rest> void start(Invocation<ParseContextType>& invocation, std::index_sequence<First, Rest...>) const {
+            (m_pool->submit([this, &invocation]() { parse<Rest>(invocation); }), ...);
+            parse<First>(invocation);
+        }
+
+        //parses an alternative, unless the result is decided by an alternative before it
+        template <size_t Index, class ParseContextType> void parse(Invocation<ParseContextType>& invocation) const {
+            Branch<ParseContextType>& branch = invocation.branches[Index];
+            if (Index < invocation.decidingIndex.load()) {
+                bool decided = false;
+                try {
+                    branch.success = std::get<Index>(children())(*branch.pc);
+                    decided = branch.success || branch.pc->cutCount() > 0;
+                }
+                catch (const ParseCancelledException&) {
+                }
+                catch (...) {
+                    branch.exception = std::current_exception();
+                    decided = true;
+                }
+                if (decided) {
+                    decide(invocation, Index);
+                }
+            }
+            //notified under the lock, since the invocation is destroyed as soon as the waiting thread sees no pending alternatives
+            std::lock_guard lock(invocation.mutex);
+            --invocation.pendingCount;
+            invocation.condition.notify_all();
+        }
+
+        //records that the alternative at the given index decides the result, and cancels the alternatives after it
+        template <class ParseContextType> static void decide(Invocation<ParseContextType>& invocation, size_t index) {
+            size_t decidingIndex = invocation.decidingIndex.load();
+            while (index < decidingIndex && !invocation.decidingIndex.compare_exchange_weak(decidingIndex, index)) {
+            }
+            for (size_t later = index + 1; later < sizeof...(Children); ++later) {
+                invocation.branches[later].cancelled.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        //waits for the alternatives, running queued tasks meanwhile; if the parse context is cancelled, the alternatives are cancelled too
+        template <class ParseContextType> void wait(Invocation<ParseContextType>& invocation, const ParseContextType& pc) const {
+            for (;;) {
+                if (pc.cancelled()) {
+                    decide(invocation, static_cast<size_t>(-1));
+                }
+                {
+                    std::lock_guard lock(invocation.mutex);
+                    if (invocation.pendingCount == 0) {
+                        break;
+                    }
+                }
+                if (!m_pool->runQueuedTask()) {
+                    std::unique_lock lock(invocation.mutex);
+                    invocation.condition.wait_for(lock, std::chrono::milliseconds(1), [&]() { return invocation.pendingCount == 0; });
+                }
+            }
+            if (pc.cancelled()) {
+                throw ParseCancelledException();
+            }
+        }
+    };
+
+
+    /**
+     * FIRST set trait for parallel choices; it is the FIRST set of the sequential choice of the same children.
+     * @param Children children parser nodes.
+     */
+    template <class ...Children> struct FirstSet<ParallelChoiceParser<Children...>> {
+        /**
+         * Adds the FIRST set of the sequential choice to the set.
+         * @param node parser node.
+         * @param set character set to add the FIRST set to.
+         * @param nullable set to true if any child is nullable.
+         * @return true if the FIRST sets of all children are known.
+         */
+        static bool addTo(const ParallelChoiceParser<Children...>& node, CharacterSet& set, bool& nullable) {
+            return addFirstSet(node.choice(), set, nullable);
+        }
+    };
+
+
+    /**
+     * Creates a parallel choice out of a choice; the alternatives are parsed on the default pool.
+     * @param choice the choice.
+     * @return a parallel choice.
+     */
+    template <class ...Children> ParallelChoiceParser<Children...> parallelChoice(const ParserNode<ChoiceParser<Children...>>& choice) {
+        return ParallelChoiceParser<Children...>(static_cast<const ChoiceParser<Children...>&>(choice).children());
+    }
+
+
+    /**
+     * Creates a parallel choice out of a choice.
+     * @param choice the choice.
+     * @param pool the pool of threads to parse the alternatives with; it must outlive the parser.
+     * @return a parallel choice.
+     */
+    template <class ...Children> ParallelChoiceParser<Children...> parallelChoice(const ParserNode<ChoiceParser<Children...>>& choice, ParallelChoicePool& pool) {
+        return ParallelChoiceParser<Children...>(static_cast<const ChoiceParser<Children...>&>(choice).children(), pool);
+    }
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_PARALLELCHOICEPARSER_HPP
@@ -0,0 +1,237 @@
+#ifndef PARSERLIB_PARALLELPARSE_HPP
+#define PARSERLIB_PARALLELPARSE_HPP
+
+
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <iterator>
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include "ParseContext.hpp"
+#include "util.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * The result of a parallel parse.
+     * @param ParseContextType type of parse context used for each part of the source.
+     */
+    template <class ParseContextType> class ParallelParseResult {
+    public:
+        /**
+         * Match container type.
+         */
+        using MatchContainerType = typename ParseContextType::MatchContainerType;
+
+        /**
+         * Error container type.
+         */
+        using ErrorContainerType = typename ParseContextType::ErrorContainerType;
+
+        /**
+         * Constructor.
+         * @param success the result of parsing.
+         * @param matches the matches.
+         * @param errors the errors.
+         * @param partCount number of parts the source was split into.
+         */
+        ParallelParseResult(bool success, MatchContainerType&& matches, ErrorContainerType&& errors, size_t partCount)
+            : m_success(success), m_matches(std::move(matches)), m_errors(std::move(errors)), m_partCount(partCount)
+        {
+        }
+
+        /**
+         * Checks if all the parts of the source were parsed successfully and completely.
+         * @return true if parsing succeeded, false otherwise.
+         */
+        bool success() const {
+            return m_success;
+        }
+
+        /**
+         * Returns the matches of all the parts, in source order.
+         * @return the matches of all the parts.
+         */
+        const MatchContainerType& matches() const {
+            return m_matches;
+        }
+
+        /**
+         * Returns the errors of all the parts, in source order.
+         * @return the errors of all the parts.
+         */
+        const ErrorContainerType& errors() const {
+            return m_errors;
+        }
+
+        /**
+         * Returns the number of parts the source was split into.
+         * @return the number of parts the source was split into.
+         */
+        size_t partCount() const {
+            return m_partCount;
+        }
+
+    private:
+        bool m_success;
+        MatchContainerType m_matches;
+        ErrorContainerType m_errors;
+        size_t m_partCount;
+    };
+
+
+    /**
+     * Appends matches of a part of the source to a vector of matches.
+     * @param matches destination.
+     * @param partMatches matches to append; they are moved.
+     */
+    template <class MatchType, class Alloc>
+    void appendMatches(std::vector<MatchType, Alloc>& matches, std::vector<MatchType, Alloc>&& partMatches) {
+        matches.insert(matches.end(), std::make_move_iterator(partMatches.begin()), std::make_move_iterator(partMatches.end()));
+    }
+
+
+    /**
+     * Appends matches of a part of the source to a flat match tree.
+     * @param matches destination.
+     * @param partMatches matches to append.
+     */
+    template <class SourceType, class MatchIdType, class PositionType>
+    void appendMatches(FlatMatchTree<SourceType, MatchIdType, PositionType>& matches, FlatMatchTree<SourceType, MatchIdType, PositionType>&& partMatches) {
+        for (const auto& node : partMatches) {
+            matches.push_back(node);
+        }
+    }
+
+
+    /**
+     * Parses a source that is a sequence of independent items, using multiple threads.
+     *
+     * The source is split into parts of about equal size; each split point is moved forward
+     * to the end of the first position where the boundary parser succeeds, e.g. after a newline.
+     * Each part is then parsed by the grammar on its own thread, with its own parse context,
+     * and it must be parsed completely.
+     *
+     * Source positions are relative to the whole source: the position at the beginning of each part
+     * is computed by advancing the position at the beginning of the previous part,
+     * and therefore line counting positions have correct lines and columns.
+     * The end of the source positions of each part is the end of that part.
+     *
+     * Matches and errors are merged in source order. With a match handler, a single parse context should be used instead.
+     *
+     * Grammars, including rules, are immutable while parsing, and therefore they can be shared by all threads.
+     *
+     * @param source the source; it shall have random access iterators.
+     * @param grammar the grammar to use for each part.
+     * @param boundary the parser that recognizes the boundaries between items.
+     * @param threadCount number of threads; if 0, the number of hardware threads is used.
+     * @return the result of parsing.
+     * @exception whatever the grammar throws; exceptions thrown on the parsing threads are rethrown after all threads are joined.
+     */
+    template <class ParseContextType, class GrammarType, class BoundaryType>
+    ParallelParseResult<ParseContextType> parallelParse(const typename ParseContextType::SourceType& source, const GrammarType& grammar, const BoundaryType& boundary, size_t threadCount = 0) {
+        using PositionType = typename ParseContextType::PositionType;
+        using Iterator = typename ParseContextType::SourceType::const_iterator;
+
+        static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<Iterator>::iterator_category>,
+            "parallel parsing requires a source with random access iterators");
+
+        if (threadCount == 0) {
+            threadCount = std::thread::hardware_concurrency();
+        }
+
+        const Iterator begin = source.begin();
+        const Iterator end = source.end();
+        const size_t size = static_cast<size_t>(end - begin);
+        const size_t partCount = std::max(size_t(1), std::min(threadCount, size));
+
+        //find the split points; a single parse context is reset for each candidate position
+        std::vector<Iterator> splits{ begin };
+        ParseContextType pc(PositionType(begin, end));
+        for (size_t index = 1; index < partCount; ++index) {
+            Iterator it = std::max(begin + size * index / partCount, splits.back());
+            for (; it != end; ++it) {
+                pc.reset(PositionType(it, end));
+                if (boundary(pc)) {
+                    it = pc.sourcePosition().iterator();
+                    break;
+                }
+            }
+            if (it != splits.back() && it != end) {
+                splits.push_back(it);
+            }
+        }
+        splits.push_back(end);
+
+        //compute the start positions of the parts, so as that line and column are correct
+        std::vector<PositionType> positions;
+        {
+            PositionType position(begin, end);
+            for (size_t index = 0; index + 1 < splits.size(); ++index) {
+                if (index > 0) {
+                    position.increase(static_cast<size_t>(splits[index] - splits[index - 1]));
+                }
+                positions.push_back(PositionType(position, splits[index + 1]));
+            }
+        }
+
+        //parse the parts
+        struct PartResult {
+            bool success{ false };
+            typename ParallelParseResult<ParseContextType>::MatchContainerType matches;
+            typename ParallelParseResult<ParseContextType>::ErrorContainerType errors;
+            std::exception_ptr exception;
+        };
+        std::vector<PartResult> partResults(positions.size());
+
+        const auto parsePart = [&](size_t index) {
+            try {
+                ParseContextType pc(positions[index]);
+                partResults[index].success = grammar(pc) && pc.sourceEnded();
+                partResults[index].matches = pc.takeMatches();
+                partResults[index].errors = pc.errors();
+            }
+            catch (...) {
+                partResults[index].exception = std::current_exception();
+            }
+        };
+
+        //the threads are joined even if starting a thread throws, since destroying a joinable thread terminates the program
+        {
+            std::vector<std::thread> threads;
+            const ScopeExit joinThreads([&]() {
+                for (std::thread& thread : threads) {
+                    thread.join();
+                }
+            });
+            threads.reserve(positions.size());
+            for (size_t index = 1; index < positions.size(); ++index) {
+                threads.emplace_back(parsePart, index);
+            }
+            parsePart(0);
+        }
+
+        //merge in source order
+        bool success = true;
+        typename ParallelParseResult<ParseContextType>::MatchContainerType matches;
+        typename ParallelParseResult<ParseContextType>::ErrorContainerType errors;
+        for (PartResult& partResult : partResults) {
+            if (partResult.exception) {
+                std::rethrow_exception(partResult.exception);
+            }
+            success = success && partResult.success;
+            appendMatches(matches, std::move(partResult.matches));
+            errors.insert(errors.end(), partResult.errors.begin(), partResult.errors.end());
+        }
+        return ParallelParseResult<ParseContextType>(success, std::move(matches), std::move(errors), positions.size());
+    }
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_PARALLELPARSE_HPP
@@ -0,0 +1,154 @@
+#ifndef PARSERLIB_PARSEARENA_HPP
+#define PARSERLIB_PARSEARENA_HPP
+
+
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include <string>
+#include "ParseContext.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * A monotonic memory resource for parse contexts.
+     *
+     * Memory is allocated from blocks, by advancing an offset; deallocation does nothing,
+     * and all memory is reclaimed at once by resetting the arena between parses.
+     * Resetting keeps the memory: if more than one block was used, the blocks are replaced by one block of their total size,
+     * and therefore, once the arena has grown to the size a parse requires, parsing allocates no memory from the global allocator.
+     *
+     * An arena shall be used by one thread at a time, and it shall outlive the parse contexts and matches that use it.
+     */
+    class ParseArena : public std::pmr::memory_resource {
+    public:
+        /**
+         * Constructor.
+         * @param blockSize size of the first block; the size of each next block is doubled, or larger, if the allocation requires it.
+         */
+        explicit ParseArena(size_t blockSize = 65536)
+            : m_nextBlockSize(blockSize > 0 ? blockSize : 1)
+        {
+        }
+
+        ParseArena(const ParseArena&) = delete;
+
+        ParseArena& operator = (const ParseArena&) = delete;
+
+        /**
+         * Reclaims all the memory allocated from the arena; the memory is kept for the next parse.
+         * Objects allocated from the arena shall not be used afterwards.
+         */
+        void reset() {
+            if (m_blocks.size() > 1) {
+                const size_t size = capacity();
+                m_blocks.clear();
+                m_blocks.push_back(Block{ std::unique_ptr<std::byte[]>(new std::byte[size]), size });
+                m_nextBlockSize = size * 2;
+            }
+            m_blockIndex = 0;
+            m_offset = 0;
+        }
+
+        /**
+         * Returns the total size of the blocks of the arena.
+         * @return the total size of the blocks of the arena.
+         */
+        size_t capacity() const {
+            size_t result = 0;
+            for (const Block& block : m_blocks) {
+                result += block.size;
+            }
+            return result;
+        }
+
+        /**
+         * Returns the number of blocks of the arena.
+         * @return the number of blocks of the arena.
+         */
+        size_t blockCount() const {
+            return m_blocks.size();
+        }
+
+    protected:
+        /**
+         * Allocates memory from the current block, or from the next one.
+         * @param bytes number of bytes to allocate.
+         * @param alignment alignment of the memory.
+         * @return pointer to the allocated memory.
+         */
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            for (; m_blockIndex < m_blocks.size(); ++m_blockIndex, m_offset = 0) {
+                if (void* result = allocateFromBlock(m_blocks[m_blockIndex], bytes, alignment)) {
+                    return result;
+                }
+            }
+            const size_t size = std::max(m_nextBlockSize, bytes + alignment);
+            m_blocks.push_back(Block{ std::unique_ptr<std::byte[]>(new std::byte[size]), size });
+            m_nextBlockSize = size * 2;
+            m_blockIndex = m_blocks.size() - 1;
+            m_offset = 0;
+            return allocateFromBlock(m_blocks.back(), bytes, alignment);
+        }
+
+        /**
+         * Does nothing; memory is reclaimed by resetting the arena.
+         */
+        void do_deallocate(void*, size_t, size_t) override {
+        }
+
+        /**
+         * Checks if the given memory resource is this arena.
+         * @param other the other memory resource.
+         * @return true if the other memory resource is this arena.
+         */
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    private:
+        struct Block {
+            std::unique_ptr<std::byte[]> data;
+            size_t size;
+        };
+
+        std::vector<Block> m_blocks;
+        size_t m_blockIndex{ 0 };
+        size_t m_offset{ 0 };
+        size_t m_nextBlockSize;
+
+        //allocates from the given block, after the current offset; returns null if the block does not have enough space
+        void* allocateFromBlock(const Block& block, size_t bytes, size_t alignment) {
+            void* ptr = block.data.get() + m_offset;
+            size_t space = block.size - m_offset;
+            if (!std::align(alignment, bytes, ptr, space)) {
+                return nullptr;
+            }
+            m_offset = static_cast<size_t>(static_cast<std::byte*>(ptr) - block.data.get()) + bytes;
+            return ptr;
+        }
+    };
+
+
+    /**
+     * Parse context type that allocates its matches, the children of its matches, its errors and its rule states
+     * from a memory resource, such as a ParseArena.
+     * The memory resource is passed to the constructor of the parse context.
+     * @param SourceType container with source data.
+     * @param MatchIdType id to apply to a match.
+     * @param PositionType type of source position.
+     */
+    template <class SourceType = std::string, class MatchIdType = std::string, class PositionType = SourcePosition<SourceType>>
+    using ArenaParseContext = ParseContext<SourceType, MatchIdType, PositionType,
+        std::pmr::vector<Match<SourceType, MatchIdType, PositionType, std::pmr::polymorphic_allocator<char>>>,
+        TrackErrors, NoInstrumentation, std::pmr::polymorphic_allocator<char>>;
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_PARSEARENA_HPP
@@ -0,0 +1,30 @@
+#ifndef PARSERLIB_PARSECANCELLEDEXCEPTION_HPP
+#define PARSERLIB_PARSECANCELLEDEXCEPTION_HPP
+
+
+#include <stdexcept>
+
+
+namespace parserlib {
+
+
+    /**
+     * Exception thrown when a rule is invoked after the cancellation flag of a parse context is set.
+     * Parallel choices use it to stop the alternatives whose result is no longer needed.
+     */
+    class ParseCancelledException : public std::runtime_error {
+    public:
+        /**
+         * The constructor.
+         */
+        ParseCancelledException()
+            : std::runtime_error("Parsing was cancelled.")
+        {
+        }
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_PARSECANCELLEDEXCEPTION_HPP
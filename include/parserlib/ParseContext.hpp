@@ -2,15 +2,34 @@
 #define PARSERLIB_PARSERCONTEXT_HPP
 
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include <atomic>
 #include "Match.hpp"
 #include "TreeMatchException.hpp"
+#include "ParseDepthException.hpp"
+#include "ParseCancelledException.hpp"
 #include "RuleState.hpp"
+#include "MemoEntry.hpp"
+#include "FlatMatchTree.hpp"
+#include "MatchDelivery.hpp"
 #include "SourcePosition.hpp"
 #include "LineCountingSourcePosition.hpp"
+#include "CompactSourcePosition.hpp"
+#include "KeywordTrie.hpp"
 #include "Error.hpp"
+#include "ErrorTrackingPolicy.hpp"
+#include "InstrumentationPolicy.hpp"
+#include "ExaminedSourcePolicy.hpp"
+#include "ParseProfile.hpp"
 
 
 namespace parserlib {
@@ -27,8 +46,21 @@ namespace parserlib {
      *  must be immutable while being used by a parser context.
      * @param MatchIdType id to apply to a match.
      * @param PositionType type of source position.
+     * @param MatchContainerType type of container for matches;
+     *  either a vector of matches, where each match holds its children,
+     *  or a FlatMatchTree, where the whole match tree is stored in one array.
+     * @param ErrorTrackingPolicy either TrackErrors, in order to record errors, or NoErrors, in order to ignore errors.
+     * @param InstrumentationPolicy either NoInstrumentation, or ProfileParsing, in order to keep a profile of parsing.
+     * @param Allocator allocator of the matches, errors and rule states, rebound to each element type;
+     *  for example, a `std::pmr::polymorphic_allocator` over a ParseArena.
+     *  The match container shall use the allocator in order to allocate matches with it.
+     * @param ExaminedSourcePolicy either IgnoreExaminedSource, or TrackExaminedSource, in order to allow incremental and resumable parsing;
+     *  by default, the source is tracked only for sources that grow while parsing, like a PushSource.
      */
-    template <class SourceType_ = std::string, class MatchIdType_ = std::string, class SourcePositionType_ = SourcePosition<SourceType_>>
+    template <class SourceType_ = std::string, class MatchIdType_ = std::string, class SourcePositionType_ = SourcePosition<SourceType_>,
+        class MatchContainerType_ = std::vector<Match<SourceType_, MatchIdType_, SourcePositionType_>>, class ErrorTrackingPolicy_ = TrackErrors,
+        class InstrumentationPolicy_ = NoInstrumentation, class Allocator_ = std::allocator<char>,
+        class ExaminedSourcePolicy_ = typename DefaultExaminedSourcePolicy<SourceType_>::type>
     class ParseContext {
     public:
         /**
@@ -49,7 +81,7 @@ namespace parserlib {
         /**
          * this type.
          */
-        using ThisType = ParseContext<SourceType, MatchIdType, PositionType>;
+        using ThisType = ParseContext<SourceType, MatchIdType, PositionType, MatchContainerType_, ErrorTrackingPolicy_, InstrumentationPolicy_, Allocator_, ExaminedSourcePolicy_>;
 
         /**
          * Associated rule type.
@@ -62,9 +94,49 @@ namespace parserlib {
         using RuleStateType = RuleState<ThisType>;
 
         /**
-         * Match type.
+         * Match container type.
          */
-        using MatchType = Match<SourceType, MatchIdType, PositionType>;
+        using MatchContainerType = MatchContainerType_;
+
+        /**
+         * Match type; the element type of the match container.
+         */
+        using MatchType = typename MatchContainerType::value_type;
+
+        /**
+         * Allocator type.
+         */
+        using Allocator = Allocator_;
+
+        /**
+         * Error container type.
+         */
+        using ErrorContainerType = std::vector<Error<PositionType>, typename std::allocator_traits<Allocator>::template rebind_alloc<Error<PositionType>>>;
+
+        /**
+         * Error tracking policy.
+         */
+        using ErrorTrackingPolicy = ErrorTrackingPolicy_;
+
+        /**
+         * Instrumentation policy.
+         */
+        using InstrumentationPolicy = InstrumentationPolicy_;
+
+        /**
+         * Examined source policy.
+         */
+        using ExaminedSourcePolicy = ExaminedSourcePolicy_;
+
+        /**
+         * Profile type; ParseProfile if parsing is instrumented, otherwise an empty type.
+         */
+        using ProfileType = std::conditional_t<InstrumentationPolicy::enabled, ParseProfile, NoParseProfile>;
+
+        /**
+         * Memo entry type.
+         */
+        using MemoEntryType = MemoEntry<ThisType>;
 
         /**
          * Current parser state.
@@ -95,8 +167,8 @@ namespace parserlib {
             }
 
         private:
-            const PositionType m_sourcePosition;
-            const size_t m_matchCount;
+            PositionType m_sourcePosition;
+            size_t m_matchCount{ 0 };
 
             //constructor
             State(const PositionType& position, const size_t matchCount)
@@ -110,18 +182,96 @@ namespace parserlib {
         /**
          * Constructor.
          * @param src source.
+         * @param allocator allocator of the matches, errors and rule states.
          */
-        ParseContext(const SourceType& src)
+        ParseContext(const SourceType& src, const Allocator& allocator = Allocator())
             : m_sourcePosition(src.begin(), src.end())
+            , m_sourceBegin(src.begin())
+            , m_sourceEnd(src.end())
+            , m_allocator(allocator)
+            , m_matches(makeMatchContainer(allocator))
+            , m_ruleStates(allocator)
+            , m_errors(allocator)
         {
         }
 
+        /**
+         * Constructor from source position.
+         * Parsing starts from the given position, up to the end of the source of the position;
+         * it allows parsing a part of a source, with positions that are relative to the whole source.
+         * @param begin the position to start parsing from.
+         * @param allocator allocator of the matches, errors and rule states.
+         */
+        ParseContext(const PositionType& begin, const Allocator& allocator = Allocator())
+            : m_sourcePosition(begin)
+            , m_sourceBegin(begin.iterator())
+            , m_sourceEnd(begin.end())
+            , m_allocator(allocator)
+            , m_matches(makeMatchContainer(allocator))
+            , m_ruleStates(allocator)
+            , m_errors(allocator)
+        {
+        }
+
+        /**
+         * Returns the allocator of the matches, errors and rule states.
+         * @return the allocator.
+         */
+        const Allocator& allocator() const {
+            return m_allocator;
+        }
+
+        /**
+         * Prepares the parse context for parsing a new source, as if it was created for it,
+         * while keeping the memory of the matches, the errors and the rule states;
+         * parsing many small sources with one parse context therefore does not allocate memory for each source,
+         * after the containers have grown to the size the sources require.
+         *
+         * The matches, the errors and the memoized results are discarded;
+         * the memoization flag, the max rule depth, the max recovery count, the match handler and the profile are kept.
+         *
+         * @param src the new source; it must outlive the parse context.
+         */
+        void reset(const SourceType& src) {
+            m_sourcePosition = PositionType(src.begin(), src.end());
+            m_sourceBegin = src.begin();
+            m_sourceEnd = src.end();
+            m_memo.clear();
+            resetParseState();
+        }
+
+        /**
+         * Prepares the parse context for parsing from a new source position, as if it was created for it,
+         * while keeping the memory of the matches, the errors and the rule states.
+         * @param begin the position to start parsing from.
+         */
+        void reset(const PositionType& begin) {
+            m_sourcePosition = begin;
+            m_sourceBegin = begin.iterator();
+            m_sourceEnd = begin.end();
+            m_memo.clear();
+            resetParseState();
+        }
+
+        /**
+         * Reserves memory for the expected number of matches and errors.
+         * The memory is kept by the function `reset`.
+         * @param matchCount expected number of matches.
+         * @param errorCount expected number of errors.
+         */
+        void reserve(size_t matchCount, size_t errorCount = 0) {
+            m_matches.reserve(matchCount);
+            if constexpr (ErrorTrackingPolicy::enabled) {
+                m_errors.reserve(errorCount);
+            }
+        }
+
         /**
          * Returns the current state.
          * @return the current state.
          */
         State state() const {
-            return State(m_sourcePosition, m_matches.size());
+            return State(m_sourcePosition, m_droppedMatchCount + m_matches.size());
         }
 
         /**
@@ -129,8 +279,16 @@ namespace parserlib {
          * @param state state.
          */
         void setState(const State& state) {
+            if constexpr (InstrumentationPolicy::enabled) {
+                if (state.sourcePosition() < m_sourcePosition) {
+                    m_profile.addBacktrackedBytes(static_cast<size_t>(std::distance(state.sourcePosition().iterator(), m_sourcePosition.iterator())));
+                }
+            }
             m_sourcePosition = state.sourcePosition();
-            m_matches.resize(state.matchCount());
+            m_matches.resize(state.matchCount() > m_droppedMatchCount ? state.matchCount() - m_droppedMatchCount : 0);
+            if (m_deliveredMatchCount > m_matches.size()) {
+                m_deliveredMatchCount = m_matches.size();
+            }
         }
 
         /**
@@ -148,6 +306,7 @@ namespace parserlib {
          */
         template <class T>
         bool sourcePositionContains(const T& value) const {
+            examine(1);
             return m_sourcePosition.contains(value);
         }
 
@@ -159,6 +318,7 @@ namespace parserlib {
          */
         template <class T>
         bool sourcePositionContains(const T& minValue, const T& maxValue) const {
+            examine(1);
             return m_sourcePosition.contains(minValue, maxValue);
         }
 
@@ -169,6 +329,7 @@ namespace parserlib {
          */
         template <class T, class Alloc>
         bool sourcePositionContains(const std::vector<T, Alloc>& values) const {
+            examine(1);
             return m_sourcePosition.contains(values);
         }
 
@@ -179,7 +340,65 @@ namespace parserlib {
          */
         template <class T>
         bool sourcePositionContains(const T* str) const {
-            return m_sourcePosition.contains(str);
+            if constexpr (ExaminedSourcePolicy::enabled) {
+                if (tracksExaminedSource()) {
+                    examine(std::char_traits<T>::length(str));
+                }
+            }
+            if constexpr (HasSourceEnd<PositionType>::value) {
+                return m_sourcePosition.contains(str);
+            }
+            else {
+                return m_sourcePosition.contains(m_sourceEnd, str);
+            }
+        }
+
+        /**
+         * Checks if the given string of known length can be recognized at current position.
+         * @param str string to check.
+         * @param foldedStr the string folded to lowercase with the function `foldCharacter`; used by case insensitive source positions.
+         * @param length length of the string.
+         * @return true if string is recognized, false otherwise.
+         */
+        template <class T>
+        bool sourcePositionContains(const T* str, const T* foldedStr, size_t length) const {
+            examine(length);
+            if constexpr (HasSourceEnd<PositionType>::value) {
+                return m_sourcePosition.contains(str, foldedStr, length);
+            }
+            else {
+                return m_sourcePosition.contains(m_sourceEnd, str, foldedStr, length);
+            }
+        }
+
+        /**
+         * Searches for a keyword of the given trie at the current source position.
+         * The source is folded to lowercase if the source position type is case insensitive.
+         * @param trie keyword trie.
+         * @return the result of the search.
+         */
+        template <class T>
+        typename KeywordTrie<T>::Result sourcePositionKeyword(const KeywordTrie<T>& trie) const {
+            const auto result = trie.find(m_sourcePosition.iterator(), m_sourceEnd, !IsCaseSensitive<PositionType>::value);
+            examine(result.examinedCount);
+            return result;
+        }
+
+        /**
+         * Returns the number of consecutive elements, from the current source position, that belong to the given character set.
+         * @param set character set.
+         * @return number of consecutive elements that belong to the set.
+         */
+        size_t sourcePositionSpan(const CharacterSet& set) const {
+            size_t count;
+            if constexpr (HasSourceEnd<PositionType>::value) {
+                count = m_sourcePosition.span(set);
+            }
+            else {
+                count = m_sourcePosition.span(m_sourceEnd, set);
+            }
+            examine(count + 1);
+            return count;
         }
 
         /**
@@ -202,7 +421,7 @@ namespace parserlib {
          * @return the end of the source.
          */
         const typename SourceType::const_iterator& sourceEnd() const {
-            return m_sourcePosition.end();
+            return m_sourceEnd;
         }
 
         /**
@@ -210,17 +429,29 @@ namespace parserlib {
          * @return true if there is no more source to parse, false otherwise.
          */
         bool sourceEnded() const {
-            return m_sourcePosition == m_sourcePosition.end();
+            examine(1);
+            return m_sourcePosition == m_sourceEnd;
         }
 
         /**
          * Returns the current matches.
          * @return the current matches.
          */
-        const std::vector<MatchType>& matches() const {
+        const MatchContainerType& matches() const {
             return m_matches;
         }
 
+        /**
+         * Removes the matches from the parse context and returns them.
+         * @return the matches.
+         */
+        MatchContainerType takeMatches() {
+            MatchContainerType result(std::move(m_matches));
+            m_matches.clear();
+            m_deliveredMatchCount = 0;
+            return result;
+        }
+
         /**
          * Adds a match.
          * @param id match id.
@@ -228,7 +459,10 @@ namespace parserlib {
          * @param end end position into the source.
          */
         void addMatch(const MatchIdType& id, const PositionType& begin, const PositionType& end) {
-            m_matches.push_back(MatchType(id, begin, end));
+            addMatch(m_matches, id, begin, end);
+            if (m_backtrackDepth == 0 && m_treeMatchDepth == 0) {
+                deliverMatches();
+            }
         }
 
         /**
@@ -243,9 +477,10 @@ namespace parserlib {
             if (childCount > m_matches.size()) {
                 throw TreeMatchException<ThisType>(*this);
             }
-            MatchType m(id, begin, end, std::vector<MatchType>(m_matches.end() - childCount, m_matches.end()));
-            m_matches.resize(m_matches.size() - childCount);
-            m_matches.push_back(std::move(m));
+            addMatch(m_matches, id, begin, end, childCount);
+            if (m_backtrackDepth == 0 && m_treeMatchDepth == 0) {
+                deliverMatches();
+            }
         }
 
         /**
@@ -255,22 +490,546 @@ namespace parserlib {
          * @exception std::runtime_error thrown if there is no rule state for the given rule.
          */
         const RuleStateType& ruleState(const RuleType& rule) const {
-            const auto it = m_ruleStates.find(rule.this_());
-            return it != m_ruleStates.end() ? it->second : throw std::runtime_error("No rule state for the given rule exists.");
+            return rule.index() < m_ruleStates.size() ? m_ruleStates[rule.index()] : throw std::runtime_error("No rule state for the given rule exists.");
         }
 
         /**
          * Returns the existing or a new rule state for the given rule.
+         * Rule states are stored in a vector indexed by rule index;
+         * the vector grows when a rule without a state is first entered, up to the indexes of the rules that exist,
+         * and therefore a returned reference is invalidated by subsequent calls to this function.
          * @param rule rule to get the rule state of.
          * @return the rule state for the rule.
          */
         RuleStateType& ruleState(const RuleType& rule) {
-            const auto it1 = m_ruleStates.find(rule.this_());
-            if (it1 != m_ruleStates.end()) {
-                return it1->second;
+            if (rule.index() >= m_ruleStates.size()) {
+                m_ruleStates.resize(RuleType::ruleCount(), RuleStateType(PositionType(m_sourceEnd, m_sourceEnd)));
+            }
+            return m_ruleStates[rule.index()];
+        }
+
+        /**
+         * Returns the number of nested rule invocations that are currently parsing, excluding the ones that found left recursion.
+         * @return the number of nested rule invocations that are currently parsing.
+         */
+        size_t ruleDepth() const {
+            return m_ruleDepth;
+        }
+
+        /**
+         * Returns the max number of nested rule invocations that may be parsing at the same time.
+         * @return the max rule depth.
+         */
+        size_t maxRuleDepth() const {
+            return m_maxRuleDepth;
+        }
+
+        /**
+         * Sets the max number of nested rule invocations that may be parsing at the same time;
+         * a rule invoked at the max depth throws a ParseDepthException instead of parsing.
+         * Since each nested rule invocation uses native stack, the max depth allows deeply nested input
+         * to fail cleanly instead of overflowing the stack. By default, the depth is unlimited.
+         * @param depth the max rule depth.
+         */
+        void setMaxRuleDepth(size_t depth) {
+            m_maxRuleDepth = depth;
+        }
+
+        /**
+         * Returns the number of error recoveries attempted since the parse context was created or reset.
+         * @return the recovery count.
+         */
+        size_t recoveryCount() const {
+            return m_recoveryCount;
+        }
+
+        /**
+         * Returns the max number of error recoveries that may be attempted.
+         * @return the max recovery count.
+         */
+        size_t maxRecoveryCount() const {
+            return m_maxRecoveryCount;
+        }
+
+        /**
+         * Sets the max number of error recoveries that may be attempted;
+         * after that, error recovery points fail instead of searching for a recovery position,
+         * and therefore malformed input with many errors cannot make parsing scan the source again for each error.
+         * By default, the count is unlimited.
+         * @param count the max recovery count.
+         */
+        void setMaxRecoveryCount(size_t count) {
+            m_maxRecoveryCount = count;
+        }
+
+        /**
+         * Increments the number of error recoveries, if the max recovery count is not reached.
+         * @return true if the count was incremented, false if the max recovery count is reached.
+         */
+        bool incrementRecoveryCount() {
+            if (m_recoveryCount == m_maxRecoveryCount) {
+                return false;
+            }
+            ++m_recoveryCount;
+            return true;
+        }
+
+        /**
+         * Increments the number of nested rule invocations that are currently parsing.
+         * @exception ParseDepthException thrown if the max rule depth is reached.
+         * @exception ParseCancelledException thrown if this is a fork and parsing is cancelled.
+         */
+        void incrementRuleDepth() {
+            if (m_ruleDepth == m_maxRuleDepth) {
+                throwParseDepthException();
+            }
+            if (m_forked && cancelled()) {
+                throwParseCancelledException();
+            }
+            ++m_ruleDepth;
+        }
+
+        /**
+         * Sets the flag that cancels parsing; when another thread sets the flag,
+         * the next rule invoked throws a ParseCancelledException.
+         * The flag is checked only by parse contexts created by `fork()`,
+         * so as that parsing without forks does not pay for cancellation.
+         * @param flag the cancellation flag; it can be null, and it must outlive parsing.
+         */
+        void setCancellationFlag(const std::atomic<bool>* flag) {
+            m_cancellationFlag = flag;
+        }
+
+        /**
+         * Checks if parsing is cancelled.
+         * @return true if the cancellation flag is set, false otherwise.
+         */
+        bool cancelled() const {
+            return m_cancellationFlag && m_cancellationFlag->load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Creates a parse context that continues parsing from the current state of this parse context, independently of it;
+         * it allows trying a parser speculatively, e.g. on another thread, and then joining its result to this parse context.
+         *
+         * The fork has the source position, the rule states, the rule depth, the limits and the cancellation flag of this parse context,
+         * and the uncommitted error, if there is one; it starts without matches, memoized results, match handler and profile.
+         * The fork uses a copy of the allocator, and therefore the allocator must be thread-safe for forks to parse on other threads.
+         *
+         * @return the fork.
+         */
+        ThisType fork() const {
+            ThisType result(m_sourcePosition, m_allocator);
+            result.m_sourceBegin = m_sourceBegin;
+            result.m_examinedOffset = m_examinedOffset;
+            result.m_ruleStates = m_ruleStates;
+            result.m_ruleDepth = m_ruleDepth;
+            result.m_maxRuleDepth = m_maxRuleDepth;
+            result.m_maxRecoveryCount = m_maxRecoveryCount - m_recoveryCount;
+            result.m_memoization = m_memoization;
+            result.m_examinedSourceTracking = m_examinedSourceTracking;
+            result.m_cancellationFlag = m_cancellationFlag;
+            result.m_forked = true;
+            if constexpr (ErrorTrackingPolicy::enabled) {
+                if (m_errors.size() > m_committedErrorCount) {
+                    result.m_errors.push_back(m_errors.back());
+                }
+            }
+            return result;
+        }
+
+        /**
+         * Joins the result of a fork of this parse context, as if the parser the fork was used for had parsed with this parse context.
+         * The errors of the fork are added as if they were added to this parse context, the counts of recoveries, cuts and left recursions
+         * are added to the counts of this parse context, the left recursions the fork found upon the rules that are parsing are recorded,
+         * and the examined source is extended to the source the fork examined;
+         * if the parser succeeded, the source position and the matches of the fork are also taken.
+         * @param fork the fork; its matches are moved.
+         * @param success true if the parser succeeded, false otherwise.
+         */
+        void join(ThisType& fork, bool success) {
+            if constexpr (ErrorTrackingPolicy::enabled) {
+                for (size_t index = 0; index < fork.m_errors.size(); ++index) {
+                    addError(fork.m_errors[index].position(), [&]() { return fork.m_errors[index]; });
+                    if (index + 1 == fork.m_committedErrorCount) {
+                        commitErrors();
+                    }
+                }
+            }
+            m_examinedOffset = std::max(m_examinedOffset, fork.m_examinedOffset);
+            m_recoveryCount += fork.m_recoveryCount;
+            m_cutCount += fork.m_cutCount;
+            m_leftRecursionCount += fork.m_leftRecursionCount;
+
+            //left recursion found by the fork upon the rules that are parsing
+            for (size_t index = 0; index < std::min(m_ruleStates.size(), fork.m_ruleStates.size()); ++index) {
+                if (fork.m_ruleStates[index].leftRecursion()) {
+                    m_ruleStates[index].setLeftRecursion(true);
+                }
+            }
+            m_backtrackDepth += fork.m_backtrackDepth;
+            if (success) {
+                m_sourcePosition = fork.m_sourcePosition;
+                appendMatches(m_matches, fork.m_matches);
+                fork.m_matches.clear();
+                if (m_backtrackDepth == 0 && m_treeMatchDepth == 0) {
+                    deliverMatches();
+                }
+            }
+        }
+
+        /**
+         * Decrements the number of nested rule invocations that are currently parsing.
+         */
+        void decrementRuleDepth() {
+            --m_ruleDepth;
+        }
+
+        /**
+         * Returns the memoization flag.
+         * @return true if rule results are memoized, false otherwise.
+         */
+        bool memoization() const {
+            return m_memoization;
+        }
+
+        /**
+         * Enables or disables memoization of rule results.
+         * When enabled, each rule invocation result is stored per (rule, source position),
+         * and a rule that is invoked again at the same position replays the stored result
+         * instead of parsing again.
+         * Disabling memoization also discards the memoized results.
+         * @param v the memoization flag.
+         */
+        void setMemoization(bool v) {
+            m_memoization = v;
+            if (!v) {
+                m_memo.clear();
             }
-            const auto [it2, ok] = m_ruleStates.emplace(rule.this_(), RuleStateType(PositionType(m_sourcePosition.end(), m_sourcePosition.end())));
-            return it2->second;
+        }
+
+        /**
+         * Returns the memoized result of the given rule at the current source position.
+         * @param rule rule to get the memoized result of.
+         * @return pointer to the memo entry, or null if there is no memoized result.
+         */
+        const MemoEntryType* memoEntry(const RuleType& rule) const {
+            const auto it = m_memo.find(std::make_pair(m_sourcePosition, rule.index()));
+            return it != m_memo.end() ? &it->second : nullptr;
+        }
+
+        /**
+         * Memoizes the result of a rule invocation.
+         * The source position after the invocation is the current source position,
+         * and the matches produced by the invocation are those after the given match count.
+         * @param rule the rule that was invoked.
+         * @param position the source position the rule was invoked at.
+         * @param success the result of the rule invocation.
+         * @param matchCount number of matches at the time the rule was invoked.
+         * @param examinedOffset offset of the end of the source examined by the rule invocation.
+         */
+        void addMemoEntry(const RuleType& rule, const PositionType& position, bool success, size_t matchCount, size_t examinedOffset = 0) {
+            std::vector<MatchType> matches(m_matches.begin() + matchCount, m_matches.end());
+            m_memo.insert_or_assign(std::make_pair(position, rule.index()), MemoEntryType(success, m_sourcePosition, std::move(matches), examinedOffset));
+        }
+
+        /**
+         * Replays a memoized result: if it was successful,
+         * the source position is set to the entry's end position and its matches are appended to the current matches.
+         * @param entry entry to replay.
+         * @return the result of the memoized rule invocation.
+         */
+        bool applyMemoEntry(const MemoEntryType& entry) {
+            m_examinedOffset = std::max(m_examinedOffset, entry.examinedOffset());
+            if (entry.success()) {
+                m_sourcePosition = entry.endPosition();
+                for (const MatchType& match : entry.matches()) {
+                    m_matches.push_back(match);
+                }
+            }
+            return entry.success();
+        }
+
+        /**
+         * Discards the memoized results of rules invoked before the given position.
+         * It allows bounding the memory used by memoization when the caller knows
+         * that parsing will not backtrack before the given position.
+         * @param position position before which memoized results are discarded.
+         */
+        void discardMemoEntriesBefore(const PositionType& position) {
+            m_memo.erase(m_memo.begin(), m_memo.lower_bound(std::make_pair(position, size_t(0))));
+        }
+
+        /**
+         * Returns the offset, from the beginning of parsing, of the end of the source examined so far;
+         * it is tracked only while memoization or examined source tracking is enabled, only for random access sources,
+         * and only if the examined source policy is TrackExaminedSource.
+         * Rules reset it while they parse, in order to record the extent of the source their memoized results depend on.
+         * @return the offset of the end of the examined source.
+         */
+        size_t examinedOffset() const {
+            return m_examinedOffset;
+        }
+
+        /**
+         * Sets the offset of the end of the source examined so far.
+         * @param offset the new offset.
+         */
+        void setExaminedOffset(size_t offset) {
+            m_examinedOffset = offset;
+        }
+
+        /**
+         * Returns the examined source tracking flag.
+         * @return true if the examined offset is tracked even when memoization is disabled, false otherwise.
+         */
+        bool examinedSourceTracking() const {
+            return m_examinedSourceTracking;
+        }
+
+        /**
+         * Enables or disables the tracking of the examined offset when memoization is disabled.
+         * It allows resumable parsing to detect parsers that need more input than is currently available.
+         * @param v the examined source tracking flag.
+         */
+        void setExaminedSourceTracking(bool v) {
+            m_examinedSourceTracking = v;
+        }
+
+        /**
+         * Checks if the source examined so far extends past the end of the source;
+         * it happens when a parser tested for the end of the source, or needed more elements than there are.
+         * Always false for sources that are not random access, for which the examined offset is not tracked.
+         * @return true if the examined offset is after the end of the source, false otherwise.
+         */
+        bool examinedPastSourceEnd() const {
+            if constexpr (IsRandomAccess) {
+                return m_examinedOffset > static_cast<size_t>(m_sourceEnd - m_sourceBegin);
+            }
+            else {
+                return false;
+            }
+        }
+
+        /**
+         * Prepares the parse context for reparsing its source after an edit, reusing the memoized results the edit does not affect.
+         *
+         * A memoized result is kept if the source it examined ends before the edit, or if it begins after the removed elements;
+         * in the latter case, its positions are shifted by the difference between the inserted and the removed elements.
+         * The positions of the kept results are moved into the new source; all other memoized results are discarded.
+         * Results that begin within a kept successful result that begins before them are also discarded,
+         * since parsing replays the enclosing result instead of invoking them.
+         *
+         * The rest of the parse context is reset, as if it was created for the new source with memoization enabled;
+         * the match handler and the profile are kept.
+         * Parsing the new source with the same grammar then produces the same result as parsing it with a new parse context,
+         * with the rules whose results are reused not parsing again.
+         *
+         * Requires a random access source and the TrackExaminedSource policy, e.g. an IncrementalParseContext;
+         * parsers shall examine the source only through the parse context.
+         *
+         * @param source the edited source; it must outlive the parse context;
+         *  the previous source must still be valid when this function is called.
+         * @param offset offset of the edit, from the beginning of parsing.
+         * @param removedCount number of elements removed at the offset.
+         * @param insertedCount number of elements inserted at the offset.
+         */
+        void applyEdit(const SourceType& source, size_t offset, size_t removedCount, size_t insertedCount) {
+            static_assert(IsRandomAccess, "Incremental parsing requires a random access source.");
+            static_assert(ExaminedSourcePolicy::enabled, "Incremental parsing requires the TrackExaminedSource policy, e.g. an IncrementalParseContext.");
+
+            //positions before the edit keep their place relative to the beginning of the source,
+            //positions after the edit keep their place relative to the end of the edit
+            const PositionType oldBegin(m_sourceBegin, m_sourceEnd);
+            const PositionType newBegin(source.begin(), source.end());
+            PositionType oldEditEnd(oldBegin);
+            oldEditEnd.increase(offset + removedCount);
+            PositionType newEditEnd(newBegin);
+            newEditEnd.increase(offset + insertedCount);
+
+            //the end of the kept successful results that begin before the current one, and of the ones that begin at it
+            size_t coveredEnd = 0;
+            size_t groupOffset = 0;
+            size_t groupCoveredEnd = 0;
+
+            std::map<std::pair<PositionType, size_t>, MemoEntryType> memo;
+            for (auto it = m_memo.begin(); it != m_memo.end(); ) {
+                auto node = m_memo.extract(it++);
+                MemoEntryType& entry = node.mapped();
+                const size_t beginOffset = sourceOffset(node.key().first);
+                const size_t endOffset = sourceOffset(entry.endPosition());
+
+                if (beginOffset != groupOffset) {
+                    coveredEnd = std::max(coveredEnd, groupCoveredEnd);
+                    groupOffset = beginOffset;
+                }
+                if (beginOffset < coveredEnd) {
+                    continue;
+                }
+
+                const PositionType* oldAnchor;
+                const PositionType* newAnchor;
+                size_t examinedOffset;
+                if (std::max({ entry.examinedOffset(), beginOffset, endOffset }) <= offset) {
+                    oldAnchor = &oldBegin;
+                    newAnchor = &newBegin;
+                    examinedOffset = entry.examinedOffset();
+                }
+                else if (beginOffset >= offset + removedCount) {
+                    oldAnchor = &oldEditEnd;
+                    newAnchor = &newEditEnd;
+                    examinedOffset = entry.examinedOffset() - removedCount + insertedCount;
+                }
+                else {
+                    continue;
+                }
+                if (entry.success()) {
+                    groupCoveredEnd = std::max(groupCoveredEnd, endOffset);
+                }
+
+                const auto rebase = [&](const PositionType& position) {
+                    PositionType result(position);
+                    result.rebase(*oldAnchor, *newAnchor);
+                    return result;
+                };
+                entry.mapPositions(rebase, examinedOffset);
+                node.key().first = rebase(node.key().first);
+                memo.insert(memo.end(), std::move(node));
+            }
+            m_memo = std::move(memo);
+
+            //reset the rest of the state for the new source
+            m_sourcePosition = PositionType(source.begin(), source.end());
+            m_sourceBegin = source.begin();
+            m_sourceEnd = source.end();
+            m_memoization = true;
+            resetParseState();
+        }
+
+        /**
+         * Type of match delivered to a match handler:
+         * the match type for vectors of matches, the match view type for flat match trees.
+         */
+        using DeliveredMatchType = typename DeliveredMatch<MatchContainerType>::Type;
+
+        /**
+         * Type of function that receives the final matches.
+         */
+        using MatchHandler = std::function<void(const DeliveredMatchType& match)>;
+
+        /**
+         * Sets the function that receives each top-level match when it becomes final,
+         * i.e. when the parse can no longer backtrack before it.
+         * A match is final when it is added outside of any choice, loop iteration, optional, predicate or tree match,
+         * when such an enclosing parser completes, or at a cut.
+         * @param handler the match handler; it can be empty.
+         * @param delivery what to do with the delivered matches.
+         */
+        void setMatchHandler(const MatchHandler& handler, MatchDelivery delivery = MatchDelivery::DropMatches) {
+            m_matchHandler = handler;
+            m_matchDelivery = delivery;
+        }
+
+        /**
+         * Returns the number of cuts so far.
+         * Choices, loops and optionals compare the number of cuts before and after a branch fails,
+         * in order to not backtrack past a cut.
+         * @return the number of cuts so far.
+         */
+        size_t cutCount() const {
+            return m_cutCount;
+        }
+
+        /**
+         * Commits the parse up to the current source position.
+         * Memoized results before the current source position are discarded,
+         * and, if the cut is not within a tree match, the matches found so far are delivered to the match handler.
+         */
+        void cut() {
+            ++m_cutCount;
+            discardMemoEntriesBefore(m_sourcePosition);
+            if (m_treeMatchDepth == 0) {
+                deliverMatches();
+            }
+        }
+
+        /**
+         * Returns the number of matches removed from the parse context after their delivery.
+         * @return the number of matches removed from the parse context after their delivery.
+         */
+        size_t droppedMatchCount() const {
+            return m_droppedMatchCount;
+        }
+
+        /**
+         * Returns the number of parsers that may backtrack and that are currently parsing.
+         * @return the number of parsers that may backtrack and that are currently parsing.
+         */
+        size_t backtrackDepth() const {
+            return m_backtrackDepth;
+        }
+
+        /**
+         * Sets the number of parsers that may backtrack and that are currently parsing;
+         * if there are none, the matches found so far are final, and therefore delivered.
+         * @param depth the new depth.
+         */
+        void setBacktrackDepth(size_t depth) {
+            m_backtrackDepth = depth;
+            if (m_backtrackDepth == 0 && m_treeMatchDepth == 0) {
+                deliverMatches();
+            }
+        }
+
+        /**
+         * Increments the number of parsers that may backtrack and that are currently parsing;
+         * matches are not final while such a parser is parsing.
+         */
+        void incrementBacktrackDepth() {
+            ++m_backtrackDepth;
+        }
+
+        /**
+         * Decrements the number of parsers that may backtrack and that are currently parsing;
+         * if there are none left, the matches found so far are final, and therefore delivered.
+         */
+        void decrementBacktrackDepth() {
+            if (--m_backtrackDepth == 0 && m_treeMatchDepth == 0) {
+                deliverMatches();
+            }
+        }
+
+        /**
+         * Increments the number of tree matches being parsed;
+         * matches are not final while a tree match is parsed,
+         * since the tree match takes the matches after its beginning as its children.
+         */
+        void incrementTreeMatchDepth() {
+            ++m_treeMatchDepth;
+        }
+
+        /**
+         * Decrements the number of tree matches being parsed.
+         */
+        void decrementTreeMatchDepth() {
+            --m_treeMatchDepth;
+        }
+
+        /**
+         * Returns the number of left recursions found so far.
+         * Rule results obtained while left recursion was found depend on the state of left-recursive rules,
+         * and therefore they are not memoized.
+         * @return the number of left recursions found so far.
+         */
+        size_t leftRecursionCount() const {
+            return m_leftRecursionCount;
+        }
+
+        /**
+         * Increments the number of left recursions found so far.
+         */
+        void incrementLeftRecursionCount() {
+            ++m_leftRecursionCount;
         }
 
         /**
@@ -293,7 +1052,12 @@ namespace parserlib {
          * @return the current error state.
          */
         ErrorState errorState() const {
-            return { m_errors.size() };
+            if constexpr (ErrorTrackingPolicy::enabled) {
+                return { m_errors.size() };
+            }
+            else {
+                return { 0 };
+            }
         }
 
         /**
@@ -301,14 +1065,17 @@ namespace parserlib {
          * @param es the error state to set the current error state from.
          */
         void setErrorState(const ErrorState& es) {
-            m_errors.resize(std::max(es.m_errorCount, m_committedErrorCount));
+            if constexpr (ErrorTrackingPolicy::enabled) {
+                m_errors.resize(std::max(es.m_errorCount, m_committedErrorCount));
+            }
         }
 
         /**
          * Returns the current list of errors.
+         * It is always empty if errors are not tracked.
          * @return the current list of errors.
          */
-        const ErrorContainer<PositionType>& errors() const {
+        const ErrorContainerType& errors() const {
             return m_errors;
         }
 
@@ -324,30 +1091,248 @@ namespace parserlib {
          * @param ecf error creation function; it allows the creation of the error message only if needed.
          */
         template <class ErrorCreationFunc> void addError(const PositionType& pos, const ErrorCreationFunc& ecf) {
-            if (m_errors.size() == m_committedErrorCount) {
-                m_errors.push_back(ecf());
+            if constexpr (ErrorTrackingPolicy::enabled) {
+                if (m_errors.size() == m_committedErrorCount) {
+                    m_errors.push_back(ecf());
+                }
+                else if (pos > m_errors.back().position()) {
+                    m_errors.back() = ecf();
+                }
+            }
+        }
+
+        /**
+         * Checks if an error at the given position would be added by `addError`.
+         * It allows skipping parsers that can only fail at the given position, when the error they would add is not needed.
+         * @param pos position of the error.
+         * @return true if an error at the given position would be added, false otherwise or if errors are not tracked.
+         */
+        bool canAddError(const PositionType& pos) const {
+            if constexpr (ErrorTrackingPolicy::enabled) {
+                return m_errors.size() == m_committedErrorCount || pos > m_errors.back().position();
             }
-            else if (pos > m_errors.back().position()) {
-                m_errors.back() = ecf();
+            else {
+                return false;
             }
         }
 
+        /**
+         * Returns the profile of parsing.
+         * It is an empty object if parsing is not instrumented.
+         * @return the profile of parsing.
+         */
+        const ProfileType& profile() const {
+            return m_profile;
+        }
+
+        /**
+         * Returns the profile of parsing, for the instrumentation hooks and for naming rules.
+         * @return the profile of parsing.
+         */
+        ProfileType& profile() {
+            return m_profile;
+        }
+
         /**
          * Commits the current set of errors.
          */
         void commitErrors() {
-            m_committedErrorCount = m_errors.size();
+            if constexpr (ErrorTrackingPolicy::enabled) {
+                m_committedErrorCount = m_errors.size();
+            }
         }
 
     private:
+        static constexpr bool IsRandomAccess = std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<typename SourceType::const_iterator>::iterator_category>;
+
+        //placeholder for the beginning of parsing, for sources that are not random access;
+        //iterators of such sources may keep parts of the source alive
+        struct NoSourceBegin {
+            NoSourceBegin(const typename SourceType::const_iterator&) {
+            }
+        };
+
         PositionType m_sourcePosition;
-        std::vector<MatchType> m_matches;
-        std::map<const RuleType*, RuleStateType> m_ruleStates;
-        ErrorContainer<PositionType> m_errors;
+        std::conditional_t<IsRandomAccess, typename SourceType::const_iterator, NoSourceBegin> m_sourceBegin;
+        typename SourceType::const_iterator m_sourceEnd;
+        Allocator m_allocator;
+        mutable size_t m_examinedOffset{ 0 };
+        MatchContainerType m_matches;
+        std::vector<RuleStateType, typename std::allocator_traits<Allocator>::template rebind_alloc<RuleStateType>> m_ruleStates;
+        size_t m_ruleDepth{ 0 };
+        size_t m_maxRuleDepth{ SIZE_MAX };
+        size_t m_recoveryCount{ 0 };
+        size_t m_maxRecoveryCount{ SIZE_MAX };
+        const std::atomic<bool>* m_cancellationFlag{ nullptr };
+        bool m_forked{ false };
+        bool m_memoization{ false };
+        bool m_examinedSourceTracking{ false };
+        std::map<std::pair<PositionType, size_t>, MemoEntryType> m_memo;
+        size_t m_leftRecursionCount{ 0 };
+        size_t m_cutCount{ 0 };
+        size_t m_treeMatchDepth{ 0 };
+        size_t m_backtrackDepth{ 0 };
+        size_t m_droppedMatchCount{ 0 };
+        size_t m_deliveredMatchCount{ 0 };
+        MatchHandler m_matchHandler;
+        MatchDelivery m_matchDelivery{ MatchDelivery::DropMatches };
+        ErrorContainerType m_errors;
         size_t m_committedErrorCount{ 0 };
+        ProfileType m_profile;
+
+        //creates a match container that uses the given allocator, if the container supports allocators
+        static MatchContainerType makeMatchContainer(const Allocator& allocator) {
+            if constexpr (std::is_constructible_v<MatchContainerType, const Allocator&>) {
+                return MatchContainerType(allocator);
+            }
+            else {
+                return MatchContainerType();
+            }
+        }
+
+        //resets the state of parsing for the current source; the containers keep their memory
+        void resetParseState() {
+            m_matches.clear();
+            m_ruleStates.assign(m_ruleStates.size(), RuleStateType(PositionType(m_sourceEnd, m_sourceEnd)));
+            m_ruleDepth = 0;
+            m_recoveryCount = 0;
+            m_examinedOffset = 0;
+            m_leftRecursionCount = 0;
+            m_cutCount = 0;
+            m_treeMatchDepth = 0;
+            m_backtrackDepth = 0;
+            m_droppedMatchCount = 0;
+            m_deliveredMatchCount = 0;
+            m_errors.clear();
+            m_committedErrorCount = 0;
+        }
+
+        //kept out of line, so as that the check of the rule depth remains small
+        [[noreturn]] void throwParseDepthException() {
+            throw ParseDepthException<ThisType>(*this);
+        }
+
+        //kept out of line, as the exception for the rule depth
+        [[noreturn]] void throwParseCancelledException() {
+            throw ParseCancelledException();
+        }
+
+        //returns the offset of a position from the beginning of parsing
+        size_t sourceOffset(const PositionType& position) const {
+            return static_cast<size_t>(position.iterator() - m_sourceBegin);
+        }
+
+        //checks if the examined offset is tracked
+        bool tracksExaminedSource() const {
+            return m_memoization || m_examinedSourceTracking;
+        }
+
+        //records that the given number of elements from the current position were examined, while memoizing or tracking;
+        //compiles to nothing unless the examined source policy tracks the source
+        void examine(size_t count) const {
+            if constexpr (IsRandomAccess && ExaminedSourcePolicy::enabled) {
+                if (tracksExaminedSource()) {
+                    const size_t offset = sourceOffset(m_sourcePosition) + count;
+                    if (offset > m_examinedOffset) {
+                        m_examinedOffset = offset;
+                    }
+                }
+            }
+        }
+
+        //delivers the matches not delivered yet to the match handler
+        void deliverMatches() {
+            if (!m_matchHandler || m_deliveredMatchCount == m_matches.size()) {
+                return;
+            }
+            deliverMatches(m_matches);
+            if (m_matchDelivery == MatchDelivery::DropMatches) {
+                m_droppedMatchCount += m_matches.size();
+                m_matches.clear();
+                m_deliveredMatchCount = 0;
+            }
+            else {
+                m_deliveredMatchCount = m_matches.size();
+            }
+        }
+
+        //delivers matches of vector
+        template <class Alloc>
+        void deliverMatches(const std::vector<MatchType, Alloc>& matches) const {
+            for (size_t index = m_deliveredMatchCount; index < matches.size(); ++index) {
+                m_matchHandler(matches[index]);
+            }
+        }
+
+        //delivers root matches of flat match tree; all nodes after the delivered ones belong to complete trees
+        void deliverMatches(const FlatMatchTree<SourceType, MatchIdType, PositionType>& matches) const {
+            std::vector<size_t, typename std::allocator_traits<Allocator>::template rebind_alloc<size_t>> roots(m_allocator);
+            for (size_t index = matches.size(); index > m_deliveredMatchCount; index -= matches[index - 1].subtreeSize()) {
+                roots.push_back(index - 1);
+            }
+            for (auto it = roots.rbegin(); it != roots.rend(); ++it) {
+                m_matchHandler(matches.match(*it));
+            }
+        }
+
+        //add match to vector of matches
+        template <class Alloc>
+        static void addMatch(std::vector<MatchType, Alloc>& matches, const MatchIdType& id, const PositionType& begin, const PositionType& end) {
+            matches.push_back(MatchType(id, begin, end));
+        }
+
+        //add match to vector of matches, moving the last matches to its children
+        template <class Alloc>
+        static void addMatch(std::vector<MatchType, Alloc>& matches, const MatchIdType& id, const PositionType& begin, const PositionType& end, size_t childCount) {
+            using ChildContainerType = typename MatchType::ChildContainerType;
+            MatchType m(id, begin, end, ChildContainerType(std::make_move_iterator(matches.end() - childCount), std::make_move_iterator(matches.end()), typename ChildContainerType::allocator_type(matches.get_allocator())));
+            matches.resize(matches.size() - childCount);
+            matches.push_back(std::move(m));
+        }
+
+        //add match to flat match tree
+        static void addMatch(FlatMatchTree<SourceType, MatchIdType, PositionType>& matches, const MatchIdType& id, const PositionType& begin, const PositionType& end) {
+            matches.addMatch(id, begin, end);
+        }
+
+        //moves matches of a fork to the end of a vector of matches
+        template <class Alloc>
+        static void appendMatches(std::vector<MatchType, Alloc>& matches, std::vector<MatchType, Alloc>& forkMatches) {
+            matches.insert(matches.end(), std::make_move_iterator(forkMatches.begin()), std::make_move_iterator(forkMatches.end()));
+        }
+
+        //copies the nodes of a fork to the end of a flat match tree; the links of the nodes are relative, so they remain valid
+        static void appendMatches(FlatMatchTree<SourceType, MatchIdType, PositionType>& matches, const FlatMatchTree<SourceType, MatchIdType, PositionType>& forkMatches) {
+            for (const auto& node : forkMatches) {
+                matches.push_back(node);
+            }
+        }
+
+        //add match to flat match tree, making it the parent of the last nodes
+        static void addMatch(FlatMatchTree<SourceType, MatchIdType, PositionType>& matches, const MatchIdType& id, const PositionType& begin, const PositionType& end, size_t childCount) {
+            matches.addMatch(id, begin, end, childCount);
+        }
     };
 
 
+    /**
+     * Deduction guide for creating a parse context from a source;
+     * it resolves the ambiguity with the constructor from source position.
+     */
+    template <class SourceType> ParseContext(const SourceType&) -> ParseContext<SourceType>;
+
+
+    /**
+     * Parse context type that tracks the source examined by parsers, as required for incremental parsing.
+     * @param SourceType container with source data.
+     * @param MatchIdType id to apply to a match.
+     * @param PositionType type of source position.
+     */
+    template <class SourceType = std::string, class MatchIdType = std::string, class PositionType = SourcePosition<SourceType>>
+    using IncrementalParseContext = ParseContext<SourceType, MatchIdType, PositionType,
+        std::vector<Match<SourceType, MatchIdType, PositionType>>, TrackErrors, NoInstrumentation, std::allocator<char>, TrackExaminedSource>;
+
+
 } //namespace parserlib
 
 
@@ -0,0 +1,70 @@
+#ifndef PARSERLIB_PARSEDEPTHEXCEPTION_HPP
+#define PARSERLIB_PARSEDEPTHEXCEPTION_HPP
+
+
+#include <stdexcept>
+
+
+namespace parserlib {
+
+
+    /**
+     * Exception thrown when a rule is invoked while the max number of nested rule invocations of a parse context are parsing.
+     * It allows parsing deeply nested input to fail cleanly, instead of overflowing the native stack;
+     * such input can be parsed by a bytecode program of the same grammar, which does not use the native stack for nesting.
+     * @param ParseContextType parse context type.
+     */
+    template <class ParseContextType> class ParseDepthException : public std::runtime_error {
+    public:
+        /**
+         * The constructor.
+         * @param pc parse context.
+         */
+        ParseDepthException(ParseContextType& pc)
+            : std::runtime_error("Max rule depth exceeded."), m_parseContext(pc), m_position(pc.sourcePosition()), m_depth(pc.ruleDepth())
+        {
+        }
+
+        /**
+         * Returns the parse context.
+         * @return the parse context.
+         */
+        const ParseContextType& parseContext() const {
+            return m_parseContext;
+        }
+
+        /**
+         * Returns the parse context.
+         * @return the parse context.
+         */
+        ParseContextType& parseContext() {
+            return m_parseContext;
+        }
+
+        /**
+         * Returns the source position at the time the exception was thrown.
+         * @return the source position at the time the exception was thrown.
+         */
+        const typename ParseContextType::PositionType& position() const {
+            return m_position;
+        }
+
+        /**
+         * Returns the number of nested rule invocations that were parsing at the time the exception was thrown.
+         * @return the number of nested rule invocations that were parsing at the time the exception was thrown.
+         */
+        size_t depth() const {
+            return m_depth;
+        }
+
+    private:
+        ParseContextType& m_parseContext;
+        typename ParseContextType::PositionType m_position;
+        size_t m_depth;
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_PARSEDEPTHEXCEPTION_HPP
@@ -0,0 +1,341 @@
+#ifndef PARSERLIB_PARSEPROFILE_HPP
+#define PARSERLIB_PARSEPROFILE_HPP
+
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <ostream>
+#include <algorithm>
+
+
+namespace parserlib {
+
+
+    /**
+     * The profile of parsing with a parse context that uses the ProfileParsing instrumentation policy.
+     *
+     * It contains statistics for each rule, indexed by rule index, and for each choice, by the address of the choice,
+     * and the call tree of rules, with the time spent in each path of the tree.
+     *
+     * The hooks are invoked by rules, choices and the parse context while parsing;
+     * they are not invoked at all if the parse context is not instrumented.
+     */
+    class ParseProfile {
+    public:
+        /**
+         * Clock type.
+         */
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * Duration type.
+         */
+        using Duration = std::chrono::nanoseconds;
+
+        /**
+         * Value of rule indexes that do not refer to a rule.
+         */
+        static constexpr size_t NoRule = SIZE_MAX;
+
+        /**
+         * Statistics of a rule.
+         */
+        struct RuleStatistics {
+            /**
+             * Number of times the rule was invoked, excluding the invocations that found left recursion.
+             */
+            size_t invocations{ 0 };
+
+            /**
+             * Number of successful invocations.
+             */
+            size_t successes{ 0 };
+
+            /**
+             * Number of failed invocations.
+             */
+            size_t failures{ 0 };
+
+            /**
+             * Number of parsed elements that were discarded by backtracking while the rule was the innermost rule.
+             */
+            size_t backtrackedBytes{ 0 };
+
+            /**
+             * Number of iterations of the left recursion continuation loop of the rule.
+             */
+            size_t leftRecursionIterations{ 0 };
+
+            /**
+             * Time spent in the rule, including the rules it invoked; recursive invocations are counted once.
+             */
+            Duration inclusiveTime{ 0 };
+
+            /**
+             * Time spent in the rule, excluding the rules it invoked.
+             */
+            Duration exclusiveTime{ 0 };
+        };
+
+        /**
+         * Statistics of a choice.
+         */
+        struct ChoiceStatistics {
+            /**
+             * The innermost rule when the choice was first invoked, or NoRule.
+             */
+            size_t rule{ NoRule };
+
+            /**
+             * Number of times the choice was invoked.
+             */
+            size_t invocations{ 0 };
+
+            /**
+             * Number of times each alternative parsed successfully.
+             */
+            std::vector<size_t> hits;
+        };
+
+        /**
+         * Returns the statistics of all rules, indexed by rule index.
+         * @return the statistics of all rules.
+         */
+        const std::vector<RuleStatistics>& rules() const {
+            return m_rules;
+        }
+
+        /**
+         * Returns the statistics of a rule.
+         * @param ruleIndex rule index.
+         * @return the statistics of the rule; empty statistics if the rule was not invoked.
+         */
+        RuleStatistics rule(size_t ruleIndex) const {
+            return ruleIndex < m_rules.size() ? m_rules[ruleIndex] : RuleStatistics();
+        }
+
+        /**
+         * Returns the statistics of all choices, by address of the choice.
+         * @return the statistics of all choices.
+         */
+        const std::unordered_map<const void*, ChoiceStatistics>& choices() const {
+            return m_choices;
+        }
+
+        /**
+         * Sets the name of a rule, which is used in reports; by default, rules are named after their index.
+         * @param ruleIndex rule index.
+         * @param name name of the rule.
+         */
+        void setRuleName(size_t ruleIndex, const std::string& name) {
+            m_ruleNames[ruleIndex] = name;
+        }
+
+        /**
+         * Returns the name of a rule.
+         * @param ruleIndex rule index.
+         * @return the name of the rule.
+         */
+        std::string ruleName(size_t ruleIndex) const {
+            const auto it = m_ruleNames.find(ruleIndex);
+            return it != m_ruleNames.end() ? it->second : "rule" + std::to_string(ruleIndex);
+        }
+
+        /**
+         * Returns a report of the statistics of the invoked rules, sorted by exclusive time,
+         * followed by the hit rates of the alternatives of the invoked choices.
+         * @return a report.
+         */
+        std::string report() const {
+            std::vector<size_t> ruleIndexes;
+            for (size_t index = 0; index < m_rules.size(); ++index) {
+                if (m_rules[index].invocations > 0) {
+                    ruleIndexes.push_back(index);
+                }
+            }
+            std::stable_sort(ruleIndexes.begin(), ruleIndexes.end(), [&](size_t a, size_t b) {
+                return m_rules[a].exclusiveTime > m_rules[b].exclusiveTime;
+            });
+
+            std::stringstream stream;
+            stream << "rule\tinvocations\tsuccesses\tfailures\tbacktracked bytes\tleft recursion iterations\tinclusive us\texclusive us\n";
+            for (size_t index : ruleIndexes) {
+                const RuleStatistics& rule = m_rules[index];
+                stream << ruleName(index) << '\t' << rule.invocations << '\t' << rule.successes << '\t' << rule.failures << '\t'
+                    << rule.backtrackedBytes << '\t' << rule.leftRecursionIterations << '\t'
+                    << std::chrono::duration<double, std::micro>(rule.inclusiveTime).count() << '\t'
+                    << std::chrono::duration<double, std::micro>(rule.exclusiveTime).count() << '\n';
+            }
+
+            for (const auto& [choice, statistics] : m_choices) {
+                stream << "choice in " << (statistics.rule != NoRule ? ruleName(statistics.rule) : std::string("<no rule>"))
+                    << ": " << statistics.invocations << " invocations; hits:";
+                for (size_t hits : statistics.hits) {
+                    stream << ' ' << hits << " (" << (100.0 * hits / statistics.invocations) << "%)";
+                }
+                stream << '\n';
+            }
+
+            return stream.str();
+        }
+
+        /**
+         * Writes the call tree of rules in the folded stack format of flame graph tools:
+         * one line per path of rules, with the names of the rules separated by semicolons,
+         * followed by the exclusive time of the path, in nanoseconds.
+         * @param stream the output stream.
+         */
+        void writeFoldedStacks(std::ostream& stream) const {
+            for (size_t nodeIndex = 1; nodeIndex < m_callTree.size(); ++nodeIndex) {
+                const CallNode& node = m_callTree[nodeIndex];
+                if (node.exclusiveTime.count() == 0) {
+                    continue;
+                }
+                std::vector<size_t> path;
+                for (size_t index = nodeIndex; index != 0; index = m_callTree[index].parent) {
+                    path.push_back(m_callTree[index].rule);
+                }
+                for (auto it = path.rbegin(); it != path.rend(); ++it) {
+                    if (it != path.rbegin()) {
+                        stream << ';';
+                    }
+                    stream << ruleName(*it);
+                }
+                stream << ' ' << node.exclusiveTime.count() << '\n';
+            }
+        }
+
+        /**
+         * Hook invoked when a rule starts parsing.
+         * @param ruleIndex rule index.
+         */
+        void enterRule(size_t ruleIndex) {
+            if (ruleIndex >= m_rules.size()) {
+                m_rules.resize(ruleIndex + 1);
+                m_activeCounts.resize(ruleIndex + 1);
+            }
+            const size_t parentNode = m_frames.empty() ? 0 : m_frames.back().node;
+            ++m_activeCounts[ruleIndex];
+            m_frames.push_back(Frame{ ruleIndex, callNode(parentNode, ruleIndex), Clock::now(), Duration(0) });
+        }
+
+        /**
+         * Hook invoked when the rule that started parsing last ends parsing.
+         * @param success the result of parsing.
+         */
+        void exitRule(bool success) {
+            const Frame frame = m_frames.back();
+            m_frames.pop_back();
+
+            const Duration inclusiveTime = std::chrono::duration_cast<Duration>(Clock::now() - frame.start);
+            const Duration exclusiveTime = inclusiveTime - frame.childTime;
+
+            RuleStatistics& rule = m_rules[frame.rule];
+            ++rule.invocations;
+            ++(success ? rule.successes : rule.failures);
+            rule.exclusiveTime += exclusiveTime;
+            if (--m_activeCounts[frame.rule] == 0) {
+                rule.inclusiveTime += inclusiveTime;
+            }
+            m_callTree[frame.node].exclusiveTime += exclusiveTime;
+
+            if (!m_frames.empty()) {
+                m_frames.back().childTime += inclusiveTime;
+            }
+        }
+
+        /**
+         * Hook invoked when parsed elements are discarded by backtracking.
+         * @param count number of elements.
+         */
+        void addBacktrackedBytes(size_t count) {
+            if (!m_frames.empty()) {
+                m_rules[m_frames.back().rule].backtrackedBytes += count;
+            }
+        }
+
+        /**
+         * Hook invoked on each iteration of the left recursion continuation loop of a rule.
+         * @param ruleIndex rule index.
+         */
+        void addLeftRecursionIteration(size_t ruleIndex) {
+            ++m_rules[ruleIndex].leftRecursionIterations;
+        }
+
+        /**
+         * Hook invoked when a choice starts parsing.
+         * @param choice address of the choice.
+         * @param alternativeCount number of alternatives of the choice.
+         */
+        void addChoiceInvocation(const void* choice, size_t alternativeCount) {
+            ChoiceStatistics& statistics = m_choices[choice];
+            if (statistics.invocations == 0) {
+                statistics.rule = m_frames.empty() ? NoRule : m_frames.back().rule;
+                statistics.hits.resize(alternativeCount);
+            }
+            ++statistics.invocations;
+        }
+
+        /**
+         * Hook invoked when an alternative of a choice parses successfully.
+         * @param choice address of the choice.
+         * @param alternative index of the alternative.
+         */
+        void addChoiceHit(const void* choice, size_t alternative) {
+            ++m_choices[choice].hits[alternative];
+        }
+
+    private:
+        //an active rule
+        struct Frame {
+            size_t rule;
+            size_t node;
+            Clock::time_point start;
+            Duration childTime;
+        };
+
+        //a node of the call tree; node 0 is the root, which is not a rule
+        struct CallNode {
+            size_t rule;
+            size_t parent;
+            Duration exclusiveTime{ 0 };
+            std::map<size_t, size_t> children;
+        };
+
+        std::vector<RuleStatistics> m_rules;
+        std::vector<size_t> m_activeCounts;
+        std::unordered_map<const void*, ChoiceStatistics> m_choices;
+        std::map<size_t, std::string> m_ruleNames;
+        std::vector<Frame> m_frames;
+        std::vector<CallNode> m_callTree{ CallNode{ NoRule, 0 } };
+
+        //returns the child node of the call tree for the given rule, creating it if needed
+        size_t callNode(size_t parentNode, size_t ruleIndex) {
+            const auto it = m_callTree[parentNode].children.find(ruleIndex);
+            if (it != m_callTree[parentNode].children.end()) {
+                return it->second;
+            }
+            const size_t node = m_callTree.size();
+            m_callTree.push_back(CallNode{ ruleIndex, parentNode });
+            m_callTree[parentNode].children[ruleIndex] = node;
+            return node;
+        }
+    };
+
+
+    /**
+     * Empty type used in place of a parse profile by parse contexts that are not instrumented.
+     */
+    struct NoParseProfile {
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_PARSEPROFILE_HPP
@@ -5,6 +5,9 @@
 namespace parserlib {
 
 
+    template <class ParseContextType> class ParserVisitor;
+
+
     /**
      * Interface for parsers allocated on the heap.
      * @param ParseContextType type of context to pass to the parse function.
@@ -32,6 +35,12 @@ namespace parserlib {
          * @return true if parsing succeeds, false otherwise.
          */
         virtual bool parseLeftRecursionContinuation(ParseContextType& pc, LeftRecursionContext<ParseContextType>& lrc) const = 0;
+
+        /**
+         * Describes the parser to a visitor.
+         * @param visitor the visitor.
+         */
+        virtual void accept(ParserVisitor<ParseContextType>& visitor) const = 0;
     };
 
 
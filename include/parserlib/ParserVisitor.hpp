@@ -0,0 +1,386 @@
+#ifndef PARSERLIB_PARSERVISITOR_HPP
+#define PARSERLIB_PARSERVISITOR_HPP
+
+
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include "CharacterPredicate.hpp"
+#include "TerminalStringParser.hpp"
+#include "SequenceParser.hpp"
+#include "ChoiceParser.hpp"
+#include "Loop0Parser.hpp"
+#include "Loop1Parser.hpp"
+#include "LoopNParser.hpp"
+#include "OptionalParser.hpp"
+#include "AndParser.hpp"
+#include "NotParser.hpp"
+#include "MatchParser.hpp"
+#include "TreeMatchParser.hpp"
+#include "ErrorParser.hpp"
+#include "EmptyParser.hpp"
+#include "EOFParser.hpp"
+#include "CutParser.hpp"
+#include "RuleReference.hpp"
+
+
+namespace parserlib {
+
+
+    template <class ParseContextType> class Rule;
+
+
+    /**
+     * Interface for visiting the structure of a grammar without knowing the types of its parser nodes.
+     *
+     * Rules erase the type of their parser; in order to allow inspecting it, each rule keeps a function
+     * that describes its parser to a visitor, node by node, via the virtual functions of this class.
+     * Children are passed to the visitor as type-erased nodes, which the visitor may accept in any order,
+     * any number of times, or not at all.
+     *
+     * The description of a parser node is thin, and it does not depend on what the visitor does with it;
+     * therefore tools built on top of visitors, like the bytecode compiler, are instantiated only when used.
+     *
+     * Character predicates over byte-sized sources are described as character sets;
+     * parser nodes unknown to this class are described as opaque parsers.
+     *
+     * @param ParseContextType type of parse context to use for parsing.
+     */
+    template <class ParseContextType> class ParserVisitor {
+    public:
+        /**
+         * Element type of the source.
+         */
+        using ElementType = typename ParseContextType::SourceType::value_type;
+
+        /**
+         * Match id type.
+         */
+        using MatchIdType = typename ParseContextType::MatchIdType;
+
+        /**
+         * Rule type.
+         */
+        using RuleType = Rule<ParseContextType>;
+
+        /**
+         * A parser node whose type is erased.
+         */
+        struct Node {
+            /**
+             * The parser object.
+             */
+            const void* parser;
+
+            /**
+             * The function that describes the parser object to a visitor.
+             */
+            void (*accept)(const void* parser, ParserVisitor& visitor);
+
+            /**
+             * The function that invokes the parser object.
+             */
+            bool (*parse)(const void* parser, ParseContextType& pc);
+
+            /**
+             * Describes the parser object to the given visitor.
+             * @param visitor the visitor.
+             */
+            void operator ()(ParserVisitor& visitor) const {
+                accept(parser, visitor);
+            }
+        };
+
+        /**
+         * The destructor.
+         */
+        virtual ~ParserVisitor() {
+        }
+
+        /**
+         * Creates a type-erased node for the given parser.
+         * @param parser the parser; it must outlive the node.
+         * @return the node.
+         */
+        template <class ParserNodeType> static Node node(const ParserNodeType& parser) {
+            return Node{ std::addressof(parser), &acceptNode<ParserNodeType>, &parseNode<ParserNodeType> };
+        }
+
+        /**
+         * Visits a character predicate, i.e. a terminal, a terminal set, a terminal range, or a choice of them,
+         * over a source of byte-sized elements.
+         * @param node the parser node.
+         * @param set the set of characters the parser accepts.
+         */
+        virtual void visitCharacterSet(const Node& node, const CharacterSet& set) = 0;
+
+        /**
+         * Visits a terminal string whose value type is the element type of the source.
+         * @param node the parser node.
+         * @param string the null-terminated string.
+         * @param foldedString the string folded to lowercase.
+         */
+        virtual void visitString(const Node& node, const ElementType* string, const ElementType* foldedString) = 0;
+
+        /**
+         * Visits a sequence.
+         * @param children the children nodes.
+         * @param count number of children.
+         */
+        virtual void visitSequence(const Node* children, size_t count) = 0;
+
+        /**
+         * Visits a choice that is not a character predicate.
+         * @param children the children nodes.
+         * @param count number of children.
+         */
+        virtual void visitChoice(const Node* children, size_t count) = 0;
+
+        /**
+         * Visits a loop of zero or more iterations.
+         * @param child the child node.
+         * @param set the character set of the child, if the child is a character predicate, otherwise null.
+         */
+        virtual void visitLoop0(const Node& child, const CharacterSet* set) = 0;
+
+        /**
+         * Visits a loop of one or more iterations.
+         * @param child the child node.
+         * @param set the character set of the child, if the child is a character predicate, otherwise null.
+         */
+        virtual void visitLoop1(const Node& child, const CharacterSet* set) = 0;
+
+        /**
+         * Visits a loop with a fixed number of iterations.
+         * @param node the parser node.
+         * @param child the child node.
+         * @param loopCount number of iterations.
+         */
+        virtual void visitLoopN(const Node& node, const Node& child, size_t loopCount) = 0;
+
+        /**
+         * Visits an optional parser.
+         * @param child the child node.
+         */
+        virtual void visitOptional(const Node& child) = 0;
+
+        /**
+         * Visits a logical and predicate.
+         * @param child the child node.
+         */
+        virtual void visitAnd(const Node& child) = 0;
+
+        /**
+         * Visits a logical not predicate.
+         * @param child the child node.
+         */
+        virtual void visitNot(const Node& child) = 0;
+
+        /**
+         * Visits a match parser.
+         * @param child the child node.
+         * @param matchId the match id.
+         */
+        virtual void visitMatch(const Node& child, const MatchIdType& matchId) = 0;
+
+        /**
+         * Visits a tree match parser.
+         * @param child the child node.
+         * @param matchId the match id.
+         */
+        virtual void visitTreeMatch(const Node& child, const MatchIdType& matchId) = 0;
+
+        /**
+         * Visits an error parser.
+         * @param node the parser node.
+         * @param lhs the node that is parsed first.
+         * @param rhs the node that recovers from errors of the left-hand-side node.
+         */
+        virtual void visitErrorParser(const Node& node, const Node& lhs, const Node& rhs) = 0;
+
+        /**
+         * Visits the empty parser.
+         */
+        virtual void visitEmpty() = 0;
+
+        /**
+         * Visits the end-of-source parser.
+         */
+        virtual void visitEndOfSource() = 0;
+
+        /**
+         * Visits a cut.
+         */
+        virtual void visitCut() = 0;
+
+        /**
+         * Visits a reference to a rule.
+         * @param rule the rule.
+         */
+        virtual void visitRule(const RuleType& rule) = 0;
+
+        /**
+         * Visits a parser that is opaque to visitors, e.g. a terminal over a source of wide elements,
+         * or a parser node type unknown to this class.
+         * @param node the parser node.
+         * @param nullable true if the parser may succeed without consuming input.
+         */
+        virtual void visitParser(const Node& node, bool nullable) = 0;
+
+    private:
+        //the parser is a single character predicate over a byte-sized source
+        template <class ParserNodeType> static constexpr bool isCharacterSetParser() {
+            return CharacterPredicate<ParserNodeType>::value && sizeof(ElementType) == 1;
+        }
+
+        //describes a type-erased parser node to the visitor
+        template <class ParserNodeType> static void acceptNode(const void* parser, ParserVisitor& visitor) {
+            accept(*static_cast<const ParserNodeType*>(parser), visitor);
+        }
+
+        //invokes a type-erased parser node
+        template <class ParserNodeType> static bool parseNode(const void* parser, ParseContextType& pc) {
+            return (*static_cast<const ParserNodeType*>(parser))(pc);
+        }
+
+        //returns the character set of a parser, or null if it is not a character predicate
+        template <class ParserNodeType> static const CharacterSet* characterSet(const ParserNodeType& parser, CharacterSet& set) {
+            if constexpr (isCharacterSetParser<ParserNodeType>()) {
+                CharacterPredicate<ParserNodeType>::addTo(parser, set);
+                return &set;
+            }
+            else {
+                return nullptr;
+            }
+        }
+
+        //accept parser; dispatches on the node type
+        template <class ParserNodeType> static void accept(const ParserNodeType& parser, ParserVisitor& visitor) {
+            if constexpr (isCharacterSetParser<ParserNodeType>()) {
+                visitor.visitCharacterSet(node(parser), makeCharacterSet(parser));
+            }
+            else {
+                acceptParser(parser, visitor);
+            }
+        }
+
+        //accept a parser that is unknown; it is assumed that it may not consume input
+        template <class ParserNodeType> static void acceptParser(const ParserNodeType& parser, ParserVisitor& visitor) {
+            visitor.visitParser(node(parser), true);
+        }
+
+        //accept terminal over a source of wide elements
+        template <class TerminalValueType> static void acceptParser(const TerminalParser<TerminalValueType>& parser, ParserVisitor& visitor) {
+            visitor.visitParser(node(parser), false);
+        }
+
+        //accept terminal set over a source of wide elements
+        template <class TerminalValueType> static void acceptParser(const TerminalSetParser<TerminalValueType>& parser, ParserVisitor& visitor) {
+            visitor.visitParser(node(parser), false);
+        }
+
+        //accept terminal range over a source of wide elements
+        template <class TerminalValueType> static void acceptParser(const TerminalRangeParser<TerminalValueType>& parser, ParserVisitor& visitor) {
+            visitor.visitParser(node(parser), false);
+        }
+
+        //accept terminal string; strings of other element types are opaque
+        template <class TerminalValueType> static void acceptParser(const TerminalStringParser<TerminalValueType>& parser, ParserVisitor& visitor) {
+            if constexpr (std::is_same_v<TerminalValueType, ElementType>) {
+                visitor.visitString(node(parser), parser.string(), parser.foldedString());
+            }
+            else {
+                visitor.visitParser(node(parser), parser.string()[0] == TerminalValueType());
+            }
+        }
+
+        //accept sequence
+        template <class ...Children> static void acceptParser(const SequenceParser<Children...>& parser, ParserVisitor& visitor) {
+            std::apply([&](const auto&... children) {
+                const Node nodes[] = { node(children)... };
+                visitor.visitSequence(nodes, sizeof...(children));
+                }, parser.children());
+        }
+
+        //accept choice
+        template <class ...Children> static void acceptParser(const ChoiceParser<Children...>& parser, ParserVisitor& visitor) {
+            std::apply([&](const auto&... children) {
+                const Node nodes[] = { node(children)... };
+                visitor.visitChoice(nodes, sizeof...(children));
+                }, parser.children());
+        }
+
+        //accept loop 0
+        template <class ParserNodeType> static void acceptParser(const Loop0Parser<ParserNodeType>& parser, ParserVisitor& visitor) {
+            CharacterSet set;
+            visitor.visitLoop0(node(parser.child()), characterSet(parser.child(), set));
+        }
+
+        //accept loop 1
+        template <class ParserNodeType> static void acceptParser(const Loop1Parser<ParserNodeType>& parser, ParserVisitor& visitor) {
+            CharacterSet set;
+            visitor.visitLoop1(node(parser.child()), characterSet(parser.child(), set));
+        }
+
+        //accept loop n
+        template <class ParserNodeType> static void acceptParser(const LoopNParser<ParserNodeType>& parser, ParserVisitor& visitor) {
+            visitor.visitLoopN(node(parser), node(parser.child()), parser.loopCount());
+        }
+
+        //accept optional
+        template <class ParserNodeType> static void acceptParser(const OptionalParser<ParserNodeType>& parser, ParserVisitor& visitor) {
+            visitor.visitOptional(node(parser.child()));
+        }
+
+        //accept and
+        template <class ParserNodeType> static void acceptParser(const AndParser<ParserNodeType>& parser, ParserVisitor& visitor) {
+            visitor.visitAnd(node(parser.child()));
+        }
+
+        //accept not
+        template <class ParserNodeType> static void acceptParser(const NotParser<ParserNodeType>& parser, ParserVisitor& visitor) {
+            visitor.visitNot(node(parser.child()));
+        }
+
+        //accept match
+        template <class ParserNodeType, class ParserMatchIdType> static void acceptParser(const MatchParser<ParserNodeType, ParserMatchIdType>& parser, ParserVisitor& visitor) {
+            visitor.visitMatch(node(parser.child()), parser.matchId());
+        }
+
+        //accept tree match
+        template <class ParserNodeType, class ParserMatchIdType> static void acceptParser(const TreeMatchParser<ParserNodeType, ParserMatchIdType>& parser, ParserVisitor& visitor) {
+            visitor.visitTreeMatch(node(parser.child()), parser.matchId());
+        }
+
+        //accept error parser
+        template <class LHS, class RHS> static void acceptParser(const ErrorParser<LHS, RHS>& parser, ParserVisitor& visitor) {
+            visitor.visitErrorParser(node(parser), node(parser.lhs()), node(parser.rhs()));
+        }
+
+        //accept empty
+        static void acceptParser(const EmptyParser& parser, ParserVisitor& visitor) {
+            visitor.visitEmpty();
+        }
+
+        //accept eof
+        static void acceptParser(const EOFParser& parser, ParserVisitor& visitor) {
+            visitor.visitEndOfSource();
+        }
+
+        //accept cut
+        static void acceptParser(const CutParser& parser, ParserVisitor& visitor) {
+            visitor.visitCut();
+        }
+
+        //accept rule reference
+        static void acceptParser(const RuleReference<ParseContextType>& parser, ParserVisitor& visitor) {
+            visitor.visitRule(parser.rule());
+        }
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_PARSERVISITOR_HPP
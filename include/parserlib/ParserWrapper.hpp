@@ -52,6 +52,14 @@ namespace parserlib {
             return m_parser.parseLeftRecursionContinuation(pc, lrc);
         }
 
+        /**
+         * Describes the wrapped parser to a visitor.
+         * @param visitor the visitor.
+         */
+        void accept(ParserVisitor<ParseContextType>& visitor) const override {
+            ParserVisitor<ParseContextType>::node(m_parser)(visitor);
+        }
+
     private:
         const ParserNodeType m_parser;
     };
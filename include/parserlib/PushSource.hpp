@@ -0,0 +1,327 @@
+#ifndef PARSERLIB_PUSHSOURCE_HPP
+#define PARSERLIB_PUSHSOURCE_HPP
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <iterator>
+#include "ExaminedSourcePolicy.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * A source whose elements are appended by the application as they become available,
+     * e.g. as they are received from a non-blocking socket.
+     *
+     * Unlike a `StreamSource`, which pulls its elements from a function that blocks until they are read,
+     * a push source never waits for input; it is meant for parsing with `BytecodeMachine::start` and `BytecodeMachine::resume`,
+     * which return `ParseStatus::NeedMoreInput` when the parser needs elements that have not been appended yet.
+     *
+     * Iterators refer to elements by index, therefore appending elements does not invalidate them.
+     * The end iterator does not refer to a fixed index: it is always at the current end of the source,
+     * so as that a parse context, and the source positions it keeps, see the elements appended after its creation.
+     *
+     * The elements are not guaranteed to stay at the same address after an append;
+     * therefore the source is not contiguous, and match contents over it shall be taken from iterators.
+     *
+     * @param Elem element type.
+     */
+    template <class Elem = char> class PushSource {
+    public:
+        /**
+         * Element type.
+         */
+        using value_type = Elem;
+
+        /**
+         * Random access iterator over the elements of the source.
+         */
+        class const_iterator {
+        public:
+            /**
+             * Iterator category.
+             */
+            using iterator_category = std::random_access_iterator_tag;
+
+            /**
+             * Value type.
+             */
+            using value_type = Elem;
+
+            /**
+             * Difference type.
+             */
+            using difference_type = std::ptrdiff_t;
+
+            /**
+             * Pointer type.
+             */
+            using pointer = const Elem*;
+
+            /**
+             * Reference type.
+             */
+            using reference = const Elem&;
+
+            /**
+             * The default constructor; creates an iterator that does not belong to any source.
+             */
+            const_iterator() {
+            }
+
+            /**
+             * Returns the element the iterator points to.
+             * @return the element the iterator points to.
+             */
+            const Elem& operator *() const {
+                return m_source->m_data[index()];
+            }
+
+            /**
+             * Returns a pointer to the element the iterator points to.
+             * @return a pointer to the element the iterator points to.
+             */
+            const Elem* operator ->() const {
+                return &m_source->m_data[index()];
+            }
+
+            /**
+             * Returns the element at the given distance from the iterator.
+             * @param count distance from the iterator.
+             * @return the element at the given distance from the iterator.
+             */
+            const Elem& operator [](difference_type count) const {
+                return m_source->m_data[index() + count];
+            }
+
+            /**
+             * Moves the iterator to the next element.
+             * @return reference to this.
+             */
+            const_iterator& operator ++() {
+                m_index = index() + 1;
+                return *this;
+            }
+
+            /**
+             * Moves the iterator to the next element.
+             * @return the iterator before the increment.
+             */
+            const_iterator operator ++(int) {
+                const_iterator result = *this;
+                ++*this;
+                return result;
+            }
+
+            /**
+             * Moves the iterator to the previous element.
+             * @return reference to this.
+             */
+            const_iterator& operator --() {
+                m_index = index() - 1;
+                return *this;
+            }
+
+            /**
+             * Moves the iterator to the previous element.
+             * @return the iterator before the decrement.
+             */
+            const_iterator operator --(int) {
+                const_iterator result = *this;
+                --*this;
+                return result;
+            }
+
+            /**
+             * Moves the iterator by the given number of elements.
+             * @param count number of elements.
+             * @return reference to this.
+             */
+            const_iterator& operator += (difference_type count) {
+                m_index = index() + count;
+                return *this;
+            }
+
+            /**
+             * Moves the iterator back by the given number of elements.
+             * @param count number of elements.
+             * @return reference to this.
+             */
+            const_iterator& operator -= (difference_type count) {
+                m_index = index() - count;
+                return *this;
+            }
+
+            /**
+             * Returns an iterator moved by the given number of elements.
+             * @param count number of elements.
+             * @return an iterator moved by the given number of elements.
+             */
+            const_iterator operator + (difference_type count) const {
+                return const_iterator(m_source, index() + count);
+            }
+
+            /**
+             * Returns an iterator moved back by the given number of elements.
+             * @param count number of elements.
+             * @return an iterator moved back by the given number of elements.
+             */
+            const_iterator operator - (difference_type count) const {
+                return const_iterator(m_source, index() - count);
+            }
+
+            /**
+             * Returns the distance between two iterators.
+             * @param other the other iterator.
+             * @return the distance between this and the other iterator.
+             */
+            difference_type operator - (const const_iterator& other) const {
+                return static_cast<difference_type>(index()) - static_cast<difference_type>(other.index());
+            }
+
+            /**
+             * Returns the index of the element the iterator points to;
+             * for the end iterator, it is the current size of the source.
+             * @return the index of the element the iterator points to.
+             */
+            size_t index() const {
+                return m_index != End ? m_index : m_source->m_data.size();
+            }
+
+            /**
+             * Checks if the two iterators are equal.
+             * @param other the other iterator to compare this to.
+             * @return true if they are equal, false otherwise.
+             */
+            bool operator == (const const_iterator& other) const {
+                return index() == other.index();
+            }
+
+            /**
+             * Checks if the two iterators are different.
+             * @param other the other iterator to compare this to.
+             * @return true if they are different, false otherwise.
+             */
+            bool operator != (const const_iterator& other) const {
+                return index() != other.index();
+            }
+
+            /**
+             * Checks if this iterator comes before the other iterator.
+             * @param other the other iterator to compare this to.
+             * @return true if the comparison is true, false otherwise.
+             */
+            bool operator < (const const_iterator& other) const {
+                return index() < other.index();
+            }
+
+            /**
+             * Checks if this iterator comes after the other iterator.
+             * @param other the other iterator to compare this to.
+             * @return true if the comparison is true, false otherwise.
+             */
+            bool operator > (const const_iterator& other) const {
+                return index() > other.index();
+            }
+
+            /**
+             * Checks if this iterator comes before or at the other iterator.
+             * @param other the other iterator to compare this to.
+             * @return true if the comparison is true, false otherwise.
+             */
+            bool operator <= (const const_iterator& other) const {
+                return index() <= other.index();
+            }
+
+            /**
+             * Checks if this iterator comes after or at the other iterator.
+             * @param other the other iterator to compare this to.
+             * @return true if the comparison is true, false otherwise.
+             */
+            bool operator >= (const const_iterator& other) const {
+                return index() >= other.index();
+            }
+
+        private:
+            //index of the end iterator, which follows the end of the source as elements are appended
+            static constexpr size_t End = SIZE_MAX;
+
+            const PushSource* m_source{ nullptr };
+            size_t m_index{ End };
+
+            const_iterator(const PushSource* source, size_t index) : m_source(source), m_index(index) {
+            }
+
+            friend PushSource;
+        };
+
+        /**
+         * Iterator type.
+         */
+        using iterator = const_iterator;
+
+        /**
+         * Appends elements to the source.
+         * @param data pointer to the elements to append.
+         * @param size number of elements to append.
+         */
+        void append(const Elem* data, size_t size) {
+            m_data.insert(m_data.end(), data, data + size);
+        }
+
+        /**
+         * Returns the number of elements appended so far.
+         * @return the number of elements appended so far.
+         */
+        size_t size() const {
+            return m_data.size();
+        }
+
+        /**
+         * Checks if no elements have been appended yet.
+         * @return true if the source is empty, false otherwise.
+         */
+        bool empty() const {
+            return m_data.empty();
+        }
+
+        /**
+         * Returns an iterator to the first element.
+         * @return an iterator to the first element.
+         */
+        const_iterator begin() const {
+            return const_iterator(this, 0);
+        }
+
+        /**
+         * Returns the end iterator; it remains at the end of the source when elements are appended.
+         * @return the end iterator.
+         */
+        const_iterator end() const {
+            return const_iterator(this, const_iterator::End);
+        }
+
+    private:
+        std::vector<Elem> m_data;
+    };
+
+
+    /**
+     * Parse contexts over push sources track the examined source by default, as required for resumable parsing.
+     * @param Elem element type.
+     */
+    template <class Elem> struct DefaultExaminedSourcePolicy<PushSource<Elem>> {
+        /**
+         * The default policy.
+         */
+        using type = TrackExaminedSource;
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_PUSHSOURCE_HPP
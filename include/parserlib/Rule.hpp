@@ -3,6 +3,10 @@
 
 
 #include <memory>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
 #include "ParseContext.hpp"
 #include "ParserWrapper.hpp"
 #include "RuleReference.hpp"
@@ -18,6 +22,7 @@
 #include "TreeMatchParser.hpp"
 #include "util.hpp"
 #include "ErrorParser.hpp"
+#include "ParserVisitor.hpp"
 
 
 namespace parserlib {
@@ -25,6 +30,10 @@ namespace parserlib {
 
     /**
      * An interface to a parser that can be recursive.
+     *
+     * A rule is immutable after construction; the state of a rule while parsing is kept in the parse context.
+     * Therefore, the same rules can be used concurrently by multiple threads, each one with its own parse context.
+     *
      * @param ParseContextType type of context to pass to the parse function.
      */
     template <class ParseContextType = ParseContext<>> class Rule {
@@ -42,6 +51,19 @@ namespace parserlib {
         template <class ParserNodeType> 
         Rule(const ParserNode<ParserNodeType>& parser)
             : m_parser(std::make_shared<ParserWrapper<ParseContextType, ParserNodeType>>(static_cast<const ParserNodeType&>(parser)))
+            , m_index(allocateIndex())
+        {
+        }
+
+        /**
+         * The copy constructor.
+         * The new rule shares the parser of the given rule, but it gets its own index,
+         * since it is a different rule with its own state.
+         * @param rule rule to copy.
+         */
+        Rule(const Rule& rule)
+            : m_parser(rule.m_parser)
+            , m_index(allocateIndex())
         {
         }
         
@@ -53,6 +75,14 @@ namespace parserlib {
         Rule(const TerminalType& term) : Rule(terminal(term)) {
         }
 
+        /**
+         * The destructor.
+         * The index of the rule is released, in order to be reused by a rule created later.
+         */
+        ~Rule() {
+            releaseIndex(m_index);
+        }
+
         /**
          * Returns the parser.
          * @return the parser.
@@ -61,6 +91,28 @@ namespace parserlib {
             return m_parser;
         }
 
+        /**
+         * Returns the index of the rule.
+         * Each rule gets a dense index at construction, unique among the rules that exist at the same time,
+         * which parse contexts use to store the rule's state in constant time.
+         * The indexes of destroyed rules are reused; therefore a parse context that memoizes results
+         * shall be reset before parsing with rules created after the destruction of the rules it parsed with.
+         * @return the index of the rule.
+         */
+        size_t index() const {
+            return m_index;
+        }
+
+        /**
+         * Returns the number of rule indexes allocated so far for the parse context type;
+         * it is bounded by the max number of rules that existed at the same time, since indexes are reused.
+         * All rule indexes are less than this value.
+         * @return the number of rule indexes allocated so far.
+         */
+        static size_t ruleCount() {
+            return s_ruleCount;
+        }
+
         /**
          * Returns this ptr.
          * Operator & is reserved for a specific operation of the library.
@@ -112,8 +164,49 @@ namespace parserlib {
                 });
         }
 
+        /**
+         * Describes the parser of the rule to the given visitor.
+         * @param visitor the visitor.
+         */
+        void accept(ParserVisitor<ParseContextType>& visitor) const {
+            m_parser->accept(visitor);
+        }
+
     private:
         const std::shared_ptr<ParserInterface<ParseContextType>> m_parser;
+        const size_t m_index;
+        inline static std::atomic<size_t> s_ruleCount{ 0 };
+
+        //indexes released by destroyed rules
+        struct FreeIndexes {
+            std::mutex mutex;
+            std::vector<size_t> indexes;
+        };
+
+        //constructed on first use, so as that it is destroyed after the rules with static storage duration
+        static FreeIndexes& freeIndexes() {
+            static FreeIndexes freeIndexes;
+            return freeIndexes;
+        }
+
+        //returns a released index, if there is one, otherwise a new index
+        static size_t allocateIndex() {
+            FreeIndexes& table = freeIndexes();
+            std::lock_guard lock(table.mutex);
+            if (!table.indexes.empty()) {
+                const size_t index = table.indexes.back();
+                table.indexes.pop_back();
+                return index;
+            }
+            return s_ruleCount++;
+        }
+
+        //makes an index available to rules created later
+        static void releaseIndex(size_t index) {
+            FreeIndexes& table = freeIndexes();
+            std::lock_guard lock(table.mutex);
+            table.indexes.push_back(index);
+        }
 
         //parse
         template <class LRF> bool parse(ParseContextType& pc, const LRF& lrf) const {
@@ -121,21 +214,87 @@ namespace parserlib {
             RuleStateType& ruleState = pc.ruleState(*this);
 
             //check if there is left recursion
-            if (ruleState.position() == pc.sourcePosition()) {
+            if (ruleState.isAt(pc.sourcePosition())) {
+                pc.incrementLeftRecursionCount();
+                //matches are not final until the left recursion continuation of the rule is parsed
+                pc.incrementBacktrackDepth();
                 return lrf(ruleState);
             }
 
             //no left recursion; proceed with normal parsing
+            if constexpr (ParseContextType::InstrumentationPolicy::enabled) {
+                pc.profile().enterRule(m_index);
+                bool result = false;
+                const ScopeExit exitRule([&]() { pc.profile().exitRule(result); });
+                result = parseMemoized(pc);
+                return result;
+            }
+            else {
+                return parseMemoized(pc);
+            }
+        }
+
+        //parse without left recursion;
+        //if the rule was already invoked at this position, replay the result
+        bool parseMemoized(ParseContextType& pc) const {
+            if (pc.memoization()) {
+                if (const auto* memoEntry = pc.memoEntry(*this)) {
+                    return pc.applyMemoEntry(*memoEntry);
+                }
+
+                const auto startPosition = pc.sourcePosition();
+                const size_t startMatchCount = pc.matches().size();
+                const size_t startLeftRecursionCount = pc.leftRecursionCount();
+                const size_t startCutCount = pc.cutCount();
+                const size_t startDroppedMatchCount = pc.droppedMatchCount();
+
+                //record the extent of the source examined by the rule alone, then merge it into the enclosing extent
+                const size_t startExaminedOffset = pc.examinedOffset();
+                pc.setExaminedOffset(0);
+                const bool result = parseRule(pc);
+                const size_t examinedOffset = pc.examinedOffset();
+                pc.setExaminedOffset(std::max(startExaminedOffset, examinedOffset));
+
+                //the result does not depend on the state of left-recursive rules only if no left recursion was found;
+                //results that include a cut or delivered matches are not memoized
+                if (pc.memoization() && pc.leftRecursionCount() == startLeftRecursionCount && pc.cutCount() == startCutCount && pc.droppedMatchCount() == startDroppedMatchCount) {
+                    pc.addMemoEntry(*this, startPosition, result, startMatchCount, examinedOffset);
+                }
+
+                return result;
+            }
+
+            return parseRule(pc);
+        }
 
+        //parse the rule;
+        //at the end, restore the backtrack depth, which is increased when left recursion is found
+        bool parseRule(ParseContextType& pc) const {
+            const size_t backtrackDepth = pc.backtrackDepth();
+            const bool result = parseRuleState(pc);
+            pc.setBacktrackDepth(backtrackDepth);
+            return result;
+        }
+
+        //parse with a new rule state;
+        //the rule state is retrieved again after invoking other parsers,
+        //since the parse context may relocate rule states when it encounters a new rule
+        bool parseRuleState(ParseContextType& pc) const {
             //keep the current state to later restore it
-            const RuleStateType prevState = ruleState;
+            const RuleStateType prevState = pc.ruleState(*this);
+
+            //parse within the max rule depth
+            pc.incrementRuleDepth();
 
-            //at scope exit, restore the rule state
-            const ScopeExit scopeExitHandler([&]() { ruleState = prevState; });
+            //at scope exit, restore the rule state and the rule depth
+            const ScopeExit scopeExitHandler([&]() {
+                pc.ruleState(*this) = prevState;
+                pc.decrementRuleDepth();
+            });
 
             //initialize the rule state for non-left recursive parsing
-            ruleState.setPosition(pc.sourcePosition());
-            ruleState.setLeftRecursion(false);
+            pc.ruleState(*this).setPosition(pc.sourcePosition());
+            pc.ruleState(*this).setLeftRecursion(false);
 
             //create a left recursion context, if needed later
             LeftRecursionContext<ParseContextType> lrc(pc.sourcePosition(), pc.matches().size());
@@ -151,20 +310,24 @@ namespace parserlib {
             //success
 
             //if left recursion was detected, parse continuation
-            if (ruleState.leftRecursion()) {
-                return parseLeftRecursionContinuation(pc, ruleState, lrc);
+            if (pc.ruleState(*this).leftRecursion()) {
+                return parseLeftRecursionContinuationLoop(pc, lrc);
             }
 
             return true;
         }
 
         //parse left recursion continuation
-        bool parseLeftRecursionContinuation(ParseContextType& pc, RuleStateType& ruleState, LeftRecursionContext<ParseContextType>& lrc) const {
+        bool parseLeftRecursionContinuationLoop(ParseContextType& pc, LeftRecursionContext<ParseContextType>& lrc) const {
             while (!pc.sourceEnded()) {
                 const auto startPosition = pc.sourcePosition();
 
+                if constexpr (ParseContextType::InstrumentationPolicy::enabled) {
+                    pc.profile().addLeftRecursionIteration(m_index);
+                }
+
                 //set the current position so as that more left recursion is found
-                ruleState.setPosition(pc.sourcePosition());
+                pc.ruleState(*this).setPosition(pc.sourcePosition());
 
                 //invoke the parser
                 if (!m_parser->parseLeftRecursionContinuation(pc, lrc)) {
@@ -492,30 +655,30 @@ namespace parserlib {
 
 
     template <class ParseContextType>
-    TreeMatchParser<RuleReference<ParseContextType>, std::string>
+    TreeMatchParser<RuleReference<ParseContextType>, BasicMatchId<char>>
         operator >= (const Rule<ParseContextType>& rule, const char* matchId) {
-        return TreeMatchParser<RuleReference<ParseContextType>, std::string>(RuleReference<ParseContextType>(rule), matchId);
+        return TreeMatchParser<RuleReference<ParseContextType>, BasicMatchId<char>>(RuleReference<ParseContextType>(rule), matchId);
     }
 
 
     template <class ParseContextType>
-    TreeMatchParser<RuleReference<ParseContextType>, std::wstring>
+    TreeMatchParser<RuleReference<ParseContextType>, BasicMatchId<wchar_t>>
         operator >= (const Rule<ParseContextType>& rule, const wchar_t* matchId) {
-        return TreeMatchParser<RuleReference<ParseContextType>, std::wstring>(RuleReference<ParseContextType>(rule), matchId);
+        return TreeMatchParser<RuleReference<ParseContextType>, BasicMatchId<wchar_t>>(RuleReference<ParseContextType>(rule), matchId);
     }
 
 
     template <class ParseContextType>
-    TreeMatchParser<RuleReference<ParseContextType>, std::u16string>
+    TreeMatchParser<RuleReference<ParseContextType>, BasicMatchId<char16_t>>
         operator >= (const Rule<ParseContextType>& rule, const char16_t* matchId) {
-        return TreeMatchParser<RuleReference<ParseContextType>, std::u16string>(RuleReference<ParseContextType>(rule), matchId);
+        return TreeMatchParser<RuleReference<ParseContextType>, BasicMatchId<char16_t>>(RuleReference<ParseContextType>(rule), matchId);
     }
 
 
     template <class ParseContextType>
-    TreeMatchParser<RuleReference<ParseContextType>, std::u32string>
+    TreeMatchParser<RuleReference<ParseContextType>, BasicMatchId<char32_t>>
         operator >= (const Rule<ParseContextType>& rule, const char32_t* matchId) {
-        return TreeMatchParser<RuleReference<ParseContextType>, std::u32string>(RuleReference<ParseContextType>(rule), matchId);
+        return TreeMatchParser<RuleReference<ParseContextType>, BasicMatchId<char32_t>>(RuleReference<ParseContextType>(rule), matchId);
     }
 
 
@@ -564,7 +727,33 @@ namespace parserlib {
      */
     template <class ParseContextType, class RHS>
     ErrorParser<RuleReference<ParseContextType>, RHS> operator >> (const Rule<ParseContextType>& lhs, const ErrorRecoveryPoint<RHS>& rhs) {
-        return { RuleReference<ParseContextType>(lhs), rhs.parser() };
+        return { RuleReference<ParseContextType>(lhs), rhs };
+    }
+
+
+    /**
+     * Creates an error recovery point from a rule, with a sync set and a max distance.
+     * @param rule rule to use for error recovery.
+     * @param sync parser node whose FIRST set is the sync set; error recovery invokes the rule only at the elements of the set.
+     * @param maxDistance max number of elements error recovery may skip.
+     * @return an error recovery point.
+     * @exception std::invalid_argument thrown if the FIRST set of the sync parser node is unknown, or if the sync parser node is nullable.
+     */
+    template <class ParseContextType, class SyncParserNodeType>
+    ErrorRecoveryPoint<RuleReference<ParseContextType>> recoveryPoint(const Rule<ParseContextType>& rule, const ParserNode<SyncParserNodeType>& sync, size_t maxDistance = SIZE_MAX) {
+        return { RuleReference<ParseContextType>(rule), makeSyncSet(static_cast<const SyncParserNodeType&>(sync)), maxDistance };
+    }
+
+
+    /**
+     * Creates an error recovery point from a rule, with a max distance.
+     * @param rule rule to use for error recovery.
+     * @param maxDistance max number of elements error recovery may skip.
+     * @return an error recovery point.
+     */
+    template <class ParseContextType>
+    ErrorRecoveryPoint<RuleReference<ParseContextType>> recoveryPoint(const Rule<ParseContextType>& rule, size_t maxDistance) {
+        return { RuleReference<ParseContextType>(rule), maxDistance };
     }
 
 
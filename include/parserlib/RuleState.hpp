@@ -13,6 +13,8 @@ namespace parserlib {
     public:
         /**
          * Constructor.
+         * The rule state has no position until one is set, i.e. until the rule is invoked,
+         * so as that a rule invoked at the initial position is not mistaken for left recursion.
          * @param position initial position.
          */
         RuleState(const typename ParseContextType::PositionType& position = {}) 
@@ -33,6 +35,16 @@ namespace parserlib {
          */
         void setPosition(const typename ParseContextType::PositionType& position) {
             m_position = position;
+            m_hasPosition = true;
+        }
+
+        /**
+         * Checks if the rule is being parsed at the given position.
+         * @param position the position to check.
+         * @return true if a position was set and it is equal to the given one, false otherwise.
+         */
+        bool isAt(const typename ParseContextType::PositionType& position) const {
+            return m_hasPosition && m_position == position;
         }
 
         /**
@@ -53,6 +65,7 @@ namespace parserlib {
 
     private:
         typename ParseContextType::PositionType m_position;
+        bool m_hasPosition{ false };
         bool m_leftRecursion{ false };
     };
 
@@ -0,0 +1,644 @@
+#ifndef PARSERLIB_SERIALIZEDMATCHTREE_HPP
+#define PARSERLIB_SERIALIZEDMATCHTREE_HPP
+
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <stdexcept>
+#include <type_traits>
+#include <iterator>
+#include "FlatMatchTree.hpp"
+#include "MatchId.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * Layout of serialized match trees.
+     *
+     * A serialized match tree is a header, followed by the nodes of the matches in preorder, followed by the string table, if there is one:
+     *  - header: magic "PLMT", version, byte order mark, flags, node count, string count, and the offset of the string table.
+     *  - node: begin offset, end offset, id, and subtree size, i.e. the number of nodes of the subtree that has the node as root.
+     *    The first child of a node is the next node, and the next sibling of a node is after its subtree.
+     *  - string table: the offset and length of each string, followed by the characters of the strings.
+     *
+     * Integers are stored in the byte order of the machine that serialized the tree; the byte order mark allows readers to reject trees of another byte order.
+     * Ids of enumeration and integral types are stored as integers; ids of string types and interned ids are indexes into the string table.
+     */
+    struct SerializedMatchTreeFormat {
+        /**
+         * Magic of serialized match trees.
+         */
+        static constexpr char Magic[4] = { 'P', 'L', 'M', 'T' };
+
+        /**
+         * Version of the format.
+         */
+        static constexpr std::uint32_t Version = 1;
+
+        /**
+         * Byte order mark.
+         */
+        static constexpr std::uint32_t ByteOrderMark = 0x01020304;
+
+        /**
+         * Flag that signifies that ids are indexes into the string table.
+         */
+        static constexpr std::uint32_t StringIds = 1;
+
+        /**
+         * Header.
+         */
+        struct Header {
+            char magic[4];
+            std::uint32_t version;
+            std::uint32_t byteOrderMark;
+            std::uint32_t flags;
+            std::uint64_t nodeCount;
+            std::uint64_t stringCount;
+            std::uint64_t stringTableOffset;
+        };
+
+        /**
+         * Node.
+         */
+        struct Node {
+            std::uint64_t begin;
+            std::uint64_t end;
+            std::uint64_t id;
+            std::uint64_t subtreeSize;
+        };
+
+        /**
+         * Entry of the string table.
+         */
+        struct String {
+            std::uint64_t offset;
+            std::uint64_t length;
+        };
+    };
+
+
+    /**
+     * Trait that tells if a match id type is stored in the string table of serialized match trees.
+     * @param MatchIdType type of match id.
+     */
+    template <class MatchIdType> struct IsStringMatchId : std::false_type {
+    };
+
+
+    /**
+     * Strings are stored in the string table of serialized match trees.
+     * @param CharType character type.
+     * @param Traits character traits.
+     * @param Alloc allocator.
+     */
+    template <class CharType, class Traits, class Alloc> struct IsStringMatchId<std::basic_string<CharType, Traits, Alloc>> : std::true_type {
+    };
+
+
+    /**
+     * The names of interned ids are stored in the string table of serialized match trees.
+     * @param CharType character type.
+     */
+    template <class CharType> struct IsStringMatchId<BasicMatchId<CharType>> : std::true_type {
+    };
+
+
+    /**
+     * Type of ids returned by serialized match trees; ids of string types are returned as string views, other ids as they are.
+     * @param MatchIdType type of match id.
+     */
+    template <class MatchIdType, bool IsString = IsStringMatchId<MatchIdType>::value> struct SerializedMatchId {
+        /**
+         * The id type.
+         */
+        using Type = MatchIdType;
+
+        /**
+         * Size of a character of the id; not used for ids that are not strings.
+         */
+        static constexpr size_t CharSize = 1;
+    };
+
+
+    /**
+     * Ids of string types are returned as string views into the string table.
+     * @param MatchIdType type of match id.
+     */
+    template <class MatchIdType> struct SerializedMatchId<MatchIdType, true> {
+        /**
+         * The id type.
+         */
+        using Type = std::basic_string_view<typename MatchIdType::value_type, typename MatchIdType::traits_type>;
+
+        /**
+         * Size of a character of the id.
+         */
+        static constexpr size_t CharSize = sizeof(typename MatchIdType::value_type);
+
+        /**
+         * Returns the string of an id.
+         * @param id the id.
+         * @return the string of the id.
+         */
+        static Type name(const MatchIdType& id) {
+            return Type(id);
+        }
+    };
+
+
+    /**
+     * Interned ids are returned as string views of their names, into the string table.
+     * @param CharType character type.
+     */
+    template <class CharType> struct SerializedMatchId<BasicMatchId<CharType>, true> {
+        /**
+         * The id type.
+         */
+        using Type = std::basic_string_view<CharType>;
+
+        /**
+         * Size of a character of the id.
+         */
+        static constexpr size_t CharSize = sizeof(CharType);
+
+        /**
+         * Returns the name of an id.
+         * @param id the id.
+         * @return the name of the id.
+         */
+        static Type name(const BasicMatchId<CharType>& id) {
+            return id.name();
+        }
+    };
+
+
+    /**
+     * A read-only view of a serialized match tree, e.g. over a memory-mapped file; the tree is traversed in place, without deserializing it.
+     * The data must outlive the view, and the matches and ids taken from it.
+     * @param MatchIdType type of match id the tree was serialized with; ids of string types are returned as string views into the data.
+     */
+    template <class MatchIdType> class SerializedMatchTree {
+    public:
+        /**
+         * Id type; a string view for string match ids, otherwise the match id type.
+         */
+        using IdType = typename SerializedMatchId<MatchIdType>::Type;
+
+        /**
+         * Value that represents an invalid index.
+         */
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        class Range;
+
+        /**
+         * A reference to a match stored in a serialized tree.
+         */
+        class Match {
+        public:
+            /**
+             * Constructor.
+             * @param tree the tree.
+             * @param index index of the node into the tree.
+             */
+            Match(const SerializedMatchTree& tree, size_t index) : m_tree(&tree), m_index(index) {
+            }
+
+            /**
+             * Returns the index of the node of this match.
+             * @return the index of the node of this match.
+             */
+            size_t index() const {
+                return m_index;
+            }
+
+            /**
+             * Returns the id of the match.
+             * @return the id of the match.
+             */
+            IdType id() const {
+                return m_tree->id(node().id);
+            }
+
+            /**
+             * Returns the offset, from the beginning of the source, the match begins at.
+             * @return the offset the match begins at.
+             */
+            size_t begin() const {
+                return static_cast<size_t>(node().begin);
+            }
+
+            /**
+             * Returns the offset, from the beginning of the source, the match ends at.
+             * @return the offset the match ends at.
+             */
+            size_t end() const {
+                return static_cast<size_t>(node().end);
+            }
+
+            /**
+             * Returns the number of nodes of the subtree that has this match as root, including this match.
+             * @return the number of nodes of the subtree.
+             */
+            size_t subtreeSize() const {
+                return static_cast<size_t>(node().subtreeSize);
+            }
+
+            /**
+             * Returns the children matches.
+             * @return a range over the children matches.
+             */
+            Range children() const {
+                return Range(*m_tree, m_index + 1, m_index + subtreeSize());
+            }
+
+        private:
+            const SerializedMatchTree* m_tree;
+            size_t m_index;
+
+            SerializedMatchTreeFormat::Node node() const {
+                return m_tree->node(m_index);
+            }
+        };
+
+        /**
+         * Iterator over sibling matches.
+         */
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Match;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Match*;
+            using reference = Match;
+
+            /**
+             * Constructor.
+             * @param tree the tree.
+             * @param index index of the current node.
+             */
+            Iterator(const SerializedMatchTree& tree, size_t index) : m_tree(&tree), m_index(index) {
+            }
+
+            /**
+             * Returns the current match.
+             * @return the current match.
+             */
+            Match operator *() const {
+                return { *m_tree, m_index };
+            }
+
+            /**
+             * Moves to the next sibling.
+             * @return reference to this.
+             */
+            Iterator& operator ++() {
+                m_index += static_cast<size_t>(m_tree->node(m_index).subtreeSize);
+                return *this;
+            }
+
+            /**
+             * Moves to the next sibling.
+             * @return the previous iterator.
+             */
+            Iterator operator ++(int) {
+                Iterator result = *this;
+                operator ++();
+                return result;
+            }
+
+            /**
+             * Checks if two iterators are equal.
+             * @param other the other iterator.
+             * @return true if equal, false otherwise.
+             */
+            bool operator == (const Iterator& other) const {
+                return m_index == other.m_index;
+            }
+
+            /**
+             * Checks if two iterators are different.
+             * @param other the other iterator.
+             * @return true if different, false otherwise.
+             */
+            bool operator != (const Iterator& other) const {
+                return m_index != other.m_index;
+            }
+
+        private:
+            const SerializedMatchTree* m_tree;
+            size_t m_index;
+        };
+
+        /**
+         * A range of sibling matches.
+         */
+        class Range {
+        public:
+            /**
+             * Constructor.
+             * @param tree the tree.
+             * @param first index of the first node.
+             * @param last index after the last node of the last subtree.
+             */
+            Range(const SerializedMatchTree& tree, size_t first, size_t last) : m_tree(&tree), m_first(first), m_last(last) {
+            }
+
+            /**
+             * Returns the iterator to the first match.
+             * @return the iterator to the first match.
+             */
+            Iterator begin() const {
+                return { *m_tree, m_first };
+            }
+
+            /**
+             * Returns the end iterator.
+             * @return the end iterator.
+             */
+            Iterator end() const {
+                return { *m_tree, m_last };
+            }
+
+            /**
+             * Checks if the range is empty.
+             * @return true if empty, false otherwise.
+             */
+            bool empty() const {
+                return m_first == m_last;
+            }
+
+            /**
+             * Returns the number of matches in the range; it is linear to the number of matches.
+             * @return the number of matches in the range.
+             */
+            size_t size() const {
+                return static_cast<size_t>(std::distance(begin(), end()));
+            }
+
+        private:
+            const SerializedMatchTree* m_tree;
+            size_t m_first;
+            size_t m_last;
+        };
+
+        /**
+         * Constructor.
+         * The header, the string table and the nodes are validated,
+         * so as that each subtree lies within the subtree of its parent and each string id refers to the string table.
+         * @param data the serialized tree; it does not need to be aligned.
+         * @param size size of the serialized tree, in bytes.
+         * @exception std::runtime_error thrown if the data are not a serialized match tree of the given match id type and of the byte order of the machine.
+         */
+        SerializedMatchTree(const void* data, size_t size)
+            : m_data(static_cast<const char*>(data))
+        {
+            if (size < sizeof(Header)) {
+                throw std::runtime_error("SerializedMatchTree: the data are too small.");
+            }
+            std::memcpy(&m_header, m_data, sizeof(Header));
+            if (std::memcmp(m_header.magic, SerializedMatchTreeFormat::Magic, sizeof(m_header.magic)) != 0 || m_header.version != SerializedMatchTreeFormat::Version) {
+                throw std::runtime_error("SerializedMatchTree: the data are not a serialized match tree of a supported version.");
+            }
+            if (m_header.byteOrderMark != SerializedMatchTreeFormat::ByteOrderMark) {
+                throw std::runtime_error("SerializedMatchTree: the data have a different byte order.");
+            }
+            if (((m_header.flags & SerializedMatchTreeFormat::StringIds) != 0) != IsStringMatchId<MatchIdType>::value) {
+                throw std::runtime_error("SerializedMatchTree: the data have a different match id type.");
+            }
+            const std::uint64_t nodesEnd = sizeof(Header) + m_header.nodeCount * sizeof(Node);
+            if (m_header.nodeCount > size / sizeof(Node) || nodesEnd > m_header.stringTableOffset || m_header.stringTableOffset > size
+                || m_header.stringCount > (size - m_header.stringTableOffset) / sizeof(String)) {
+                throw std::runtime_error("SerializedMatchTree: the data are truncated.");
+            }
+            const std::uint64_t charactersOffset = m_header.stringTableOffset + m_header.stringCount * sizeof(String);
+            for (size_t index = 0; index < m_header.stringCount; ++index) {
+                const String str = string(index);
+                if (str.offset < charactersOffset || str.offset > size || str.length > (size - str.offset) / SerializedMatchId<MatchIdType>::CharSize) {
+                    throw std::runtime_error("SerializedMatchTree: the data are truncated.");
+                }
+            }
+            std::vector<std::uint64_t> subtreeEnds{ m_header.nodeCount };
+            for (size_t index = 0; index < m_header.nodeCount; ++index) {
+                const Node n = node(index);
+                while (subtreeEnds.back() <= index) {
+                    subtreeEnds.pop_back();
+                }
+                if (n.subtreeSize == 0 || n.subtreeSize > subtreeEnds.back() - index) {
+                    throw std::runtime_error("SerializedMatchTree: the data have an invalid subtree size.");
+                }
+                if constexpr (IsStringMatchId<MatchIdType>::value) {
+                    if (n.id >= m_header.stringCount) {
+                        throw std::runtime_error("SerializedMatchTree: the data have an invalid string id.");
+                    }
+                }
+                subtreeEnds.push_back(index + n.subtreeSize);
+            }
+        }
+
+        /**
+         * Returns the number of matches.
+         * @return the number of matches.
+         */
+        size_t size() const {
+            return static_cast<size_t>(m_header.nodeCount);
+        }
+
+        /**
+         * Checks if the tree is empty.
+         * @return true if empty, false otherwise.
+         */
+        bool empty() const {
+            return m_header.nodeCount == 0;
+        }
+
+        /**
+         * Returns the match at the given index; matches are indexed in preorder.
+         * @param index index of match.
+         * @return the match at the given index.
+         */
+        Match match(size_t index) const {
+            return { *this, index };
+        }
+
+        /**
+         * Returns the root matches, i.e. the matches without a parent.
+         * @return a range over the root matches.
+         */
+        Range roots() const {
+            return { *this, 0, size() };
+        }
+
+        /**
+         * Returns the number of strings of the string table.
+         * @return the number of strings.
+         */
+        size_t stringCount() const {
+            return static_cast<size_t>(m_header.stringCount);
+        }
+
+    private:
+        using Header = SerializedMatchTreeFormat::Header;
+        using Node = SerializedMatchTreeFormat::Node;
+        using String = SerializedMatchTreeFormat::String;
+
+        const char* m_data;
+        Header m_header;
+
+        //reads a node; the data may not be aligned
+        Node node(size_t index) const {
+            Node result;
+            std::memcpy(&result, m_data + sizeof(Header) + index * sizeof(Node), sizeof(Node));
+            return result;
+        }
+
+        //reads an entry of the string table
+        String string(size_t index) const {
+            String result;
+            std::memcpy(&result, m_data + m_header.stringTableOffset + index * sizeof(String), sizeof(String));
+            return result;
+        }
+
+        //converts a stored id to the id type
+        IdType id(std::uint64_t value) const {
+            if constexpr (IsStringMatchId<MatchIdType>::value) {
+                const String str = string(static_cast<size_t>(value));
+                return IdType(reinterpret_cast<const typename IdType::value_type*>(m_data + str.offset), static_cast<size_t>(str.length));
+            }
+            else {
+                return static_cast<MatchIdType>(value);
+            }
+        }
+    };
+
+
+    /**
+     * Serializes match trees, in the format described by SerializedMatchTreeFormat.
+     * @param MatchIdType type of match id; an enumeration, an integral type, or a string type.
+     */
+    template <class MatchIdType> class MatchTreeSerializer {
+    public:
+        /**
+         * Serializes the given matches and their children.
+         * @param sourceBegin the beginning of the source; match offsets are relative to it.
+         * @param matches the root matches; a vector of matches, or the roots of a flat match tree.
+         * @return the serialized tree.
+         */
+        template <class Iterator, class MatchRange> static std::vector<char> serialize(const Iterator& sourceBegin, const MatchRange& matches) {
+            MatchTreeSerializer serializer;
+            serializer.m_data.resize(sizeof(Header));
+            for (const auto& match : matches) {
+                serializer.addMatch(sourceBegin, match);
+            }
+            return serializer.finish();
+        }
+
+    private:
+        using Header = SerializedMatchTreeFormat::Header;
+        using Node = SerializedMatchTreeFormat::Node;
+        using String = SerializedMatchTreeFormat::String;
+
+        std::vector<char> m_data;
+        std::uint64_t m_nodeCount{ 0 };
+        std::vector<const MatchIdType*> m_strings;
+        std::map<MatchIdType, std::uint64_t> m_stringIndexes;
+
+        //the default constructor; serializers are created only by the serialize function
+        MatchTreeSerializer() {
+        }
+
+        //returns the value an id is stored as
+        std::uint64_t idValue(const MatchIdType& id) {
+            if constexpr (IsStringMatchId<MatchIdType>::value) {
+                const auto [it, inserted] = m_stringIndexes.emplace(id, m_strings.size());
+                if (inserted) {
+                    m_strings.push_back(&it->first);
+                }
+                return it->second;
+            }
+            else {
+                static_assert(std::is_enum_v<MatchIdType> || std::is_integral_v<MatchIdType>, "Match ids shall be enumerations, integers or strings, in order to be serialized.");
+                return static_cast<std::uint64_t>(id);
+            }
+        }
+
+        //adds a node for the match, then the nodes of its children, then sets the subtree size of the node
+        template <class Iterator, class MatchType> void addMatch(const Iterator& sourceBegin, const MatchType& match) {
+            const size_t offset = m_data.size();
+            const std::uint64_t index = m_nodeCount++;
+            Node node{ static_cast<std::uint64_t>(match.begin().iterator() - sourceBegin), static_cast<std::uint64_t>(match.end().iterator() - sourceBegin), idValue(match.id()), 0 };
+            m_data.resize(offset + sizeof(Node));
+            for (const auto& child : match.children()) {
+                addMatch(sourceBegin, child);
+            }
+            node.subtreeSize = m_nodeCount - index;
+            std::memcpy(m_data.data() + offset, &node, sizeof(Node));
+        }
+
+        //appends the string table, then writes the header
+        std::vector<char> finish() {
+            Header header{};
+            std::memcpy(header.magic, SerializedMatchTreeFormat::Magic, sizeof(header.magic));
+            header.version = SerializedMatchTreeFormat::Version;
+            header.byteOrderMark = SerializedMatchTreeFormat::ByteOrderMark;
+            header.flags = IsStringMatchId<MatchIdType>::value ? SerializedMatchTreeFormat::StringIds : 0;
+            header.nodeCount = m_nodeCount;
+            header.stringCount = m_strings.size();
+            header.stringTableOffset = m_data.size();
+
+            if constexpr (IsStringMatchId<MatchIdType>::value) {
+                using CharType = typename SerializedMatchId<MatchIdType>::Type::value_type;
+                size_t tableOffset = m_data.size();
+                std::uint64_t charactersOffset = tableOffset + m_strings.size() * sizeof(String);
+                m_data.resize(static_cast<size_t>(charactersOffset));
+                for (const MatchIdType* id : m_strings) {
+                    const auto str = SerializedMatchId<MatchIdType>::name(*id);
+                    const String entry{ charactersOffset, str.size() };
+                    std::memcpy(m_data.data() + tableOffset, &entry, sizeof(String));
+                    tableOffset += sizeof(String);
+                    m_data.insert(m_data.end(), reinterpret_cast<const char*>(str.data()), reinterpret_cast<const char*>(str.data() + str.size()));
+                    charactersOffset += str.size() * sizeof(CharType);
+                }
+            }
+
+            std::memcpy(m_data.data(), &header, sizeof(Header));
+            return std::move(m_data);
+        }
+    };
+
+
+    /**
+     * Serializes matches and their children into one array, in the format described by SerializedMatchTreeFormat;
+     * the array can be written to a file, or sent to another process, and read in place with a SerializedMatchTree.
+     * @param source the source the matches were parsed from; match offsets are relative to its beginning.
+     * @param matches the matches of a parse context.
+     * @return the serialized tree.
+     */
+    template <class SourceType, class MatchContainerType> std::vector<char> serializeMatches(const SourceType& source, const MatchContainerType& matches) {
+        using MatchIdType = std::decay_t<decltype(std::declval<const typename MatchContainerType::value_type&>().id())>;
+        return MatchTreeSerializer<MatchIdType>::serialize(source.begin(), matches);
+    }
+
+
+    /**
+     * Serializes the matches of a flat match tree into one array, in the format described by SerializedMatchTreeFormat.
+     * @param source the source the matches were parsed from; match offsets are relative to its beginning.
+     * @param matches the flat match tree of a parse context.
+     * @return the serialized tree.
+     */
+    template <class SourceType, class MatchIdType, class PositionType> std::vector<char> serializeMatches(const SourceType& source, const FlatMatchTree<SourceType, MatchIdType, PositionType>& matches) {
+        return MatchTreeSerializer<MatchIdType>::serialize(source.begin(), matches.roots());
+    }
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_SERIALIZEDMATCHTREE_HPP
@@ -3,8 +3,14 @@
 
 
 #include <cctype>
+#include <cstring>
+#include <iterator>
 #include <vector>
 #include <string>
+#include <utility>
+#include <type_traits>
+#include "CharacterSet.hpp"
+#include "SourceView.hpp"
 
 
 namespace parserlib {
@@ -15,8 +21,18 @@ namespace parserlib {
      * @param SourceType source type.
      * @param CaseSensitive if true, comparison is case sensitive, otherwise case insensitive.
      */
-    template <class SourceType = std::string, bool CaseSensitive = true> class SourcePosition {
+    template <class SourceType_ = std::string, bool CaseSensitive = true> class SourcePosition {
     public:
+        /**
+         * Source type.
+         */
+        using SourceType = SourceType_;
+
+        /**
+         * True if comparison is case sensitive, false otherwise.
+         */
+        static constexpr bool CaseSensitiveComparison = CaseSensitive;
+
         /**
          * The default constructor.
          */
@@ -34,6 +50,19 @@ namespace parserlib {
         {
         }
 
+        /**
+         * Constructor from position and end.
+         * The new position has the state of the given position, but a different end;
+         * it allows parsing a part of a source.
+         * @param pos position to copy the state of.
+         * @param end iterator to the end of the part of the source.
+         */
+        SourcePosition(const SourcePosition& pos, const typename SourceType::const_iterator& end)
+            : m_iterator(pos.m_iterator)
+            , m_end(end)
+        {
+        }
+
         /**
          * Returns the iterator.
          * @return the iterator.
@@ -50,6 +79,17 @@ namespace parserlib {
             return m_end;
         }
 
+        /**
+         * Returns a view of the source from this position, without copying it.
+         * Available only for contiguous sources.
+         * @param length max number of elements of the view; the view ends at the end of the source, if it is reached before.
+         * @return a view of the source from this position.
+         */
+        SourceViewType<SourceType> view(size_t length) const {
+            const size_t remaining = static_cast<size_t>(m_end - m_iterator);
+            return makeSourceView<SourceType>(m_iterator, m_iterator + (length < remaining ? length : remaining));
+        }
+
         /**
          * Compares the current value with the given one.
          * If CaseSensitive is false, then both values are set to lowercase before compared.
@@ -102,6 +142,53 @@ namespace parserlib {
             return false;
         }
 
+        /**
+         * Checks if the current value belongs to the given character set.
+         * If CaseSensitive is false, then the case insensitive table of the set is used.
+         * @param iterator position in source that contains the element to check.
+         * @param set character set.
+         * @return true if within the set, false otherwise.
+         */
+        static bool contains(const typename SourceType::const_iterator& iterator, const CharacterSet& set) {
+            if constexpr (CaseSensitive) {
+                return set.contains(*iterator);
+            }
+            else {
+                return set.containsCaseInsensitive(*iterator);
+            }
+        }
+
+        /**
+         * Returns the number of consecutive elements, from the given position, that belong to the given character set.
+         * If the source is contiguous and its elements are byte-sized, then the elements are scanned in bulk.
+         * @param iterator position in source to start from.
+         * @param end end of source.
+         * @param set character set.
+         * @return number of consecutive elements that belong to the set.
+         */
+        static size_t span(const typename SourceType::const_iterator& iterator, const typename SourceType::const_iterator& end, const CharacterSet& set) {
+            if constexpr (IsContiguousSource<SourceType>::value && sizeof(typename SourceType::value_type) == 1) {
+                if (iterator == end) {
+                    return 0;
+                }
+                const unsigned char* begin = reinterpret_cast<const unsigned char*>(&*iterator);
+                const unsigned char* last = begin + (end - iterator);
+                if constexpr (CaseSensitive) {
+                    return set.span(begin, last);
+                }
+                else {
+                    return set.spanCaseInsensitive(begin, last);
+                }
+            }
+            else {
+                size_t count = 0;
+                for (auto it = iterator; it != end && contains(it, set); ++it) {
+                    ++count;
+                }
+                return count;
+            }
+        }
+
         /**
          * Compares the current value with the given null-terminated string.
          * If CaseSensitive is false, then values are set to lowercase before compared.
@@ -139,6 +226,56 @@ namespace parserlib {
             return true;
         }
 
+        /**
+         * Compares the source from the given position with the given string of known length.
+         * The bounds of the source are checked once, if the source is random access.
+         * If the source is contiguous and its elements are byte-sized, then the elements are compared in bulk:
+         * with `memcmp` if CaseSensitive is true, otherwise folded to lowercase and compared with the lowercase string.
+         * @param iterator position in source to start from.
+         * @param end end of source.
+         * @param str string.
+         * @param foldedStr the string folded to lowercase with the function `foldCharacter`; used if CaseSensitive is false.
+         * @param length length of the string.
+         * @return true if string is present at the given position, false otherwise.
+         */
+        template <class T>
+        static bool contains(const typename SourceType::const_iterator& iterator, const typename SourceType::const_iterator& end, const T* str, const T* foldedStr, size_t length) {
+            if constexpr (std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<typename SourceType::const_iterator>::iterator_category>) {
+                if (static_cast<size_t>(end - iterator) < length) {
+                    return false;
+                }
+                if constexpr (IsContiguousSource<SourceType>::value && sizeof(typename SourceType::value_type) == 1 && sizeof(T) == 1) {
+                    if (length == 0) {
+                        return true;
+                    }
+                    if constexpr (CaseSensitive) {
+                        return std::memcmp(&*iterator, str, length) == 0;
+                    }
+                    else {
+                        return equalCharactersCaseInsensitive(reinterpret_cast<const unsigned char*>(&*iterator), reinterpret_cast<const unsigned char*>(foldedStr), length);
+                    }
+                }
+                else {
+                    auto it = iterator;
+                    for (size_t index = 0; index < length; ++index, ++it) {
+                        if (!contains(it, str[index])) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+            }
+            else {
+                auto it = iterator;
+                for (size_t index = 0; index < length; ++index, ++it) {
+                    if (it == end || !contains(it, str[index])) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        }
+
         /**
          * Compares the current value with the given one.
          * If CaseSensitive is false, then both values are set to lowercase before compared.
@@ -173,6 +310,24 @@ namespace parserlib {
             return contains(m_iterator, values);
         }
 
+        /**
+         * Checks if the current value belongs to the given character set.
+         * @param set character set.
+         * @return true if within the set, false otherwise.
+         */
+        bool contains(const CharacterSet& set) const {
+            return contains(m_iterator, set);
+        }
+
+        /**
+         * Returns the number of consecutive elements, from the current position, that belong to the given character set.
+         * @param set character set.
+         * @return number of consecutive elements that belong to the set.
+         */
+        size_t span(const CharacterSet& set) const {
+            return span(m_iterator, m_end, set);
+        }
+
         /**
          * Compares the current value with the given null-terminated string.
          * If CaseSensitive is false, then values are set to lowercase before compared.
@@ -184,6 +339,18 @@ namespace parserlib {
             return contains(m_iterator, m_end, str);
         }
 
+        /**
+         * Compares the source from the current position with the given string of known length.
+         * @param str string.
+         * @param foldedStr the string folded to lowercase with the function `foldCharacter`; used if CaseSensitive is false.
+         * @param length length of the string.
+         * @return true if string is present at the current position, false otherwise.
+         */
+        template <class T>
+        bool contains(const T* str, const T* foldedStr, size_t length) const {
+            return contains(m_iterator, m_end, str, foldedStr, length);
+        }
+
         /**
          * Increments the position by one place.
          */
@@ -199,6 +366,19 @@ namespace parserlib {
             m_iterator += count;
         }
 
+        /**
+         * Moves the position from one source to another, keeping its place relative to an anchor position:
+         * the position, which is at or after the old anchor, is placed after the new anchor at the same distance.
+         * The elements between the old anchor and the position shall be the same in both sources.
+         * Available only for random access sources.
+         * @param oldAnchor position in the source of this position.
+         * @param newAnchor the corresponding position in the other source.
+         */
+        void rebase(const SourcePosition& oldAnchor, const SourcePosition& newAnchor) {
+            m_iterator = newAnchor.m_iterator + (m_iterator - oldAnchor.m_iterator);
+            m_end = newAnchor.m_end;
+        }
+
         /**
          * Checks if the two positions are equal.
          * @param other the other position to compare this to.
@@ -313,6 +493,32 @@ namespace parserlib {
     };
 
 
+    /**
+     * Trait that tells if a source position type holds the end of the source, i.e. if it provides the function `end()`.
+     * Parse contexts keep the end of the source for position types that do not hold it.
+     * @param PositionType source position type.
+     */
+    template <class PositionType, class = void> struct HasSourceEnd : std::false_type {
+    };
+
+
+    template <class PositionType> struct HasSourceEnd<PositionType, std::void_t<decltype(std::declval<const PositionType&>().end())>> : std::true_type {
+    };
+
+
+    /**
+     * Trait that tells if a source position type compares elements case sensitively,
+     * i.e. if its constant `CaseSensitiveComparison` is true; position types without the constant are case sensitive.
+     * @param PositionType source position type.
+     */
+    template <class PositionType, class = void> struct IsCaseSensitive : std::true_type {
+    };
+
+
+    template <class PositionType> struct IsCaseSensitive<PositionType, std::void_t<decltype(PositionType::CaseSensitiveComparison)>> : std::bool_constant<PositionType::CaseSensitiveComparison> {
+    };
+
+
 } //namespace parserlib
 
 
@@ -0,0 +1,174 @@
+#ifndef PARSERLIB_SOURCEVIEW_HPP
+#define PARSERLIB_SOURCEVIEW_HPP
+
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <array>
+#include <type_traits>
+
+
+namespace parserlib {
+
+
+    /**
+     * Trait that tells if the elements of a source are stored contiguously in memory.
+     * Sources with pointer iterators, strings, string views, vectors and arrays are contiguous.
+     * It can be specialized for other source types.
+     * @param SourceType source type.
+     */
+    template <class SourceType> struct IsContiguousSource : std::is_pointer<typename SourceType::const_iterator> {
+    };
+
+
+    template <class Elem, class Traits, class Alloc> struct IsContiguousSource<std::basic_string<Elem, Traits, Alloc>> : std::true_type {
+    };
+
+
+    template <class Elem, class Traits> struct IsContiguousSource<std::basic_string_view<Elem, Traits>> : std::true_type {
+    };
+
+
+    template <class T, class Alloc> struct IsContiguousSource<std::vector<T, Alloc>> : std::bool_constant<!std::is_same_v<T, bool>> {
+    };
+
+
+    template <class T, size_t N> struct IsContiguousSource<std::array<T, N>> : std::true_type {
+    };
+
+
+    /**
+     * A non-owning view of a contiguous sequence of elements.
+     * Used for the content of matches over sources whose elements are not characters.
+     * @param T element type.
+     */
+    template <class T> class Span {
+    public:
+        /**
+         * Element type.
+         */
+        using value_type = std::remove_cv_t<T>;
+
+        /**
+         * Iterator type.
+         */
+        using iterator = T*;
+
+        /**
+         * Const iterator type.
+         */
+        using const_iterator = T*;
+
+        /**
+         * The default constructor; creates an empty span.
+         */
+        Span() {
+        }
+
+        /**
+         * Constructor from parameters.
+         * @param data pointer to the first element.
+         * @param size number of elements.
+         */
+        Span(T* data, size_t size) : m_data(data), m_size(size) {
+        }
+
+        /**
+         * Returns the pointer to the first element.
+         * @return the pointer to the first element.
+         */
+        T* data() const {
+            return m_data;
+        }
+
+        /**
+         * Returns the number of elements.
+         * @return the number of elements.
+         */
+        size_t size() const {
+            return m_size;
+        }
+
+        /**
+         * Checks if the span is empty.
+         * @return true if the span is empty, false otherwise.
+         */
+        bool empty() const {
+            return m_size == 0;
+        }
+
+        /**
+         * Returns the beginning of the span.
+         * @return the beginning of the span.
+         */
+        T* begin() const {
+            return m_data;
+        }
+
+        /**
+         * Returns the end of the span.
+         * @return the end of the span.
+         */
+        T* end() const {
+            return m_data + m_size;
+        }
+
+        /**
+         * Returns an element.
+         * @param index index of element.
+         * @return the element at the given index.
+         */
+        T& operator [](size_t index) const {
+            return m_data[index];
+        }
+
+    private:
+        T* m_data{ nullptr };
+        size_t m_size{ 0 };
+    };
+
+
+    /**
+     * Trait that tells if a type is a character type, for which a string view is used as source view.
+     * @param T type to check.
+     */
+    template <class T> struct IsCharacterType : std::bool_constant<
+        std::is_same_v<T, char> ||
+        std::is_same_v<T, wchar_t> ||
+        std::is_same_v<T, char16_t> ||
+        std::is_same_v<T, char32_t>>
+    {
+    };
+
+
+    /**
+     * The type of a view of a part of a contiguous source:
+     * a string view for character sources, a span of const elements otherwise.
+     * @param SourceType source type.
+     */
+    template <class SourceType> using SourceViewType = std::conditional_t<
+        IsCharacterType<typename SourceType::value_type>::value,
+        std::basic_string_view<typename SourceType::value_type>,
+        Span<const typename SourceType::value_type>>;
+
+
+    /**
+     * Creates a view of a part of a contiguous source, without copying it.
+     * @param begin the beginning of the part.
+     * @param end the end of the part.
+     * @return a view of the elements between begin and end.
+     */
+    template <class SourceType> SourceViewType<SourceType> makeSourceView(const typename SourceType::const_iterator& begin, const typename SourceType::const_iterator& end) {
+        static_assert(IsContiguousSource<SourceType>::value, "source views require a contiguous source type");
+        const size_t size = static_cast<size_t>(end - begin);
+        return SourceViewType<SourceType>(size > 0 ? std::addressof(*begin) : nullptr, size);
+    }
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_SOURCEVIEW_HPP
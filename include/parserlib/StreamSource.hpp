@@ -0,0 +1,375 @@
+#ifndef PARSERLIB_STREAMSOURCE_HPP
+#define PARSERLIB_STREAMSOURCE_HPP
+
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <iterator>
+#include <istream>
+#include <functional>
+#include <stdexcept>
+
+
+namespace parserlib {
+
+
+    /**
+     * A source that reads its elements on demand, in chunks of fixed size,
+     * from a stream or any other function that produces elements.
+     *
+     * Chunks are reference-counted and linked forward only: an iterator keeps alive its chunk and the chunks after it,
+     * but not the ones before it. Therefore, a chunk is released as soon as no source position refers to it,
+     * i.e. when it is before the current position, the states saved for backtracking by sequences, choices and loops,
+     * the matches, the errors and the memoized results of a parse context.
+     * Memory use is then bounded by the lookahead depth of the grammar, and by the data kept by the parse context,
+     * instead of the size of the input.
+     *
+     * The source itself does not keep any chunk alive; `begin()` can only be invoked while the first chunk is alive.
+     *
+     * @param Elem element type.
+     */
+    template <class Elem = char> class StreamSource {
+    private:
+        struct Chunk;
+        struct Reader;
+
+    public:
+        /**
+         * Element type.
+         */
+        using value_type = Elem;
+
+        /**
+         * Type of function that reads elements; it shall return the number of elements read, or 0 at the end of input.
+         */
+        using ReadFunction = std::function<size_t(Elem* buffer, size_t size)>;
+
+        /**
+         * Default chunk size, in elements.
+         */
+        static constexpr size_t DefaultChunkSize = 65536;
+
+        /**
+         * Forward iterator over the elements of the source; it reads chunks as needed.
+         */
+        class const_iterator {
+        public:
+            /**
+             * Iterator category.
+             */
+            using iterator_category = std::forward_iterator_tag;
+
+            /**
+             * Value type.
+             */
+            using value_type = Elem;
+
+            /**
+             * Difference type.
+             */
+            using difference_type = std::ptrdiff_t;
+
+            /**
+             * Pointer type.
+             */
+            using pointer = const Elem*;
+
+            /**
+             * Reference type.
+             */
+            using reference = const Elem&;
+
+            /**
+             * The default constructor; creates an end iterator.
+             */
+            const_iterator() {
+            }
+
+            /**
+             * Returns the element the iterator points to.
+             * @return the element the iterator points to.
+             */
+            const Elem& operator *() const {
+                return m_chunk->data[m_index];
+            }
+
+            /**
+             * Returns a pointer to the element the iterator points to.
+             * @return a pointer to the element the iterator points to.
+             */
+            const Elem* operator ->() const {
+                return &m_chunk->data[m_index];
+            }
+
+            /**
+             * Moves the iterator to the next element.
+             * @return reference to this.
+             */
+            const_iterator& operator ++() {
+                ++m_index;
+                if (m_index == m_chunk->data.size()) {
+                    nextChunk();
+                }
+                return *this;
+            }
+
+            /**
+             * Moves the iterator to the next element.
+             * @return the iterator before the increment.
+             */
+            const_iterator operator ++(int) {
+                const_iterator result = *this;
+                ++*this;
+                return result;
+            }
+
+            /**
+             * Moves the iterator forward by the given number of elements, or up to the end of the source.
+             * @param count number of elements.
+             * @return reference to this.
+             */
+            const_iterator& operator += (size_t count) {
+                while (count > 0 && m_chunk) {
+                    const size_t available = m_chunk->data.size() - m_index;
+                    if (count < available) {
+                        m_index += count;
+                        break;
+                    }
+                    count -= available;
+                    nextChunk();
+                }
+                return *this;
+            }
+
+            /**
+             * Returns the offset of the element the iterator points to, from the beginning of the source.
+             * @return the offset of the element, or the max value of size_t for an end iterator.
+             */
+            size_t offset() const {
+                return m_chunk ? m_chunk->offset + m_index : static_cast<size_t>(-1);
+            }
+
+            /**
+             * Checks if the two iterators are equal.
+             * @param other the other iterator to compare this to.
+             * @return true if they are equal, false otherwise.
+             */
+            bool operator == (const const_iterator& other) const {
+                return offset() == other.offset();
+            }
+
+            /**
+             * Checks if the two iterators are different.
+             * @param other the other iterator to compare this to.
+             * @return true if they are different, false otherwise.
+             */
+            bool operator != (const const_iterator& other) const {
+                return offset() != other.offset();
+            }
+
+            /**
+             * Checks if this iterator comes before the other iterator.
+             * @param other the other iterator to compare this to.
+             * @return true if the comparison is true, false otherwise.
+             */
+            bool operator < (const const_iterator& other) const {
+                return offset() < other.offset();
+            }
+
+            /**
+             * Checks if this iterator comes after the other iterator.
+             * @param other the other iterator to compare this to.
+             * @return true if the comparison is true, false otherwise.
+             */
+            bool operator > (const const_iterator& other) const {
+                return offset() > other.offset();
+            }
+
+            /**
+             * Checks if this iterator comes before or at the other iterator.
+             * @param other the other iterator to compare this to.
+             * @return true if the comparison is true, false otherwise.
+             */
+            bool operator <= (const const_iterator& other) const {
+                return offset() <= other.offset();
+            }
+
+            /**
+             * Checks if this iterator comes after or at the other iterator.
+             * @param other the other iterator to compare this to.
+             * @return true if the comparison is true, false otherwise.
+             */
+            bool operator >= (const const_iterator& other) const {
+                return offset() >= other.offset();
+            }
+
+        private:
+            std::shared_ptr<Chunk> m_chunk;
+            size_t m_index{ 0 };
+
+            //iterator at the beginning of the given chunk; empty chunks are not created
+            const_iterator(const std::shared_ptr<Chunk>& chunk) : m_chunk(chunk) {
+            }
+
+            //moves to the next chunk, reading it, if not read yet; becomes an end iterator at the end of input
+            void nextChunk() {
+                m_chunk = m_chunk->next();
+                m_index = 0;
+            }
+
+            friend StreamSource;
+        };
+
+        /**
+         * Iterator type.
+         */
+        using iterator = const_iterator;
+
+        /**
+         * Constructor from read function.
+         * @param read function that reads elements.
+         * @param chunkSize number of elements per chunk.
+         */
+        StreamSource(ReadFunction read, size_t chunkSize = DefaultChunkSize)
+            : m_reader(std::make_shared<Reader>(std::move(read), chunkSize > 0 ? chunkSize : 1))
+        {
+        }
+
+        /**
+         * Constructor from stream.
+         * @param stream the stream to read; it must outlive the source and the parse context.
+         * @param chunkSize number of elements per chunk.
+         */
+        StreamSource(std::basic_istream<Elem>& stream, size_t chunkSize = DefaultChunkSize)
+            : StreamSource([&stream](Elem* buffer, size_t size) {
+                stream.read(buffer, static_cast<std::streamsize>(size));
+                return static_cast<size_t>(stream.gcount());
+            }, chunkSize)
+        {
+        }
+
+        /**
+         * Returns an iterator to the first element; the first chunk is read, if not read yet.
+         * @return an iterator to the first element.
+         * @exception std::logic_error thrown if the first chunk has already been released.
+         */
+        const_iterator begin() const {
+            if (!m_reader->started) {
+                m_reader->started = true;
+                std::shared_ptr<Chunk> chunk = Reader::readChunk(m_reader, 0);
+                m_first = chunk;
+                m_empty = !chunk;
+                return const_iterator(chunk);
+            }
+            std::shared_ptr<Chunk> chunk = m_first.lock();
+            if (!chunk && !m_empty) {
+                throw std::logic_error("StreamSource: the beginning of the source has been released.");
+            }
+            return const_iterator(chunk);
+        }
+
+        /**
+         * Returns the end iterator.
+         * @return the end iterator.
+         */
+        const_iterator end() const {
+            return const_iterator();
+        }
+
+        /**
+         * Returns the number of chunks currently in memory.
+         * @return the number of chunks currently in memory.
+         */
+        size_t chunkCount() const {
+            return m_reader->chunkCount;
+        }
+
+        /**
+         * Returns the max number of chunks that were in memory at the same time.
+         * @return the max number of chunks that were in memory at the same time.
+         */
+        size_t maxChunkCount() const {
+            return m_reader->maxChunkCount;
+        }
+
+    private:
+        //reads chunks; shared by the source and the chunks, so as that iterators can read ahead
+        struct Reader {
+            ReadFunction read;
+            size_t chunkSize;
+            bool started{ false };
+            bool ended{ false };
+            size_t chunkCount{ 0 };
+            size_t maxChunkCount{ 0 };
+
+            Reader(ReadFunction&& r, size_t size) : read(std::move(r)), chunkSize(size) {
+            }
+
+            //reads a chunk; returns null at the end of input
+            static std::shared_ptr<Chunk> readChunk(const std::shared_ptr<Reader>& reader, size_t offset) {
+                if (reader->ended) {
+                    return nullptr;
+                }
+                std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>(reader, offset);
+                size_t size = 0;
+                while (size < reader->chunkSize) {
+                    const size_t count = reader->read(chunk->data.data() + size, reader->chunkSize - size);
+                    if (count == 0) {
+                        reader->ended = true;
+                        break;
+                    }
+                    size += count;
+                }
+                if (size == 0) {
+                    return nullptr;
+                }
+                chunk->data.resize(size);
+                return chunk;
+            }
+        };
+
+        //a chunk of elements; it owns the chunks after it
+        struct Chunk {
+            std::shared_ptr<Reader> reader;
+            size_t offset;
+            std::vector<Elem> data;
+            std::shared_ptr<Chunk> nextChunk;
+            bool nextRead{ false };
+
+            Chunk(const std::shared_ptr<Reader>& r, size_t o) : reader(r), offset(o), data(r->chunkSize) {
+                ++reader->chunkCount;
+                if (reader->chunkCount > reader->maxChunkCount) {
+                    reader->maxChunkCount = reader->chunkCount;
+                }
+            }
+
+            //releases the chain of chunks iteratively, in order to avoid deep recursion
+            ~Chunk() {
+                --reader->chunkCount;
+                std::shared_ptr<Chunk> chunk = std::move(nextChunk);
+                while (chunk && chunk.use_count() == 1) {
+                    chunk = std::move(chunk->nextChunk);
+                }
+            }
+
+            //returns the next chunk, reading it if not read yet
+            const std::shared_ptr<Chunk>& next() {
+                if (!nextRead) {
+                    nextChunk = Reader::readChunk(reader, offset + data.size());
+                    nextRead = true;
+                }
+                return nextChunk;
+            }
+        };
+
+        std::shared_ptr<Reader> m_reader;
+        mutable std::weak_ptr<Chunk> m_first;
+        mutable bool m_empty{ false };
+    };
+
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_STREAMSOURCE_HPP
@@ -47,8 +47,7 @@ namespace parserlib {
                 }
                 else {
                     pc.addError(pc.sourcePosition(), [&]() {
-                        return makeError(ErrorType::SyntaxError, pc.sourcePosition(),
-                            toString("Syntax error: expected: ", m_terminalValue, ", found: ", *pc.sourcePosition().iterator())); 
+                        return makeError(ErrorType::SyntaxError, pc.sourcePosition(), m_errorDescription.get([&]() { return toString("Syntax error: expected: ", m_terminalValue); }), pc.sourceEnd(), 1);
                         });
                 }
             }
@@ -69,6 +68,7 @@ namespace parserlib {
     private:
         //the terminal value.
         const TerminalValueType m_terminalValue;
+        ErrorDescription m_errorDescription;
     };
 
 
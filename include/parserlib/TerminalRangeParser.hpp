@@ -56,8 +56,7 @@ namespace parserlib {
                 }
                 else {
                     pc.addError(pc.sourcePosition(), [&]() {
-                        return makeError(ErrorType::SyntaxError, pc.sourcePosition(),
-                            toString("Syntax error: expected one of: ", tokenToString(m_minTerminalValue), "..", tokenToString(m_maxTerminalValue), ", found: ", *pc.sourcePosition().iterator()));
+                        return makeError(ErrorType::SyntaxError, pc.sourcePosition(), m_errorDescription.get([&]() { return toString("Syntax error: expected one of: ", tokenToString(m_minTerminalValue), "..", tokenToString(m_maxTerminalValue)); }), pc.sourceEnd(), 1);
                         });
                 }
             }
@@ -78,6 +77,7 @@ namespace parserlib {
     private:
         const TerminalValueType m_minTerminalValue;
         const TerminalValueType m_maxTerminalValue;
+        ErrorDescription m_errorDescription;
     };
 
 
@@ -3,7 +3,9 @@
 
 
 #include <vector>
+#include <type_traits>
 #include "ParserNode.hpp"
+#include "CharacterSet.hpp"
 #include "util.hpp"
 #include "Error.hpp"
 
@@ -13,6 +15,8 @@ namespace parserlib {
 
     /**
      * A parser that parses a terminal out of a set of possible terminal values.
+     * For byte-sized terminal values, the set is also stored as a 256-bit table,
+     * which is used when the source elements are also byte-sized.
      * @param TerminalValueType value type of the terminal.
      */
     template <class TerminalValueType> class TerminalSetParser 
@@ -24,6 +28,7 @@ namespace parserlib {
          */
         TerminalSetParser(const std::vector<TerminalValueType>& terminalValues)
             : m_terminalValues(terminalValues)
+            , m_characterSet(terminalValues)
         {
         }
 
@@ -42,14 +47,13 @@ namespace parserlib {
          */
         template <class ParseContextType> bool operator ()(ParseContextType& pc) const {
             if (!pc.sourceEnded()) {
-                if (pc.sourcePositionContains(m_terminalValues)) {
+                if (contains(pc)) {
                     pc.incrementSourcePosition();
                     return true;
                 }
                 else {
                     pc.addError(pc.sourcePosition(), [&]() {
-                        return makeError(ErrorType::SyntaxError, pc.sourcePosition(),
-                            toString("Syntax error: expected one of: ", m_terminalValues, ", found: ", *pc.sourcePosition().iterator()));
+                        return makeError(ErrorType::SyntaxError, pc.sourcePosition(), m_errorDescription.get([&]() { return toString("Syntax error: expected one of: ", m_terminalValues); }), pc.sourceEnd(), 1);
                         });
                 }
             }
@@ -68,7 +72,28 @@ namespace parserlib {
         }
 
     private:
+        //the character set is used only for byte-sized values
+        static constexpr bool UseCharacterSet = sizeof(TerminalValueType) == 1;
+
+        //empty type used in place of the character set for non-byte-sized values
+        struct NoCharacterSet {
+            NoCharacterSet(const std::vector<TerminalValueType>&) {
+            }
+        };
+
         std::vector<TerminalValueType> m_terminalValues;
+        std::conditional_t<UseCharacterSet, CharacterSet, NoCharacterSet> m_characterSet;
+        ErrorDescription m_errorDescription;
+
+        //checks if the current source element is within the set
+        template <class ParseContextType> bool contains(const ParseContextType& pc) const {
+            if constexpr (UseCharacterSet && sizeof(typename ParseContextType::SourceType::value_type) == 1) {
+                return pc.sourcePositionContains(m_characterSet);
+            }
+            else {
+                return pc.sourcePositionContains(m_terminalValues);
+            }
+        }
     };
 
 
@@ -6,6 +6,9 @@
 #include "ParserNode.hpp"
 #include "util.hpp"
 #include "Error.hpp"
+#include "SourceView.hpp"
+#include "SourcePosition.hpp"
+#include "CharacterScan.hpp"
 
 
 namespace parserlib {
@@ -13,6 +16,7 @@ namespace parserlib {
 
     /**
      * A parser which parses a null-terminated string of terminal values.
+     * The string is also kept folded to lowercase, for case insensitive source positions to compare the source to it in bulk.
      * @param TerminalValueType type of terminal value stored in the string.
      */
     template <class TerminalValueType> class TerminalStringParser
@@ -22,7 +26,10 @@ namespace parserlib {
          * Constructor.
          * @param string string.
          */
-        TerminalStringParser(const TerminalValueType* string) : m_string(string) {
+        TerminalStringParser(const TerminalValueType* string) : m_string(string), m_foldedString(m_string) {
+            for (TerminalValueType& value : m_foldedString) {
+                value = foldCharacter(value);
+            }
         }
 
         /**
@@ -30,9 +37,17 @@ namespace parserlib {
          * @return the string.
          */
         const TerminalValueType* string() const {
-            return m_string;
+            return m_string.c_str();
+        }
+
+        /**
+         * Returns the string folded to lowercase.
+         * @return the string folded to lowercase.
+         */
+        const TerminalValueType* foldedString() const {
+            return m_foldedString.c_str();
         }
-        
+
         /**
          * Parses the source against the string.
          * @param pc parse context.
@@ -40,14 +55,13 @@ namespace parserlib {
          */
         template <class ParseContextType> bool operator ()(ParseContextType& pc) const {
             if (!pc.sourceEnded()) {
-                if (pc.sourcePositionContains(m_string.c_str())) {
+                if (pc.sourcePositionContains(m_string.c_str(), m_foldedString.c_str(), m_string.size())) {
                     pc.increaseSourcePosition(m_string.size());
                     return true;
                 }
                 else {
                     pc.addError(pc.sourcePosition(), [&]() {
-                        return makeError(ErrorType::SyntaxError, pc.sourcePosition(),
-                            toString("Syntax error: expected: \"", m_string, "\", found: \"", toSubString(pc.sourcePosition().iterator(), pc.sourcePosition().end(), m_string.length()), "\""));
+                        return makeError(ErrorType::SyntaxError, pc.sourcePosition(), m_errorDescription.get([&]() { return toString("Syntax error: expected: \"", m_string, "\""); }), pc.sourceEnd(), HasSourceEnd<typename ParseContextType::PositionType>::value ? m_string.size() : 0, true);
                         });
                 }
             }
@@ -67,6 +81,8 @@ namespace parserlib {
 
     private:
         const std::basic_string<TerminalValueType> m_string;
+        std::basic_string<TerminalValueType> m_foldedString;
+        ErrorDescription m_errorDescription;
     };
 
 
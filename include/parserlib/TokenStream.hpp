@@ -0,0 +1,316 @@
+#ifndef PARSERLIB_TOKENSTREAM_HPP
+#define PARSERLIB_TOKENSTREAM_HPP
+
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <type_traits>
+#include "SourceView.hpp"
+#include "ParseContext.hpp"
+
+
+namespace parserlib {
+
+
+    /**
+     * A token: the id of a match of a lexer grammar, and the part of the character source it was matched from.
+     * Tokens compare to token ids, and therefore terminals of token ids parse tokens.
+     * @param TokenIdType type of token id.
+     */
+    template <class TokenIdType> class Token {
+    public:
+        /**
+         * The default constructor.
+         * No member is initialized.
+         */
+        Token() {
+        }
+
+        /**
+         * Constructor from parameters.
+         * @param id id of the token.
+         * @param offset offset of the token in the character source.
+         * @param length number of characters of the token.
+         */
+        Token(const TokenIdType& id, size_t offset, size_t length)
+            : m_id(id), m_offset(offset), m_length(length)
+        {
+        }
+
+        /**
+         * Returns the id of the token.
+         * @return the id of the token.
+         */
+        const TokenIdType& id() const {
+            return m_id;
+        }
+
+        /**
+         * Returns the offset of the token in the character source.
+         * @return the offset of the token in the character source.
+         */
+        size_t offset() const {
+            return m_offset;
+        }
+
+        /**
+         * Returns the number of characters of the token.
+         * @return the number of characters of the token.
+         */
+        size_t length() const {
+            return m_length;
+        }
+
+        /**
+         * Checks if the id of the token is equal to the given id.
+         * @param id id to compare the id of the token to.
+         * @return true if they are equal, false otherwise.
+         */
+        bool operator == (const TokenIdType& id) const {
+            return m_id == id;
+        }
+
+        /**
+         * Checks if the id of the token is different to the given id.
+         * @param id id to compare the id of the token to.
+         * @return true if they are different, false otherwise.
+         */
+        bool operator != (const TokenIdType& id) const {
+            return m_id != id;
+        }
+
+        /**
+         * Checks if the id of the token comes before the given id.
+         * @param id id to compare the id of the token to.
+         * @return true if the comparison is true, false otherwise.
+         */
+        bool operator < (const TokenIdType& id) const {
+            return m_id < id;
+        }
+
+        /**
+         * Checks if the id of the token comes after the given id.
+         * @param id id to compare the id of the token to.
+         * @return true if the comparison is true, false otherwise.
+         */
+        bool operator > (const TokenIdType& id) const {
+            return m_id > id;
+        }
+
+        /**
+         * Checks if the id of the token comes before or is equal to the given id.
+         * @param id id to compare the id of the token to.
+         * @return true if the comparison is true, false otherwise.
+         */
+        bool operator <= (const TokenIdType& id) const {
+            return m_id <= id;
+        }
+
+        /**
+         * Checks if the id of the token comes after or is equal to the given id.
+         * @param id id to compare the id of the token to.
+         * @return true if the comparison is true, false otherwise.
+         */
+        bool operator >= (const TokenIdType& id) const {
+            return m_id >= id;
+        }
+
+    private:
+        TokenIdType m_id;
+        size_t m_offset;
+        size_t m_length;
+    };
+
+
+    /**
+     * Writes the id of a token to a stream, for error messages; enumerations are written as integers.
+     * @param stream output stream.
+     * @param token token to write.
+     * @return the stream.
+     */
+    template <class Elem, class Traits, class TokenIdType>
+    std::basic_ostream<Elem, Traits>& operator << (std::basic_ostream<Elem, Traits>& stream, const Token<TokenIdType>& token) {
+        if constexpr (std::is_enum_v<TokenIdType>) {
+            stream << static_cast<std::underlying_type_t<TokenIdType>>(token.id());
+        }
+        else {
+            stream << token.id();
+        }
+        return stream;
+    }
+
+
+    /**
+     * A source of tokens, created from the matches of a lexer grammar over a character source.
+     *
+     * A parser grammar parses the tokens with terminals of token ids; since the source is scanned once by the lexer,
+     * backtracking in the parser grammar repeats token comparisons instead of character comparisons.
+     * Positions in the tokens, such as the positions of errors and matches, are mapped back to the character source
+     * with the functions `sourceIterator` and `sourceOffset`.
+     *
+     * @param TokenIdType type of token id.
+     * @param SourceType type of the character source.
+     */
+    template <class TokenIdType, class SourceType = std::string> class TokenStream {
+    public:
+        /**
+         * Token type.
+         */
+        using TokenType = Token<TokenIdType>;
+
+        /**
+         * Element type.
+         */
+        using value_type = TokenType;
+
+        /**
+         * Const iterator type.
+         */
+        using const_iterator = typename std::vector<TokenType>::const_iterator;
+
+        /**
+         * Iterator type; tokens are not modifiable.
+         */
+        using iterator = const_iterator;
+
+        /**
+         * The default constructor; creates an empty token stream.
+         */
+        TokenStream() {
+        }
+
+        /**
+         * Constructor from the top-level matches of a lexer grammar; each match becomes a token.
+         * @param source the character source; it must outlive the token stream.
+         * @param matches the matches of a lexer grammar over the source, in source order.
+         */
+        template <class MatchContainerType>
+        TokenStream(const SourceType& source, const MatchContainerType& matches)
+            : m_sourceBegin(source.begin())
+            , m_sourceSize(source.size())
+        {
+            m_tokens.reserve(matches.size());
+            for (const auto& match : matches) {
+                const size_t offset = static_cast<size_t>(match.begin().iterator() - m_sourceBegin);
+                m_tokens.emplace_back(match.id(), offset, static_cast<size_t>(match.end().iterator() - match.begin().iterator()));
+            }
+        }
+
+        /**
+         * Returns the tokens.
+         * @return the tokens.
+         */
+        const std::vector<TokenType>& tokens() const {
+            return m_tokens;
+        }
+
+        /**
+         * Returns the number of tokens.
+         * @return the number of tokens.
+         */
+        size_t size() const {
+            return m_tokens.size();
+        }
+
+        /**
+         * Checks if there are no tokens.
+         * @return true if there are no tokens, false otherwise.
+         */
+        bool empty() const {
+            return m_tokens.empty();
+        }
+
+        /**
+         * Returns the beginning of the tokens.
+         * @return the beginning of the tokens.
+         */
+        const_iterator begin() const {
+            return m_tokens.begin();
+        }
+
+        /**
+         * Returns the end of the tokens.
+         * @return the end of the tokens.
+         */
+        const_iterator end() const {
+            return m_tokens.end();
+        }
+
+        /**
+         * Returns a token.
+         * @param index index of token.
+         * @return the token at the given index.
+         */
+        const TokenType& operator [](size_t index) const {
+            return m_tokens[index];
+        }
+
+        /**
+         * Returns the offset, in the character source, of the token at the given position.
+         * @param it iterator to a token; if it is the end of the tokens, then the size of the character source is returned.
+         * @return the offset of the token in the character source.
+         */
+        size_t sourceOffset(const const_iterator& it) const {
+            return it != m_tokens.end() ? it->offset() : m_sourceSize;
+        }
+
+        /**
+         * Returns the iterator, to the character source, of the token at the given position.
+         * @param it iterator to a token; if it is the end of the tokens, then the end of the character source is returned.
+         * @return the iterator to the beginning of the token in the character source.
+         */
+        typename SourceType::const_iterator sourceIterator(const const_iterator& it) const {
+            return m_sourceBegin + sourceOffset(it);
+        }
+
+        /**
+         * Returns the iterator, to the character source, of the end of the token before the given position.
+         * @param it iterator to the token after the end of a range of tokens.
+         * @return the iterator to the end of the range in the character source.
+         */
+        typename SourceType::const_iterator sourceEndIterator(const const_iterator& it) const {
+            if (it == m_tokens.begin()) {
+                return m_sourceBegin;
+            }
+            const TokenType& token = *(it - 1);
+            return m_sourceBegin + (token.offset() + token.length());
+        }
+
+    private:
+        typename SourceType::const_iterator m_sourceBegin{};
+        size_t m_sourceSize{ 0 };
+        std::vector<TokenType> m_tokens;
+    };
+
+
+    /**
+     * Token streams are contiguous sources.
+     * @param TokenIdType type of token id.
+     * @param SourceType type of the character source.
+     */
+    template <class TokenIdType, class SourceType> struct IsContiguousSource<TokenStream<TokenIdType, SourceType>> : std::true_type {
+    };
+
+
+    /**
+     * Tokenizes a source: parses it with a lexer grammar, and creates a token stream out of the top-level matches.
+     * The lexer grammar is parsed with a `ParseContext<SourceType, TokenIdType>`; rules of the lexer grammar shall use this parse context type.
+     * @param lexer lexer grammar; it shall add a match for each token, with the token id as the match id.
+     * @param source the character source; it must outlive the token stream.
+     * @param tokens the token stream to create.
+     * @return true if the whole source was tokenized, false otherwise;
+     *  on failure, the stream contains the tokens matched before the failure, and the end of the last one is where tokenizing stopped.
+     */
+    template <class TokenIdType, class SourceType, class LexerType>
+    bool tokenize(const LexerType& lexer, const SourceType& source, TokenStream<TokenIdType, SourceType>& tokens) {
+        ParseContext<SourceType, TokenIdType> pc(source);
+        const bool success = lexer(pc) && pc.sourceEnded();
+        tokens = TokenStream<TokenIdType, SourceType>(source, pc.matches());
+        return success;
+    }
+
+} //namespace parserlib
+
+
+#endif //PARSERLIB_TOKENSTREAM_HPP
@@ -18,7 +18,9 @@ namespace parserlib {
          * The constructor.
          * @param pc parse context.
          */
-        TreeMatchException(ParseContextType& pc) : std::runtime_error("Match tree mismatch."), m_parseContext(pc) {
+        TreeMatchException(ParseContextType& pc)
+            : std::runtime_error("Match tree mismatch."), m_parseContext(pc), m_position(pc.sourcePosition())
+        {
         }
 
         /**
@@ -37,8 +39,27 @@ namespace parserlib {
             return m_parseContext;
         }
 
+        /**
+         * Returns the source position at the time the exception was thrown.
+         * @return the source position at the time the exception was thrown.
+         */
+        const typename ParseContextType::PositionType& position() const {
+            return m_position;
+        }
+
+        /**
+         * Returns a view of the source at the position the exception was thrown, without copying it.
+         * Available only for contiguous sources.
+         * @param length max number of elements of the view.
+         * @return a view of the source at the position the exception was thrown.
+         */
+        auto sourceView(size_t length) const {
+            return m_position.view(length);
+        }
+
     private:
         ParseContextType& m_parseContext;
+        typename ParseContextType::PositionType m_position;
     };
 
 
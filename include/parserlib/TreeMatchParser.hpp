@@ -4,6 +4,8 @@
 
 #include <string>
 #include "ParserNode.hpp"
+#include "MatchId.hpp"
+#include "util.hpp"
 
 
 namespace parserlib {
@@ -81,7 +83,13 @@ namespace parserlib {
         template <class ParseContextType, class PF> bool parse(ParseContextType& pc, const PF& pf) const {
             const auto begin = pc.sourcePosition();
             const size_t beginMatchCount = pc.matches().size();
-            if (pf()) {
+            pc.incrementTreeMatchDepth();
+            bool result;
+            {
+                const ScopeExit scopeExitHandler([&]() { pc.decrementTreeMatchDepth(); });
+                result = pf();
+            }
+            if (result) {
                 const size_t endMatchCount = pc.matches().size();
                 const size_t childMatchCount = endMatchCount - beginMatchCount;
                 pc.addMatch(m_matchId, begin, pc.sourcePosition(), childMatchCount);
@@ -112,9 +120,9 @@ namespace parserlib {
      * @return a match parser.
      */
     template <class ParserNodeType, class CharType>
-    TreeMatchParser<ParserNodeType, std::basic_string<CharType>>
+    TreeMatchParser<ParserNodeType, BasicMatchId<CharType>>
         operator >= (const ParserNode<ParserNodeType>& node, const CharType* matchId) {
-        return TreeMatchParser<ParserNodeType, std::basic_string<CharType>>(static_cast<const ParserNodeType&>(node), matchId);
+        return TreeMatchParser<ParserNodeType, BasicMatchId<CharType>>(static_cast<const ParserNodeType&>(node), matchId);
     }
 
 
@@ -7,6 +7,7 @@
 #include <sstream>
 #include <vector>
 #include <algorithm>
+#include <iterator>
 
 
 namespace parserlib {
@@ -37,20 +38,52 @@ namespace parserlib {
     };
 
 
+    /**
+     * Utility function for loading the contents of a stream as ASCII text.
+     * If the size of the stream is known, the stream is read directly into the result string;
+     * otherwise, e.g. for pipes and for files which report a size of 0, like the ones of /proc, it is read sequentially.
+     * @param strm the stream; it is read from its current position to its end.
+     * @param appendZero appends the '\0' character, optionally.
+     * @return the contents of the stream as a string.
+     */
+    inline std::string loadASCIIStream(std::istream& strm, const bool appendZero = false) {
+        std::string result;
+        const std::streampos begin = strm.tellg();
+        std::streamoff size = -1;
+        if (begin != std::streampos(-1) && strm.seekg(0, std::ios::end)) {
+            size = strm.tellg() - begin;
+            strm.seekg(begin);
+        }
+        strm.clear();
+        if (size > 0) {
+            result.resize(static_cast<size_t>(size));
+            strm.read(&result[0], size);
+            //in text mode, the number of characters read may be less than the file size
+            result.resize(static_cast<size_t>(strm.gcount()));
+        }
+        //read sequentially what remains; it is all of the stream if its size is unknown
+        char buffer[65536];
+        while (strm.read(buffer, sizeof(buffer)) || strm.gcount() > 0) {
+            result.append(buffer, static_cast<size_t>(strm.gcount()));
+        }
+        if (appendZero) {
+            result += '\0';
+        }
+        return result;
+    }
+
+
     /**
      * Utility function for loading an ASCII file.
+     * The file is read directly into the result string, if its size is known.
+     * For large files, a `MappedFileSource` avoids copying the file altogether.
      * @param filename name of the file.
      * @param appendZero appends the '\0' character, optionally.
      * @return the file as a string.
      */
     inline std::string loadASCIIFile(const char* filename, const bool appendZero = false) {
         std::ifstream strm(filename);
-        std::stringstream buffer;
-        buffer << strm.rdbuf();
-        if (appendZero) {
-            buffer << '\0';
-        }
-        return buffer.str();
+        return loadASCIIStream(strm, appendZero);
     }
 
 
@@ -89,8 +122,12 @@ namespace parserlib {
     }
 
 
-    inline std::string toSubString(const std::string::const_iterator& begin, const std::string::const_iterator& end, size_t len) {
-        return std::string(begin, begin + std::min(static_cast<std::ptrdiff_t>(len), std::distance(begin, end)));
+    template <class Iterator>
+    std::basic_string<typename std::iterator_traits<Iterator>::value_type> toSubString(const Iterator& begin, const Iterator& end, size_t len) {
+        Iterator it = begin;
+        for (; len > 0 && it != end; --len, ++it) {
+        }
+        return std::basic_string<typename std::iterator_traits<Iterator>::value_type>(begin, it);
     }
 
 
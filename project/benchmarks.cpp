@@ -0,0 +1,1063 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <thread>
+#include <atomic>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#include "parserlib.hpp"
+#include "parserlib/LineIndex.hpp"
+#include "parserlib/TokenStream.hpp"
+#include "parserlib/ParseArena.hpp"
+#include "parserlib/SerializedMatchTree.hpp"
+#include "parserlib/ParallelChoiceParser.hpp"
+#include "parserlib/PushSource.hpp"
+#include "parserlib/BytecodeCompiler.hpp"
+#include "ebnf/ebnf.hpp"
+
+
+using namespace std;
+using namespace parserlib;
+
+
+//number of allocations made by the program; the global allocation functions are replaced in order to count them
+static std::atomic<size_t> allocationCount{ 0 };
+
+
+//allocates memory for the replaced allocation functions; the alignment is at least the default one
+static void* allocate(std::size_t size, std::size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) noexcept {
+    ++allocationCount;
+    size = size ? size : 1;
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return std::malloc(size);
+    }
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+
+//frees memory allocated by allocate
+static void deallocate(void* ptr) noexcept {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+
+//allocates memory for the replaced throwing allocation functions
+static void* allocateOrThrow(std::size_t size, std::size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    if (void* ptr = allocate(size, alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+
+void* operator new(std::size_t size) {
+    return allocateOrThrow(size);
+}
+
+
+void* operator new[](std::size_t size) {
+    return allocateOrThrow(size);
+}
+
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+
+void operator delete(void* ptr) noexcept {
+    deallocate(ptr);
+}
+
+
+void operator delete[](void* ptr) noexcept {
+    deallocate(ptr);
+}
+
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    deallocate(ptr);
+}
+
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    deallocate(ptr);
+}
+
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    deallocate(ptr);
+}
+
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    deallocate(ptr);
+}
+
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept {
+    deallocate(ptr);
+}
+
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept {
+    deallocate(ptr);
+}
+
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    deallocate(ptr);
+}
+
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    deallocate(ptr);
+}
+
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    deallocate(ptr);
+}
+
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    deallocate(ptr);
+}
+
+
+//runs the given function the given number of times; returns the average duration in microseconds
+template <class F> static double benchmark(size_t count, const F& func) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        func();
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / count;
+}
+
+
+//creates an ebnf grammar with the given number of rules; each rule has nested groups of the given depth
+static std::string createEBNFGrammar(size_t ruleCount, size_t depth) {
+    std::string result;
+    for (size_t i = 0; i < ruleCount; ++i) {
+        result += "rule" + std::to_string(i) + " = ";
+        for (size_t d = 0; d < depth; ++d) {
+            result += "( 'a', [ b ] | { c } , ";
+        }
+        result += "'x'";
+        for (size_t d = 0; d < depth; ++d) {
+            result += " )";
+        }
+        result += " ;\n";
+    }
+    return result;
+}
+
+
+static void benchmark_ebnf() {
+    const std::string source = createEBNFGrammar(100, 3);
+    std::vector<ebnf::Match> matches;
+
+    const double duration = benchmark(20, [&]() {
+        const bool ok = ebnf::parse(source, matches);
+        if (!ok || matches.size() != 100) {
+            throw std::logic_error("benchmark_ebnf: parse failed");
+        }
+    });
+
+    std::cout << "ebnf: " << source.size() << " bytes, " << duration << " us per parse\n";
+}
+
+
+static void benchmark_characterScan() {
+    std::string source;
+    for (size_t i = 0; i < 10000; ++i) {
+        source += "    identifier_" + std::to_string(i) + "_with_a_long_name\n";
+    }
+
+    const auto ws = terminalSet(' ', '\t', '\n', '\r');
+    const auto identifierChar = terminalRange('a', 'z') | terminalRange('A', 'Z') | terminalRange('0', '9') | '_';
+    const auto grammar = *(*ws >> +identifierChar) >> *ws;
+
+    //the string terminal makes the loop children non-character predicates, which are parsed one element at a time
+    const auto referenceGrammar = *(*(ws | "\r\n") >> +(identifierChar | "::")) >> *(ws | "\r\n");
+
+    const double duration = benchmark(20, [&]() {
+        ParseContext<> pc(source);
+        if (!grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_characterScan: parse failed");
+        }
+    });
+
+    const double referenceDuration = benchmark(20, [&]() {
+        ParseContext<> pc(source);
+        if (!referenceGrammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_characterScan: parse failed");
+        }
+    });
+
+    std::cout << "character scan: " << source.size() << " bytes, " << duration << " us per parse (bulk), " << referenceDuration << " us per parse (per element)\n";
+}
+
+
+//parses a keyword-heavy source, for any parse context type
+template <class ParseContextType, class KeywordParserType> static double benchmarkKeywords(const std::string& source, const KeywordParserType& keyword) {
+    const auto ws = *terminalSet(' ', '\n');
+    const auto identifier = +(terminalRange('a', 'z') | terminalRange('A', 'Z') | '_');
+    const auto grammar = *(ws >> (keyword | identifier)) >> ws;
+    return benchmark(20, [&]() {
+        ParseContextType pc(source);
+        if (!grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmarkKeywords: parse failed");
+        }
+    });
+}
+
+
+static void benchmark_keywords() {
+    std::string source;
+    for (size_t i = 0; i < 10000; ++i) {
+        source += i % 2 ? "select_distinct name from people where age order_by name\n" : "SELECT name FROM people WHERE age GROUP_BY name\n";
+    }
+
+    using CaseInsensitiveParseContext = ParseContext<std::string, std::string, SourcePosition<std::string, false>>;
+    const auto choice = terminal("select_distinct") | terminal("select") | terminal("from") | terminal("where") | terminal("order_by") | terminal("group_by");
+    const auto trie = keywords({ "select_distinct", "select", "from", "where", "order_by", "group_by" });
+
+    const double duration = benchmarkKeywords<ParseContext<>>(source, choice);
+    const double caseInsensitiveDuration = benchmarkKeywords<CaseInsensitiveParseContext>(source, choice);
+    const double trieDuration = benchmarkKeywords<ParseContext<>>(source, trie);
+    const double caseInsensitiveTrieDuration = benchmarkKeywords<CaseInsensitiveParseContext>(source, trie);
+
+    std::cout << "keywords: " << source.size() << " bytes, " << duration << " us per parse (choice, case sensitive), " << caseInsensitiveDuration << " us per parse (choice, case insensitive), "
+        << trieDuration << " us per parse (trie, case sensitive), " << caseInsensitiveTrieDuration << " us per parse (trie, case insensitive)\n";
+}
+
+
+static const auto jsonWS = *terminalSet(' ', '\t', '\n', '\r');
+
+
+static const auto jsonString = '"' >> *(terminal('\\') >> terminalRange(' ', '~') | (terminalRange(' ', '~') - '"')) >> '"';
+
+
+static const auto jsonNumber = -terminal('-') >> +terminalRange('0', '9') >> -('.' >> +terminalRange('0', '9'));
+
+
+//json grammar, for any parse context type
+template <class ParseContextType> class JSONGrammar {
+public:
+    JSONGrammar()
+        : value((object >= "object")
+              | (array >= "array")
+              | (jsonString == "string")
+              | (jsonNumber == "number")
+              | (terminal("true") == "true")
+              | (terminal("false") == "false")
+              | (terminal("null") == "null"))
+        , member(jsonString >> jsonWS >> ':' >> jsonWS >> value >> jsonWS)
+        , object('{' >> jsonWS >> -(member >> *(',' >> jsonWS >> member)) >> '}')
+        , array('[' >> jsonWS >> -(value >> jsonWS >> *(',' >> jsonWS >> value >> jsonWS)) >> ']')
+        , grammar(jsonWS >> value >> jsonWS)
+    {
+    }
+
+    const Rule<ParseContextType> value;
+    const Rule<ParseContextType> member;
+    const Rule<ParseContextType> object;
+    const Rule<ParseContextType> array;
+    const Rule<ParseContextType> grammar;
+};
+
+
+//creates a json document with the given number of objects
+static std::string createJSON(size_t objectCount) {
+    std::string result = "[";
+    for (size_t i = 0; i < objectCount; ++i) {
+        if (i > 0) {
+            result += ",";
+        }
+        result += "{\"id\":" + std::to_string(i) + ",\"name\":\"object" + std::to_string(i) + "\",\"value\":-" + std::to_string(i) + ".5,"
+            "\"flags\":[true,false,null],\"child\":{\"a\":[1,2,3],\"b\":\"text\"}}";
+    }
+    result += "]";
+    return result;
+}
+
+
+template <class ParseContextType> static double benchmarkJSON(const std::string& source) {
+    const JSONGrammar<ParseContextType> json;
+    return benchmark(20, [&]() {
+        ParseContextType pc(source);
+        if (!json.grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmarkJSON: parse failed");
+        }
+    });
+}
+
+
+static void benchmark_errorTracking() {
+    using NoErrorsParseContext = ParseContext<std::string, std::string, SourcePosition<>, std::vector<Match<std::string, std::string, SourcePosition<>>>, NoErrors>;
+    const std::string source = createJSON(2000);
+    const double duration = benchmarkJSON<ParseContext<>>(source);
+    const double noErrorsDuration = benchmarkJSON<NoErrorsParseContext>(source);
+    std::cout << "json: " << source.size() << " bytes, " << duration << " us per parse (errors tracked), " << noErrorsDuration << " us per parse (no errors)\n";
+}
+
+
+//parses statements that start with one of four letters, with a choice of four branches that start with different terminals
+template <class ParseContextType> static double benchmarkChoiceDispatch(const std::string& source) {
+    const auto digits = +terminalRange('0', '9');
+    const auto statement = (terminal('a') >> digits) | (terminal('b') >> digits) | (terminal('c') >> digits) | (terminal('d') >> digits);
+    const auto grammar = *(statement >> ';') >> eof();
+    return benchmark(20, [&]() {
+        ParseContextType pc(source);
+        if (!grammar(pc)) {
+            throw std::logic_error("benchmark_choiceDispatch: parse failed");
+        }
+    });
+}
+
+
+//with errors tracked, the first branch that fails past the previous errors is still tried, in order to record its error;
+//therefore branches are skipped mainly without error tracking
+static void benchmark_choiceDispatch() {
+    using NoErrorsParseContext = ParseContext<std::string, std::string, SourcePosition<>, std::vector<Match<std::string, std::string, SourcePosition<>>>, NoErrors>;
+    std::string source;
+    for (size_t index = 0; index < 100000; ++index) {
+        source += "abcd"[index % 4];
+        source += "123;";
+    }
+    const double duration = benchmarkChoiceDispatch<ParseContext<>>(source);
+    const double noErrorsDuration = benchmarkChoiceDispatch<NoErrorsParseContext>(source);
+    std::cout << "choice dispatch: " << source.size() << " bytes, " << duration << " us per parse (errors tracked), " << noErrorsDuration << " us per parse (no errors; branches are skipped mainly without error tracking)\n";
+}
+
+
+//parses the given source the given number of times on each of the given number of threads, with one shared grammar;
+//returns the throughput in megabytes per second
+static double benchmarkConcurrentJSON(const JSONGrammar<ParseContext<>>& json, const std::string& source, size_t threadCount, size_t count) {
+    std::atomic<bool> failed{ false };
+    const double duration = benchmark(1, [&]() {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < threadCount; ++t) {
+            threads.emplace_back([&]() {
+                for (size_t i = 0; i < count; ++i) {
+                    ParseContext<> pc(source);
+                    if (!json.grammar(pc) || !pc.sourceEnded()) {
+                        failed = true;
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    });
+    if (failed) {
+        throw std::logic_error("benchmarkConcurrentJSON: parse failed");
+    }
+    return static_cast<double>(source.size() * threadCount * count) / duration;
+}
+
+
+static void benchmark_concurrentParse() {
+    const JSONGrammar<ParseContext<>> json;
+    const std::string source = createJSON(500);
+    std::cout << "concurrent json: " << source.size() << " bytes;";
+    for (size_t threadCount : { 1, 2, 4, 8 }) {
+        std::cout << " " << benchmarkConcurrentJSON(json, source, threadCount, 20) << " MB/s (" << threadCount << " threads)";
+    }
+    std::cout << "\n";
+}
+
+
+//creates an arithmetic expression with the given number of terms, nested in parentheses every few terms
+static std::string createExpression(size_t termCount) {
+    std::string result;
+    size_t openCount = 0;
+    for (size_t i = 0; i < termCount; ++i) {
+        if (i > 0) {
+            result += i % 2 ? "+" : "*";
+        }
+        if (i % 8 == 0) {
+            result += "(";
+            ++openCount;
+        }
+        result += std::to_string(i % 100);
+        if (i % 8 == 7) {
+            result += ")";
+            --openCount;
+        }
+    }
+    result.append(openCount, ')');
+    return result;
+}
+
+
+//a grammar of small rules, without matches, so as that most of the time is spent invoking rules
+class ExpressionGrammar {
+public:
+    ExpressionGrammar()
+        : digit(terminalRange('0', '9'))
+        , number(+digit)
+        , factor(number | '(' >> expr >> ')')
+        , term(factor >> *('*' >> factor))
+        , expr(term >> *('+' >> term))
+    {
+    }
+
+    const Rule<> digit;
+    const Rule<> number;
+    const Rule<> factor;
+    const Rule<> term;
+    const Rule<> expr;
+};
+
+
+static void benchmark_bytecode() {
+    const JSONGrammar<ParseContext<>> json;
+    const auto jsonProgram = compileBytecode(json.grammar);
+    const std::string jsonSource = createJSON(2000);
+
+    const double jsonDuration = benchmark(20, [&]() {
+        ParseContext<> pc(jsonSource);
+        if (!json.grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_bytecode: parse failed");
+        }
+    });
+
+    const double jsonProgramDuration = benchmark(20, [&]() {
+        ParseContext<> pc(jsonSource);
+        if (!jsonProgram(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_bytecode: parse failed");
+        }
+    });
+
+    const ExpressionGrammar expression;
+    const auto expressionProgram = compileBytecode(expression.expr);
+    const std::string expressionSource = createExpression(100000);
+
+    const double expressionDuration = benchmark(20, [&]() {
+        ParseContext<> pc(expressionSource);
+        if (!expression.expr(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_bytecode: parse failed");
+        }
+    });
+
+    const double expressionProgramDuration = benchmark(20, [&]() {
+        ParseContext<> pc(expressionSource);
+        if (!expressionProgram(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_bytecode: parse failed");
+        }
+    });
+
+    std::cout << "bytecode: json " << jsonDuration << " us per parse (parser nodes), " << jsonProgramDuration << " us per parse (bytecode); "
+        << "expression " << expressionDuration << " us per parse (parser nodes), " << expressionProgramDuration << " us per parse (bytecode)\n";
+}
+
+
+//the measurements of parsing a source
+struct ParseMeasurement {
+    //microseconds per parse
+    double duration;
+
+    //matches per parse, including the children of tree matches
+    size_t matchCount;
+
+    //allocations per parse
+    size_t allocationCount;
+};
+
+
+//counts the matches of a container, including the children of tree matches
+template <class MatchContainerType> static size_t countMatches(const MatchContainerType& matches) {
+    size_t count = 0;
+    for (const auto& match : matches) {
+        count += 1 + countMatches(match.children());
+    }
+    return count;
+}
+
+
+//runs the given parse function the given number of times; the parse function returns the number of matches
+template <class F> static ParseMeasurement measureParse(size_t count, const F& parse) {
+    size_t matchCount = 0;
+    const size_t allocationsBefore = allocationCount;
+    const double duration = benchmark(count, [&]() { matchCount = parse(); });
+    return { duration, matchCount, (allocationCount - allocationsBefore) / count };
+}
+
+
+//prints the throughput of a measurement
+static void report(const std::string& name, size_t sourceSize, const ParseMeasurement& measurement) {
+    std::cout << name << ": " << sourceSize << " bytes, "
+        << sourceSize / measurement.duration << " MB/s, "
+        << measurement.matchCount / measurement.duration << " M matches/s, "
+        << static_cast<double>(measurement.allocationCount) / sourceSize << " allocations per byte\n";
+}
+
+
+//arithmetic expression grammar with left recursion, for any parse context type
+template <class ParseContextType> class ArithmeticGrammar {
+public:
+    ArithmeticGrammar()
+        : number(+terminalRange('0', '9') == "number")
+        , value(number | '(' >> grammar >> ')')
+        , mul((mul >> '*' >> value) >= "mul" | value)
+        , grammar((grammar >> '+' >> mul) >= "add" | mul)
+    {
+    }
+
+    const Rule<ParseContextType> number;
+    const Rule<ParseContextType> value;
+    const Rule<ParseContextType> mul;
+    const Rule<ParseContextType> grammar;
+};
+
+
+//measures parsing the given source with the given grammar and parse context type
+template <template <class> class GrammarType, class ParseContextType> static void benchmarkGrammar(const std::string& name, const std::string& source) {
+    const GrammarType<ParseContextType> grammar;
+    report(name, source.size(), measureParse(5, [&]() {
+        ParseContextType pc(source);
+        if (!grammar.grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmarkGrammar: parse failed");
+        }
+        return countMatches(pc.matches());
+    }));
+}
+
+
+//measures parsing the given source with the given grammar, for each source position type and case mode
+template <template <class> class GrammarType> static void benchmarkSourcePositions(const std::string& name, const std::string& source) {
+    benchmarkGrammar<GrammarType, ParseContext<std::string, std::string, SourcePosition<std::string, true>>>(name + " (source position, case sensitive)", source);
+    benchmarkGrammar<GrammarType, ParseContext<std::string, std::string, SourcePosition<std::string, false>>>(name + " (source position, case insensitive)", source);
+    benchmarkGrammar<GrammarType, ParseContext<std::string, std::string, CompactSourcePosition<std::string, true>>>(name + " (compact, case sensitive)", source);
+    benchmarkGrammar<GrammarType, ParseContext<std::string, std::string, LineCountingSourcePosition<std::string, true>>>(name + " (line counting, case sensitive)", source);
+    benchmarkGrammar<GrammarType, ParseContext<std::string, std::string, LineCountingSourcePosition<std::string, false>>>(name + " (line counting, case insensitive)", source);
+}
+
+
+//measures parsing with the global allocator, against parsing with an arena that is reset between parses
+static void benchmark_arena() {
+    const std::string source = createJSON(20000);
+    const JSONGrammar<ParseContext<>> json;
+    const JSONGrammar<ArenaParseContext<>> arenaJSON;
+
+    report("arena json (global allocator)", source.size(), measureParse(5, [&]() {
+        ParseContext<> pc(source);
+        if (!json.grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_arena: parse failed");
+        }
+        return countMatches(pc.matches());
+    }));
+
+    ParseArena arena;
+    const auto parse = [&]() {
+        arena.reset();
+        ArenaParseContext<> pc(source, &arena);
+        if (!arenaJSON.grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_arena: parse failed");
+        }
+        return countMatches(pc.matches());
+    };
+
+    //the first parse grows the arena
+    parse();
+    report("arena json (arena)", source.size(), measureParse(5, parse));
+}
+
+//measures parsing many small messages with a new parse context for each message, against resetting one parse context
+static void benchmark_reset() {
+    using FlatParseContext = ParseContext<std::string, std::string, SourcePosition<std::string>, FlatMatchTree<std::string, std::string, SourcePosition<std::string>>>;
+
+    std::vector<std::string> messages;
+    size_t size = 0;
+    for (size_t index = 0; index < 1000; ++index) {
+        messages.push_back(createJSON(1 + index % 4));
+        size += messages.back().size();
+    }
+    const JSONGrammar<FlatParseContext> json;
+
+    report("reset json (new context)", size, measureParse(5, [&]() {
+        size_t matchCount = 0;
+        for (const std::string& message : messages) {
+            FlatParseContext pc(message);
+            if (!json.grammar(pc) || !pc.sourceEnded()) {
+                throw std::logic_error("benchmark_reset: parse failed");
+            }
+            matchCount += pc.matches().size();
+        }
+        return matchCount;
+    }));
+
+    FlatParseContext pc(messages[0]);
+    pc.reserve(256);
+    const auto parse = [&]() {
+        size_t matchCount = 0;
+        for (const std::string& message : messages) {
+            pc.reset(message);
+            if (!json.grammar(pc) || !pc.sourceEnded()) {
+                throw std::logic_error("benchmark_reset: parse failed");
+            }
+            matchCount += pc.matches().size();
+        }
+        return matchCount;
+    };
+
+    //the first pass grows the containers to the size of the largest message
+    parse();
+    report("reset json (reset context)", size, measureParse(5, parse));
+}
+
+
+//measures error recovery that skips to the sync set of the recovery point, against error recovery that tries a rule at each position
+static void benchmark_errorRecovery() {
+    std::string source;
+    for (size_t index = 0; index < 20000; ++index) {
+        source += "name" + std::to_string(index) + " = value";
+        if (index % 10 == 0) {
+            source += " ~ this part of the statement is malformed and shall be skipped by error recovery";
+        }
+        source += "; ";
+    }
+
+    const auto ws = *terminal(' ');
+    const auto identifier = +(terminalRange('a', 'z') | terminalRange('0', '9'));
+    const auto assignment = identifier >> ws >> '=' >> ws >> identifier >> ws;
+    const Rule<> end = terminal(';');
+    const auto scanGrammar = *(ws >> ((assignment >> ~terminal(';')) == "statement")) >> ws;
+    const auto ruleGrammar = *(ws >> ((assignment >> ~end) == "statement")) >> ws;
+
+    const auto measure = [&](const std::string& name, const auto& grammar) {
+        report(name, source.size(), measureParse(10, [&]() {
+            ParseContext<> pc(source);
+            if (!grammar(pc) || !pc.sourceEnded() || pc.errors().size() != 2000) {
+                throw std::logic_error("benchmark_errorRecovery: parse failed");
+            }
+            return pc.matches().size();
+        }));
+    };
+    measure("error recovery (rule at each position)", ruleGrammar);
+    measure("error recovery (sync set scan)", scanGrammar);
+}
+
+
+//the grammar of ExpressionGrammar, with a tree match for each rule, as the rules of grammars compiled from ebnf
+class MatchingExpressionGrammar {
+public:
+    MatchingExpressionGrammar()
+        : digit(terminalRange('0', '9') >= "digit")
+        , number(+digit >= "number")
+        , factor((number | '(' >> expr >> ')') >= "factor")
+        , term((factor >> *('*' >> factor)) >= "term")
+        , expr((term >> *('+' >> term)) >= "expr")
+    {
+    }
+
+    const Rule<> digit;
+    const Rule<> number;
+    const Rule<> factor;
+    const Rule<> term;
+    const Rule<> expr;
+};
+
+
+//measures a grammar compiled from ebnf at runtime, against the same grammar written with parser nodes
+static void benchmark_ebnfCompiler() {
+    const std::string grammarSource =
+        "expr = term, { '+', term };\n"
+        "term = factor, { '*', factor };\n"
+        "factor = number | '(', expr, ')';\n"
+        "number = digit+;\n"
+        "digit = '0' | '1' | '2' | '3' | '4' | '5' | '6' | '7' | '8' | '9';\n";
+    const std::string source = createExpression(100000);
+
+    const double compileDuration = benchmark(20, [&]() {
+        ebnf::compile(grammarSource);
+    });
+    const ebnf::Grammar grammar = ebnf::compile(grammarSource);
+    std::cout << "ebnf compiler: " << compileDuration << " us per compile\n";
+
+    report("ebnf compiler expression (compiled grammar)", source.size(), measureParse(10, [&]() {
+        ebnf::GrammarParseContext pc(source);
+        if (!grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_ebnfCompiler: parse failed");
+        }
+        return countMatches(pc.matches());
+    }));
+
+    const MatchingExpressionGrammar expression;
+    report("ebnf compiler expression (parser nodes)", source.size(), measureParse(10, [&]() {
+        ParseContext<> pc(source);
+        if (!expression.expr(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_ebnfCompiler: parse failed");
+        }
+        return countMatches(pc.matches());
+    }));
+}
+
+
+//measures parsing without line counting and locating the objects with a line index, against parsing with line counting
+static void benchmark_lineIndex() {
+    using LineCountingParseContext = ParseContext<std::string, std::string, LineCountingSourcePosition<>>;
+
+    //one object per line
+    const std::string compactSource = createJSON(2000);
+    std::string source;
+    for (const char c : compactSource) {
+        source += c;
+        if (c == ',' && source.size() > 1 && source[source.size() - 2] == '}') {
+            source += '\n';
+        }
+    }
+
+    size_t lineSum = 0;
+    const JSONGrammar<ParseContext<>> json;
+    const double indexDuration = benchmark(20, [&]() {
+        ParseContext<> pc(source);
+        if (!json.grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_lineIndex: parse failed");
+        }
+        const LineIndex<> index(source);
+        for (const auto& object : pc.matches()[0].children()) {
+            lineSum += index.line(object.begin());
+        }
+    });
+
+    const JSONGrammar<LineCountingParseContext> lineCountingJSON;
+    const double lineCountingDuration = benchmark(20, [&]() {
+        LineCountingParseContext pc(source);
+        if (!lineCountingJSON.grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_lineIndex: parse failed");
+        }
+        for (const auto& object : pc.matches()[0].children()) {
+            lineSum -= object.begin().line();
+        }
+    });
+
+    if (lineSum != 0) {
+        throw std::logic_error("benchmark_lineIndex: lines differ");
+    }
+
+    std::cout << "line index: json " << source.size() << " bytes, " << indexDuration << " us per parse and location of objects (line index), "
+        << lineCountingDuration << " us per parse (line counting)\n";
+}
+
+
+//measures parsing with and without a max rule depth
+static void benchmark_maxRuleDepth() {
+    const JSONGrammar<ParseContext<>> json;
+    const std::string source = createJSON(2000);
+    const auto parse = [&](size_t maxRuleDepth) {
+        return benchmark(20, [&]() {
+            ParseContext<> pc(source);
+            pc.setMaxRuleDepth(maxRuleDepth);
+            if (!json.grammar(pc) || !pc.sourceEnded()) {
+                throw std::logic_error("benchmark_maxRuleDepth: parse failed");
+            }
+        });
+    };
+    const double unlimitedDuration = parse(SIZE_MAX);
+    const double limitedDuration = parse(1000);
+    std::cout << "max rule depth: json " << unlimitedDuration << " us per parse (unlimited), " << limitedDuration << " us per parse (max depth 1000)\n";
+}
+
+
+//measures reparsing after a one-character edit, incrementally and from scratch
+static void benchmark_incremental() {
+    const JSONGrammar<ParseContext<>> json;
+    const std::string source = createJSON(2000);
+    const size_t offset = source.find("\"id\":1000") + 5;
+    std::string editedSource = source;
+    editedSource[offset] = '2';
+
+    const double fullDuration = benchmark(20, [&]() {
+        ParseContext<> pc(editedSource);
+        if (!json.grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_incremental: parse failed");
+        }
+    });
+
+    //each iteration edits the source of the previous iteration, alternating between the two sources
+    const JSONGrammar<IncrementalParseContext<>> incrementalJSON;
+    IncrementalParseContext<> pc(source);
+    pc.setMemoization(true);
+    incrementalJSON.grammar(pc);
+    size_t iteration = 0;
+    const double incrementalDuration = benchmark(20, [&]() {
+        pc.applyEdit(++iteration % 2 ? editedSource : source, offset, 1, 1);
+        if (!incrementalJSON.grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_incremental: incremental parse failed");
+        }
+    });
+
+    std::cout << "incremental json: " << source.size() << " bytes, " << incrementalDuration << " us per reparse after a one-character edit, " << fullDuration << " us per full parse\n";
+}
+
+
+static void benchmark_throughput() {
+    const std::string ebnfSource = createEBNFGrammar(100, 3);
+    std::vector<ebnf::Match> ebnfMatches;
+    report("throughput ebnf (line counting, case sensitive)", ebnfSource.size(), measureParse(5, [&]() {
+        if (!ebnf::parse(ebnfSource, ebnfMatches)) {
+            throw std::logic_error("benchmark_throughput: parse failed");
+        }
+        return countMatches(ebnfMatches);
+    }));
+
+    benchmarkSourcePositions<JSONGrammar>("throughput json", createJSON(20000));
+    benchmarkSourcePositions<ArithmeticGrammar>("throughput arithmetic", createExpression(200000));
+}
+
+
+enum ArithmeticToken { NumberToken, PlusToken, MulToken, LeftParenToken, RightParenToken };
+
+
+//arithmetic grammar over the tokens of an arithmetic expression
+class ArithmeticTokenGrammar {
+public:
+    using ParseContextType = ParseContext<TokenStream<ArithmeticToken>>;
+
+    ArithmeticTokenGrammar()
+        : number(terminal(NumberToken) == "number")
+        , value(number | terminal(LeftParenToken) >> grammar >> terminal(RightParenToken))
+        , mul((mul >> terminal(MulToken) >> value) >= "mul" | value)
+        , grammar((grammar >> terminal(PlusToken) >> mul) >= "add" | mul)
+    {
+    }
+
+    const Rule<ParseContextType> number;
+    const Rule<ParseContextType> value;
+    const Rule<ParseContextType> mul;
+    const Rule<ParseContextType> grammar;
+};
+
+
+//measures tokenizing an expression and parsing its tokens, against parsing its characters
+static void benchmark_tokenStream() {
+    const std::string source = createExpression(100000);
+    const ArithmeticGrammar<ParseContext<>> characterGrammar;
+    const ArithmeticTokenGrammar tokenGrammar;
+    const auto lexer = *((+terminalRange('0', '9') == NumberToken) | (terminal('+') == PlusToken) | (terminal('*') == MulToken) | (terminal('(') == LeftParenToken) | (terminal(')') == RightParenToken));
+
+    const double characterDuration = benchmark(5, [&]() {
+        ParseContext<> pc(source);
+        if (!characterGrammar.grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_tokenStream: parse failed");
+        }
+    });
+
+    TokenStream<ArithmeticToken> tokens;
+    const double lexerDuration = benchmark(5, [&]() {
+        if (!tokenize(lexer, source, tokens)) {
+            throw std::logic_error("benchmark_tokenStream: tokenize failed");
+        }
+    });
+
+    const double tokenDuration = benchmark(5, [&]() {
+        ArithmeticTokenGrammar::ParseContextType pc(tokens);
+        if (!tokenGrammar.grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_tokenStream: parse failed");
+        }
+    });
+
+    std::cout << "token stream: " << source.size() << " bytes, " << tokens.size() << " tokens, " << characterDuration << " us per character parse, "
+        << lexerDuration << " us per tokenize, " << tokenDuration << " us per token parse\n";
+}
+
+//measures serializing the matches of a json document, and traversing the serialized tree in place, against parsing the document
+static void benchmark_serializedMatchTree() {
+    using FlatParseContext = ParseContext<std::string, std::string, SourcePosition<std::string>, FlatMatchTree<std::string, std::string, SourcePosition<std::string>>>;
+
+    const std::string source = createJSON(20000);
+    const JSONGrammar<FlatParseContext> json;
+    FlatParseContext pc(source);
+    const double parseDuration = benchmark(5, [&]() {
+        pc.reset(source);
+        if (!json.grammar(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_serializedMatchTree: parse failed");
+        }
+    });
+
+    std::vector<char> data;
+    const double serializeDuration = benchmark(5, [&]() {
+        data = serializeMatches(source, pc.matches());
+    });
+
+    //counts the string matches, from the root matches down
+    size_t stringCount = 0;
+    const double traverseDuration = benchmark(5, [&]() {
+        const SerializedMatchTree<std::string> tree(data.data(), data.size());
+        stringCount = 0;
+        const auto count = [&](const auto& self, const auto& range) -> void {
+            for (const auto match : range) {
+                stringCount += match.id() == "string";
+                self(self, match.children());
+            }
+        };
+        count(count, tree.roots());
+    });
+    if (stringCount == 0) {
+        throw std::logic_error("benchmark_serializedMatchTree: traversal failed");
+    }
+
+    std::cout << "serialized match tree: " << source.size() << " bytes, " << pc.matches().size() << " matches, " << data.size() << " bytes serialized, "
+        << parseDuration << " us per parse, " << serializeDuration << " us per serialize, " << traverseDuration << " us per traversal\n";
+}
+
+
+//measures parsing with interned match ids, against string match ids; the word grammar has ids that do not fit in the small string buffer
+static void benchmark_matchId() {
+    const std::string source = createJSON(20000);
+    benchmarkGrammar<JSONGrammar, ParseContext<std::string, std::string>>("json (string ids)", source);
+    benchmarkGrammar<JSONGrammar, ParseContext<std::string, MatchId>>("json (interned ids)", source);
+
+    std::string words;
+    for (size_t index = 0; index < 200000; ++index) {
+        words += index % 2 ? "alpha " : "12345 ";
+    }
+    const auto word = (+terminalRange('a', 'z') == "identifier_of_a_word") | (+terminalRange('0', '9') == "numeric_literal_of_a_word");
+    const auto grammar = *(word >> *terminal(' '));
+    const auto measure = [&](auto* pcType) {
+        using ParseContextType = std::remove_pointer_t<decltype(pcType)>;
+        return measureParse(5, [&]() {
+            ParseContextType pc(words);
+            if (!grammar(pc) || !pc.sourceEnded()) {
+                throw std::logic_error("benchmark_matchId: parse failed");
+            }
+            return pc.matches().size();
+        });
+    };
+    report("words (string ids)", words.size(), measure(static_cast<ParseContext<std::string, std::string>*>(nullptr)));
+    report("words (interned ids)", words.size(), measure(static_cast<ParseContext<std::string, MatchId>*>(nullptr)));
+}
+
+
+//measures a choice of four alternatives that each parse a whole json document, in order and in parallel;
+//when the last alternative succeeds, all alternatives parse the whole document; when the first succeeds, the others are cancelled
+static void benchmark_parallelChoice() {
+    const JSONGrammar<ParseContext<>> json;
+    const auto alternatives = (json.grammar >> '!') | (json.grammar >> '?') | (json.grammar >> '#') | (json.grammar >> ';');
+    ParallelChoicePool pool(3);
+    const auto parallel = parallelChoice(alternatives, pool);
+
+    for (const char* terminator : { ";", "!" }) {
+        const std::string source = createJSON(5000) + terminator;
+        const auto measure = [&](const auto& grammar) {
+            return benchmark(5, [&]() {
+                ParseContext<> pc(source);
+                if (!grammar(pc) || !pc.sourceEnded()) {
+                    throw std::logic_error("benchmark_parallelChoice: parse failed");
+                }
+            });
+        };
+        const double sequentialDuration = measure(alternatives);
+        const double parallelDuration = measure(parallel);
+        std::cout << "parallel choice (" << (terminator[0] == ';' ? "last" : "first") << " alternative succeeds): " << source.size() << " bytes, "
+            << sequentialDuration << " us per parse (sequential), " << parallelDuration << " us per parse (parallel, "
+            << pool.threadCount() + 1 << " threads, " << std::thread::hardware_concurrency() << " hardware threads)\n";
+    }
+}
+
+
+static void benchmark_resumableParsing() {
+    using PushParseContext = ParseContext<PushSource<>>;
+    const JSONGrammar<PushParseContext> json;
+    const auto program = compileBytecode(json.grammar);
+    const std::string source = createJSON(2000);
+
+    PushSource<> wholeSource;
+    wholeSource.append(source.data(), source.size());
+    const double wholeDuration = benchmark(20, [&]() {
+        PushParseContext pc(wholeSource);
+        if (!program(pc) || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_resumableParsing: parse failed");
+        }
+    });
+
+    //the input is received in chunks of the size of a network packet
+    const size_t chunkSize = 1460;
+    const double chunkedDuration = benchmark(20, [&]() {
+        PushSource<> chunkedSource;
+        PushParseContext pc(chunkedSource);
+        BytecodeMachine<PushParseContext> machine(program);
+        ParseStatus status = machine.start(pc);
+        for (size_t offset = 0; offset < source.size() && status == ParseStatus::NeedMoreInput; offset += chunkSize) {
+            chunkedSource.append(source.data() + offset, std::min(chunkSize, source.size() - offset));
+            status = machine.resume(pc);
+        }
+        if (status == ParseStatus::NeedMoreInput) {
+            status = machine.resume(pc, true);
+        }
+        if (status != ParseStatus::Success || !pc.sourceEnded()) {
+            throw std::logic_error("benchmark_resumableParsing: parse failed");
+        }
+    });
+
+    std::cout << "resumable parsing: " << source.size() << " bytes, " << wholeDuration << " us per parse (whole input), "
+        << chunkedDuration << " us per parse (" << chunkSize << "-byte chunks)\n";
+}
+
+
+void runBenchmarks() {
+    benchmark_ebnf();
+    benchmark_characterScan();
+    benchmark_keywords();
+    benchmark_errorTracking();
+    benchmark_choiceDispatch();
+    benchmark_concurrentParse();
+    benchmark_bytecode();
+    benchmark_incremental();
+    benchmark_maxRuleDepth();
+    benchmark_lineIndex();
+    benchmark_tokenStream();
+    benchmark_throughput();
+    benchmark_arena();
+    benchmark_reset();
+    benchmark_errorRecovery();
+    benchmark_ebnfCompiler();
+    benchmark_serializedMatchTree();
+    benchmark_matchId();
+    benchmark_parallelChoice();
+    benchmark_resumableParsing();
+}
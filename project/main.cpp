@@ -1,11 +1,35 @@
+#include <cstdlib>
 #include <iostream>
 
 
+//both the unit tests and the benchmarks are run by default; the CMake project builds a separate executable for each
+#ifndef PARSERLIB_RUN_UNIT_TESTS
+#define PARSERLIB_RUN_UNIT_TESTS 1
+#endif
+
+#ifndef PARSERLIB_RUN_BENCHMARKS
+#define PARSERLIB_RUN_BENCHMARKS 1
+#endif
+
+
+#if PARSERLIB_RUN_UNIT_TESTS
 extern void runUnitTests();
+#endif
+
+#if PARSERLIB_RUN_BENCHMARKS
+extern void runBenchmarks();
+#endif
 
 
 int main() {
+#if PARSERLIB_RUN_UNIT_TESTS
     runUnitTests();
+#endif
+#if PARSERLIB_RUN_BENCHMARKS
+    runBenchmarks();
+#endif
+#if defined(_WIN32) && PARSERLIB_RUN_UNIT_TESTS && PARSERLIB_RUN_BENCHMARKS
     system("pause");
+#endif
     return 0;
 }
@@ -1,7 +1,25 @@
 #include <cassert>
 #include <iostream>
 #include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <thread>
+#include <list>
+#include <atomic>
 #include "parserlib.hpp"
+#include "parserlib/MappedFileSource.hpp"
+#include "parserlib/StreamSource.hpp"
+#include "parserlib/ParallelParse.hpp"
+#include "parserlib/LineIndex.hpp"
+#include "parserlib/TokenStream.hpp"
+#include "parserlib/ParseArena.hpp"
+#include "parserlib/SerializedMatchTree.hpp"
+#include "parserlib/ParallelChoiceParser.hpp"
+#include "parserlib/PushSource.hpp"
+#include "parserlib/BytecodeCompiler.hpp"
+#include "ebnf/ebnf.hpp"
 
 
 using namespace std;
@@ -470,6 +488,39 @@ static void unitTest_terminalSetParser() {
 }
 
 
+static void unitTest_characterSet() {
+    {
+        const CharacterSet set(std::vector<char>{ 'a', 'Z', '+', '\xff' });
+        assert(set.contains('a') && set.contains('Z') && set.contains('+') && set.contains('\xff'));
+        assert(!set.contains('A') && !set.contains('z') && !set.contains('-') && !set.contains('\0'));
+        assert(set.containsCaseInsensitive('a') && set.containsCaseInsensitive('A'));
+        assert(set.containsCaseInsensitive('z') && set.containsCaseInsensitive('Z'));
+        assert(set.containsCaseInsensitive('+') && !set.containsCaseInsensitive('b'));
+    }
+
+    {
+        const auto parser = terminalSet('a', 'b', '\xe9');
+        const std::string input = "Ab\xe9" "c";
+        ParseContext<std::string, std::string, SourcePosition<std::string, false>> pc(input);
+        assert(parser(pc));
+        assert(parser(pc));
+        assert(parser(pc));
+        assert(!parser(pc));
+        assert(pc.sourcePosition() == input.end() - 1);
+    }
+
+    {
+        //non-byte-sized values do not use a character set
+        const auto parser = terminalSet(1, 300, 5);
+        const std::vector<int> input{ 300, 5, 256 };
+        ParseContext<std::vector<int>> pc(input);
+        assert(parser(pc));
+        assert(parser(pc));
+        assert(!parser(pc));
+    }
+}
+
+
 static void unitTest_terminalStringParser() {
     const auto parser = terminal("int");
 
@@ -594,7 +645,7 @@ static void unitTest_TreeMatch() {
 
 
 static void unitTest_recursion() {
-    const Rule<> r = 'x' >> r >> 'b'
+    const Rule<> r = terminal('x') >> r >> 'b'
                    | 'a';
 
     {
@@ -681,7 +732,7 @@ static Rule<> mul = (mul >> '*' >> num) >= "mul"
                   | num;
 
 
-static Rule<> add = (add >> '+' >> mul) >= "add"
+Rule<> add = (add >> '+' >> mul) >= "add"
                   | (add >> '-' >> mul) >= "sub"
                   | mul;
 
@@ -852,6 +903,7 @@ static void unitTest_leftRecursion() {
         std::string input = "1";
         ParseContext pc(input);
         const bool ok = add(pc);
+        assert(ok);
         const int r = eval(pc.matches()[0]);
         assert(r == 1);
     }
@@ -860,6 +912,7 @@ static void unitTest_leftRecursion() {
         std::string input = "1+2";
         ParseContext pc(input);
         const bool ok = add(pc);
+        assert(ok);
         const int r = eval(pc.matches()[0]);
         assert(r == 3);
     }
@@ -868,6 +921,7 @@ static void unitTest_leftRecursion() {
         std::string input = "1+2*3";
         ParseContext pc(input);
         const bool ok = add(pc);
+        assert(ok);
         const int r = eval(pc.matches()[0]);
         assert(r == 7);
     }
@@ -876,6 +930,7 @@ static void unitTest_leftRecursion() {
         std::string input = "1*2+3";
         ParseContext pc(input);
         const bool ok = add(pc);
+        assert(ok);
         const int r = eval(pc.matches()[0]);
         assert(r == 5);
     }
@@ -884,6 +939,7 @@ static void unitTest_leftRecursion() {
         std::string input = "(1+2)*3";
         ParseContext pc(input);
         const bool ok = add(pc);
+        assert(ok);
         const int r = eval(pc.matches()[0]);
         assert(r == 9);
     }
@@ -892,6 +948,7 @@ static void unitTest_leftRecursion() {
         std::string input = "1*(2+3)";
         ParseContext pc(input);
         const bool ok = add(pc);
+        assert(ok);
         const int r = eval(pc.matches()[0]);
         assert(r == 5);
     }
@@ -900,6 +957,7 @@ static void unitTest_leftRecursion() {
         std::string input = "(1*(2+3))*4";
         ParseContext pc(input);
         const bool ok = add(pc);
+        assert(ok);
         const int r = eval(pc.matches()[0]);
         assert(r == 20);
     }
@@ -922,6 +980,66 @@ static void unitTest_lineCountingSourcePosition() {
 }
 
 
+static void unitTest_characterScan() {
+    const auto identifierChar = terminalRange('a', 'z') | terminalRange('A', 'Z') | terminalRange('0', '9') | '_';
+    assert(CharacterPredicate<std::decay_t<decltype(identifierChar)>>::value);
+
+    //a choice with a string terminal is not a character predicate; it is used as reference
+    const auto referenceChar = identifierChar | "#!";
+    assert(!CharacterPredicate<std::decay_t<decltype(referenceChar)>>::value);
+
+    //inputs longer than the simd block sizes, stopping at every offset
+    for (size_t length = 0; length < 80; ++length) {
+        std::string input;
+        for (size_t i = 0; i < length; ++i) {
+            input += "aZ9_"[i % 4];
+        }
+        input += '-';
+        input += "abc";
+
+        ParseContext<> pc1(input);
+        assert((*identifierChar)(pc1));
+        ParseContext<> pc2(input);
+        assert((*referenceChar)(pc2));
+        assert(pc1.sourcePosition() == pc2.sourcePosition());
+        assert(pc1.sourcePosition() == input.begin() + length);
+
+        ParseContext<> pc3(input);
+        assert((+identifierChar)(pc3) == (length > 0));
+        assert(pc3.sourcePosition() == input.begin() + length);
+    }
+
+    {
+        //case insensitive
+        const auto lower = *terminalRange('a', 'f');
+        const std::string input = "abcDEFabcdefABCDEFabcdefABCDEFabcdefg";
+        ParseContext<std::string, std::string, SourcePosition<std::string, false>> pc(input);
+        assert(lower(pc));
+        assert(pc.sourcePosition() == input.end() - 1);
+    }
+
+    {
+        //line counting over whitespace
+        const auto ws = *terminalSet(' ', '\n', '\t');
+        const std::string input = "  \n\t \n                                   \n   x";
+        ParseContext<std::string, std::string, LineCountingSourcePosition<std::string>> pc(input);
+        assert(ws(pc));
+        assert(*pc.sourcePosition().iterator() == 'x');
+        assert(pc.sourcePosition().line() == 4);
+        assert(pc.sourcePosition().column() == 4);
+    }
+
+    {
+        //sets that need more ranges than the simd kernels support
+        const auto parser = *terminalSet('a', 'c', 'e', 'g', 'i', 'k', 'm', 'o', 'q', 's');
+        const std::string input = "acegikmoqsacegikmoqsacegikmoqsacegikmoqsb";
+        ParseContext<> pc(input);
+        assert(parser(pc));
+        assert(pc.sourcePosition() == input.end() - 1);
+    }
+}
+
+
 static void unitTest_errorHandling() {
     const auto parser = terminal('a') >> 'b' >> 'd' >> 'e'
                       | terminal('a') >> 'b' >> 'c' >> 'd';
@@ -959,6 +1077,89 @@ static void unitTest_errorHandling() {
 }
 
 
+static void unitTest_errorMessages() {
+    {
+        const auto parser = terminal('a') >> 'b';
+        const std::string input = "ac";
+        ParseContext<> pc(input);
+        assert(!parser(pc));
+        assert(pc.errors().size() == 1);
+        assert(pc.errors()[0].type() == static_cast<int>(ErrorType::SyntaxError));
+        assert(pc.errors()[0].message() == "Syntax error: expected: b, found: c");
+        assert(formatError(pc.errors()[0]) == "Syntax error: expected: b, found: c");
+    }
+
+    {
+        const auto parser = terminalSet('a', 'b');
+        const std::string input = "c";
+        ParseContext<> pc(input);
+        assert(!parser(pc));
+        assert(pc.errors().size() == 1);
+        assert(pc.errors()[0].message() == "Syntax error: expected one of: ['a','b'], found: c");
+    }
+
+    {
+        const auto parser = terminalRange('0', '9');
+        const std::string input = "x";
+        ParseContext<> pc(input);
+        assert(!parser(pc));
+        assert(pc.errors().size() == 1);
+        assert(pc.errors()[0].message() == "Syntax error: expected one of: '0'..'9', found: x");
+    }
+
+    {
+        const auto parser = terminal("int");
+        const std::string input = "inx";
+        ParseContext<> pc(input);
+        assert(!parser(pc));
+        assert(pc.errors().size() == 1);
+        assert(pc.errors()[0].message() == "Syntax error: expected: \"int\", found: \"inx\"");
+    }
+
+    {
+        const Error<SourcePosition<>> error(ErrorType::User, SourcePosition<>(), std::string("user error"));
+        assert(error.message() == "user error");
+        assert(Error<SourcePosition<>>().type() == 0);
+    }
+
+    {
+        //messages are created out of values copied into the errors, after the parser and the source are destroyed
+        std::vector<Error<SourcePosition<>>> errors;
+        {
+            const auto parser = terminal("let") | terminalSet('x', 'y');
+            const std::string input = "lex";
+            ParseContext<> pc(input);
+            assert(!parser(pc));
+            errors = pc.errors();
+        }
+        assert(errors.size() == 1);
+        assert(errors[0].message() == "Syntax error: expected: \"let\", found: \"lex\"");
+    }
+
+    {
+        //messages can be requested from multiple threads at the same time
+        const auto parser = terminal('a');
+        const std::string input = "b";
+        ParseContext<> pc(input);
+        assert(!parser(pc));
+        const auto& error = pc.errors()[0];
+        std::vector<std::thread> threads;
+        std::atomic<size_t> matchingCount{ 0 };
+        for (size_t i = 0; i < 4; ++i) {
+            threads.emplace_back([&]() {
+                if (error.message() == "Syntax error: expected: a, found: b") {
+                    ++matchingCount;
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        assert(matchingCount == 4);
+    }
+}
+
+
 static void unitTest_errorRecovery() {
     const auto ws = *terminal(' ');
     const auto letter = terminalRange('a', 'z') | terminalRange('A', 'Z');
@@ -1031,25 +1232,2451 @@ static void unitTest_errorRecovery() {
 }
 
 
+class InvocationCounter : public ParserNode<InvocationCounter> {
+public:
+    InvocationCounter(size_t& count) : m_count(count) {
+    }
+
+    template <class ParseContextType> bool operator ()(ParseContextType& pc) const {
+        ++m_count;
+        return true;
+    }
+
+    template <class ParseContextType> bool parseLeftRecursionContinuation(ParseContextType& pc, LeftRecursionContext<ParseContextType>& lrc) const {
+        return false;
+    }
+
+private:
+    size_t& m_count;
+};
+
+
+static void unitTest_noErrors() {
+    using NoErrorsParseContext = ParseContext<std::string, std::string, SourcePosition<>, std::vector<Match<std::string, std::string, SourcePosition<>>>, NoErrors>;
+
+    const auto parser = terminal('a') >> 'b' >> 'd' >> 'e'
+                      | terminal('a') >> 'b' >> 'c' >> 'd';
+
+    {
+        const std::string input = "abcd";
+        NoErrorsParseContext pc(input);
+        const bool ok = parser(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+        assert(pc.errors().size() == 0);
+    }
+
+    {
+        const std::string input = "abcf";
+        NoErrorsParseContext pc(input);
+        const bool ok = parser(pc);
+        assert(!ok);
+        assert(pc.errors().size() == 0);
+    }
+
+    {
+        //error recovery still resumes parsing
+        const auto ws = *terminal(' ');
+        const auto character = terminalRange('a', 'z') | terminalRange('0', '9');
+        const auto terminal_ = ('\'' >> *(character - '\'') >> ~terminal('\'')) == "terminal";
+        const auto grammar = ws >> *(terminal_ >> ws);
+        const std::string input = "'abc' '1@23' 'abc123'";
+        NoErrorsParseContext pc(input);
+        const bool ok = grammar(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+        assert(pc.matches().size() == 3);
+        assert(pc.errors().size() == 0);
+    }
+}
+
+
+static void unitTest_memoization() {
+    size_t count = 0;
+    const Rule<> inner = (InvocationCounter(count) >> 'a' >> 'b') == "ab";
+    const Rule<> outer = inner >> 'c'
+                       | inner >> 'd';
+
+    {
+        count = 0;
+        const std::string input = "abd";
+        ParseContext<> pc(input);
+        const bool ok = outer(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+        assert(count == 2);
+        assert(pc.matches().size() == 1);
+    }
+
+    {
+        count = 0;
+        const std::string input = "abd";
+        ParseContext<> pc(input);
+        pc.setMemoization(true);
+        const bool ok = outer(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+        assert(count == 1);
+        assert(pc.matches().size() == 1);
+        assert(pc.matches()[0].id() == "ab");
+        assert(pc.matches()[0].content() == "ab");
+    }
+
+    {
+        count = 0;
+        const std::string input = "abe";
+        ParseContext<> pc(input);
+        pc.setMemoization(true);
+        const auto state = pc.state();
+        bool ok = outer(pc);
+        assert(!ok);
+        assert(count == 1);
+
+        //memoized results are replayed
+        pc.setState(state);
+        ok = outer(pc);
+        assert(!ok);
+        assert(count == 1);
+
+        //discarded results are parsed again
+        pc.discardMemoEntriesBefore(ParseContext<>::PositionType(input.end(), input.end()));
+        pc.setState(state);
+        ok = outer(pc);
+        assert(!ok);
+        assert(count == 2);
+    }
+
+    {
+        std::string input = "(1*(2+3))*4-1";
+        ParseContext pc(input);
+        pc.setMemoization(true);
+        const bool ok = add(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+        assert(pc.matches().size() == 1);
+        const int r = eval(pc.matches()[0]);
+        assert(r == 19);
+    }
+}
+
+
+static void unitTest_ruleIndex() {
+    const Rule<> r1 = terminal('a');
+    const Rule<> r2 = terminal('b');
+    const Rule<> r3 = r1;
+    assert(r1.index() != r2.index());
+    assert(r3.index() != r1.index());
+    assert(r1.index() < Rule<>::ruleCount() && r2.index() < Rule<>::ruleCount() && r3.index() < Rule<>::ruleCount());
+
+    const std::string input = "ab";
+    ParseContext<> pc(input);
+
+    //rule created after the parse context
+    const Rule<> r4 = r1 >> r2;
+    const bool ok = r4(pc);
+    assert(ok);
+    assert(pc.sourceEnded());
+
+    //the indexes of destroyed rules are reused, so as that grammars built at runtime do not grow the rule count
+    const size_t ruleCount = Rule<>::ruleCount();
+    for (size_t i = 0; i < 1000; ++i) {
+        const Rule<> a = terminal('a');
+        const Rule<> b = a >> 'b';
+        ParseContext<> temp(input);
+        assert(b(temp));
+    }
+    assert(Rule<>::ruleCount() <= ruleCount + 2);
+}
+
+
+using FlatParseContext = ParseContext<std::string, std::string, SourcePosition<std::string>, FlatMatchTree<std::string, std::string, SourcePosition<std::string>>>;
+
+
+static int eval(const FlatParseContext::MatchContainerType::Match& m) {
+    if (m.id() == "int") {
+        std::stringstream stream;
+        stream << m.content();
+        int v;
+        stream >> v;
+        return v;
+    }
+    auto it = m.children().begin();
+    const int left = eval(*it);
+    const int right = eval(*++it);
+    if (m.id() == "add") {
+        return left + right;
+    }
+    if (m.id() == "sub") {
+        return left - right;
+    }
+    if (m.id() == "mul") {
+        return left * right;
+    }
+    if (m.id() == "div") {
+        return left / right;
+    }
+    throw std::logic_error("Invalid match id");
+}
+
+
+extern Rule<FlatParseContext> flatAdd;
+
+
+static auto flatNum = integer
+                    | '(' >> flatAdd >> ')';
+
+
+static Rule<FlatParseContext> flatMul = (flatMul >> '*' >> flatNum) >= "mul"
+                                      | (flatMul >> '/' >> flatNum) >= "div"
+                                      | flatNum;
+
+
+Rule<FlatParseContext> flatAdd = (flatAdd >> '+' >> flatMul) >= "add"
+                               | (flatAdd >> '-' >> flatMul) >= "sub"
+                               | flatMul;
+
+
+static void unitTest_flatMatchTree() {
+    {
+        const auto grammar = ((((terminal('a') == "a") >> (terminal('b') == "b")) >= "ab") >> (terminal('c') == "c")) >= "abc";
+        const std::string input = "abc";
+        FlatParseContext pc(input);
+        const bool ok = grammar(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+
+        //nodes are stored in post-order
+        const auto& tree = pc.matches();
+        assert(tree.size() == 5);
+        assert(tree[0].id() == "a" && tree[1].id() == "b" && tree[2].id() == "ab" && tree[3].id() == "c" && tree[4].id() == "abc");
+        assert(tree[4].subtreeSize() == 5);
+
+        const auto roots = tree.roots();
+        assert(roots.size() == 1);
+        const auto root = *roots.begin();
+        assert(root.id() == "abc" && root.content() == "abc" && !root.hasParent());
+
+        const auto children = root.children();
+        assert(children.size() == 2);
+        auto it = children.begin();
+        assert((*it).id() == "ab" && (*it).content() == "ab" && (*it).parent() == root);
+        assert((*it).children().size() == 2);
+        assert((*(*it).children().begin()).id() == "a");
+        ++it;
+        assert((*it).id() == "c" && (*it).children().empty());
+        ++it;
+        assert(it == children.end());
+    }
+
+    {
+        //matches of failed branches are removed, and orphaned children become roots
+        const auto grammar = ((terminal('a') == "a") >> (terminal('b') == "b") >> 'x') >= "abx"
+                           | (terminal('a') == "a") >> (terminal('b') == "b") >> (terminal('c') == "c");
+        const std::string input = "abc";
+        FlatParseContext pc(input);
+        const bool ok = grammar(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+        const auto roots = pc.matches().roots();
+        assert(roots.size() == 3);
+        auto it = roots.begin();
+        assert((*it).id() == "a");
+        assert((*++it).id() == "b");
+        assert((*++it).id() == "c");
+    }
+
+    {
+        std::string input = "(1*(2+3))*4-1";
+        FlatParseContext pc(input);
+        const bool ok = flatAdd(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+        assert(pc.matches().roots().size() == 1);
+        const int r = eval(*pc.matches().roots().begin());
+        assert(r == 19);
+    }
+
+    {
+        std::string input = "(1*(2+3))*4-1";
+        FlatParseContext pc(input);
+        pc.setMemoization(true);
+        const bool ok = flatAdd(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+        assert(pc.matches().roots().size() == 1);
+        const int r = eval(*pc.matches().roots().begin());
+        assert(r == 19);
+    }
+}
+
+
+static void unitTest_contentView() {
+    {
+        const auto grammar = *((+terminalRange('a', 'z') == "word") >> *terminal(' '));
+        const std::string input = "hello world";
+        ParseContext<> pc(input);
+        const bool ok = grammar(pc);
+        assert(ok);
+        assert(pc.matches().size() == 2);
+        const std::string_view view = pc.matches()[0].contentView();
+        assert(view == "hello");
+        assert(view.data() == input.data());
+        assert(pc.matches()[1].contentView() == "world");
+    }
+
+    {
+        const std::string input = "(1*(2+3))*4-1";
+        FlatParseContext pc(input);
+        const bool ok = flatAdd(pc);
+        assert(ok);
+        const auto root = *pc.matches().roots().begin();
+        assert(root.contentView() == input);
+        assert(root.contentView().data() == input.data());
+    }
+
+    {
+        const std::vector<int> input{ 1, 2, 3, 4 };
+        const auto grammar = terminal(1) >> (+terminalRange(2, 3) == "mid") >> 4;
+        ParseContext<std::vector<int>> pc(input);
+        const bool ok = grammar(pc);
+        assert(ok);
+        assert(pc.matches().size() == 1);
+        const auto view = pc.matches()[0].contentView();
+        assert(view.size() == 2);
+        assert(view.data() == input.data() + 1);
+        assert(view[0] == 2 && view[1] == 3);
+    }
+
+    {
+        const auto grammar = terminal("abc");
+        const std::string input = "abx";
+        ParseContext<> pc(input);
+        const bool ok = grammar(pc);
+        assert(!ok);
+        assert(pc.errors().size() == 1);
+        assert(pc.errors()[0].sourceView(3) == "abx");
+        assert(pc.errors()[0].sourceView(10) == "abx");
+        assert(pc.errors()[0].message() == "Syntax error: expected: \"abc\", found: \"abx\"");
+    }
+
+    {
+        const std::string input = "abc";
+        ParseContext<> pc(input);
+        pc.increaseSourcePosition(1);
+        bool thrown = false;
+        try {
+            pc.addMatch("x", pc.sourcePosition(), pc.sourcePosition(), 1);
+        }
+        catch (const TreeMatchException<ParseContext<>>& ex) {
+            thrown = true;
+            assert(ex.sourceView(1) == "b");
+            assert(ex.sourceView(5) == "bc");
+        }
+        assert(thrown);
+    }
+}
+
+
+static void unitTest_mappedFileSource() {
+    const char* filename = "parserlib_unitTest_mappedFileSource.txt";
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file << "alpha beta gamma";
+    }
+
+    {
+        MappedFileSource source(filename);
+        assert(source.size() == 16);
+        assert(std::string(source.begin(), source.end()) == loadASCIIFile(filename));
+        assert(loadASCIIFile(filename, true) == std::string("alpha beta gamma", 17));
+
+        const auto grammar = *((+terminalRange('a', 'z') == "word") >> *terminal(' '));
+        ParseContext<MappedFileSource> pc(source);
+        const bool ok = grammar(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+        assert(pc.matches().size() == 3);
+        assert(pc.matches()[0].contentView() == "alpha");
+        assert(pc.matches()[0].contentView().data() == source.data());
+        assert(pc.matches()[2].contentView() == "gamma");
+
+        MappedFileSource moved(std::move(source));
+        assert(moved.size() == 16 && source.empty());
+    }
+
+    std::remove(filename);
+
+    {
+        //streams of unknown size, e.g. pipes, are read sequentially
+        struct UnseekableBuffer : std::streambuf {
+            UnseekableBuffer(std::string& data) {
+                setg(&data[0], &data[0], &data[0] + data.size());
+            }
+        };
+        std::string data(100000, 'x');
+        UnseekableBuffer buffer(data);
+        std::istream stream(&buffer);
+        assert(loadASCIIStream(stream) == data);
+    }
+
+    {
+        {
+            std::ofstream file(filename, std::ios::binary);
+        }
+        const MappedFileSource source(filename);
+        assert(source.empty());
+        assert(source.begin() == source.end());
+        std::remove(filename);
+    }
+
+    {
+        bool thrown = false;
+        try {
+            const MappedFileSource source("parserlib_unitTest_missing_file.txt");
+        }
+        catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+}
+
+
+static void unitTest_streamSource() {
+    std::string input;
+    for (size_t i = 0; i < 2000; ++i) {
+        input += "line" + std::to_string(i) + "\n";
+    }
+
+    const auto letter = terminalRange('a', 'z');
+    const auto digit = terminalRange('0', '9');
+
+    {
+        //without matches, only the chunks within the lookahead are kept in memory
+        std::istringstream stream(input);
+        StreamSource<> source(stream, 64);
+        const auto grammar = *(+letter >> +digit >> '\n');
+        ParseContext<StreamSource<>> pc(source);
+        const bool ok = grammar(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+        assert(source.maxChunkCount() <= 3);
+    }
+
+    {
+        //matches keep their chunks alive
+        std::istringstream stream(input);
+        StreamSource<> source(stream, 64);
+        const auto grammar = *((+letter >> +digit == "line") >> '\n');
+        ParseContext<StreamSource<>> pc(source);
+        const bool ok = grammar(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+        assert(pc.matches().size() == 2000);
+        const auto& match = pc.matches()[1234];
+        assert(std::string(match.begin().iterator(), match.end().iterator()) == "line1234");
+    }
+
+    {
+        //backtracking across chunks
+        std::istringstream stream("abcdefgh");
+        StreamSource<> source(stream, 2);
+        const auto grammar = terminal("abcdefgx") | terminal("abcdefgh");
+        ParseContext<StreamSource<>> pc(source);
+        const bool ok = grammar(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+    }
+
+    {
+        //read function source
+        size_t remaining = 3;
+        StreamSource<> source([&](char* buffer, size_t size) {
+            if (remaining == 0 || size == 0) {
+                return size_t(0);
+            }
+            --remaining;
+            *buffer = 'a';
+            return size_t(1);
+        }, 2);
+        const auto grammar = *terminal('a') >> eof();
+        ParseContext<StreamSource<>> pc(source);
+        const bool ok = grammar(pc);
+        assert(ok);
+    }
+
+    {
+        std::istringstream stream("");
+        StreamSource<> source(stream);
+        assert(source.begin() == source.end());
+        ParseContext<StreamSource<>> pc(source);
+        assert(pc.sourceEnded());
+    }
+}
+
+
+static void unitTest_cut() {
+    {
+        //without a cut, the choice tries the next branch
+        const auto grammar = (terminal('a') >> 'b') | terminal("ac");
+        const std::string input = "ac";
+        ParseContext<> pc(input);
+        assert(grammar(pc));
+    }
+
+    {
+        //with a cut, the choice does not try the next branch
+        const auto grammar = (terminal('a') >> cut() >> 'b') | terminal("ac");
+        const std::string input = "ac";
+        ParseContext<> pc(input);
+        assert(!grammar(pc));
+        assert(pc.cutCount() == 1);
+    }
+
+    {
+        //a loop fails if an iteration fails after a cut
+        const auto grammar = *(terminal('a') >> cut() >> 'b');
+        const std::string input = "abac";
+        ParseContext<> pc(input);
+        assert(!grammar(pc));
+    }
+
+    {
+        //an optional fails if its child fails after a cut
+        const auto grammar = -(terminal('a') >> cut() >> 'b') >> "ac";
+        const std::string input = "ac";
+        ParseContext<> pc(input);
+        assert(!grammar(pc));
+    }
+
+    {
+        //records are delivered to the match handler at each cut
+        const auto digit = terminalRange('0', '9');
+        const auto field = +digit == "field";
+        const auto record = ((field >> *(',' >> field)) >= "record") >> ';' >> cut();
+        const auto grammar = *record >> eof();
+        const std::string input = "1,2,3;4;5,6;";
+        ParseContext<> pc(input);
+        std::vector<std::string> records;
+        size_t maxMatchCount = 0;
+        pc.setMatchHandler([&](const Match<std::string, std::string, SourcePosition<>>& match) {
+            maxMatchCount = std::max(maxMatchCount, pc.matches().size());
+            assert(match.id() == "record");
+            records.push_back(match.content());
+        });
+        const bool ok = grammar(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+        assert(pc.matches().empty());
+        assert(maxMatchCount == 1);
+        assert(records == std::vector<std::string>({ "1,2,3", "4", "5,6" }));
+    }
+
+    {
+        //backtracking after delivering matches
+        const auto record = (((terminal('a') == "a") >> ';') | ((terminal('b') == "b") >> ',')) >> cut();
+        const auto grammar = *record >> ((terminal('a') == "x") >> '.' | (terminal('a') == "y") >> '!');
+        const std::string input = "a;b,a!";
+        ParseContext<> pc(input);
+        std::string delivered;
+        pc.setMatchHandler([&](const Match<std::string, std::string, SourcePosition<>>& match) {
+            delivered += match.id();
+        });
+        const bool ok = grammar(pc);
+        assert(ok);
+        assert(delivered == "aby");
+        assert(pc.matches().empty());
+        assert(pc.droppedMatchCount() == 3);
+    }
+}
+
+
+static void unitTest_matchHandler() {
+    const auto digit = terminalRange('0', '9');
+    const auto field = +digit == "field";
+    const auto record = (field >> *(',' >> field) >> ';') >= "record";
+
+    {
+        //records become final at the end of each loop iteration
+        const std::string input = "1,2,3;4;5,6;";
+        ParseContext<> pc(input);
+        std::vector<std::string> records;
+        size_t maxMatchCount = 0;
+        pc.setMatchHandler([&](const Match<std::string, std::string, SourcePosition<>>& match) {
+            maxMatchCount = std::max(maxMatchCount, pc.matches().size());
+            assert(match.id() == "record");
+            records.push_back(std::string(match.contentView()));
+        });
+        const bool ok = (*record >> eof())(pc);
+        assert(ok);
+        assert(pc.matches().empty());
+        assert(pc.droppedMatchCount() == 3);
+        assert(maxMatchCount == 1);
+        assert(records == std::vector<std::string>({ "1,2,3;", "4;", "5,6;" }));
+    }
+
+    {
+        //matches of a failed iteration are not delivered
+        const std::string input = "1;2,";
+        ParseContext<> pc(input);
+        std::vector<std::string> records;
+        pc.setMatchHandler([&](const Match<std::string, std::string, SourcePosition<>>& match) {
+            records.push_back(match.content());
+        });
+        const bool ok = (*record)(pc);
+        assert(ok);
+        assert(records == std::vector<std::string>({ "1;" }));
+    }
+
+    {
+        //matches are delivered and kept
+        const std::string input = "1;2;";
+        ParseContext<> pc(input);
+        size_t deliveredCount = 0;
+        pc.setMatchHandler([&](const Match<std::string, std::string, SourcePosition<>>& match) {
+            ++deliveredCount;
+        }, MatchDelivery::KeepMatches);
+        const bool ok = (*record)(pc);
+        assert(ok);
+        assert(deliveredCount == 2);
+        assert(pc.matches().size() == 2);
+        assert(pc.droppedMatchCount() == 0);
+    }
+
+    {
+        //the tree of a left-recursive rule is delivered once complete
+        std::string input = "1+2*3-4";
+        ParseContext<> pc(input);
+        std::vector<std::string> ids;
+        pc.setMatchHandler([&](const Match<std::string, std::string, SourcePosition<>>& match) {
+            ids.push_back(match.id());
+            assert(eval(match) == 3);
+        });
+        const bool ok = add(pc);
+        assert(ok);
+        assert(pc.sourceEnded());
+        assert(ids == std::vector<std::string>({ "sub" }));
+        assert(pc.matches().empty());
+    }
+
+    {
+        //flat match trees deliver their root matches
+        const std::string input = "1,2;3;";
+        FlatParseContext pc(input);
+        std::vector<size_t> childCounts;
+        pc.setMatchHandler([&](const FlatParseContext::DeliveredMatchType& match) {
+            assert(match.id() == "record");
+            childCounts.push_back(match.children().size());
+        });
+        const auto flatRecord = ((+digit == "field") >> *(',' >> (+digit == "field")) >> ';') >= "record";
+        const bool ok = (*flatRecord)(pc);
+        assert(ok);
+        assert(pc.matches().empty());
+        assert(childCounts == std::vector<size_t>({ 2, 1 }));
+    }
+}
+
+
+static void unitTest_parallelParse() {
+    using LineParseContext = ParseContext<std::string, std::string, LineCountingSourcePosition<>>;
+
+    const auto letter = terminalRange('a', 'z');
+    const auto digit = terminalRange('0', '9');
+    const auto line = ((+letter == "key") >> '=' >> (+digit == "value") >> '\n') >= "line";
+    const Rule<LineParseContext> grammar = *line;
+    const auto boundary = terminal('\n');
+
+    std::string input;
+    for (size_t i = 0; i < 1000; ++i) {
+        input += "key=" + std::to_string(i) + "\n";
+    }
+
+    {
+        LineParseContext pc(input);
+        assert(grammar(pc) && pc.sourceEnded());
+
+        const auto result = parallelParse<LineParseContext>(input, grammar, boundary, 4);
+        assert(result.success());
+        assert(result.partCount() == 4);
+        assert(result.errors().empty());
+        assert(result.matches().size() == pc.matches().size());
+        for (size_t i = 0; i < pc.matches().size(); ++i) {
+            const auto& expected = pc.matches()[i];
+            const auto& match = result.matches()[i];
+            assert(match.id() == expected.id());
+            assert(match.begin().iterator() == expected.begin().iterator());
+            assert(match.begin().line() == i + 1 && match.begin().column() == 1);
+            assert(match.children()[1].content() == std::to_string(i));
+            assert(match.children()[1].begin().column() == 5);
+        }
+    }
+
+    {
+        //an invalid line fails its part
+        std::string invalidInput = input;
+        invalidInput.replace(invalidInput.find("key=900"), 7, "key=90x");
+        const auto result = parallelParse<LineParseContext>(invalidInput, grammar, boundary, 4);
+        assert(!result.success());
+    }
+
+    {
+        //an error is reported at its line, after error recovery
+        const auto recoveringLine = (((+letter == "key") >> '=' >> (+digit == "value")) >= "line") >> ~terminal('\n');
+        const Rule<LineParseContext> recoveringGrammar = *recoveringLine;
+        std::string invalidInput = input;
+        invalidInput.replace(invalidInput.find("key=900"), 7, "key=90x");
+        const auto result = parallelParse<LineParseContext>(invalidInput, recoveringGrammar, boundary, 4);
+        assert(result.success());
+        assert(result.matches().size() == 1000);
+        assert(!result.errors().empty());
+        assert(result.errors()[0].position().line() == 901);
+        assert(result.errors()[0].position().column() == 7);
+    }
+
+    {
+        //a single thread parses the whole source
+        const auto result = parallelParse<LineParseContext>(input, grammar, boundary, 1);
+        assert(result.success());
+        assert(result.partCount() == 1);
+        assert(result.matches().size() == 1000);
+    }
+}
+
+
+static void unitTest_concurrentParse() {
+    //the same grammars are used by multiple threads at the same time, each one with its own parse context
+    const std::vector<std::pair<std::string, int>> expressions{
+        { "(1*(2+3))*4-1", 19 },
+        { "1+2*3-4", 3 },
+        { "((((1))))", 1 },
+        { "9-8-7", -6 },
+        { "2*3*4/6", 4 }
+    };
+
+    std::atomic<size_t> failureCount{ 0 };
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t]() {
+            for (size_t i = 0; i < 200; ++i) {
+                const auto& expression = expressions[(t + i) % expressions.size()];
+                {
+                    ParseContext<> pc(expression.first);
+                    pc.setMemoization(i % 2 == 0);
+                    if (!add(pc) || !pc.sourceEnded() || pc.matches().size() != 1 || eval(pc.matches()[0]) != expression.second) {
+                        ++failureCount;
+                    }
+                }
+                {
+                    FlatParseContext pc(expression.first);
+                    if (!flatAdd(pc) || !pc.sourceEnded() || eval(*pc.matches().roots().begin()) != expression.second) {
+                        ++failureCount;
+                    }
+                }
+                {
+                    //errors and their lazily created messages are per parse context
+                    const std::string input = expression.first + ")";
+                    ParseContext<> pc(input);
+                    add(pc);
+                    for (const auto& error : pc.errors()) {
+                        if (error.message().empty()) {
+                            ++failureCount;
+                        }
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    assert(failureCount == 0);
+}
+
+
+//checks if two lists of matches are the same
+static bool sameMatches(const std::vector<ParseContext<>::MatchType>& a, const std::vector<ParseContext<>::MatchType>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].id() != b[i].id() || a[i].begin().iterator() != b[i].begin().iterator() || a[i].end().iterator() != b[i].end().iterator() || !sameMatches(a[i].children(), b[i].children())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static void unitTest_bytecode() {
+    //a grammar that uses all the compiled parser nodes
+    struct Grammar {
+        Grammar()
+            : ws(*terminalSet(' ', '\n'))
+            , identifier((+(terminalRange('a', 'z') | '_') - "null") == "identifier")
+            , number((-terminal('-') >> +terminalRange('0', '9')) == "number")
+            , list(('[' >> ws >> -(value >> *(',' >> ws >> value)) >> ']') >= "list")
+            , value(((terminal("null") == "null") | number | identifier | list | (&terminal('{') >> '{' >> ws >> '}' >= "object")) >> ws)
+            , grammar(ws >> *value >> !terminal('$') >> eof())
+        {
+        }
+
+        const Rule<> ws;
+        const Rule<> identifier;
+        const Rule<> number;
+        const Rule<> list;
+        const Rule<> value;
+        const Rule<> grammar;
+    };
+
+    const Grammar g;
+    const auto program = compileBytecode(g.grammar);
+    const auto listProgram = compileBytecode(g.list);
+
+    //the program gives the same results as the grammar, for valid and invalid input
+    const auto compare = [](const Rule<>& rule, const BytecodeProgram<ParseContext<>>& program, const std::string& input) {
+        ParseContext<> treePC(input);
+        const bool treeResult = rule(treePC);
+
+        ParseContext<> pc(input);
+        const bool result = program(pc);
+
+        assert(result == treeResult);
+        assert(pc.sourcePosition().iterator() == treePC.sourcePosition().iterator());
+        assert(sameMatches(pc.matches(), treePC.matches()));
+        assert(pc.errors().size() == treePC.errors().size());
+        for (size_t i = 0; i < pc.errors().size(); ++i) {
+            assert(pc.errors()[i].position().iterator() == treePC.errors()[i].position().iterator());
+            assert(pc.errors()[i].message() == treePC.errors()[i].message());
+        }
+        return result;
+    };
+    for (const std::string input : { "", "a [1, -2, [x_y, null]] {} nullable", "[1, [2, a]] b", "[1, [2 a]]", "[1, 2", "a $", "[-]", "[1 2]", "[{ }, []]" }) {
+        compare(g.grammar, program, input);
+        compare(g.list, listProgram, input);
+    }
+    assert(compare(g.grammar, program, "a [1, -2, [x_y, null]] {} nullable"));
+    assert(!compare(g.list, listProgram, "[1 2]"));
+
+    {
+        //error recovery parsers that fail leave the position where recovery stopped, as the grammar does,
+        //unless they are within a sequence, which restores its state
+        const Rule<> leaking = terminal('q') >> ~terminal('r');
+        const Rule<> recoveryChoice = (terminal('q') >> ~terminal('r')) | terminal('q');
+        const Rule<> recoveryLoop = *(terminal('q') >> ~terminal('r'));
+        const Rule<> recoveryLoop1 = +(terminal('q') >> ~terminal('r')) >> -terminal('x');
+        const Rule<> recoveryOptional = -(terminal('q') >> ~terminal('r'));
+        const Rule<> recoveryMatch = ((terminal('q') >> ~terminal('r')) == "recovery") | (terminal('q') == "q");
+        const Rule<> recoveryRule = leaking | terminal('q');
+        const Rule<> recoverySequence = (terminal('a') >> (terminal('q') >> ~terminal('r'))) | (terminal('a') >> terminal('q'));
+        const Rule<> recoveryNested = (terminal('a') >> ((terminal('q') >> ~terminal('r')) | terminal('x'))) | (terminal('a') >> terminal('q'));
+        const auto compareRecovery = [&](const Rule<>& rule) {
+            const auto recoveryProgram = compileBytecode(rule);
+            for (const std::string input : { "", "q", "qx", "qr", "qxr", "qrqx", "qxxqr", "aqx", "aqr", "x" }) {
+                compare(rule, recoveryProgram, input);
+            }
+        };
+        for (const Rule<>& rule : { std::cref(leaking), std::cref(recoveryChoice), std::cref(recoveryLoop), std::cref(recoveryLoop1), std::cref(recoveryOptional),
+            std::cref(recoveryMatch), std::cref(recoveryRule), std::cref(recoverySequence), std::cref(recoveryNested) }) {
+            compareRecovery(rule);
+        }
+    }
+
+    {
+        //left-recursive rules are invoked natively
+        const std::string input = "1+2*(3-4)/5";
+        ParseContext<> treePC(input);
+        assert(add(treePC));
+
+        const auto addProgram = compileBytecode(add);
+        ParseContext<> pc(input);
+        assert(addProgram(pc));
+        assert(pc.sourceEnded());
+        assert(sameMatches(pc.matches(), treePC.matches()));
+        assert(addProgram.instructions()[0].opcode == BytecodeOpcode::Native);
+    }
+
+    {
+        //nesting is limited by memory, not by the native stack; the deep match tree is stored in a flat match tree
+        const Rule<FlatParseContext> nested = ('[' >> -nested >> ']') >= "list";
+        const auto nestedProgram = compileBytecode(nested);
+        const size_t depth = 100000;
+        const std::string input = std::string(depth, '[') + std::string(depth, ']');
+        FlatParseContext pc(input);
+        BytecodeMachine<FlatParseContext> machine(nestedProgram);
+        assert(machine(pc));
+        assert(pc.sourceEnded());
+        assert(pc.matches().size() == depth && pc.matches().roots().size() == 1);
+        assert(machine.maxStackSize() > depth);
+    }
+
+    {
+        //cuts and match handlers behave as in the grammar
+        const auto record = ((+terminalRange('0', '9') == "field") >> cut() >> ';') >= "record";
+        const auto recordProgram = compileBytecode<ParseContext<>>(record);
+        const auto recordsProgram = compileBytecode<ParseContext<>>(*record);
+        const std::string input = "1;2;3";
+        size_t treeDeliveredCount = 0;
+        size_t deliveredCount = 0;
+        ParseContext<> treePC(input);
+        treePC.setMatchHandler([&](const Match<std::string, std::string, SourcePosition<>>& match) {
+            ++treeDeliveredCount;
+        });
+        ParseContext<> pc(input);
+        pc.setMatchHandler([&](const Match<std::string, std::string, SourcePosition<>>& match) {
+            ++deliveredCount;
+        });
+        assert(!(*record)(treePC));
+        assert(!recordsProgram(pc));
+        assert(deliveredCount == 2 && treeDeliveredCount == 2);
+        assert(pc.matches().empty());
+        assert(recordProgram.instructions().size() < recordsProgram.instructions().size());
+    }
+}
+
+
+static void unitTest_firstSet() {
+    {
+        //first sets of sequences include the children up to the first child that is not nullable
+        CharacterSet set;
+        bool nullable;
+        assert(addFirstSet(-terminal('-') >> *terminal(' ') >> +terminalRange('0', '9') >> 'x', set, nullable));
+        assert(!nullable);
+        assert(set.contains('-') && set.contains(' ') && set.contains('0') && set.contains('9'));
+        assert(!set.contains('x'));
+    }
+
+    {
+        //predicates do not consume input; nullable nodes are reported
+        CharacterSet set;
+        bool nullable;
+        assert(addFirstSet(!terminal('a') >> terminal("bc"), set, nullable));
+        assert(!nullable);
+        assert(set.contains('b') && !set.contains('a') && !set.contains('c'));
+        assert(addFirstSet(*terminal('a') | eof(), set, nullable));
+        assert(nullable);
+    }
+
+    {
+        //the first set of a rule is unknown
+        const Rule<> rule = terminal('a');
+        CharacterSet set;
+        bool nullable;
+        assert(!addFirstSet(terminal('b') | rule, set, nullable));
+        assert(addFirstSet(terminal('b') >> rule, set, nullable));
+    }
+
+    {
+        //a choice skips alternatives that cannot parse the current element, and parses the same as without skipping
+        const auto grammar = ((terminal('(') >> 'a' >> ')') == "group")
+                           | ((terminal('[') >> 'a' >> ']') == "option")
+                           | ((+terminalRange('0', '9')) == "number")
+                           | (*terminal(' ') == "space");
+        for (const std::string input : { "(a)", "[a]", "123", "  ", "" }) {
+            ParseContext<> pc(input);
+            assert(grammar(pc));
+            assert(pc.sourceEnded());
+            assert(pc.matches().size() == 1);
+        }
+    }
+
+    {
+        //case insensitive sources use the case insensitive first sets
+        using PC = ParseContext<std::string, std::string, SourcePosition<std::string, false>>;
+        const Rule<PC> grammar = (terminal('a') >> 'b') | (terminal('c') >> 'd');
+        const std::string input = "CD";
+        PC pc(input);
+        assert(grammar(pc));
+        assert(pc.sourceEnded());
+    }
+
+    {
+        //on failure, the errors are the same as the ones of trying the alternatives in order
+        const Rule<> group = terminal('(') >> 'a' >> ')';
+        const Rule<> option = terminal('[') >> 'a' >> ']';
+        const Rule<> referenceGrammar = group | option;
+        const auto grammar = (terminal('(') >> 'a' >> ')') | (terminal('[') >> 'a' >> ']');
+        for (const std::string input : { "{", "(b", "[b", "" }) {
+            ParseContext<> pc(input);
+            ParseContext<> referencePC(input);
+            assert(!grammar(pc));
+            assert(!referenceGrammar(referencePC));
+            assert(pc.errors().size() == referencePC.errors().size());
+            for (size_t index = 0; index < pc.errors().size(); ++index) {
+                assert(pc.errors()[index].position() == referencePC.errors()[index].position());
+                assert(pc.errors()[index].message() == referencePC.errors()[index].message());
+            }
+        }
+    }
+
+    {
+        //failing nested choices do not parse the alternatives again in order to record their errors
+        using PC = ParseContext<std::string, std::string, SourcePosition<>, std::vector<Match<std::string, std::string, SourcePosition<>>>, TrackErrors, ProfileParsing>;
+        const Rule<PC> nested = (terminal('(') >> nested >> ')') | (terminal('[') >> nested >> ']') | 'x';
+        const size_t depth = 24;
+        const std::string input = std::string(depth, '(') + 'y';
+        PC pc(input);
+        assert(!nested(pc));
+        assert(pc.profile().rule(nested.index()).invocations == depth + 1);
+        assert(pc.errors().size() == 1);
+        assert(pc.errors()[0].position().iterator() == input.begin() + depth);
+    }
+}
+
+
+static void unitTest_profiling() {
+    using PC = ParseContext<std::string, std::string, SourcePosition<>, std::vector<Match<std::string, std::string, SourcePosition<>>>, TrackErrors, ProfileParsing>;
+
+    //without instrumentation, there is no profile
+    static_assert(std::is_empty_v<ParseContext<>::ProfileType>);
+
+    {
+        //invocations, backtracking and choice hits
+        const Rule<PC> letter = terminalRange('a', 'z');
+        const Rule<PC> pair = (letter >> 'x') | (letter >> 'y');
+        const Rule<PC> grammar = *pair;
+        const std::string input = "axayaz";
+        PC pc(input);
+        pc.profile().setRuleName(pair.index(), "pair");
+        pc.profile().setRuleName(grammar.index(), "grammar");
+        assert(grammar(pc));
+        assert(pc.sourcePosition().iterator() == input.begin() + 4);
+
+        const auto& profile = pc.profile();
+        assert(profile.rule(grammar.index()).invocations == 1);
+        assert(profile.rule(pair.index()).invocations == 3);
+        assert(profile.rule(pair.index()).successes == 2);
+        assert(profile.rule(pair.index()).failures == 1);
+        assert(profile.rule(letter.index()).invocations == 5);
+        assert(profile.rule(pair.index()).backtrackedBytes == 3);
+        assert(profile.rule(grammar.index()).inclusiveTime >= profile.rule(pair.index()).inclusiveTime);
+
+        assert(profile.choices().size() == 1);
+        const auto& choice = profile.choices().begin()->second;
+        assert(choice.rule == pair.index());
+        assert(choice.invocations == 3);
+        assert(choice.hits == std::vector<size_t>({ 1, 1 }));
+
+        std::stringstream stream;
+        profile.writeFoldedStacks(stream);
+        assert(stream.str().find("grammar;pair;rule" + std::to_string(letter.index()) + " ") != std::string::npos);
+        assert(profile.report().find("pair\t3\t2\t1\t3\t0\t") != std::string::npos);
+    }
+
+    {
+        //left recursion continuation iterations
+        Rule<PC> add = (add >> '+' >> terminalRange('0', '9')) | terminalRange('0', '9');
+        const std::string input = "1+2+3";
+        PC pc(input);
+        assert(add(pc));
+        assert(pc.sourceEnded());
+        assert(pc.profile().rule(add.index()).leftRecursionIterations == 2);
+        assert(pc.profile().rule(add.index()).successes == 1);
+    }
+}
+
+
+static void unitTest_incremental() {
+    using PC = IncrementalParseContext<std::string, std::string, LineCountingSourcePosition<>>;
+
+    //only incremental parse contexts and parse contexts over push sources track the examined source
+    static_assert(PC::ExaminedSourcePolicy::enabled && ParseContext<PushSource<>>::ExaminedSourcePolicy::enabled);
+    static_assert(!ParseContext<>::ExaminedSourcePolicy::enabled);
+    {
+        const std::string input = "abc";
+        ParseContext<> pc(input);
+        pc.setMemoization(true);
+        assert(terminal("abc")(pc));
+        assert(pc.examinedOffset() == 0);
+    }
+
+    size_t count = 0;
+    const Rule<PC> identifier = (InvocationCounter(count) >> +terminalRange('a', 'z')) == "identifier";
+    const Rule<PC> statement = identifier >> ';' >> *terminal('\n');
+    const Rule<PC> grammar = *statement >> eof();
+
+    //reparses the edited source incrementally and compares the result to parsing it from scratch;
+    //returns the number of identifiers parsed again
+    const auto reparse = [&](PC& pc, const std::string& input, size_t offset, size_t removedCount, size_t insertedCount) {
+        count = 0;
+        pc.applyEdit(input, offset, removedCount, insertedCount);
+        assert(grammar(pc));
+        assert(pc.sourceEnded());
+        const size_t reparsedCount = count;
+
+        PC referencePC(input);
+        assert(grammar(referencePC));
+        assert(pc.matches().size() == referencePC.matches().size());
+        for (size_t index = 0; index < pc.matches().size(); ++index) {
+            const auto& match = pc.matches()[index];
+            const auto& referenceMatch = referencePC.matches()[index];
+            assert(match.content() == referenceMatch.content());
+            assert(match.begin() == referenceMatch.begin());
+            assert(match.begin().line() == referenceMatch.begin().line());
+            assert(match.begin().column() == referenceMatch.begin().column());
+            assert(match.end().line() == referenceMatch.end().line());
+        }
+        return reparsedCount;
+    };
+
+    {
+        //an edit within one statement parses only that statement again
+        const std::string input = "alpha;\nbeta;\ngamma;\n";
+        PC pc(input);
+        pc.setMemoization(true);
+        assert(grammar(pc));
+        assert(pc.sourceEnded());
+        assert(count == 4);
+
+        const std::string edited1 = "alpha;\ndelta;\ngamma;\n";
+        assert(reparse(pc, edited1, 7, 4, 5) == 1);
+        assert(pc.matches()[2].content() == "gamma");
+        assert(pc.matches()[2].begin().line() == 3);
+
+        //inserting a line moves the following statements to the next line
+        const std::string edited2 = "alpha;\ndelta;\nx;\ngamma;\n";
+        assert(reparse(pc, edited2, 14, 0, 3) == 1);
+        assert(pc.matches()[3].content() == "gamma");
+        assert(pc.matches()[3].begin().line() == 4);
+
+        //removing a statement parses nothing again
+        const std::string edited3 = "alpha;\ndelta;\ngamma;\n";
+        assert(reparse(pc, edited3, 14, 3, 0) == 0);
+        assert(pc.matches()[2].begin().line() == 3);
+    }
+
+    {
+        //appending to the source parses only the appended statement
+        const std::string input = "alpha;\n";
+        PC pc(input);
+        pc.setMemoization(true);
+        assert(grammar(pc));
+        const std::string edited = "alpha;\nbeta;\n";
+        assert(reparse(pc, edited, 7, 0, 6) == 1);
+    }
+
+    {
+        //an edit that joins two statements parses both again
+        const std::string input = "alpha;\nbeta;\n";
+        PC pc(input);
+        pc.setMemoization(true);
+        assert(grammar(pc));
+        const std::string edited = "alphabeta;\n";
+        assert(reparse(pc, edited, 5, 2, 0) == 1);
+        assert(pc.matches().size() == 1);
+    }
+}
+
+
+static void unitTest_maxRuleDepth() {
+    Rule<> value = ('(' >> value >> ')') | terminalRange('0', '9');
+    const std::string shallowInput = std::string(50, '(') + "1" + std::string(50, ')');
+    const std::string deepInput = std::string(200, '(') + "1" + std::string(200, ')');
+
+    {
+        //by default, the depth is unlimited
+        ParseContext<> pc(deepInput);
+        assert(value(pc));
+        assert(pc.sourceEnded());
+        assert(pc.ruleDepth() == 0);
+    }
+
+    {
+        //input within the max depth parses normally
+        ParseContext<> pc(shallowInput);
+        pc.setMaxRuleDepth(100);
+        assert(value(pc));
+        assert(pc.sourceEnded());
+    }
+
+    {
+        //input deeper than the max depth fails with an exception, and the parse context remains usable
+        ParseContext<> pc(deepInput);
+        pc.setMaxRuleDepth(100);
+        bool thrown = false;
+        try {
+            value(pc);
+        }
+        catch (const ParseDepthException<ParseContext<>>& ex) {
+            thrown = true;
+            assert(ex.depth() == 100);
+            assert(ex.position().iterator() == deepInput.begin() + 100);
+        }
+        assert(thrown);
+        assert(pc.ruleDepth() == 0);
+
+        //the nesting of a bytecode program is not limited by the native stack
+        const auto program = compileBytecode(value);
+        ParseContext<> programPC(deepInput);
+        programPC.setMaxRuleDepth(100);
+        assert(program(programPC));
+        assert(programPC.sourceEnded());
+    }
+}
+
+
+static void unitTest_lineIndex() {
+    //newlines at the beginning, at the end, consecutive, and across the blocks of the simd scan
+    std::string input = "\nab\n\ncd";
+    for (size_t i = 0; i < 100; ++i) {
+        input += std::string(i % 37, 'x') + "\n";
+    }
+    input += "end";
+
+    {
+        //the same lines and columns as the ones counted while parsing
+        const LineIndex<> index(input);
+        assert(index.lineCount() == 104);
+        LineCountingSourcePosition<> position(input.begin(), input.end());
+        for (;; position.increment()) {
+            const auto location = index.location(position.iterator());
+            assert(location.line == position.line());
+            assert(location.column == position.column());
+            if (position.iterator() == input.end()) {
+                break;
+            }
+        }
+    }
+
+    {
+        //the positions of errors and matches of a parse without line counting
+        const std::string source = "a = 1;\nb = 2 x;\nc = 3;\n";
+        const auto ws = *terminal(' ');
+        const auto statement = (terminalRange('a', 'z') == "name") >> ws >> '=' >> ws >> terminalRange('0', '9') >> ws >> ~terminal(';') >> *terminal('\n');
+        const auto grammar = *statement;
+        ParseContext<> pc(source);
+        assert(grammar(pc));
+        assert(pc.sourceEnded());
+        const LineIndex<> index(source);
+        assert(pc.matches().size() == 3);
+        assert(index.line(pc.matches()[2].begin()) == 3);
+        assert(index.column(pc.matches()[2].begin()) == 1);
+        assert(pc.errors().size() == 1);
+        assert(index.line(pc.errors()[0].position()) == 2);
+        assert(index.column(pc.errors()[0].position()) == 7);
+    }
+
+    {
+        //sources that are not contiguous
+        const std::list<char> source(input.begin(), input.end());
+        const LineIndex<std::list<char>> index(source);
+        assert(index.lineCount() == 104);
+        assert(index.line(std::next(source.begin(), 4)) == 3);
+        assert(index.column(std::next(source.begin(), 4)) == 1);
+        assert(index.location(source.end()).line == 104);
+        assert(index.location(source.end()).column == 4);
+    }
+
+    {
+        //an empty source has one line
+        const std::string source;
+        const LineIndex<> index(source);
+        assert(index.lineCount() == 1);
+        assert(index.line(source.begin()) == 1);
+        assert(index.column(source.begin()) == 1);
+    }
+}
+
+
+static void unitTest_compactSourcePosition() {
+    using CompactParseContext = ParseContext<std::string, std::string, CompactSourcePosition<>>;
+    static_assert(sizeof(CompactSourcePosition<>) == sizeof(std::string::const_iterator));
+    static_assert(sizeof(CompactParseContext::State) < sizeof(ParseContext<>::State));
+    static_assert(!HasSourceEnd<CompactSourcePosition<>>::value && HasSourceEnd<SourcePosition<>>::value);
+
+    const auto ws = *terminal(' ');
+    const auto identifier = +terminalRange('a', 'z');
+    const auto grammar = *(ws >> (terminal("let") == "let") >> ws >> (identifier == "name") >> ws >> ~terminal(';')) >> ws >> eof();
+
+    {
+        //the same results as the default source position
+        const std::string input = "let a; let bc x; let d;";
+        CompactParseContext pc(input);
+        ParseContext<> referencePC(input);
+        const bool ok = grammar(pc);
+        const bool referenceOk = grammar(referencePC);
+        assert(ok == referenceOk);
+        assert(pc.sourcePosition().iterator() == referencePC.sourcePosition().iterator());
+        assert(pc.matches().size() == referencePC.matches().size());
+        for (size_t index = 0; index < pc.matches().size(); ++index) {
+            assert(pc.matches()[index].id() == referencePC.matches()[index].id());
+            assert(pc.matches()[index].content() == referencePC.matches()[index].content());
+        }
+        assert(!pc.errors().empty() && pc.errors().size() == referencePC.errors().size());
+        for (size_t index = 0; index < pc.errors().size(); ++index) {
+            assert(pc.errors()[index].position().iterator() == referencePC.errors()[index].position().iterator());
+            assert(pc.errors()[index].message() == referencePC.errors()[index].message());
+        }
+    }
+
+    {
+        //a terminal string is not recognized past the end of the source
+        const std::string input = "le";
+        const auto let = terminal("let");
+        CompactParseContext pc(input);
+        assert(!let(pc));
+        assert(pc.sourcePosition().iterator() == input.begin());
+        assert(pc.errors().size() == 1);
+        assert(pc.errors()[0].message() == "Syntax error: expected: \"let\"");
+    }
+
+    {
+        //memoization, incremental parsing and bytecode
+        using IncrementalCompactParseContext = IncrementalParseContext<std::string, std::string, CompactSourcePosition<>>;
+        const Rule<IncrementalCompactParseContext> statement = ws >> (terminal("let") == "let") >> ws >> (identifier == "name") >> ws >> ';';
+        const Rule<IncrementalCompactParseContext> statements = *statement >> ws >> eof();
+        const std::string input = "let a; let b;";
+        IncrementalCompactParseContext pc(input);
+        pc.setMemoization(true);
+        assert(statements(pc));
+        const std::string edited = "let a; let bc;";
+        pc.applyEdit(edited, 11, 1, 2);
+        assert(statements(pc));
+        assert(pc.matches().size() == 4);
+        assert(pc.matches()[3].content() == "bc");
+
+        const auto program = compileBytecode(statements);
+        IncrementalCompactParseContext programPC(edited);
+        assert(program(programPC));
+        assert(programPC.matches().size() == 4);
+    }
+}
+
+
+static void unitTest_terminalStringComparison() {
+    using CaseInsensitiveParseContext = ParseContext<std::string, std::string, SourcePosition<std::string, false>>;
+    const std::string keyword = "Transaction_Isolation_Level_Serializable_Read_Committed";
+
+    {
+        //the bulk comparison agrees with the per-character comparison, at every length and mismatch place
+        const std::string folded = "abcdefghijklmnopqrstuvwxyz[\\]^_`@{|}0123456789abcdefghijklmnopqrstuvwxyz";
+        for (size_t length = 0; length <= folded.size(); ++length) {
+            std::string source = folded.substr(0, length);
+            for (char& c : source) {
+                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+            assert(equalCharactersCaseInsensitive(reinterpret_cast<const unsigned char*>(source.data()), reinterpret_cast<const unsigned char*>(folded.data()), length));
+            for (size_t index = 0; index < length; ++index) {
+                std::string other = source;
+                other[index] = static_cast<char>(other[index] ^ 0x20);
+                const bool expected = foldCharacter(other[index]) == folded[index];
+                assert(equalCharactersCaseInsensitive(reinterpret_cast<const unsigned char*>(other.data()), reinterpret_cast<const unsigned char*>(folded.data()), length) == expected);
+            }
+        }
+    }
+
+    {
+        //case sensitive
+        const auto parser = terminal(keyword.c_str());
+        const std::string input = keyword + " x";
+        ParseContext<> pc(input);
+        assert(parser(pc));
+        assert(pc.sourcePosition().iterator() == input.begin() + keyword.size());
+
+        std::string lower = keyword;
+        lower[0] = 't';
+        ParseContext<> lowerPC(lower);
+        assert(!parser(lowerPC));
+
+        std::string last = keyword;
+        last.back() = 'x';
+        ParseContext<> lastPC(last);
+        assert(!parser(lastPC));
+
+        const std::string shorter = keyword.substr(0, keyword.size() - 1);
+        ParseContext<> shorterPC(shorter);
+        assert(!parser(shorterPC));
+        assert(shorterPC.sourcePosition().iterator() == shorter.begin());
+    }
+
+    {
+        //case insensitive
+        const auto parser = terminal(keyword.c_str());
+        std::string mixed = keyword;
+        for (size_t index = 0; index < mixed.size(); index += 2) {
+            mixed[index] = static_cast<char>(std::toupper(static_cast<unsigned char>(mixed[index])));
+        }
+        CaseInsensitiveParseContext pc(mixed);
+        assert(parser(pc));
+        assert(pc.sourceEnded());
+
+        //the characters next to the letters are not folded
+        const std::string brackets = "{";
+        CaseInsensitiveParseContext bracketsPC(brackets);
+        assert(!terminal("[")(bracketsPC));
+
+        const std::string shorter = mixed.substr(0, mixed.size() - 1);
+        CaseInsensitiveParseContext shorterPC(shorter);
+        assert(!parser(shorterPC));
+    }
+
+    {
+        //sources that are not random access
+        std::istringstream stream("SELECT * FROM t");
+        StreamSource<> source(stream, 4);
+        ParseContext<StreamSource<>, std::string, SourcePosition<StreamSource<>, false>> pc(source);
+        assert(terminal("select")(pc));
+        assert(!terminal("*  FROM t")(pc));
+        assert(terminal(" * from t")(pc));
+        assert(pc.sourceEnded());
+        assert(!terminal("x")(pc));
+    }
+
+    {
+        //compact source positions and bytecode
+        const Rule<CaseInsensitiveParseContext> statement = terminal("select") >> ' ' >> (terminal("from") | terminal("where"));
+        const auto program = compileBytecode(statement);
+        const std::string input = "SELECT WHERE";
+        CaseInsensitiveParseContext pc(input);
+        assert(program(pc));
+        assert(pc.sourceEnded());
+
+        ParseContext<std::string, std::string, CompactSourcePosition<std::string, false>> compactPC(input);
+        assert((terminal("select") >> ' ' >> terminal("where"))(compactPC));
+        assert(compactPC.sourceEnded());
+    }
+}
+
+static void unitTest_keywordsParser() {
+    enum KEYWORD { SELECT, SELECT_DISTINCT, FROM, WHERE, IN, INTO };
+    using IntParseContext = ParseContext<std::string, int>;
+
+    {
+        //longest keyword
+        const auto parser = keywords({ "select", "select_distinct", "from", "where", "in", "into" });
+        const std::string input = "select_distinct";
+        ParseContext<> pc(input);
+        assert(parser(pc));
+        assert(pc.sourceEnded());
+    }
+
+    {
+        //first keyword, as a choice of terminal strings
+        const auto parser = keywords({ "select", "select_distinct" }, KeywordMatch::First);
+        const std::string input = "select_distinct";
+        ParseContext<> pc(input);
+        assert(parser(pc));
+        assert(pc.sourcePosition().iterator() == input.begin() + 6);
+    }
+
+    {
+        //matches with the ids of the keywords
+        const auto parser = *(keywords({ "select", "select_distinct", "from", "where", "in", "into" }, { SELECT, SELECT_DISTINCT, FROM, WHERE, IN, INTO }) >> -terminal(' '));
+        const std::string input = "select into in from wher";
+        IntParseContext pc(input);
+        assert(parser(pc));
+        assert(pc.sourcePosition().iterator() == input.begin() + 20);
+        assert(pc.matches().size() == 4);
+        assert(pc.matches()[0].id() == SELECT && pc.matches()[0].content() == "select");
+        assert(pc.matches()[1].id() == INTO && pc.matches()[1].content() == "into");
+        assert(pc.matches()[2].id() == IN && pc.matches()[2].content() == "in");
+        assert(pc.matches()[3].id() == FROM && pc.matches()[3].content() == "from");
+    }
+
+    {
+        //error at the beginning of an unrecognized keyword
+        const auto parser = keywords({ "select", "where" });
+        const std::string input = "wher ";
+        ParseContext<> pc(input);
+        assert(!parser(pc));
+        assert(pc.errors().size() == 1);
+        assert(pc.errors()[0].position().iterator() == input.begin());
+    }
+
+    {
+        //there shall be one match id for each keyword
+        bool exception = false;
+        try {
+            const auto parser = keywords({ "true", "false" }, { "bool" });
+        }
+        catch (const std::invalid_argument&) {
+            exception = true;
+        }
+        assert(exception);
+    }
+
+    {
+        //character string match ids
+        const auto parser = keywords({ "true", "false" }, { "bool", "bool" });
+        const std::string input = "false";
+        ParseContext<> pc(input);
+        assert(parser(pc));
+        assert(pc.matches().size() == 1 && pc.matches()[0].id() == "bool");
+    }
+
+    {
+        //failure when the source ends within a keyword, and at the end of the source without an error
+        const auto parser = keywords({ "where" });
+        const std::string input = "wh";
+        ParseContext<> pc(input);
+        assert(!parser(pc));
+        assert(pc.sourcePosition().iterator() == input.begin());
+        assert(pc.errors().size() == 1);
+
+        const std::string empty;
+        ParseContext<> emptyPC(empty);
+        assert(!parser(emptyPC));
+        assert(emptyPC.errors().empty());
+    }
+
+    {
+        //case insensitive
+        const auto parser = keywords({ "select", "from" }, { SELECT, FROM });
+        const std::string input = "SeLeCtFROM";
+        ParseContext<std::string, int, SourcePosition<std::string, false>> pc(input);
+        assert((parser >> parser)(pc));
+        assert(pc.sourceEnded());
+        assert(pc.matches().size() == 2 && pc.matches()[1].id() == FROM);
+
+        ParseContext<std::string, int> caseSensitivePC(input);
+        assert(!parser(caseSensitivePC));
+    }
+
+    {
+        //many keywords, in a choice, a rule and bytecode
+        std::vector<std::string> words;
+        for (size_t index = 0; index < 300; ++index) {
+            words.push_back("k" + std::to_string(index * 7919 % 1000));
+        }
+        const KeywordsParser<char> parser(words);
+        const Rule<> grammar = *((parser | terminal('x')) >> ' ');
+        std::string input;
+        for (size_t index = 0; index < words.size(); index += 3) {
+            input += words[index] + " x ";
+        }
+        ParseContext<> pc(input);
+        assert(grammar(pc));
+        assert(pc.sourceEnded());
+
+        const auto program = compileBytecode(grammar);
+        ParseContext<> programPC(input);
+        assert(program(programPC));
+        assert(programPC.sourceEnded());
+    }
+
+    {
+        //streams
+        std::istringstream stream("from select");
+        StreamSource<> source(stream, 4);
+        ParseContext<StreamSource<>> pc(source);
+        assert((keywords({ "select", "from" }) >> ' ' >> keywords({ "select", "from" }))(pc));
+        assert(pc.sourceEnded());
+    }
+}
+
+enum TOKEN { NUM, PLUS, MUL, LPAREN, RPAREN };
+
+
+using TokenParseContext = ParseContext<TokenStream<TOKEN>>;
+
+
+extern Rule<TokenParseContext> tokenAdd;
+
+
+static const Rule<TokenParseContext> tokenValue = (terminal(NUM) == "num") | (terminal(LPAREN) >> tokenAdd >> terminal(RPAREN));
+
+
+static const Rule<TokenParseContext> tokenMul = tokenValue >> *(terminal(MUL) >> tokenValue);
+
+
+Rule<TokenParseContext> tokenAdd = tokenMul >> *(terminal(PLUS) >> tokenMul);
+
+
+static void unitTest_tokenStream() {
+    const auto ws = *terminalSet(' ', '\n');
+    const auto lexer = *(ws >> ((+terminalRange('0', '9') == NUM) | (terminal('+') == PLUS) | (terminal('*') == MUL) | (terminal('(') == LPAREN) | (terminal(')') == RPAREN))) >> ws;
+    const auto grammar = tokenAdd >> eof();
+
+    {
+        //tokens and matches over tokens
+        const std::string input = "12 + 3 * (45 + 6)\n";
+        TokenStream<TOKEN> tokens;
+        assert(tokenize(lexer, input, tokens));
+        assert(tokens.size() == 9);
+        assert(tokens[0] == NUM && tokens[0].offset() == 0 && tokens[0].length() == 2);
+        assert(tokens[6] == PLUS && tokens[6].offset() == 13);
+        assert(tokens[8] == RPAREN && tokens.sourceOffset(tokens.end()) == input.size());
+
+        TokenParseContext pc(tokens);
+        assert(grammar(pc));
+        assert(pc.sourceEnded());
+        assert(pc.matches().size() == 4);
+        const auto& match = pc.matches()[2];
+        assert(match.contentView().size() == 1 && match.contentView()[0] == NUM);
+        assert(std::string(tokens.sourceIterator(match.begin().iterator()), tokens.sourceEndIterator(match.end().iterator())) == "45");
+    }
+
+    {
+        //errors are mapped back to characters
+        const std::string input = "(1 +\n2 3)";
+        TokenStream<TOKEN> tokens;
+        assert(tokenize(lexer, input, tokens));
+        TokenParseContext pc(tokens);
+        assert(!grammar(pc));
+        assert(!pc.errors().empty());
+        const auto position = tokens.sourceIterator(pc.errors().back().position().iterator());
+        assert(position == input.begin() + 7);
+        const LineIndex<> index(input);
+        assert(index.line(position) == 2 && index.column(position) == 3);
+    }
+
+    {
+        //tokenizing stops at unknown characters
+        const std::string input = "1 + x";
+        TokenStream<TOKEN> tokens;
+        assert(!tokenize(lexer, input, tokens));
+        assert(tokens.size() == 2);
+        assert(tokens.sourceEndIterator(tokens.end()) == input.begin() + 3);
+    }
+}
+
+static void unitTest_parseArena() {
+    const auto ws = *terminal(' ');
+    const auto identifier = +terminalRange('a', 'z') == "identifier";
+    const auto grammar = *(ws >> ((identifier >> ws >> '=' >> ws >> identifier >> ws >> ';') >= "assignment")) >> ws;
+    const std::string input = "a = b; cd = ef; g = ;";
+
+    ParseArena arena(64);
+    size_t capacity = 0;
+    for (size_t iteration = 0; iteration < 3; ++iteration) {
+        arena.reset();
+        ArenaParseContext<> pc(input, &arena);
+        ParseContext<> referencePC(input);
+        assert(grammar(pc) == grammar(referencePC));
+        assert(pc.sourcePosition().iterator() == referencePC.sourcePosition().iterator());
+
+        //matches, their children and errors are allocated from the arena
+        assert(pc.matches().size() == 2 && pc.matches().size() == referencePC.matches().size());
+        assert(pc.matches().get_allocator().resource() == &arena);
+        for (size_t index = 0; index < pc.matches().size(); ++index) {
+            const auto& match = pc.matches()[index];
+            assert(match.id() == "assignment" && match.content() == referencePC.matches()[index].content());
+            assert(match.children().size() == 2 && match.children().get_allocator().resource() == &arena);
+            assert(match.children()[1].content() == referencePC.matches()[index].children()[1].content());
+        }
+        assert(pc.errors().size() == referencePC.errors().size() && pc.errors().get_allocator().resource() == &arena);
+
+        //after the first parse, the arena has one block that is large enough
+        if (iteration == 0) {
+            assert(arena.blockCount() > 1);
+        }
+        else {
+            assert(arena.blockCount() == 1);
+            if (iteration == 1) {
+                capacity = arena.capacity();
+            }
+            assert(arena.capacity() == capacity);
+        }
+    }
+
+    //the default memory resource is used without an arena
+    ArenaParseContext<> pc(input);
+    assert(pc.allocator().resource() == std::pmr::get_default_resource());
+}
+
+static void unitTest_reset() {
+    const auto ws = *terminal(' ');
+    const auto identifier = +terminalRange('a', 'z') == "identifier";
+    const auto grammar = *(ws >> ((identifier >> ws >> '=' >> ws >> identifier >> ws >> ';') >= "assignment")) >> ws;
+    const std::vector<std::string> inputs = { "a = b; cd = ef; g = ;", "x = y;", "", "p = q; r = s; t = u; v = ;" };
+
+    //a reset parse context parses as a new one does
+    ParseContext<> pc(inputs[0]);
+    pc.reserve(16, 4);
+    const size_t matchCapacity = pc.matches().capacity();
+    const size_t errorCapacity = pc.errors().capacity();
+    assert(matchCapacity >= 16 && errorCapacity >= 4);
+    for (size_t iteration = 0; iteration < 2; ++iteration) {
+        for (const std::string& input : inputs) {
+            pc.reset(input);
+            ParseContext<> referencePC(input);
+            assert(grammar(pc) == grammar(referencePC));
+            assert(pc.sourcePosition().iterator() == referencePC.sourcePosition().iterator());
+            assert(pc.matches().size() == referencePC.matches().size());
+            for (size_t index = 0; index < pc.matches().size(); ++index) {
+                assert(pc.matches()[index].content() == referencePC.matches()[index].content());
+                assert(pc.matches()[index].children().size() == referencePC.matches()[index].children().size());
+            }
+            assert(pc.errors().size() == referencePC.errors().size());
+            for (size_t index = 0; index < pc.errors().size(); ++index) {
+                assert(pc.errors()[index].position().iterator() == referencePC.errors()[index].position().iterator());
+            }
+
+            //the containers keep their memory
+            assert(pc.matches().capacity() == matchCapacity);
+            assert(pc.errors().capacity() == errorCapacity);
+        }
+    }
+
+    //the memoization flag is kept, and the memoized results are discarded
+    {
+        ParseContext<> memoPC(inputs[0]);
+        memoPC.setMemoization(true);
+        assert(grammar(memoPC));
+        memoPC.reset(inputs[1]);
+        assert(memoPC.memoization());
+        assert(grammar(memoPC) && memoPC.sourceEnded());
+        assert(memoPC.matches().size() == 1 && memoPC.matches()[0].content() == "x = y;");
+    }
+
+    //a flat match tree keeps its memory
+    {
+        FlatParseContext flatPC(inputs[0]);
+        flatPC.reserve(32);
+        const size_t capacity = flatPC.matches().capacity();
+        for (const std::string& input : inputs) {
+            flatPC.reset(input);
+            FlatParseContext referencePC(input);
+            assert(grammar(flatPC) == grammar(referencePC));
+            assert(flatPC.matches().size() == referencePC.matches().size());
+            assert(flatPC.matches().capacity() == capacity);
+        }
+    }
+
+    //resetting from a source position parses a part of a source
+    {
+        const std::string input = "a = b; cd = ef;";
+        SourcePosition<> begin(input.begin(), input.end());
+        begin.increase(7);
+        pc.reset(begin);
+        assert(grammar(pc) && pc.sourceEnded());
+        assert(pc.matches().size() == 1 && pc.matches()[0].content() == "cd = ef;");
+    }
+}
+
+
+static void unitTest_errorRecoveryScan() {
+    const auto ws = *terminal(' ');
+    const auto identifier = +terminalRange('a', 'z');
+    const auto assignment = identifier >> ws >> '=' >> ws >> identifier >> ws;
+    const std::string input = "a = b; c = = d; e = f;";
+
+    //the FIRST set of the recovery parser skips to the recovery position; the result is the same as invoking the recovery parser at each position
+    {
+        const Rule<> end = terminal(';');
+        const auto grammar = *(ws >> ((assignment >> ~terminal(';')) == "statement"));
+        const auto referenceGrammar = *(ws >> ((assignment >> ~end) == "statement"));
+        ParseContext<> pc(input);
+        ParseContext<> referencePC(input);
+        assert(grammar(pc) && pc.sourceEnded());
+        assert(referenceGrammar(referencePC) && referencePC.sourceEnded());
+        assert(pc.matches().size() == 3 && referencePC.matches().size() == 3);
+        assert(pc.matches()[1].content() == "c = = d;" && referencePC.matches()[1].content() == "c = = d;");
+        assert(pc.errors().size() == 1 && referencePC.errors().size() == 1);
+        assert(pc.errors()[0].position().iterator() == referencePC.errors()[0].position().iterator());
+        assert(pc.recoveryCount() == 1);
+    }
+
+    //a sync set limits the invocations of the recovery parser to the positions of the set
+    {
+        size_t count = 0;
+        const auto grammar = *(ws >> ((assignment >> recoveryPoint(InvocationCounter(count) >> ';', terminal(';'))) == "statement"));
+        ParseContext<> pc(input);
+        assert(grammar(pc) && pc.sourceEnded());
+        assert(pc.matches().size() == 3 && pc.errors().size() == 1);
+        assert(count == 3);
+
+        size_t referenceCount = 0;
+        const auto referenceGrammar = *(ws >> ((assignment >> ~(InvocationCounter(referenceCount) >> ';')) == "statement"));
+        ParseContext<> referencePC(input);
+        assert(referenceGrammar(referencePC) && referencePC.sourceEnded());
+        assert(referencePC.matches().size() == 3 && referencePC.errors().size() == 1);
+        assert(referenceCount == 10);
+    }
+
+    //the max distance limits the number of skipped elements; the erroneous statement needs 7 elements to be skipped
+    for (size_t maxDistance = 6; maxDistance <= 7; ++maxDistance) {
+        const auto grammar = *(ws >> ((assignment >> recoveryPoint(terminal(';'), maxDistance)) == "statement"));
+        const auto syncGrammar = *(ws >> ((assignment >> recoveryPoint(terminal(';'), terminal(';'), maxDistance)) == "statement"));
+        const Rule<> end = terminal(';');
+        const auto ruleGrammar = *(ws >> ((assignment >> recoveryPoint(end, maxDistance)) == "statement"));
+        ParseContext<> pc(input);
+        ParseContext<> syncPC(input);
+        ParseContext<> rulePC(input);
+        grammar(pc);
+        syncGrammar(syncPC);
+        ruleGrammar(rulePC);
+        for (const auto* context : { &pc, &syncPC, &rulePC }) {
+            assert(context->sourceEnded() == (maxDistance == 7));
+            assert(context->matches().size() == (maxDistance == 7 ? 3 : 1));
+        }
+    }
+
+    //the max recovery count limits the number of recoveries
+    {
+        const auto grammar = *(ws >> ((assignment >> ~terminal(';')) == "statement"));
+        const std::string input2 = "a = b; c = = d; e = = f; g = h;";
+        ParseContext<> pc(input2);
+        pc.setMaxRecoveryCount(1);
+        grammar(pc);
+        assert(!pc.sourceEnded());
+        assert(pc.matches().size() == 2 && pc.recoveryCount() == 1);
+        pc.reset(input2);
+        assert(pc.recoveryCount() == 0 && pc.maxRecoveryCount() == 1);
+        pc.setMaxRecoveryCount(SIZE_MAX);
+        assert(grammar(pc) && pc.sourceEnded());
+        assert(pc.matches().size() == 4 && pc.errors().size() == 2 && pc.recoveryCount() == 2);
+    }
+
+    //the sync parser shall have a known FIRST set and shall not be nullable
+    bool thrown = false;
+    try {
+        recoveryPoint(terminal(';'), *terminal(' '));
+    }
+    catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+
+static void unitTest_ebnfCompiler() {
+    const std::string source =
+        "(* arithmetic expressions *)\n"
+        "expr = term, { ('+' | '-'), term };\n"
+        "term = factor, { '*', factor };\n"
+        "factor = number | '(', expr, ')' | 'abs', '(', expr, ')';\n"
+        "number = ['-'], digit+;\n"
+        "digit = '0' | '1' | '2' | '3' | '4' | '5' | '6' | '7' | '8' | '9';\n"
+        "name = (letter, { letter | digit }) - keyword;\n"
+        "letter = 'a' | 'b' | 'c' | 'i' | 'f';\n"
+        "keyword = 'if';\n";
+
+    //each rule adds a tree match with the name of the rule
+    {
+        const ebnf::Grammar grammar = ebnf::compile(source);
+        assert(grammar.rootRule() == "expr");
+        assert(grammar.ruleNames().size() == 8 && grammar.ruleNames()[3] == "number");
+
+        const std::string input = "1+-23*(4-abs(5))";
+        ebnf::GrammarParseContext pc(input);
+        assert(grammar(pc) && pc.sourceEnded());
+        assert(pc.matches().size() == 1);
+        const auto& expr = pc.matches()[0];
+        assert(expr.id() == "expr" && expr.content() == input);
+        assert(expr.children().size() == 2);
+        assert(expr.children()[0].id() == "term" && expr.children()[0].content() == "1");
+        const auto& term = expr.children()[1];
+        assert(term.id() == "term" && term.content() == "-23*(4-abs(5))" && term.children().size() == 2);
+        assert(term.children()[0].children()[0].id() == "number" && term.children()[0].children()[0].children().size() == 2);
+        assert(term.children()[1].children()[0].id() == "expr");
+
+        //errors are recorded
+        const std::string invalidInput = "x";
+        ebnf::GrammarParseContext invalidPC(invalidInput);
+        assert(!grammar(invalidPC));
+        assert(!invalidPC.errors().empty());
+    }
+
+    //exceptions, and a root rule other than the first rule
+    {
+        const ebnf::Grammar grammar = ebnf::compile(source, "name");
+        for (const char* input : { "abc", "fi", "i", "if", "ifa" }) {
+            const std::string str = input;
+            ebnf::GrammarParseContext pc(str);
+            const bool ok = grammar(pc) && pc.sourceEnded();
+            assert(ok == (str != "if" && str != "ifa"));
+            assert(!ok || (pc.matches().size() == 1 && pc.matches()[0].id() == "name"));
+        }
+    }
+
+    //invalid grammars
+    const auto compileError = [](const std::string& grammarSource, const std::string& root, const std::string& text) {
+        try {
+            ebnf::compile(grammarSource, root);
+        }
+        catch (const std::runtime_error& ex) {
+            return std::string(ex.what()).find(text) != std::string::npos;
+        }
+        return false;
+    };
+    assert(compileError("a = 'x';\nb = c;", "", "rule 'c' is not defined at line 2, column 5"));
+    assert(compileError("a = 'x';\na = 'y';", "", "rule 'a' is defined twice at line 2"));
+    assert(compileError("a = ['x'], b;\nb = a, 'y' | 'z';", "", "rule 'a' is left-recursive at line 1"));
+    assert(compileError("a = 'x';", "b", "the root rule 'b' is not defined"));
+    assert(compileError("a = 'x'\nb = 'y';", "", "syntax error"));
+    assert(compileError("", "", "the grammar has no rules"));
+
+    //grammar files are compiled once
+    const char* filename = "parserlib_unitTest_ebnfCompiler.ebnf";
+    {
+        std::ofstream file(filename, std::ios::binary);
+        file << source;
+    }
+    const std::shared_ptr<const ebnf::Grammar> grammar = ebnf::load(filename);
+    assert(ebnf::load(filename) == grammar);
+    assert(ebnf::load(filename, "name") != grammar && ebnf::load(filename, "name")->rootRule() == "name");
+    std::remove(filename);
+    assert(ebnf::load(filename) == grammar);
+    {
+        const std::string input = "(1)";
+        ebnf::GrammarParseContext pc(input);
+        assert((*grammar)(pc) && pc.sourceEnded());
+    }
+    bool thrown = false;
+    try {
+        ebnf::load("parserlib_unitTest_ebnfCompiler_missing.ebnf");
+    }
+    catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+
+template <class Source, class MatchType, class SerializedMatch>
+static bool equalMatches(const Source& source, const MatchType& match, const SerializedMatch& serialized) {
+    if (serialized.id() != match.id()
+        || serialized.begin() != static_cast<size_t>(match.begin().iterator() - source.begin())
+        || serialized.end() != static_cast<size_t>(match.end().iterator() - source.begin())
+        || serialized.children().size() != match.children().size())
+    {
+        return false;
+    }
+    auto serializedChild = serialized.children().begin();
+    for (const auto& child : match.children()) {
+        if (!equalMatches(source, child, *serializedChild++)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static void unitTest_serializedMatchTree() {
+    //string ids, from a flat match tree, through a file
+    {
+        const std::string input = "1+2*3-4";
+        FlatParseContext pc(input);
+        const bool ok = flatAdd(pc);
+        assert(ok && pc.sourceEnded());
+        const std::vector<char> data = serializeMatches(input, pc.matches());
+
+        const char* filename = "parserlib_unitTest_serializedMatchTree.bin";
+        {
+            std::ofstream file(filename, std::ios::binary);
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+        {
+            const MappedFileSource file(filename);
+            const SerializedMatchTree<std::string> tree(file.data(), file.size());
+            assert(tree.size() == pc.matches().size());
+            assert(tree.stringCount() == 4);
+            assert(tree.roots().size() == 1);
+            const auto root = *tree.roots().begin();
+            assert(root.id() == "sub" && root.begin() == 0 && root.end() == input.size() && root.subtreeSize() == tree.size());
+            assert(equalMatches(input, *pc.matches().roots().begin(), root));
+            assert(tree.match(tree.size() - 1).id() == "int" && tree.match(tree.size() - 1).begin() == 6);
+        }
+        std::remove(filename);
+    }
+
+    //enumeration ids, from a vector of matches
+    {
+        const std::string input = "a = 'x', {b};\nb = 'y' | 'z';";
+        std::vector<ebnf::Match> matches;
+        const bool ok = ebnf::parse(input, matches);
+        assert(ok && matches.size() == 2);
+        const std::vector<char> data = serializeMatches(input, matches);
+        const SerializedMatchTree<ebnf::EBNF> tree(data.data(), data.size());
+        assert(tree.stringCount() == 0);
+        assert(tree.roots().size() == 2);
+        auto it = tree.roots().begin();
+        for (const ebnf::Match& match : matches) {
+            assert((*it).id() == ebnf::EBNF::RULE);
+            assert(equalMatches(input, match, *it++));
+        }
+        assert(it == tree.roots().end());
+
+        //unaligned data
+        std::vector<char> unaligned(data.size() + 1);
+        std::memcpy(unaligned.data() + 1, data.data(), data.size());
+        const SerializedMatchTree<ebnf::EBNF> unalignedTree(unaligned.data() + 1, data.size());
+        assert(equalMatches(input, matches[1], *++unalignedTree.roots().begin()));
+    }
+
+    //no matches
+    {
+        const std::string input;
+        const std::vector<char> data = serializeMatches(input, std::vector<ParseContext<>::MatchType>());
+        const SerializedMatchTree<std::string> tree(data.data(), data.size());
+        assert(tree.empty() && tree.roots().empty());
+    }
+
+    //invalid data
+    {
+        const std::string input = "1+2";
+        FlatParseContext pc(input);
+        flatAdd(pc);
+        const std::vector<char> data = serializeMatches(input, pc.matches());
+        const auto invalid = [](const std::vector<char>& data, size_t size, auto idType) {
+            try {
+                SerializedMatchTree<decltype(idType)>(data.data(), size);
+            }
+            catch (const std::runtime_error&) {
+                return true;
+            }
+            return false;
+        };
+        assert(!invalid(data, data.size(), std::string()));
+        assert(invalid(data, data.size() - 1, std::string()));
+        assert(invalid(data, 10, std::string()));
+        assert(invalid(data, data.size(), ebnf::EBNF()));
+        std::vector<char> corrupted = data;
+        corrupted[0] = 'X';
+        assert(invalid(corrupted, corrupted.size(), std::string()));
+    }
+
+    //corrupt nodes
+    {
+        using Format = SerializedMatchTreeFormat;
+        const std::string input = "1*2+3";
+        FlatParseContext pc(input);
+        flatAdd(pc);
+        const std::vector<char> data = serializeMatches(input, pc.matches());
+        const size_t nodeCount = SerializedMatchTree<std::string>(data.data(), data.size()).size();
+        assert(nodeCount >= 2);
+        const auto corrupt = [&](size_t index, size_t member, std::uint64_t value) {
+            std::vector<char> corrupted = data;
+            std::memcpy(corrupted.data() + sizeof(Format::Header) + index * sizeof(Format::Node) + member, &value, sizeof(value));
+            try {
+                SerializedMatchTree<std::string>(corrupted.data(), corrupted.size());
+            }
+            catch (const std::runtime_error&) {
+                return true;
+            }
+            return false;
+        };
+        assert(corrupt(0, offsetof(Format::Node, subtreeSize), 0));
+        assert(corrupt(0, offsetof(Format::Node, subtreeSize), nodeCount + 1));
+        assert(corrupt(1, offsetof(Format::Node, subtreeSize), nodeCount));
+        assert(corrupt(1, offsetof(Format::Node, id), 1000));
+        assert(!corrupt(1, offsetof(Format::Node, subtreeSize), 1));
+    }
+}
+
+
+static void unitTest_matchId() {
+    //names are interned once
+    {
+        const size_t tableSize = MatchIdTable::instance().size();
+        const MatchId a("unitTest_matchId_a");
+        const MatchId b(std::string("unitTest_matchId_a"));
+        const MatchId c(std::string_view("unitTest_matchId_c"));
+        assert(MatchIdTable::instance().size() == tableSize + 2);
+        assert(a == b && a.index() == b.index() && &a.name() == &b.name());
+        assert(a != c && a.index() != c.index());
+        assert(a == "unitTest_matchId_a" && a != "unitTest_matchId_c" && c == std::string("unitTest_matchId_c"));
+        assert(MatchId().index() == 0 && MatchId().name().empty() && MatchId() == MatchId(""));
+        assert(MatchIdTable::instance().symbol(c.index())->name == "unitTest_matchId_c");
+        std::stringstream stream;
+        stream << a;
+        assert(stream.str() == "unitTest_matchId_a");
+    }
+
+    //concurrent interning returns the same symbols
+    {
+        std::vector<std::thread> threads;
+        std::vector<std::vector<MatchId>> ids(4);
+        for (auto& threadIds : ids) {
+            threads.emplace_back([&threadIds]() {
+                for (size_t index = 0; index < 100; ++index) {
+                    threadIds.emplace_back("unitTest_matchId_" + std::to_string(index));
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (size_t index = 0; index < 100; ++index) {
+            assert(ids[0][index] == ids[1][index] && ids[0][index] == ids[2][index] && ids[0][index] == ids[3][index]);
+        }
+    }
+
+    //string literal ids are interned when the grammar is built, and work with both interned and string ids
+    {
+        using InternedParseContext = ParseContext<std::string, MatchId>;
+        const auto integer = +terminalRange('0', '9') == "int";
+        const auto expr = (integer >> *(terminal('+') >> integer)) >= "add";
+        const std::string input = "1+22+3";
+
+        InternedParseContext pc(input);
+        assert(expr(pc) && pc.sourceEnded());
+        assert(pc.matches().size() == 1);
+        const auto& add = pc.matches()[0];
+        assert(add.id() == MatchId("add") && add.id() == "add");
+        assert(add.children().size() == 3 && add.children()[1].id() == "int" && add.children()[1].content() == "22");
+
+        ParseContext<> stringPC(input);
+        assert(expr(stringPC) && stringPC.sourceEnded());
+        assert(stringPC.matches().size() == 1 && stringPC.matches()[0].id() == "add" && stringPC.matches()[0].children().size() == 3);
+
+        Rule<InternedParseContext> rule = integer >> *(terminal('+') >> integer);
+        const auto ruleExpr = rule >= "add";
+        InternedParseContext rulePC(input);
+        assert(ruleExpr(rulePC) && rulePC.matches().size() == 1 && rulePC.matches()[0].id() == add.id());
+
+        using FlatInternedParseContext = ParseContext<std::string, MatchId, SourcePosition<std::string>, FlatMatchTree<std::string, MatchId, SourcePosition<std::string>>>;
+        FlatInternedParseContext flatPC(input);
+        assert(expr(flatPC) && flatPC.sourceEnded());
+        assert((*flatPC.matches().roots().begin()).id() == "add" && flatPC.matches().size() == 4);
+
+        //interned ids are serialized by name
+        const std::vector<char> data = serializeMatches(input, flatPC.matches());
+        const SerializedMatchTree<MatchId> tree(data.data(), data.size());
+        assert(tree.stringCount() == 2 && (*tree.roots().begin()).id() == "add" && tree.match(2).id() == "int");
+        const SerializedMatchTree<std::string> stringTree(data.data(), data.size());
+        assert(equalMatches(input, *stringPC.matches().begin(), *stringTree.roots().begin()));
+    }
+
+    //wide character ids
+    {
+        const auto grammar = +terminalRange(L'a', L'z') == L"word";
+        const std::wstring input = L"abc";
+        ParseContext<std::wstring, BasicMatchId<wchar_t>> pc(input);
+        assert(grammar(pc) && pc.matches().size() == 1 && pc.matches()[0].id() == L"word");
+    }
+}
+
+
+//pool for the parallel choices of the unit tests
+static ParallelChoicePool parallelPool(3);
+
+
+//left-recursive arithmetic grammar, the choices of which are parallel
+extern Rule<FlatParseContext> parallelAdd;
+
+
+static Rule<FlatParseContext> parallelNum = parallelChoice(integer | ('(' >> parallelAdd >> ')'), parallelPool);
+
+
+static Rule<FlatParseContext> parallelMul = parallelChoice(((parallelMul >> '*' >> parallelNum) >= "mul")
+                                                         | ((parallelMul >> '/' >> parallelNum) >= "div")
+                                                         | parallelNum, parallelPool);
+
+
+Rule<FlatParseContext> parallelAdd = parallelChoice(((parallelAdd >> '+' >> parallelMul) >= "add")
+                                                  | ((parallelAdd >> '-' >> parallelMul) >= "sub")
+                                                  | parallelMul, parallelPool);
+
+
+//parser that throws, for testing the propagation of exceptions from parallel choices
+class ThrowingParser : public ParserNode<ThrowingParser> {
+public:
+    template <class ParseContextType> bool operator ()(ParseContextType& pc) const {
+        throw std::logic_error("ThrowingParser");
+    }
+};
+
+
+static void unitTest_parallelChoice() {
+    ParallelChoicePool& pool = parallelPool;
+
+    //the same result as the sequential choice: the first alternative, in order, that succeeds
+    {
+        Rule<> digits = +terminalRange('0', '9');
+        Rule<> letters = +terminalRange('a', 'z');
+        const auto alternatives = ((digits >> '.' >> digits) == "float")
+                                | ((letters >> digits) == "name")
+                                | ((digits >> -terminal('.')) == "int")
+                                | (+terminalRange('a', 'z') == "word");
+        const auto sequential = *(alternatives >> *terminal(' '));
+        const auto parallel = *(parallelChoice(alternatives, pool) >> *terminal(' '));
+        for (const char* input : { "12.5 abc12 12. xyz 7", "abc", "1.", "", "12.5.", "a1 ! b" }) {
+            const std::string str = input;
+            ParseContext<> sequentialPC(str);
+            ParseContext<> parallelPC(str);
+            const bool sequentialResult = sequential(sequentialPC);
+            const bool parallelResult = parallel(parallelPC);
+            assert(sequentialResult == parallelResult);
+            assert(sequentialPC.sourcePosition() == parallelPC.sourcePosition());
+            assert(sequentialPC.matches().size() == parallelPC.matches().size());
+            for (size_t index = 0; index < sequentialPC.matches().size(); ++index) {
+                assert(sequentialPC.matches()[index].id() == parallelPC.matches()[index].id());
+                assert(sequentialPC.matches()[index].content() == parallelPC.matches()[index].content());
+            }
+        }
+    }
+
+    //errors of failed alternatives are kept if the choice fails
+    {
+        const auto alternatives = terminal("abc") | terminal("abd") | terminal('x');
+        const std::string input = "abz";
+        ParseContext<> sequentialPC(input);
+        ParseContext<> parallelPC(input);
+        assert(!alternatives(sequentialPC) && !parallelChoice(alternatives, pool)(parallelPC));
+        assert(sequentialPC.errors().size() == parallelPC.errors().size() && !parallelPC.errors().empty());
+        assert(sequentialPC.errors()[0].position() == parallelPC.errors()[0].position());
+    }
+
+    //an alternative that fails after a cut ends the choice
+    {
+        const auto grammar = parallelChoice((terminal('a') >> cut() >> 'b') | terminal("ac"), pool);
+        const std::string input = "ac";
+        ParseContext<> pc(input);
+        assert(!grammar(pc));
+        assert(pc.cutCount() == 1);
+    }
+
+    //exceptions of alternatives after the successful alternative are discarded
+    {
+        const auto grammar = parallelChoice(terminal('a') | ThrowingParser(), pool);
+        const std::string input = "a";
+        ParseContext<> pc(input);
+        assert(grammar(pc) && pc.sourceEnded());
+
+        const std::string failingInput = "b";
+        ParseContext<> failingPC(failingInput);
+        bool thrown = false;
+        try {
+            grammar(failingPC);
+        }
+        catch (const std::logic_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    //tree matches take the matches of the successful alternative; flat match trees are supported
+    {
+        const auto integer = +terminalRange('0', '9') == "int";
+        const auto grammar = (parallelChoice((integer >> '+' >> integer) | (integer >> '-' >> integer), pool)) >= "op";
+        const std::string input = "12-3";
+        FlatParseContext pc(input);
+        assert(grammar(pc) && pc.sourceEnded());
+        assert(pc.matches().size() == 3);
+        const auto op = *pc.matches().roots().begin();
+        assert(op.id() == "op" && op.children().size() == 2);
+    }
+
+    //nested parallel choices and left recursion
+    {
+        for (const auto& [input, value] : { std::make_pair("1+2*3-4", 3), std::make_pair("(1+2)*(3-6)/3+8", 5) }) {
+            const std::string str = input;
+            FlatParseContext pc(str);
+            assert(parallelAdd(pc) && pc.sourceEnded());
+            assert(pc.matches().roots().size() == 1 && eval(*pc.matches().roots().begin()) == value);
+        }
+    }
+
+    //rules throw once a fork is cancelled; parse contexts that are not forks do not check the flag
+    {
+        Rule<> rule = terminal('a');
+        const std::string input = "a";
+        std::atomic<bool> cancelled{ false };
+        ParseContext<> root(input);
+        root.setCancellationFlag(&cancelled);
+        ParseContext<> pc = root.fork();
+        assert(!pc.cancelled() && rule(pc));
+        cancelled = true;
+        pc.reset(input);
+        bool thrown = false;
+        try {
+            rule(pc);
+        }
+        catch (const ParseCancelledException&) {
+            thrown = true;
+        }
+        assert(thrown && pc.cancelled());
+        assert(rule(root) && root.sourceEnded());
+    }
+}
+
+
+using PushParseContext = ParseContext<PushSource<>>;
+
+
+//left-recursive arithmetic grammar over a push source; left-recursive rules are invoked natively by bytecode programs
+extern Rule<PushParseContext> pushAdd;
+
+
+static Rule<PushParseContext> pushNum = integer | ('(' >> pushAdd >> ')');
+
+
+static Rule<PushParseContext> pushMul = ((pushMul >> '*' >> pushNum) >= "mul")
+                                      | ((pushMul >> '/' >> pushNum) >= "div")
+                                      | pushNum;
+
+
+Rule<PushParseContext> pushAdd = ((pushAdd >> '+' >> pushMul) >= "add")
+                               | ((pushAdd >> '-' >> pushMul) >= "sub")
+                               | pushMul;
+
+
+static void unitTest_resumableParsing() {
+    const Rule<PushParseContext> ws = *terminalSet(' ', '\n');
+    const Rule<PushParseContext> identifier = (+(terminalRange('a', 'z') | '_') - "null") == "identifier";
+    const Rule<PushParseContext> list = ('[' >> ws >> -(identifier >> *(',' >> ws >> identifier)) >> ']') >= "list";
+    const Rule<PushParseContext> value = (((terminal("null") == "null") | list | identifier | ('=' >> pushAdd)) >> ws);
+    const Rule<PushParseContext> grammar = ws >> *value >> eof();
+    const auto program = compileBytecode(grammar);
+
+    //parsing in chunks gives the same result as parsing the whole input
+    const auto compare = [&](const std::string& input, size_t chunkSize) {
+        PushSource<> wholeSource;
+        wholeSource.append(input.data(), input.size());
+        PushParseContext wholePC(wholeSource);
+        const bool wholeResult = program(wholePC);
+
+        PushSource<> source;
+        PushParseContext pc(source);
+        BytecodeMachine<PushParseContext> machine(program);
+        ParseStatus status = machine.start(pc);
+        for (size_t offset = 0; offset < input.size() && status == ParseStatus::NeedMoreInput; offset += chunkSize) {
+            source.append(input.data() + offset, std::min(chunkSize, input.size() - offset));
+            status = machine.resume(pc);
+        }
+        if (status == ParseStatus::NeedMoreInput) {
+            assert(machine.suspended());
+            status = machine.resume(pc, true);
+        }
+        assert(!machine.suspended());
+
+        assert((status == ParseStatus::Success) == wholeResult);
+        assert(pc.sourcePosition().iterator().index() == wholePC.sourcePosition().iterator().index());
+        assert(pc.matches().size() == wholePC.matches().size());
+        for (size_t i = 0; i < pc.matches().size(); ++i) {
+            assert(pc.matches()[i].id() == wholePC.matches()[i].id());
+            assert(pc.matches()[i].begin().iterator().index() == wholePC.matches()[i].begin().iterator().index());
+            assert(pc.matches()[i].end().iterator().index() == wholePC.matches()[i].end().iterator().index());
+            assert(pc.matches()[i].children().size() == wholePC.matches()[i].children().size());
+        }
+        assert(pc.errors().size() == wholePC.errors().size());
+        return status;
+    };
+    for (const std::string input : { "", "a [b, c_d] null nullable =1+2*(3-4)/5 e", "[a, [b]]", "[a b]", "[a,", "=1+", "=(1", "nul", "null =12 x" }) {
+        for (size_t chunkSize : { 1, 2, 3, 7, 1000 }) {
+            compare(input, chunkSize);
+        }
+    }
+    assert(compare("a [b, c_d] null =1+2*(3-4)/5", 1) == ParseStatus::Success);
+    assert(compare("[a b]", 1) == ParseStatus::Failure);
+
+    {
+        //failure is detected as soon as the input received so far cannot be parsed
+        const std::string input = "[a b";
+        PushSource<> source;
+        source.append(input.data(), input.size());
+        PushParseContext pc(source);
+        BytecodeMachine<PushParseContext> machine(program);
+        assert(machine.start(pc) == ParseStatus::Failure);
+        assert(pc.sourcePosition().iterator().index() == 0);
+    }
+
+    {
+        //matches are delivered while the input is received, as soon as the loop iteration they belong to is complete
+        const std::string input = "ab cd ef";
+        std::vector<std::string> delivered;
+        PushSource<> source;
+        PushParseContext pc(source);
+        pc.setMatchHandler([&](const PushParseContext::MatchType& match) {
+            delivered.push_back(std::string(match.begin().iterator(), match.end().iterator()));
+        });
+        BytecodeMachine<PushParseContext> machine(program);
+        assert(machine.start(pc) == ParseStatus::NeedMoreInput);
+        source.append(input.data(), 6);
+        assert(machine.resume(pc) == ParseStatus::NeedMoreInput);
+        assert(delivered == std::vector<std::string>({ "ab" }));
+        source.append(input.data() + 6, 2);
+        assert(machine.resume(pc) == ParseStatus::NeedMoreInput);
+        assert(delivered == std::vector<std::string>({ "ab", "cd" }));
+        assert(machine.resume(pc, true) == ParseStatus::Success);
+        assert(delivered == std::vector<std::string>({ "ab", "cd", "ef" }));
+    }
+
+    {
+        //matches of native parsers are delivered once, after the native parser is run on enough input
+        const auto item = (terminal('a') == "a") >> ';';
+        const Rule<PushParseContext> nativeGrammar = (3 * item) >> eof();
+        const auto nativeProgram = compileBytecode(nativeGrammar);
+        const std::string input = "a;a;a;";
+        size_t deliveredCount = 0;
+        PushSource<> source;
+        PushParseContext pc(source);
+        pc.setMatchHandler([&](const PushParseContext::MatchType&) {
+            ++deliveredCount;
+        });
+        BytecodeMachine<PushParseContext> machine(nativeProgram);
+        ParseStatus status = machine.start(pc);
+        for (size_t offset = 0; offset < input.size() && status == ParseStatus::NeedMoreInput; ++offset) {
+            source.append(input.data() + offset, 1);
+            status = machine.resume(pc);
+        }
+        if (status == ParseStatus::NeedMoreInput) {
+            status = machine.resume(pc, true);
+        }
+        assert(status == ParseStatus::Success);
+        assert(deliveredCount == 3);
+    }
+
+    {
+        //only suspended parsing can be resumed
+        PushSource<> source;
+        PushParseContext pc(source);
+        BytecodeMachine<PushParseContext> machine(program);
+        bool thrown = false;
+        try {
+            machine.resume(pc);
+        }
+        catch (const std::logic_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+}
+
+
 void runUnitTests() {
-    //unitTest_AndParser();
-    //unitTest_ChoiceParser();
-    //unitTest_Loop0Parser();
-    //unitTest_Loop1Parser();
-    //unitTest_LoopNParser();
-    //unitTest_NotParser();
-    //unitTest_OptionalParser();
-    //unitTest_Rule();
-    //unitTest_sequenceParser();
-    //unitTest_terminalParser();
-    //unitTest_terminalRangeParser();
-    //unitTest_terminalSetParser();
-    //unitTest_terminalStringParser();
-    //unitTest_Match();
-    //unitTest_TreeMatch();
-    //unitTest_recursion();
-    //unitTest_leftRecursion();
-    //unitTest_lineCountingSourcePosition();
-    //unitTest_errorHandling();
+    unitTest_AndParser();
+    unitTest_ChoiceParser();
+    unitTest_Loop0Parser();
+    unitTest_Loop1Parser();
+    unitTest_LoopNParser();
+    unitTest_NotParser();
+    unitTest_OptionalParser();
+    unitTest_Rule();
+    unitTest_sequenceParser();
+    unitTest_terminalParser();
+    unitTest_terminalRangeParser();
+    unitTest_terminalSetParser();
+    unitTest_terminalStringParser();
+    unitTest_Match();
+    unitTest_TreeMatch();
+    unitTest_recursion();
+    unitTest_leftRecursion();
+    unitTest_lineCountingSourcePosition();
+    unitTest_errorHandling();
     unitTest_errorRecovery();
+    unitTest_memoization();
+    unitTest_ruleIndex();
+    unitTest_flatMatchTree();
+    unitTest_characterSet();
+    unitTest_characterScan();
+    unitTest_errorMessages();
+    unitTest_noErrors();
+    unitTest_contentView();
+    unitTest_mappedFileSource();
+    unitTest_streamSource();
+    unitTest_cut();
+    unitTest_matchHandler();
+    unitTest_parallelParse();
+    unitTest_concurrentParse();
+    unitTest_bytecode();
+    unitTest_firstSet();
+    unitTest_profiling();
+    unitTest_incremental();
+    unitTest_maxRuleDepth();
+    unitTest_lineIndex();
+    unitTest_compactSourcePosition();
+    unitTest_terminalStringComparison();
+    unitTest_keywordsParser();
+    unitTest_tokenStream();
+    unitTest_parseArena();
+    unitTest_reset();
+    unitTest_errorRecoveryScan();
+    unitTest_ebnfCompiler();
+    unitTest_serializedMatchTree();
+    unitTest_matchId();
+    unitTest_parallelChoice();
+    unitTest_resumableParsing();
 }